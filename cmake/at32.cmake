@@ -236,10 +236,7 @@ function(add_at32_executable)
     if(WARNINGS_AS_ERRORS)
         target_compile_options(${elf_target} PRIVATE -Werror)
     endif()
-    if (IS_RELEASE_BUILD)
-        target_compile_options(${elf_target} PRIVATE ${args_OPTIMIZATION})
-        target_link_options(${elf_target} PRIVATE ${args_OPTIMIZATION})
-    endif()
+    setup_optimization(${elf_target} "${args_OPTIMIZATION}")
     target_link_libraries(${elf_target} PRIVATE ${AT32_LINK_LIBRARIES})
     target_link_options(${elf_target} PRIVATE ${AT32_LINK_OPTIONS} ${args_LINK_OPTIONS})
     generate_map_file(${elf_target})
@@ -273,7 +270,7 @@ function(target_at32)
         # Boolean arguments
         "DISABLE_MSC;BOOTLOADER"
         # Single value arguments
-        "HSE_MHZ;LINKER_SCRIPT;NAME;OPENOCD_TARGET;OPTIMIZATION;STARTUP;SVD"
+        "HSE_MHZ;LINKER_SCRIPT;NAME;OPENOCD_TARGET;OPTIMIZATION;STARTUP;SVD;TCM_CODE_BUDGET;TCM_DATA_BUDGET"
         # Multi-value arguments
         "COMPILE_DEFINITIONS;COMPILE_OPTIONS;INCLUDE_DIRECTORIES;LINK_OPTIONS;SOURCES;MSC_SOURCES;MSC_INCLUDE_DIRECTORIES;VCP_SOURCES;VCP_INCLUDE_DIRECTORIES"
         # Start parsing after the known arguments
@@ -353,6 +350,7 @@ function(target_at32)
         OUTPUT_TARGET_NAME main_target_name
 
     )
+    setup_tcm_placement(${main_target_name} "${args_TCM_CODE_BUDGET}" "${args_TCM_DATA_BUDGET}")
 
     set_property(TARGET ${main_target_name} PROPERTY OPENOCD_TARGET ${args_OPENOCD_TARGET})
     set_property(TARGET ${main_target_name} PROPERTY OPENOCD_DEFAULT_INTERFACE atlink)
@@ -70,6 +70,10 @@ function(target_at32f43x)
 
         OPENOCD_TARGET at32f437xx
 
+        # Code and data share the 64K of zero wait state RAM1
+        TCM_CODE_BUDGET 16384
+        TCM_DATA_BUDGET 32768
+
         ${ARGN}
     )
 endfunction()
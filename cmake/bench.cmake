@@ -0,0 +1,206 @@
+# Hot kernel benchmarks. The same sources are built for the host (see
+# src/test/bench/CMakeLists.txt) and, with the arm-none-eabi toolchain,
+# as semihosted images that run under qemu-system-arm. See
+# docs/development/Benchmarks.md.
+
+set(BENCH_DIR "${MAIN_DIR}/src/test/bench")
+
+file(GLOB BENCH_KERNEL_SRC "${BENCH_DIR}/*_bench.c")
+set(BENCH_SRC
+    "${BENCH_DIR}/bench.c"
+    "${BENCH_DIR}/bench_main.c"
+    ${BENCH_KERNEL_SRC}
+)
+
+# Firmware sources exercised by the kernels. Keep these alphabetically sorted.
+main_sources(BENCH_MAIN_SRC
+    common/circular_queue.c
+    common/crc.c
+    common/filter.c
+    common/maths.c
+    common/streambuf.c
+    fc/fc_msp_replies.c
+    flight/dynamic_lpf_table.c
+    flight/kalman.c
+    flight/servo_mixer_rules.c
+    flight/servo_output.c
+    flight/smith_predictor.c
+    rx/rx_pipeline.c
+    rx/sbus_channels.c
+)
+
+set(BENCH_INCLUDE_DIRS
+    "${BENCH_DIR}"
+    "${MAIN_DIR}/src/test/unit"
+    "${MAIN_SRC_DIR}"
+)
+
+set(BENCH_DEFINITIONS
+    UNIT_TEST
+    USE_GYRO_KALMAN
+    USE_SERIAL_RX
+    USE_SMITH_PREDICTOR
+)
+
+set(BENCH_COMPILE_OPTIONS
+    -Wall
+    -Wextra
+    -Wdouble-promotion
+    -fsingle-precision-constant
+)
+
+if(NOT arm-none-eabi STREQUAL TOOLCHAIN)
+    return()
+endif()
+
+set(QEMU_SYSTEM_ARM "" CACHE STRING "path to qemu-system-arm (default: search for it)")
+set(BENCH_BASELINE_DIR "" CACHE PATH "directory with bench_<name>.txt results to compare against in check-bench_<name>")
+set(BENCH_REGRESSION_THRESHOLD 5 CACHE STRING "percentage a kernel may get slower before check-bench_<name> fails")
+
+if(QEMU_SYSTEM_ARM)
+    set(QEMU_SYSTEM_ARM_PATH ${QEMU_SYSTEM_ARM})
+else()
+    find_program(QEMU_SYSTEM_ARM_PATH NAMES qemu-system-arm qemu-system-arm.exe)
+    if(NOT QEMU_SYSTEM_ARM_PATH)
+        message(STATUS "Could not find qemu-system-arm, run-bench targets won't be available")
+    endif()
+endif()
+
+find_program(PYTHON_EXECUTABLE NAMES python3 python)
+
+function(target_bench name)
+    cmake_parse_arguments(
+        args
+        # Boolean arguments
+        ""
+        # Single value arguments
+        "MACHINE;SYSTICK_HZ;LINKER_SCRIPT;OPTIMIZATION"
+        # Multi-value arguments
+        "COMMON_OPTIONS;DEFINITIONS"
+        # Start parsing after the known arguments
+        ${ARGN}
+    )
+
+    set(exe bench_${name})
+    set(script_dir "${BENCH_DIR}/cortex-m")
+    set(script_path "${script_dir}/${args_LINKER_SCRIPT}.ld")
+
+    add_executable(${exe}
+        ${BENCH_SRC}
+        ${BENCH_MAIN_SRC}
+        "${script_dir}/bench_cortex_m.c"
+    )
+    target_include_directories(${exe} PRIVATE ${BENCH_INCLUDE_DIRS})
+    target_compile_definitions(${exe} PRIVATE
+        ${BENCH_DEFINITIONS}
+        ${args_DEFINITIONS}
+        BENCH_SYSTICK_HZ=${args_SYSTICK_HZ}
+        BENCH_PLATFORM_NAME="${name}"
+    )
+    target_compile_options(${exe} PRIVATE
+        ${args_COMMON_OPTIONS}
+        ${BENCH_COMPILE_OPTIONS}
+        ${args_OPTIMIZATION}
+        -ffunction-sections
+        -fdata-sections
+    )
+    target_link_options(${exe} PRIVATE
+        ${args_COMMON_OPTIONS}
+        -nostartfiles
+        --specs=nano.specs
+        --specs=rdimon.specs
+        -Wl,-gc-sections
+        -Wl,-L${script_dir}
+        -Wl,--print-memory-usage
+        -T${script_path}
+    )
+    target_link_libraries(${exe} PRIVATE -lrdimon -lm -lc)
+    set_target_properties(${exe} PROPERTIES
+        LINK_DEPENDS "${script_path};${script_dir}/bench_sections.ld"
+        RUNTIME_OUTPUT_DIRECTORY "${CMAKE_BINARY_DIR}/bench"
+    )
+    if(IS_RELEASE_BUILD)
+        # Link like the firmware, so cross module calls get inlined the same way
+        set_target_properties(${exe} PROPERTIES INTERPROCEDURAL_OPTIMIZATION ON)
+    endif()
+    exclude_from_all(${exe})
+
+    if(NOT QEMU_SYSTEM_ARM_PATH)
+        return()
+    endif()
+
+    # -icount shift=0 makes every instruction take exactly one virtual ns,
+    # which SysTick then turns into an instruction count per kernel call
+    set(output "${CMAKE_BINARY_DIR}/bench/bench_${name}.txt")
+    add_custom_target(run-bench_${name}
+        COMMAND ${QEMU_SYSTEM_ARM_PATH}
+            -M ${args_MACHINE}
+            -nographic -monitor none -serial none
+            -icount shift=0,align=off
+            -chardev file,id=bench,path=${output}
+            -semihosting-config enable=on,target=native,chardev=bench
+            -kernel $<TARGET_FILE:${exe}>
+        COMMAND ${CMAKE_COMMAND} -E cat ${output}
+        DEPENDS ${exe}
+        BYPRODUCTS ${output}
+        COMMENT "Running ${exe} on QEMU ${args_MACHINE}"
+        USES_TERMINAL
+    )
+
+    if(BENCH_BASELINE_DIR AND PYTHON_EXECUTABLE)
+        add_custom_target(check-bench_${name}
+            COMMAND ${PYTHON_EXECUTABLE} ${MAIN_UTILS_DIR}/bench_compare.py
+                --threshold ${BENCH_REGRESSION_THRESHOLD}
+                ${BENCH_BASELINE_DIR}/bench_${name}.txt ${output}
+            DEPENDS run-bench_${name}
+            USES_TERMINAL
+        )
+    endif()
+endfunction()
+
+# With OPTIMIZATION_PROFILE the firmware modules are built the way the
+# profile builds them for the firmware. The harness and the kernels keep the
+# family level, so only the code under test changes between two runs.
+if(IS_RELEASE_BUILD AND OPTIMIZATION_PROFILE STREQUAL "speed")
+    set(bench_cold_src ${BENCH_MAIN_SRC})
+    list(REMOVE_ITEM bench_cold_src ${OPTIMIZATION_HOT_SRC})
+    set(bench_hot_src ${BENCH_MAIN_SRC})
+    list(REMOVE_ITEM bench_hot_src ${bench_cold_src})
+    if(bench_cold_src)
+        set_source_files_properties(${bench_cold_src} PROPERTIES COMPILE_OPTIONS ${OPTIMIZATION_PROFILE_COLD})
+    endif()
+    if(bench_hot_src)
+        set_source_files_properties(${bench_hot_src} PROPERTIES COMPILE_OPTIONS ${OPTIMIZATION_PROFILE_HOT})
+    endif()
+endif()
+
+# One image per target family we fly. Optimization levels match the ones
+# used by the firmware for each MCU.
+target_bench(f405
+    MACHINE netduinoplus2
+    SYSTICK_HZ 168000000
+    LINKER_SCRIPT netduinoplus2
+    OPTIMIZATION -O2
+    COMMON_OPTIONS ${CORTEX_M4F_COMMON_OPTIONS}
+    DEFINITIONS ${CORTEX_M4F_DEFINITIONS}
+)
+
+target_bench(f722
+    MACHINE mps2-an500
+    SYSTICK_HZ 25000000
+    LINKER_SCRIPT mps2_an500
+    OPTIMIZATION -Os
+    COMMON_OPTIONS ${CORTEX_M7_COMMON_OPTIONS}
+    DEFINITIONS ${CORTEX_M7_DEFINITIONS}
+)
+
+target_bench(h743
+    MACHINE mps2-an500
+    SYSTICK_HZ 25000000
+    LINKER_SCRIPT mps2_an500
+    OPTIMIZATION -O2
+    COMMON_OPTIONS ${CORTEX_M7_COMMON_OPTIONS}
+    DEFINITIONS ${CORTEX_M7_DEFINITIONS}
+)
+
+add_custom_target(bench DEPENDS bench_f405 bench_f722 bench_h743)
@@ -0,0 +1,60 @@
+# Optional per module optimization profile for the firmware and the hot
+# kernel benchmarks. See docs/development/Build_Profiles.md.
+#
+# Release builds are already linked with LTO and compiled at the family
+# optimization level (-O2, or -Os on small flash parts). The "speed" profile
+# builds the modules on the gyro/PID/mixer path at -O3 and everything else at
+# -Os, so the loop gets faster while the image still fits in flash.
+
+set(OPTIMIZATION_PROFILE "" CACHE STRING "per module optimization: empty for the MCU family default, 'speed' for -O3 hot modules and -Os elsewhere")
+set_property(CACHE OPTIMIZATION_PROFILE PROPERTY STRINGS "" speed)
+set(OPTIMIZATION_PROFILE_HOT -O3 CACHE STRING "optimization of the hot modules in the speed profile")
+set(OPTIMIZATION_PROFILE_COLD -Os CACHE STRING "optimization of all other modules in the speed profile")
+
+if(OPTIMIZATION_PROFILE AND NOT OPTIMIZATION_PROFILE STREQUAL "speed")
+    message(FATAL_ERROR "Invalid OPTIMIZATION_PROFILE ${OPTIMIZATION_PROFILE}. Valid options are: speed")
+endif()
+if(OPTIMIZATION_PROFILE)
+    message("-- Optimization profile: ${OPTIMIZATION_PROFILE} (${OPTIMIZATION_PROFILE_HOT} hot modules, ${OPTIMIZATION_PROFILE_COLD} elsewhere)")
+endif()
+
+# Modules running on every gyro/PID loop iteration, together with the ones
+# they call across files. LTO only inlines across modules with compatible
+# optimization settings, so callers and callees belong in the same list.
+# Keep these alphabetically sorted.
+main_sources(OPTIMIZATION_HOT_SRC
+    common/filter.c
+    common/maths.c
+    fc/fc_core.c
+    flight/dynamic_gyro_notch.c
+    flight/dynamic_lpf.c
+    flight/kalman.c
+    flight/mixer.c
+    flight/mixer_tricopter.c
+    flight/pid.c
+    flight/rate_dynamics.c
+    flight/rpm_filter.c
+    flight/smith_predictor.c
+    programming/logic_condition.c
+    scheduler/scheduler.c
+    sensors/gyro.c
+)
+
+# Sets the optimization level of a firmware image. Must be called from the
+# directory the target is defined in, since source file properties are
+# directory scoped.
+function(setup_optimization target optimization)
+    if(NOT IS_RELEASE_BUILD)
+        return()
+    endif()
+    if(OPTIMIZATION_PROFILE STREQUAL "speed")
+        set(optimization ${OPTIMIZATION_PROFILE_COLD})
+        set_source_files_properties(${OPTIMIZATION_HOT_SRC} PROPERTIES
+            COMPILE_OPTIONS ${OPTIMIZATION_PROFILE_HOT}
+        )
+    endif()
+    # With LTO the level given for each module at compile time is kept for
+    # its functions, the one at link time applies to the rest.
+    target_compile_options(${target} PRIVATE ${optimization})
+    target_link_options(${target} PRIVATE ${optimization})
+endfunction()
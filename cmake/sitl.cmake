@@ -65,6 +65,12 @@ set(SITL_DEFINITIONS
     SITL_BUILD
 )
 
+# CLI output checks run the SITL binary, see src/utils/cli_dump_compare.py
+if(host STREQUAL TOOLCHAIN)
+    enable_testing()
+    find_program(PYTHON_EXECUTABLE NAMES python3 python)
+endif()
+
 function (target_sitl name)
     if(CMAKE_VERSION VERSION_GREATER 3.22)
         set(CMAKE_C_STANDARD 17)
@@ -131,6 +137,16 @@ function (target_sitl name)
     )
 
     setup_firmware_target(${exe_target} ${name} ${ARGN})
+
+    if(PYTHON_EXECUTABLE)
+        # diff must print what src/test/cli holds, byte for byte
+        add_test(NAME cli_dump_${name}
+            COMMAND ${PYTHON_EXECUTABLE} ${MAIN_UTILS_DIR}/cli_dump_compare.py
+                --expected ${MAIN_DIR}/src/test/cli $<TARGET_FILE:${exe_target}>
+        )
+        # Every SITL listens on the same TCP port
+        set_tests_properties(cli_dump_${name} PROPERTIES TIMEOUT 300 RESOURCE_LOCK sitl_tcp)
+    endif()
     #clean_<target>
     set(generator_cmd "")
     if (CMAKE_GENERATOR STREQUAL "Unix Makefiles")
@@ -245,10 +245,7 @@ function(add_stm32_executable)
     if(WARNINGS_AS_ERRORS)
         target_compile_options(${elf_target} PRIVATE -Werror)
     endif()
-    if (IS_RELEASE_BUILD)
-        target_compile_options(${elf_target} PRIVATE ${args_OPTIMIZATION})
-        target_link_options(${elf_target} PRIVATE ${args_OPTIMIZATION})
-    endif()
+    setup_optimization(${elf_target} "${args_OPTIMIZATION}")
     target_link_libraries(${elf_target} PRIVATE ${STM32_LINK_LIBRARIES})
     target_link_options(${elf_target} PRIVATE ${STM32_LINK_OPTIONS} ${args_LINK_OPTIONS})
     generate_map_file(${elf_target})
@@ -281,7 +278,7 @@ function(target_stm32)
         # Boolean arguments
         "DISABLE_MSC;BOOTLOADER"
         # Single value arguments
-        "HSE_MHZ;LINKER_SCRIPT;NAME;OPENOCD_TARGET;OPTIMIZATION;STARTUP;SVD"
+        "HSE_MHZ;LINKER_SCRIPT;NAME;OPENOCD_TARGET;OPTIMIZATION;STARTUP;SVD;TCM_CODE_BUDGET;TCM_DATA_BUDGET"
         # Multi-value arguments
         "COMPILE_DEFINITIONS;COMPILE_OPTIONS;INCLUDE_DIRECTORIES;LINK_OPTIONS;SOURCES;MSC_SOURCES;MSC_INCLUDE_DIRECTORIES;VCP_SOURCES;VCP_INCLUDE_DIRECTORIES"
         # Start parsing after the known arguments
@@ -359,6 +356,7 @@ function(target_stm32)
         OUTPUT_HEX_FILENAME main_hex_filename
         OUTPUT_TARGET_NAME main_target_name
     )
+    setup_tcm_placement(${main_target_name} "${args_TCM_CODE_BUDGET}" "${args_TCM_DATA_BUDGET}")
 
     set_property(TARGET ${main_target_name} PROPERTY OPENOCD_TARGET ${args_OPENOCD_TARGET})
     set_property(TARGET ${main_target_name} PROPERTY OPENOCD_DEFAULT_INTERFACE stlink)
@@ -114,6 +114,8 @@ function(target_stm32f405xg name)
         COMPILE_DEFINITIONS ${STM32F405_COMPILE_DEFINITIONS}
         LINKER_SCRIPT stm32_flash_f405xg
         SVD STM32F405
+        # 64K CCM, shared with the stack and the FAST memory pool
+        TCM_DATA_BUDGET 49152
         BOOTLOADER
         ${ARGN}
     )
@@ -153,6 +155,7 @@ function(target_stm32f427xg name)
         COMPILE_DEFINITIONS ${STM32F427_COMPILE_DEFINITIONS}
         LINKER_SCRIPT stm32_flash_f427xg
         SVD STM32F411
+        TCM_DATA_BUDGET 49152
         ${ARGN}
     )
 endfunction()
@@ -101,6 +101,10 @@ function(target_stm32f7xx)
 
         OPENOCD_TARGET stm32f7x
 
+        # 16K ITCM. DTCM is 64K or more, shared with the stack and the FAST memory pool
+        TCM_CODE_BUDGET 15360
+        TCM_DATA_BUDGET 49152
+
         BOOTLOADER
 
         ${ARGN}
@@ -189,6 +189,10 @@ function(target_stm32h7xx)
 
         OPENOCD_TARGET stm32h7x
 
+        # 64K ITCM, 128K DTCM shared with the stack and the FAST memory pool
+        TCM_CODE_BUDGET 61440
+        TCM_DATA_BUDGET 98304
+
 #        BOOTLOADER
 
         ${ARGN}
@@ -0,0 +1,46 @@
+# Profile guided placement of hot code and data into tightly coupled memory.
+# See docs/development/TCM_Placement.md.
+
+set(TCM_PROFILE "" CACHE FILEPATH "profile of hot functions and variables used to fill ITCM/DTCM/CCM (default: hand placement only)")
+
+if(TCM_PROFILE)
+    find_program(PYTHON_EXECUTABLE NAMES python3 python)
+    if(NOT PYTHON_EXECUTABLE)
+        message(FATAL_ERROR "TCM_PROFILE requires python3")
+    endif()
+    get_filename_component(TCM_PROFILE_PATH ${TCM_PROFILE} ABSOLUTE)
+    message("-- TCM placement profile: ${TCM_PROFILE_PATH}")
+endif()
+
+# Budgets are the total bytes of TCM the firmware may use for code and for
+# zero initialised data, hand placed FAST_CODE/FASTRAM included. The
+# profile fills whatever the hand placed sections leave.
+function(setup_tcm_placement target code_budget data_budget)
+    if(NOT TCM_PROFILE OR (NOT code_budget AND NOT data_budget))
+        return()
+    endif()
+    if(NOT code_budget)
+        set(code_budget 0)
+    endif()
+    if(NOT data_budget)
+        set(data_budget 0)
+    endif()
+
+    # The generated fragments shadow the empty ones in the linker directory
+    set(tcm_dir "${CMAKE_CURRENT_BINARY_DIR}/${target}_tcm")
+    file(MAKE_DIRECTORY ${tcm_dir})
+    target_link_options(${target} BEFORE PRIVATE -Wl,-L${tcm_dir})
+    set_property(TARGET ${target} APPEND PROPERTY LINK_DEPENDS ${TCM_PROFILE_PATH})
+
+    add_custom_command(TARGET ${target} PRE_LINK
+        COMMAND ${PYTHON_EXECUTABLE} ${MAIN_UTILS_DIR}/tcm_placement.py place
+            --profile ${TCM_PROFILE_PATH}
+            --objects-dir ${CMAKE_CURRENT_BINARY_DIR}/CMakeFiles/${target}.dir
+            --output-dir ${tcm_dir}
+            --code-budget ${code_budget}
+            --data-budget ${data_budget}
+            --objdump ${CMAKE_OBJDUMP}
+        COMMENT "Placing hot code and data from ${TCM_PROFILE} into TCM"
+        VERBATIM
+    )
+endfunction()
@@ -52,6 +52,9 @@ typedef enum FlightLogFieldCondition {
     FLIGHT_LOG_FIELD_CONDITION_NOT_LOGGING_EVERY_FRAME,
 
     FLIGHT_LOG_FIELD_CONDITION_DEBUG,
+    FLIGHT_LOG_FIELD_CONDITION_DEBUG_2,
+    FLIGHT_LOG_FIELD_CONDITION_DEBUG_3,
+    FLIGHT_LOG_FIELD_CONDITION_DEBUG_4,
 
     FLIGHT_LOG_FIELD_CONDITION_NAV_ACC,
     FLIGHT_LOG_FIELD_CONDITION_NAV_POS,
@@ -15,11 +15,61 @@
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <string.h>
+
 #include "build/debug.h"
 
+#include "common/maths.h"
+#include "common/utils.h"
+
 #ifdef DEBUG_SECTION_TIMES
 timeUs_t sectionTimes[2][4];
 #endif
 
+STATIC_ASSERT(DEBUG_COUNT <= 32, debug_modes_must_fit_debug_modes_enabled_mask);
+
 int32_t debug[DEBUG32_VALUE_COUNT];
 uint8_t debugMode;
+
+int32_t *debugModeValues[DEBUG_COUNT];
+
+static int32_t debugExtra[DEBUG_CHANNEL_COUNT - 1][DEBUG32_VALUE_COUNT];
+static uint8_t debugChannelModes[DEBUG_CHANNEL_COUNT];
+
+static int32_t *debugChannelStorage(uint8_t channel)
+{
+    return channel > 0 ? debugExtra[channel - 1] : debug;
+}
+
+/*
+ * Assigns each requested mode its own set of values. A mode requested
+ * more than once, DEBUG_NONE and modes compiled out via DEBUG_MODES_ENABLED
+ * leave their channel empty.
+ */
+void debugChannelsInit(const uint8_t *modes, uint8_t count)
+{
+    memset(debugModeValues, 0, sizeof(debugModeValues));
+    memset(debugChannelModes, DEBUG_NONE, sizeof(debugChannelModes));
+
+    for (uint8_t channel = 0; channel < MIN(count, DEBUG_CHANNEL_COUNT); channel++) {
+        const uint8_t mode = modes[channel];
+        if (mode == DEBUG_NONE || mode >= DEBUG_COUNT || !DEBUG_MODE_COMPILED(mode) || debugModeValues[mode]) {
+            continue;
+        }
+        debugChannelModes[channel] = mode;
+        debugModeValues[mode] = debugChannelStorage(channel);
+    }
+
+    // debugMode is kept for everything which only knows about debug[]
+    debugMode = debugChannelModes[0];
+}
+
+uint8_t debugChannelGetMode(uint8_t channel)
+{
+    return channel < DEBUG_CHANNEL_COUNT ? debugChannelModes[channel] : DEBUG_NONE;
+}
+
+const int32_t *debugChannelGetValues(uint8_t channel)
+{
+    return debugChannelStorage(channel < DEBUG_CHANNEL_COUNT ? channel : 0);
+}
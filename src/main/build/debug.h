@@ -25,7 +25,20 @@
 extern int32_t debug[DEBUG32_VALUE_COUNT];
 extern uint8_t debugMode;
 
-#define DEBUG_SET(mode, index, value) {if (debugMode == (mode)) {debug[(index)] = (value);}}
+// Number of debug modes which can be observed at the same time. Channel 0
+// is debug_mode and writes to debug[], channels 1.. are debug_mode_2.. and
+// each cost DEBUG32_VALUE_COUNT * 4 bytes of RAM and blackbox bandwidth.
+#define DEBUG_CHANNEL_COUNT 4
+
+// Targets short on flash can define DEBUG_MODES_ENABLED as a bitmask of
+// debugType_e to compile out the DEBUG_SET() calls for all other modes.
+#ifndef DEBUG_MODES_ENABLED
+#define DEBUG_MODES_ENABLED 0xFFFFFFFF
+#endif
+
+#define DEBUG_MODE_COMPILED(mode) ((DEBUG_MODES_ENABLED) & (1UL << (mode)))
+
+#define DEBUG_SET(mode, index, value) {if (DEBUG_MODE_COMPILED(mode) && debugModeValues[(mode)]) {debugModeValues[(mode)][(index)] = (value);}}
 
 #define DEBUG_SECTION_TIMES
 
@@ -70,8 +83,16 @@ typedef enum {
     DEBUG_AUTOTRIM,
     DEBUG_AUTOTUNE,
     DEBUG_RATE_DYNAMICS,
-    DEBUG_TRIFLIGHT,
     DEBUG_LANDING,
     DEBUG_POS_EST,
+    DEBUG_TRIFLIGHT,
+    DEBUG_SERVO_OUTPUT,
     DEBUG_COUNT
 } debugType_e;
+
+// Where DEBUG_SET() stores the values of each mode, NULL when not observed
+extern int32_t *debugModeValues[DEBUG_COUNT];
+
+void debugChannelsInit(const uint8_t *modes, uint8_t count);
+uint8_t debugChannelGetMode(uint8_t channel);
+const int32_t *debugChannelGetValues(uint8_t channel);
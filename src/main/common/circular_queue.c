@@ -63,4 +63,179 @@ int circularBufferIsEmpty(circularBuffer_t *circularBuffer) {
 
 size_t circularBufferCountElements(circularBuffer_t *circularBuffer) {
     return circularBuffer->size;
-}
\ No newline at end of file
+}
+
+// The index written by the other side is read with acquire and our own is
+// published with release, so the elements are in place before the other
+// side can see them. On Cortex-M both come with a DMB.
+static inline uint32_t spscLoadAcquire(const volatile uint32_t * index)
+{
+    return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static inline void spscStoreRelease(volatile uint32_t * index, uint32_t value)
+{
+    __atomic_store_n(index, value, __ATOMIC_RELEASE);
+}
+
+static inline void spscCopyElement(void * dst, const void * src, uint32_t elementSize)
+{
+    switch (elementSize) {
+        case 1:
+            *(uint8_t *)dst = *(const uint8_t *)src;
+            break;
+        case 2:
+            memcpy(dst, src, 2);
+            break;
+        case 4:
+            memcpy(dst, src, 4);
+            break;
+        default:
+            memcpy(dst, src, elementSize);
+            break;
+    }
+}
+
+bool spscRingInit(spscRing_t * ring, void * buffer, uint32_t capacity, uint32_t elementSize)
+{
+    if (capacity == 0 || (capacity & (capacity - 1))) {
+        return false;
+    }
+
+    ring->buffer = buffer;
+    ring->mask = capacity - 1;
+    ring->elementSize = elementSize;
+    ring->head = 0;
+    ring->tail = 0;
+
+    return true;
+}
+
+uint32_t spscRingCount(const spscRing_t * ring)
+{
+    return spscLoadAcquire(&ring->head) - spscLoadAcquire(&ring->tail);
+}
+
+uint32_t spscRingFree(const spscRing_t * ring)
+{
+    return ring->mask + 1 - spscRingCount(ring);
+}
+
+bool spscRingIsEmpty(const spscRing_t * ring)
+{
+    return spscRingCount(ring) == 0;
+}
+
+bool spscRingIsFull(const spscRing_t * ring)
+{
+    return spscRingCount(ring) > ring->mask;
+}
+
+bool spscRingPush(spscRing_t * ring, const void * element)
+{
+    const uint32_t head = ring->head;
+
+    if (head - spscLoadAcquire(&ring->tail) > ring->mask) {
+        return false;
+    }
+
+    spscCopyElement(ring->buffer + (head & ring->mask) * ring->elementSize, element, ring->elementSize);
+    spscStoreRelease(&ring->head, head + 1);
+
+    return true;
+}
+
+uint32_t spscRingWriteSpan(spscRing_t * ring, void ** span)
+{
+    const uint32_t head = ring->head;
+    const uint32_t space = ring->mask + 1 - (head - spscLoadAcquire(&ring->tail));
+    const uint32_t toEnd = ring->mask + 1 - (head & ring->mask);
+
+    *span = ring->buffer + (head & ring->mask) * ring->elementSize;
+
+    return space < toEnd ? space : toEnd;
+}
+
+void spscRingCommit(spscRing_t * ring, uint32_t count)
+{
+    spscStoreRelease(&ring->head, ring->head + count);
+}
+
+uint32_t spscRingPushBulk(spscRing_t * ring, const void * elements, uint32_t count)
+{
+    const uint8_t * src = elements;
+    uint32_t pushed = 0;
+
+    // At most two spans: up to the end of the buffer, then from its start
+    for (int i = 0; i < 2 && pushed < count; i++) {
+        void * span;
+        uint32_t length = spscRingWriteSpan(ring, &span);
+
+        if (length > count - pushed) {
+            length = count - pushed;
+        }
+        if (length == 0) {
+            break;
+        }
+
+        memcpy(span, src + pushed * ring->elementSize, length * ring->elementSize);
+        spscRingCommit(ring, length);
+        pushed += length;
+    }
+
+    return pushed;
+}
+
+bool spscRingPop(spscRing_t * ring, void * element)
+{
+    const uint32_t tail = ring->tail;
+
+    if (spscLoadAcquire(&ring->head) == tail) {
+        return false;
+    }
+
+    spscCopyElement(element, ring->buffer + (tail & ring->mask) * ring->elementSize, ring->elementSize);
+    spscStoreRelease(&ring->tail, tail + 1);
+
+    return true;
+}
+
+uint32_t spscRingReadSpan(spscRing_t * ring, const void ** span)
+{
+    const uint32_t tail = ring->tail;
+    const uint32_t count = spscLoadAcquire(&ring->head) - tail;
+    const uint32_t toEnd = ring->mask + 1 - (tail & ring->mask);
+
+    *span = ring->buffer + (tail & ring->mask) * ring->elementSize;
+
+    return count < toEnd ? count : toEnd;
+}
+
+void spscRingConsume(spscRing_t * ring, uint32_t count)
+{
+    spscStoreRelease(&ring->tail, ring->tail + count);
+}
+
+uint32_t spscRingPopBulk(spscRing_t * ring, void * elements, uint32_t count)
+{
+    uint8_t * dst = elements;
+    uint32_t popped = 0;
+
+    for (int i = 0; i < 2 && popped < count; i++) {
+        const void * span;
+        uint32_t length = spscRingReadSpan(ring, &span);
+
+        if (length > count - popped) {
+            length = count - popped;
+        }
+        if (length == 0) {
+            break;
+        }
+
+        memcpy(dst + popped * ring->elementSize, span, length * ring->elementSize);
+        spscRingConsume(ring, length);
+        popped += length;
+    }
+
+    return popped;
+}
@@ -25,6 +25,7 @@
 #ifndef INAV_CIRCULAR_QUEUE_H
 #define INAV_CIRCULAR_QUEUE_H
 
+#include "stdbool.h"
 #include "stdint.h"
 #include "string.h"
 
@@ -44,4 +45,39 @@ int     circularBufferIsFull(circularBuffer_t * circularBuffer);
 int     circularBufferIsEmpty(circularBuffer_t *circularBuffer);
 size_t  circularBufferCountElements(circularBuffer_t * circularBuffer);
 
+/*
+ * Single producer, single consumer ring. The producer only writes head and
+ * the consumer only writes tail, so one side may run in an interrupt (or
+ * another thread) without locking. Both indices run free and are masked on
+ * access, which needs a power of two capacity and leaves all of it usable.
+ */
+typedef struct spscRing_s {
+    volatile uint32_t head;     // Elements ever pushed
+    volatile uint32_t tail;     // Elements ever popped
+    uint32_t mask;              // Capacity - 1
+    uint32_t elementSize;
+    uint8_t * buffer;
+} spscRing_t;
+
+// Fails unless capacity is a power of two
+bool     spscRingInit(spscRing_t * ring, void * buffer, uint32_t capacity, uint32_t elementSize);
+uint32_t spscRingCount(const spscRing_t * ring);
+uint32_t spscRingFree(const spscRing_t * ring);
+bool     spscRingIsEmpty(const spscRing_t * ring);
+bool     spscRingIsFull(const spscRing_t * ring);
+
+// Producer side
+bool     spscRingPush(spscRing_t * ring, const void * element);
+uint32_t spscRingPushBulk(spscRing_t * ring, const void * elements, uint32_t count);
+// Contiguous free space to fill in place (or by DMA), then commit
+uint32_t spscRingWriteSpan(spscRing_t * ring, void ** span);
+void     spscRingCommit(spscRing_t * ring, uint32_t count);
+
+// Consumer side
+bool     spscRingPop(spscRing_t * ring, void * element);
+uint32_t spscRingPopBulk(spscRing_t * ring, void * elements, uint32_t count);
+// Contiguous elements to read in place (or by DMA), then consume
+uint32_t spscRingReadSpan(spscRing_t * ring, const void ** span);
+void     spscRingConsume(spscRing_t * ring, uint32_t count);
+
 #endif //INAV_CIRCULAR_QUEUE_H
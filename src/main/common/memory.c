@@ -24,9 +24,12 @@
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
+#include "build/build_config.h"
+
 #include "common/log.h"
 #include "common/memory.h"
 
@@ -34,41 +37,128 @@
 
 #include "fc/runtime_config.h"
 
-#if !defined(DYNAMIC_HEAP_SIZE)
-#define DYNAMIC_HEAP_SIZE   (2048)
+#if defined(SITL_BUILD) || defined(UNIT_TEST)
+
+// No linker script to take the pools from, use static buffers instead
+#if !defined(MEM_POOL_FAST_SIZE)
+#define MEM_POOL_FAST_SIZE  (4096)
+#endif
+#if !defined(MEM_POOL_RAM_SIZE)
+#define MEM_POOL_RAM_SIZE   (4096)
 #endif
 
-static uint32_t dynHeap[DYNAMIC_HEAP_SIZE / sizeof(uint32_t)];
-static uint32_t dynHeapFreeWord = 0;
-static size_t dynHeapUsage[OWNER_TOTAL_COUNT];
+static uint8_t memPoolFastBuffer[MEM_POOL_FAST_SIZE] __attribute__((aligned(MEM_POOL_DMA_ALIGNMENT)));
+static uint8_t memPoolRamBuffer[MEM_POOL_RAM_SIZE] __attribute__((aligned(MEM_POOL_DMA_ALIGNMENT)));
 
-void * memAllocate(size_t wantedSize, resourceOwner_e owner)
+#define FAST_POOL_START     (&memPoolFastBuffer[0])
+#define FAST_POOL_END       (&memPoolFastBuffer[MEM_POOL_FAST_SIZE])
+#define RAM_POOL_START      (&memPoolRamBuffer[0])
+#define RAM_POOL_END        (&memPoolRamBuffer[MEM_POOL_RAM_SIZE])
+#define DMA_POOL_START      NULL
+#define DMA_POOL_END        NULL
+
+#else
+
+extern uint8_t __fast_pool_start__;
+extern uint8_t __fast_pool_end__;
+extern uint8_t __ram_pool_start__;
+extern uint8_t __ram_pool_end__;
+extern uint8_t __dma_pool_start__;
+extern uint8_t __dma_pool_end__;
+
+#define FAST_POOL_START     (&__fast_pool_start__)
+#define FAST_POOL_END       (&__fast_pool_end__)
+#define RAM_POOL_START      (&__ram_pool_start__)
+#define RAM_POOL_END        (&__ram_pool_end__)
+#define DMA_POOL_START      (&__dma_pool_start__)
+#define DMA_POOL_END        (&__dma_pool_end__)
+
+#endif
+
+typedef struct memPoolDescriptor_s {
+    uint8_t * start;
+    uint8_t * end;
+    size_t alignment;
+} memPoolDescriptor_t;
+
+const char * const memPoolNames[MEM_POOL_COUNT] = {
+    "FAST", "RAM", "DMA"
+};
+
+static const memPoolDescriptor_t memPoolDescriptors[MEM_POOL_COUNT] = {
+    [MEM_POOL_FAST] = { FAST_POOL_START, FAST_POOL_END, MEM_POOL_ALIGNMENT },
+    [MEM_POOL_RAM]  = { RAM_POOL_START,  RAM_POOL_END,  MEM_POOL_ALIGNMENT },
+    [MEM_POOL_DMA]  = { DMA_POOL_START,  DMA_POOL_END,  MEM_POOL_DMA_ALIGNMENT },
+};
+
+static size_t memPoolUsed[MEM_POOL_COUNT];
+static size_t memPoolUsage[MEM_POOL_COUNT][OWNER_TOTAL_COUNT];
+
+size_t memGetPoolSize(memPool_e pool)
 {
-    void * retPointer = NULL;
-    const size_t wantedWords = (wantedSize + sizeof(uint32_t) - 1) / sizeof(uint32_t);
-
-    if ((dynHeapFreeWord + wantedWords) <= DYNAMIC_HEAP_SIZE / sizeof(uint32_t)) {
-        // Success
-        retPointer = &dynHeap[dynHeapFreeWord];
-        dynHeapFreeWord += wantedWords;
-        dynHeapUsage[owner] += wantedWords * sizeof(uint32_t);
-        LOG_DEBUG(SYSTEM, "Memory allocated. Free memory = %d", memGetAvailableBytes());
-    }
-    else {
-        // OOM
-        LOG_ERROR(SYSTEM, "Out of memory");
+    return memPoolDescriptors[pool].end - memPoolDescriptors[pool].start;
+}
+
+static memPool_e memResolvePool(memPool_e pool)
+{
+    // A pool nothing reserved room in and without headroom is empty, e.g.
+    // the DMA pool on F4/F7 where any SRAM is DMA capable. Allocations from
+    // it go to normal SRAM instead
+    return memGetPoolSize(pool) ? pool : MEM_POOL_RAM;
+}
+
+void * memAllocateFromPool(memPool_e pool, size_t wantedSize, resourceOwner_e owner)
+{
+    pool = memResolvePool(pool);
+
+    const memPoolDescriptor_t * desc = &memPoolDescriptors[pool];
+    const size_t offset = (memPoolUsed[pool] + desc->alignment - 1) & ~(desc->alignment - 1);
+    const size_t size = (wantedSize + desc->alignment - 1) & ~(desc->alignment - 1);
+
+    if (offset + size > memGetPoolSize(pool)) {
+        LOG_ERROR(SYSTEM, "Out of memory in %s pool", memPoolNames[pool]);
         ENABLE_ARMING_FLAG(ARMING_DISABLED_OOM);
+        return NULL;
     }
 
+    // Pools are not part of .bss, hand out zeroed memory like a static buffer would be
+    uint8_t * retPointer = desc->start + offset;
+    memset(retPointer, 0, size);
+
+    memPoolUsage[pool][owner] += (offset + size) - memPoolUsed[pool];
+    memPoolUsed[pool] = offset + size;
+    LOG_DEBUG(SYSTEM, "Memory allocated. Free %s memory = %d", memPoolNames[pool], memGetPoolAvailableBytes(pool));
+
     return retPointer;
 }
 
-size_t memGetUsedBytesByOwner(resourceOwner_e owner)
+size_t memGetPoolAvailableBytes(memPool_e pool)
+{
+    return memGetPoolSize(pool) - memPoolUsed[pool];
+}
+
+size_t memGetPoolUsedBytesByOwner(memPool_e pool, resourceOwner_e owner)
+{
+    return (owner == OWNER_FREE) ? memGetPoolAvailableBytes(pool) : memPoolUsage[pool][owner];
+}
+
+void * memAllocate(size_t wantedSize, resourceOwner_e owner)
 {
-    return (owner == OWNER_FREE) ? memGetAvailableBytes() : dynHeapUsage[owner];
+    return memAllocateFromPool(MEM_POOL_RAM, wantedSize, owner);
 }
 
 size_t memGetAvailableBytes(void)
 {
-    return (DYNAMIC_HEAP_SIZE / sizeof(uint32_t) - dynHeapFreeWord) * sizeof(uint32_t);
+    return memGetPoolAvailableBytes(MEM_POOL_RAM);
+}
+
+size_t memGetUsedBytesByOwner(resourceOwner_e owner)
+{
+    size_t total = 0;
+
+    for (int pool = 0; pool < MEM_POOL_COUNT; pool++) {
+        total += memGetPoolUsedBytesByOwner(pool, owner);
+    }
+
+    return total;
 }
@@ -24,9 +24,55 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <stdlib.h>
 #include "drivers/resource.h"
 
+/*
+ * Memory is handed out from a few typed pools. Their bounds come from the
+ * linker script (__<pool>_pool_start__/__<pool>_pool_end__). A pool is as
+ * large as the MEM_POOL_RESERVE()s compiled into the firmware, plus the
+ * headroom set with _Fast_Pool_Size, _Ram_Pool_Size and _Dma_Pool_Size.
+ * Allocation is only meant to be done during init, there is no free.
+ */
+typedef enum {
+    MEM_POOL_FAST = 0,  // FASTRAM region: CCM on F405, DTCM on F7/H7
+    MEM_POOL_RAM,       // Normal SRAM
+    MEM_POOL_DMA,       // DMA capable, non-cacheable RAM. Targets without a dedicated region fall back to MEM_POOL_RAM
+    MEM_POOL_COUNT
+} memPool_e;
+
+#define MEM_POOL_ALIGNMENT      4
+#define MEM_POOL_DMA_ALIGNMENT  32      // Cache line size on Cortex-M7
+
+#define MEM_POOL_SECTION_FAST   ".fast_pool_reserve"
+#define MEM_POOL_SECTION_RAM    ".ram_pool_reserve"
+#define MEM_POOL_SECTION_DMA    ".dma_pool_reserve"
+#define MEM_POOL_ALIGN_FAST     MEM_POOL_ALIGNMENT
+#define MEM_POOL_ALIGN_RAM      MEM_POOL_ALIGNMENT
+#define MEM_POOL_ALIGN_DMA      MEM_POOL_DMA_ALIGNMENT
+
+// Makes room in MEM_POOL_<pool> for an allocation of up to size bytes the
+// module may do at init. The room is only used if the allocation is made,
+// otherwise it stays free in the pool. Nothing sizes itself from that free
+// room yet, so a feature turned off in the configuration doesn't make the
+// others bigger, and the pools take the same RAM either way.
+#if defined(SITL_BUILD) || defined(UNIT_TEST)
+#define MEM_POOL_RESERVE(pool, name, size)
+#else
+#define MEM_POOL_RESERVE(pool, name, size) \
+    static uint8_t memPoolReserve_##name[((size) + MEM_POOL_ALIGN_##pool - 1) & ~(MEM_POOL_ALIGN_##pool - 1)] \
+        __attribute__((section(MEM_POOL_SECTION_##pool), aligned(MEM_POOL_ALIGN_##pool), used))
+#endif
+
+extern const char * const memPoolNames[MEM_POOL_COUNT];
+
+void * memAllocateFromPool(memPool_e pool, size_t wantedSize, resourceOwner_e owner);
+size_t memGetPoolSize(memPool_e pool);
+size_t memGetPoolAvailableBytes(memPool_e pool);
+size_t memGetPoolUsedBytesByOwner(memPool_e pool, resourceOwner_e owner);
+
+// Legacy interface, allocates from MEM_POOL_RAM
+void * memAllocate(size_t wantedSize, resourceOwner_e owner);
 size_t memGetAvailableBytes(void);
 size_t memGetUsedBytesByOwner(resourceOwner_e owner);
-void * memAllocate(size_t wantedSize, resourceOwner_e owner);
@@ -15,6 +15,7 @@
  * along with Cleanflight.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stddef.h>
 #include <string.h>
 #include <stdint.h>
 
@@ -27,37 +28,15 @@ sbuf_t *sbufInit(sbuf_t *sbuf, uint8_t *ptr, uint8_t *end)
     return sbuf;
 }
 
-void sbufWriteU8(sbuf_t *dst, uint8_t val)
+void *sbufReserve(sbuf_t *dst, int len)
 {
-    *dst->ptr++ = val;
-}
-
-void sbufWriteU16(sbuf_t *dst, uint16_t val)
-{
-    sbufWriteU8(dst, val >> 0);
-    sbufWriteU8(dst, val >> 8);
-}
-
-void sbufWriteU32(sbuf_t *dst, uint32_t val)
-{
-    sbufWriteU8(dst, val >> 0);
-    sbufWriteU8(dst, val >> 8);
-    sbufWriteU8(dst, val >> 16);
-    sbufWriteU8(dst, val >> 24);
-}
-
-void sbufWriteU16BigEndian(sbuf_t *dst, uint16_t val)
-{
-    sbufWriteU8(dst, val >> 8);
-    sbufWriteU8(dst, val >> 0);
-}
+    if (sbufBytesRemaining(dst) < len) {
+        return NULL;
+    }
 
-void sbufWriteU32BigEndian(sbuf_t *dst, uint32_t val)
-{
-    sbufWriteU8(dst, val >> 24);
-    sbufWriteU8(dst, val >> 16);
-    sbufWriteU8(dst, val >> 8);
-    sbufWriteU8(dst, val >> 0);
+    void *ptr = dst->ptr;
+    dst->ptr += len;
+    return ptr;
 }
 
 void sbufFill(sbuf_t *dst, uint8_t data, int len)
@@ -19,6 +19,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 // simple buffer-based serializer/deserializer without implicit size check
 // little-endian encoding implemneted now
@@ -30,16 +31,53 @@ typedef struct sbuf_s {
 
 sbuf_t *sbufInit(sbuf_t *sbuf, uint8_t *ptr, uint8_t *end);
 
-void sbufWriteU8(sbuf_t *dst, uint8_t val);
-void sbufWriteU16(sbuf_t *dst, uint16_t val);
-void sbufWriteU32(sbuf_t *dst, uint32_t val);
+// The scalar writers are inline, MSP replies are made of hundreds of them.
+// Multi-byte values go out in a single (possibly unaligned) store, which
+// Cortex-M3 and up handle in hardware. Nothing is checked here; a reply of
+// known length checks its room once with sbufReserve().
+
+static inline void sbufWriteU8(sbuf_t *dst, uint8_t val)
+{
+    *dst->ptr++ = val;
+}
+
+static inline void sbufWriteU16(sbuf_t *dst, uint16_t val)
+{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    val = __builtin_bswap16(val);
+#endif
+    memcpy(dst->ptr, &val, sizeof(val));
+    dst->ptr += sizeof(val);
+}
+
+static inline void sbufWriteU32(sbuf_t *dst, uint32_t val)
+{
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+    val = __builtin_bswap32(val);
+#endif
+    memcpy(dst->ptr, &val, sizeof(val));
+    dst->ptr += sizeof(val);
+}
+
+static inline void sbufWriteU16BigEndian(sbuf_t *dst, uint16_t val)
+{
+    sbufWriteU16(dst, __builtin_bswap16(val));
+}
+
+static inline void sbufWriteU32BigEndian(sbuf_t *dst, uint32_t val)
+{
+    sbufWriteU32(dst, __builtin_bswap32(val));
+}
+
+// Takes len bytes to be filled in place, or NULL without taking anything
+// when they don't fit
+void *sbufReserve(sbuf_t *dst, int len);
+
 void sbufFill(sbuf_t *dst, uint8_t data, int len);
 void sbufWriteData(sbuf_t *dst, const void *data, int len);
 bool sbufWriteDataSafe(sbuf_t *dst, const void *data, int len);
 void sbufWriteString(sbuf_t *dst, const char *string);
 void sbufWriteStringWithZeroTerminator(sbuf_t *dst, const char *string);
-void sbufWriteU16BigEndian(sbuf_t *dst, uint16_t val);
-void sbufWriteU32BigEndian(sbuf_t *dst, uint32_t val);
 
 uint8_t sbufReadU8(sbuf_t *src);
 uint16_t sbufReadU16(sbuf_t *src);
@@ -25,6 +25,7 @@
 #include "build/build_config.h"
 
 #include "common/crc.h"
+#include "common/maths.h"
 #include "common/utils.h"
 
 #include "config/config_eeprom.h"
@@ -76,6 +77,17 @@ typedef struct {
 } PG_PACKED configFooter_t;
 // checksum is appended just after footer. It is not included in footer to make checksum calculation consistent
 
+// Log records take one slot each, a whole number of streamer writes
+#define LOG_SLOT_SIZE (CONFIG_STREAMER_BUFFER_SIZE > 32 ? CONFIG_STREAMER_BUFFER_SIZE : 32)
+#define LOG_RECORD_FORMAT 1
+
+// Header for each log record, the crc16 of header and data follows the data
+typedef struct {
+    uint8_t format;
+    uint8_t size;
+    uint8_t data[];
+} PG_PACKED logRecord_t;
+
 // Used to check the compiler packing at build time.
 typedef struct {
     uint8_t byte;
@@ -117,6 +129,7 @@ void initEEPROM(void)
     BUILD_BUG_ON(sizeof(configHeader_t) != 1);
     BUILD_BUG_ON(sizeof(configFooter_t) != 2);
     BUILD_BUG_ON(sizeof(configRecord_t) != 6);
+    BUILD_BUG_ON(sizeof(logRecord_t) + EEPROM_LOG_RECORD_MAX_SIZE + sizeof(uint16_t) > LOG_SLOT_SIZE);
 
 #if defined(CONFIG_IN_EXTERNAL_FLASH)
     bool eepromLoaded = loadEEPROMFromExternalFlash();
@@ -178,6 +191,107 @@ uint16_t getEEPROMConfigSize(void)
     return eepromConfigSize;
 }
 
+// The log fills the rest of the erase block the config ends in: every
+// config write erases it, and an append can't reach the start of the
+// next block, which would erase that
+static uint32_t getEEPROMLogEnd(void)
+{
+    const uint32_t eraseSize = config_streamer_erase_size();
+    const uint32_t end = (eepromConfigSize + eraseSize - 1) / eraseSize * eraseSize;
+
+    return MIN(end, (uint32_t)(&__config_end - &__config_start));
+}
+
+static uint32_t getEEPROMLogStart(void)
+{
+    return (eepromConfigSize + LOG_SLOT_SIZE - 1) / LOG_SLOT_SIZE * LOG_SLOT_SIZE;
+}
+
+// Erased reads as ones in flash and as zeroes in RAM
+static bool isEEPROMLogSlotBlank(const uint8_t *slot)
+{
+    for (int i = 0; i < LOG_SLOT_SIZE; i++) {
+        if (slot[i] != slot[0]) {
+            return false;
+        }
+    }
+
+    return slot[0] == 0x00 || slot[0] == 0xFF;
+}
+
+void readEEPROMLog(eepromLogRecordFn *fn)
+{
+    if (!eepromConfigSize) {
+        return;
+    }
+
+    const uint32_t end = getEEPROMLogEnd();
+    for (uint32_t offset = getEEPROMLogStart(); offset + LOG_SLOT_SIZE <= end; offset += LOG_SLOT_SIZE) {
+        const uint8_t *slot = &__config_start + offset;
+        if (isEEPROMLogSlotBlank(slot)) {
+            break;
+        }
+
+        // Skip what a power loss left half written
+        const logRecord_t *record = (const logRecord_t *)slot;
+        if (record->format != LOG_RECORD_FORMAT || record->size > EEPROM_LOG_RECORD_MAX_SIZE) {
+            continue;
+        }
+
+        uint16_t checkSum;
+        memcpy(&checkSum, &record->data[record->size], sizeof(checkSum));
+        if (crc16_ccitt_update(0, record, sizeof(*record) + record->size) == checkSum) {
+            fn(record->data, record->size);
+        }
+    }
+}
+
+bool appendEEPROMLog(const void *data, uint8_t size)
+{
+    if (!eepromConfigSize || size > EEPROM_LOG_RECORD_MAX_SIZE) {
+        return false;
+    }
+
+    const uint32_t end = getEEPROMLogEnd();
+    uint32_t offset = getEEPROMLogStart();
+    while (offset + LOG_SLOT_SIZE <= end && !isEEPROMLogSlotBlank(&__config_start + offset)) {
+        offset += LOG_SLOT_SIZE;
+    }
+
+    if (offset + LOG_SLOT_SIZE > end) {
+        // Full until the config is written again
+        return false;
+    }
+
+    union {
+        uint8_t b[LOG_SLOT_SIZE];
+        logRecord_t record;
+    } slot;
+    memset(&slot, 0, sizeof(slot));
+    slot.record.format = LOG_RECORD_FORMAT;
+    slot.record.size = size;
+    memcpy(slot.record.data, data, size);
+    const uint16_t checkSum = crc16_ccitt_update(0, &slot.record, sizeof(slot.record) + size);
+    memcpy(&slot.record.data[size], &checkSum, sizeof(checkSum));
+
+    config_streamer_t streamer;
+    config_streamer_init(&streamer);
+    config_streamer_start(&streamer, (uintptr_t)&__config_start + offset, LOG_SLOT_SIZE);
+    config_streamer_write(&streamer, slot.b, sizeof(slot.b));
+    config_streamer_flush(&streamer);
+    if (config_streamer_finish(&streamer) != 0) {
+        return false;
+    }
+
+#ifdef CONFIG_IN_EXTERNAL_FLASH
+    if (!loadEEPROMFromExternalFlash()) {
+        return false;
+    }
+#endif
+
+    return memcmp(&__config_start + offset, slot.b, sizeof(slot.b)) == 0;
+}
+
 // find config record for reg + classification (profile info) in EEPROM
 // return NULL when record is not found
 // this function assumes that EEPROM content is valid
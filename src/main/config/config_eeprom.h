@@ -27,3 +27,12 @@ bool isEEPROMContentValid(void);
 bool loadEEPROM(void);
 void writeConfigToEEPROM(void);
 uint16_t getEEPROMConfigSize(void);
+
+// Small records appended after the config without rewriting it, kept
+// until the next config write erases them
+#define EEPROM_LOG_RECORD_MAX_SIZE 28
+
+typedef void eepromLogRecordFn(const void *data, uint8_t size);
+
+void readEEPROMLog(eepromLogRecordFn *fn);
+bool appendEEPROMLog(const void *data, uint8_t size);
@@ -29,6 +29,7 @@ SLOW_RAM uint8_t eepromData[EEPROM_SIZE];
 extern void config_streamer_impl_unlock(void);
 extern void config_streamer_impl_lock(void);
 extern int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer);
+extern uint32_t config_streamer_impl_erase_size(void);
 
 void config_streamer_init(config_streamer_t *c)
 {
@@ -84,6 +85,11 @@ int config_streamer_flush(config_streamer_t *c)
     return c-> err;
 }
 
+uint32_t config_streamer_erase_size(void)
+{
+    return config_streamer_impl_erase_size();
+}
+
 int config_streamer_finish(config_streamer_t *c)
 {
     if (c->unlocked) {
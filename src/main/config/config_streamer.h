@@ -58,6 +58,9 @@ int config_streamer_flush(config_streamer_t *c);
 int config_streamer_finish(config_streamer_t *c);
 int config_streamer_status(config_streamer_t *c);
 
+// Writing the first word of each block of this size erases the block
+uint32_t config_streamer_erase_size(void);
+
 #if defined(CONFIG_IN_FILE)
 bool configFileSetPath(char* path);
 #endif
@@ -35,6 +35,11 @@ void config_streamer_impl_unlock(void)
     flash_flag_clear(FLASH_ODF_FLAG|FLASH_PRGMERR_FLAG|FLASH_EPPERR_FLAG);
 }
 
+uint32_t config_streamer_impl_erase_size(void)
+{
+    return FLASH_PAGE_SIZE;
+}
+
 void config_streamer_impl_lock(void)
 {
     flash_lock();
@@ -39,6 +39,11 @@ void config_streamer_impl_lock(void)
     streamerLocked = true;
 }
 
+uint32_t config_streamer_impl_erase_size(void)
+{
+    return flashGetGeometry()->sectorSize;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (streamerLocked) {
@@ -95,6 +95,11 @@ void config_streamer_impl_lock(void)
     }
 }
 
+uint32_t config_streamer_impl_erase_size(void)
+{
+    return FLASH_PAGE_SIZE;
+}
+
 int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
 {
     if (streamerLocked) {
@@ -102,6 +107,12 @@ int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer
     }
 
     if ((c->address >= (uintptr_t)eepromData) && (c->address < (uintptr_t)ARRAYEND(eepromData))) {
+        // Erase pages as flash would, so nothing written after the config
+        // survives the next save
+        const uint32_t offset = c->address - (uintptr_t)eepromData;
+        if (offset % FLASH_PAGE_SIZE == 0) {
+            memset(&eepromData[offset], 0xFF, FLASH_PAGE_SIZE);
+        }
         *((uint32_t*)c->address) = *buffer;
         fprintf(stderr, "[EEPROM] Program word  %p = %08x\n", (void*)c->address, *((uint32_t*)c->address));
     } else {
@@ -103,6 +103,11 @@ void config_streamer_impl_unlock(void)
     HAL_FLASH_Unlock();
 }
 
+uint32_t config_streamer_impl_erase_size(void)
+{
+    return FLASH_PAGE_SIZE;
+}
+
 void config_streamer_impl_lock(void)
 {
     HAL_FLASH_Lock();
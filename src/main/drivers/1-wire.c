@@ -3,6 +3,7 @@
 
 #include "drivers/1-wire.h"
 #include "drivers/1-wire/ds2482.h"
+#include "drivers/time.h"
 
 #ifdef USE_1WIRE
 
@@ -24,4 +25,105 @@ owDev_t *getOwDev(void)
     return ds2482Detected ? &ds2482Dev : NULL;
 }
 
+void owQueueInit(owQueue_t *queue, owDev_t *owDev, owTransaction_t *transactions, uint8_t size)
+{
+    queue->owDev = owDev;
+    queue->transactions = transactions;
+    queue->size = size;
+    owQueueClear(queue);
+}
+
+void owQueueClear(owQueue_t *queue)
+{
+    queue->count = 0;
+    queue->index = 0;
+    queue->step = 0;
+}
+
+owTransaction_t *owQueueAdd(owQueue_t *queue)
+{
+    if (queue->count >= queue->size) {
+        return NULL;
+    }
+
+    owTransaction_t *transaction = &queue->transactions[queue->count++];
+    transaction->txLen = 0;
+    transaction->rxLen = 0;
+    transaction->state = OW_TRANSACTION_PENDING;
+    return transaction;
+}
+
+static void owQueueNext(owQueue_t *queue, owTransactionState_e state)
+{
+    queue->transactions[queue->index++].state = state;
+    queue->step = 0;
+}
+
+bool owQueueProcess(owQueue_t *queue)
+{
+    owDev_t *owDev = queue->owDev;
+
+    while (queue->index < queue->count) {
+        owTransaction_t *transaction = &queue->transactions[queue->index];
+
+        if (queue->step > 0) {
+            // Leave the I2C bus alone until the 1-Wire step could be over
+            if (cmpTimeUs(micros(), queue->readyAt) < 0) {
+                return false;
+            }
+
+            uint8_t status;
+            if (!owDev->poll(owDev, false, &status)) {
+                owQueueNext(queue, OW_TRANSACTION_FAILED);
+                continue;
+            }
+            if (OW_BUS_BUSY(status)) {
+                return false;
+            }
+
+            if (queue->step == 1 && !OW_DEVICE_PRESENT(status)) {
+                owQueueNext(queue, OW_TRANSACTION_FAILED);
+                continue;
+            }
+
+            // Fetch the byte read before the next command moves the read pointer back to the status
+            if (queue->step > 1 + transaction->txLen) {
+                if (!owDev->owReadByteResult(owDev, &transaction->rx[queue->step - 2 - transaction->txLen])) {
+                    owQueueNext(queue, OW_TRANSACTION_FAILED);
+                    continue;
+                }
+            }
+        }
+
+        if (queue->step == 1 + transaction->txLen + transaction->rxLen) {
+            owQueueNext(queue, OW_TRANSACTION_DONE);
+            continue;
+        }
+
+        bool ack;
+        timeDelta_t stepTime;
+        if (queue->step == 0) {
+            ack = owDev->owResetCommand(owDev);
+            stepTime = OW_RESET_TIME_US;
+        } else if (queue->step <= transaction->txLen) {
+            ack = owDev->owWriteByteCommand(owDev, transaction->tx[queue->step - 1]);
+            stepTime = OW_BYTE_TIME_US;
+        } else {
+            ack = owDev->owReadByteCommand(owDev);
+            stepTime = OW_BYTE_TIME_US;
+        }
+
+        if (!ack) {
+            owQueueNext(queue, OW_TRANSACTION_FAILED);
+            continue;
+        }
+
+        queue->readyAt = micros() + stepTime;
+        queue->step++;
+        return false;
+    }
+
+    return true;
+}
+
 #endif /* USE_1WIRE */
@@ -1,6 +1,8 @@
 
 #pragma once
 
+#include "common/time.h"
+
 #include "drivers/bus.h"
 
 #ifdef USE_1WIRE
@@ -30,6 +32,15 @@
 #define OW_SINGLE_BIT_WRITE0 0
 #define OW_SINGLE_BIT_WRITE1_READ (1<<7)
 
+#define OW_MATCH_ROM_CMD 0x55
+#define OW_SKIP_ROM_CMD 0xCC
+
+// Standard speed, microseconds
+#define OW_RESET_TIME_US 1148   // tRSTL + tRSTH
+#define OW_BYTE_TIME_US 560     // 8 * tSLOT
+
+#define OW_TRANSACTION_TX_MAX 10    // Match ROM, the ROM and a function command
+
 typedef struct owDev_s {
     busDevice_t *busDev;
 
@@ -69,7 +80,41 @@ typedef struct owDev_s {
     bool (*owTriplet)(struct owDev_s *owDev, uint8_t direction, uint8_t *result);
 } owDev_t;
 
+typedef enum {
+    OW_TRANSACTION_PENDING = 0,
+    OW_TRANSACTION_DONE,
+    OW_TRANSACTION_FAILED,
+} owTransactionState_e;
+
+// A bus reset, txLen bytes written and rxLen bytes read into rx
+typedef struct owTransaction_s {
+    uint8_t tx[OW_TRANSACTION_TX_MAX];
+    uint8_t txLen;
+    uint8_t *rx;
+    uint8_t rxLen;
+    owTransactionState_e state;
+} owTransaction_t;
+
+// Transactions run one 1-Wire step at a time from owQueueProcess(), which
+// never waits for the 1-Wire bus: it only talks to the bridge once the
+// step in flight should be over, then starts the next one
+typedef struct owQueue_s {
+    owDev_t *owDev;
+    owTransaction_t *transactions;
+    uint8_t size;
+    uint8_t count;
+    uint8_t index;          // Transaction being run
+    uint8_t step;           // Steps of it started: the reset, the writes then the reads
+    timeUs_t readyAt;       // When the step in flight should be done
+} owQueue_t;
+
 void owInit(void);
 owDev_t *getOwDev(void);
 
+void owQueueInit(owQueue_t *queue, owDev_t *owDev, owTransaction_t *transactions, uint8_t size);
+void owQueueClear(owQueue_t *queue);
+owTransaction_t *owQueueAdd(owQueue_t *queue);
+// Returns true once every queued transaction is done or failed
+bool owQueueProcess(owQueue_t *queue);
+
 #endif /* defined(USE_1WIRE) && defined(USE_1WIRE_DS2482) */
@@ -90,14 +90,15 @@
 
 #elif defined(UNIT_TEST) || defined(SITL_BUILD)
 
+// Distinct so that tests can tell the pin modes apart
 # define IOCFG_OUT_PP         0
-# define IOCFG_OUT_OD         0
-# define IOCFG_AF_PP          0
-# define IOCFG_AF_OD          0
-# define IOCFG_AF_OD_UP       0
-# define IOCFG_IPD            0
-# define IOCFG_IPU            0
-# define IOCFG_IN_FLOATING    0
+# define IOCFG_OUT_OD         1
+# define IOCFG_AF_PP          2
+# define IOCFG_AF_OD          3
+# define IOCFG_AF_OD_UP       4
+# define IOCFG_IPD            5
+# define IOCFG_IPU            6
+# define IOCFG_IN_FLOATING    7
 
 #else
 # warning "Unknown TARGET"
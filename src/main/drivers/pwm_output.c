@@ -58,8 +58,7 @@
 #define DSHOT_DMA_BUFFER_SIZE   18 /* resolution + frame reset (2us) */
 
 #define DSHOT_COMMAND_INTERVAL_US 10000
-#define DSHOT_COMMAND_QUEUE_LENGTH 8
-#define DHSOT_COMMAND_QUEUE_SIZE   DSHOT_COMMAND_QUEUE_LENGTH * sizeof(dshotCommands_e)
+#define DSHOT_COMMAND_QUEUE_LENGTH 8     // Power of two
 #endif
 
 typedef void (*pwmWriteFuncPtr)(uint8_t index, uint16_t value);  // function pointer used to write motors
@@ -108,8 +107,8 @@ static timeUs_t digitalMotorUpdateIntervalUs = 0;
 static timeUs_t digitalMotorLastUpdateUs;
 static timeUs_t lastCommandSent = 0;
     
-static circularBuffer_t commandsCircularBuffer;
-static uint8_t commandsBuff[DHSOT_COMMAND_QUEUE_SIZE];
+static spscRing_t commandsRing;
+static dshotCommands_e commandsBuff[DSHOT_COMMAND_QUEUE_LENGTH];
 static currentExecutingCommand_t currentExecutingCommand;
 #endif
 
@@ -338,11 +337,11 @@ void pwmRequestMotorTelemetry(int motorIndex)
 
 #ifdef USE_DSHOT
 void sendDShotCommand(dshotCommands_e cmd) {
-    circularBufferPushElement(&commandsCircularBuffer, (uint8_t *) &cmd);
+    spscRingPush(&commandsRing, &cmd);
 }
 
 void initDShotCommands(void) {
-    circularBufferInit(&commandsCircularBuffer, commandsBuff,DHSOT_COMMAND_QUEUE_SIZE, sizeof(dshotCommands_e));
+    spscRingInit(&commandsRing, commandsBuff, DSHOT_COMMAND_QUEUE_LENGTH, sizeof(dshotCommands_e));
 
     currentExecutingCommand.remainingRepeats = 0;
 }
@@ -367,11 +366,11 @@ static void executeDShotCommands(void){
     timeUs_t tNow = micros();
 
     if(currentExecutingCommand.remainingRepeats == 0) {
-       const int isTherePendingCommands = !circularBufferIsEmpty(&commandsCircularBuffer);
+       const int isTherePendingCommands = !spscRingIsEmpty(&commandsRing);
         if (isTherePendingCommands && (tNow - lastCommandSent > DSHOT_COMMAND_INTERVAL_US)){
             //Load the command
             dshotCommands_e cmd;
-            circularBufferPopHead(&commandsCircularBuffer, (uint8_t *) &cmd);
+            spscRingPop(&commandsRing, &cmd);
             currentExecutingCommand.cmd = cmd;
             currentExecutingCommand.remainingRepeats = getDShotCommandRepeats(cmd);           
         } else {
@@ -53,6 +53,8 @@ typedef enum {
     OWNER_OLED_DISPLAY,
     OWNER_PINIO,
     OWNER_IRLOCK,
+    OWNER_BLACKBOX,
+    OWNER_GYRO_ANALYSE,
     OWNER_TOTAL_COUNT
 } resourceOwner_e;
 
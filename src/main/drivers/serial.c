@@ -103,6 +103,14 @@ void serialEndWrite(serialPort_t *instance)
         instance->vTable->endWrite(instance);
 }
 
+uint32_t serialSetTxByteSpacing(serialPort_t *instance, uint32_t spacingUs)
+{
+    if (instance->vTable->setTxByteSpacing)
+        return instance->vTable->setTxByteSpacing(instance, spacingUs);
+
+    return 0;
+}
+
 bool serialIsConnected(const serialPort_t *instance)
 {
     if (instance->vTable->isConnected)
@@ -104,6 +104,10 @@ struct serialPortVTable {
     // Optional functions used to buffer large writes.
     void (*beginWrite)(serialPort_t *instance);
     void (*endWrite)(serialPort_t *instance);
+
+    // Optional, for protocols that want idle time between bytes. Returns the
+    // start to start spacing the port keeps from now on, 0 if it can't.
+    uint32_t (*setTxByteSpacing)(serialPort_t *instance, uint32_t spacingUs);
 };
 
 void serialWrite(serialPort_t *instance, uint8_t ch);
@@ -123,3 +127,4 @@ bool serialIsIdle(serialPort_t *instance);
 void serialWriteBufShim(void *instance, const uint8_t *data, int count);
 void serialBeginWrite(serialPort_t *instance);
 void serialEndWrite(serialPort_t *instance);
+uint32_t serialSetTxByteSpacing(serialPort_t *instance, uint32_t spacingUs);
@@ -641,6 +641,7 @@ static const struct serialPortVTable softSerialVTable = {
     .beginWrite = NULL,
     .endWrite = NULL,
     .isIdle = NULL,
+    .setTxByteSpacing = NULL,
 };
 
 #endif
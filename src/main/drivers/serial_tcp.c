@@ -365,6 +365,7 @@ static const struct serialPortVTable tcpVTable[] = {
         .beginWrite = NULL,
         .endWrite = NULL,
         .isIdle = NULL,
+        .setTxByteSpacing = NULL,
     }
 };
 
@@ -265,5 +265,6 @@ const struct serialPortVTable uartVTable[] = {
         .beginWrite = NULL,
         .endWrite = NULL,
         .isIdle = isUartIdle,
+        .setTxByteSpacing = NULL,
     }
 };
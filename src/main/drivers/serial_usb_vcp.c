@@ -189,6 +189,7 @@ static const struct serialPortVTable usbVTable[] = {
         .beginWrite = usbVcpBeginWrite,
         .endWrite = usbVcpEndWrite,
         .isIdle = NULL,
+        .setTxByteSpacing = NULL,
     }
 };
 
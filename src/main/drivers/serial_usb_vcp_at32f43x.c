@@ -509,6 +509,7 @@ static const struct serialPortVTable usbVTable[] = {
         .beginWrite = usbVcpBeginWrite,
         .endWrite = usbVcpEndWrite,
         .isIdle = NULL,
+        .setTxByteSpacing = NULL,
     }
 };
 
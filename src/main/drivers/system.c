@@ -189,4 +189,15 @@ void initialiseMemorySections(void)
     extern uint8_t tcm_code;
     memcpy(&tcm_code_start, &tcm_code, (size_t) (&tcm_code_end - &tcm_code_start));
 #endif
+
+    /* Functions picked by tcm_placement.py, only linked with TCM_PROFILE */
+    extern uint8_t tcm_code_profile_start __attribute__((weak));
+    extern uint8_t tcm_code_profile_end __attribute__((weak));
+    extern uint8_t tcm_code_profile __attribute__((weak));
+    memcpy(&tcm_code_profile_start, &tcm_code_profile, (size_t) (&tcm_code_profile_end - &tcm_code_profile_start));
+
+    /* Variables picked by tcm_placement.py, only linked with TCM_PROFILE */
+    extern uint8_t tcm_data_profile_start __attribute__((weak));
+    extern uint8_t tcm_data_profile_end __attribute__((weak));
+    memset(&tcm_data_profile_start, 0, (size_t) (&tcm_data_profile_end - &tcm_data_profile_start));
 }
@@ -17,6 +17,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -126,6 +127,33 @@ bool ds18b20WaitForConversion(owDev_t *owDev)
     return true;
 }
 
+// Conversion on all the devices, for a single broadcast per update
+owTransaction_t *ds18b20QueueStartConversion(owQueue_t *queue)
+{
+    owTransaction_t *transaction = owQueueAdd(queue);
+    if (transaction) {
+        transaction->tx[0] = OW_SKIP_ROM_CMD;
+        transaction->tx[1] = DS18B20_START_CONVERSION_CMD;
+        transaction->txLen = 2;
+    }
+    return transaction;
+}
+
+// buf must hold DS18B20_SCRATCHPAD_SIZE bytes
+owTransaction_t *ds18b20QueueReadScratchpad(owQueue_t *queue, uint64_t rom, uint8_t *buf)
+{
+    owTransaction_t *transaction = owQueueAdd(queue);
+    if (transaction) {
+        transaction->tx[0] = OW_MATCH_ROM_CMD;
+        memcpy(&transaction->tx[1], &rom, sizeof(rom));
+        transaction->tx[9] = DS18B20_READ_SCRATCHPAD_CMD;
+        transaction->txLen = 10;
+        transaction->rx = buf;
+        transaction->rxLen = DS18B20_SCRATCHPAD_SIZE;
+    }
+    return transaction;
+}
+
 bool ds18b20ReadTemperatureFromScratchPadBuf(const uint8_t *buf, int16_t *temperature)
 {
     if (buf[8] != ds_crc8(buf, 8)) return false;
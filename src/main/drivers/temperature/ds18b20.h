@@ -21,6 +21,8 @@
 #define DS18B20_11BIT_CONVERSION_TIME 375
 #define DS18B20_12BIT_CONVERSION_TIME 750
 
+#define DS18B20_SCRATCHPAD_SIZE 9
+
 
 bool ds18b20Enumerate(owDev_t *owDev, uint64_t *rom_table, uint8_t *rom_table_len);
 bool ds18b20Configure(owDev_t *owDev, uint64_t rom, uint8_t config);
@@ -30,6 +32,8 @@ bool ds18b20StartConversionCommand(owDev_t *owDev);
 bool ds18b20StartConversion(owDev_t *owDev);
 bool ds18b20WaitForConversion(owDev_t *owDev);
 bool ds18b20ReadScratchpadCommand(owDev_t *owDev);
+owTransaction_t *ds18b20QueueStartConversion(owQueue_t *queue);
+owTransaction_t *ds18b20QueueReadScratchpad(owQueue_t *queue, uint64_t rom, uint8_t *buf);
 bool ds18b20ReadTemperatureFromScratchPadBuf(const uint8_t *buf, int16_t *temperature);
 bool ds18b20ReadTemperature(owDev_t *owDev, uint64_t rom, int16_t *temperature);
 
@@ -25,6 +25,8 @@
 #include "platform.h"
 #include "build/debug.h"
 
+#include "drivers/serial.h"
+
 #include "vtx_common.h"
 
 static vtxDevice_t *commonVtxDevice = NULL;
@@ -175,3 +177,229 @@ bool vtxCommonGetOsdInfo(vtxDevice_t *vtxDevice, vtxDeviceOsdInfo_t * pOsdInfo)
 
     return ret;
 }
+
+bool vtxCommonIsProcessPending(const vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
+{
+    if (vtxDevice && vtxDevice->vTable->isProcessPending) {
+        return vtxDevice->vTable->isProcessPending(vtxDevice, currentTimeUs);
+    }
+    return false;
+}
+
+//
+// Request/response transport
+//
+
+void vtxTransportInit(vtxTransport_t *transport, const vtxProtocol_t *protocol, serialPort_t *port, uint32_t baudRate)
+{
+    memset(transport, 0, sizeof(*transport));
+    transport->protocol = protocol;
+    transport->port = port;
+    transport->baudRate = baudRate;
+    transport->baudDirection = 1;
+}
+
+static vtxTransaction_t *vtxTransportSlot(vtxTransport_t *transport, uint8_t index)
+{
+    return &transport->queue[(transport->head + index) % VTX_TRANSPORT_QUEUE_SIZE];
+}
+
+bool vtxTransportQueue(vtxTransport_t *transport, uint8_t command, const uint8_t *frame, uint8_t length, uint8_t flags)
+{
+    if (length > VTX_TRANSPORT_FRAME_SIZE) {
+        return false;
+    }
+
+    if (flags & VTX_TRANSACTION_REPLACE) {
+        // Nothing to gain from sending the same request twice in a row
+        if (transport->count > 0) {
+            const vtxTransaction_t *last = vtxTransportSlot(transport, transport->count - 1);
+            if (last->command == command && last->length == length && memcmp(last->frame, frame, length) == 0) {
+                return true;
+            }
+        }
+
+        // Drop an older request that isn't sent yet, the new one goes last
+        const uint8_t firstUnsent = (transport->state == VTX_TRANSPORT_IDLE) ? 0 : 1;
+        for (uint8_t i = firstUnsent; i < transport->count; i++) {
+            if (vtxTransportSlot(transport, i)->command == command) {
+                for (uint8_t j = i; j < transport->count - 1; j++) {
+                    *vtxTransportSlot(transport, j) = *vtxTransportSlot(transport, j + 1);
+                }
+                transport->count--;
+                break;
+            }
+        }
+    }
+
+    if (transport->count == VTX_TRANSPORT_QUEUE_SIZE) {
+        return false;
+    }
+
+    vtxTransaction_t *transaction = vtxTransportSlot(transport, transport->count);
+    memcpy(transaction->frame, frame, length);
+    transaction->length = length;
+    transaction->command = command;
+    transaction->flags = flags;
+    transport->count++;
+
+    return true;
+}
+
+static void vtxTransportTrackBaud(vtxTransport_t *transport)
+{
+    const vtxProtocol_t *protocol = transport->protocol;
+
+    if (protocol->baudStep == 0 || transport->baudSent < 10) {
+        // Not enough samples collected
+        return;
+    }
+
+    if ((transport->baudReceived * 100) / transport->baudSent < 70) {
+        if (transport->baudDirection > 0 && transport->baudRate >= protocol->baudMax) {
+            transport->baudDirection = -1;
+        } else if (transport->baudDirection < 0 && transport->baudRate <= protocol->baudMin) {
+            transport->baudDirection = 1;
+        }
+
+        transport->baudRate += transport->baudDirection * protocol->baudStep;
+        serialSetBaudRate(transport->port, transport->baudRate);
+    }
+
+    transport->baudSent = 0;
+    transport->baudReceived = 0;
+}
+
+static void vtxTransportSend(vtxTransport_t *transport, timeMs_t currentTimeMs)
+{
+    const vtxTransaction_t *transaction = vtxTransportSlot(transport, 0);
+
+    vtxTransportTrackBaud(transport);
+
+    serialWriteBuf(transport->port, transaction->frame, transaction->length);
+
+    transport->state = (transaction->flags & VTX_TRANSACTION_RESPONSE) ? VTX_TRANSPORT_WAIT_RESPONSE : VTX_TRANSPORT_WAIT_SETTLE;
+    transport->stateChangeMs = currentTimeMs;
+    transport->stats.sent++;
+    transport->baudSent++;
+}
+
+static void vtxTransportComplete(vtxTransport_t *transport)
+{
+    transport->head = (transport->head + 1) % VTX_TRANSPORT_QUEUE_SIZE;
+    transport->count--;
+    transport->state = VTX_TRANSPORT_IDLE;
+    transport->retries = 0;
+}
+
+static void vtxTransportFrameReceived(vtxTransport_t *transport, const uint8_t *frame, int len)
+{
+    const vtxTransaction_t *transaction = vtxTransportSlot(transport, 0);
+
+    // Half-duplex lines read back what was sent
+    if (transport->state != VTX_TRANSPORT_IDLE && transaction->length == len && memcmp(transaction->frame, frame, len) == 0) {
+        return;
+    }
+
+    const bool answersRequest = transport->state == VTX_TRANSPORT_WAIT_RESPONSE &&
+        transport->protocol->isResponse(transaction->command, frame, len);
+
+    transport->stats.received++;
+    if (answersRequest) {
+        transport->baudReceived++;
+    } else {
+        transport->stats.unexpected++;
+    }
+
+    transport->protocol->processFrame(frame, len);
+
+    if (answersRequest) {
+        vtxTransportComplete(transport);
+    }
+}
+
+static void vtxTransportReceive(vtxTransport_t *transport, uint8_t c)
+{
+    if (transport->rxLen == VTX_TRANSPORT_FRAME_SIZE) {
+        memmove(transport->rxBuf, transport->rxBuf + 1, --transport->rxLen);
+    }
+    transport->rxBuf[transport->rxLen++] = c;
+
+    while (transport->rxLen > 0) {
+        const int len = transport->protocol->decodeFrame(transport->rxBuf, transport->rxLen);
+
+        if (len == 0) {
+            break;
+        }
+
+        if (len < 0) {
+            // Resynchronise on the next byte
+            memmove(transport->rxBuf, transport->rxBuf + 1, --transport->rxLen);
+            continue;
+        }
+
+        vtxTransportFrameReceived(transport, transport->rxBuf, len);
+        transport->rxLen -= len;
+        memmove(transport->rxBuf, transport->rxBuf + len, transport->rxLen);
+    }
+}
+
+static timeMs_t vtxTransportStateTimeout(const vtxTransport_t *transport)
+{
+    return (transport->state == VTX_TRANSPORT_WAIT_RESPONSE) ? transport->protocol->responseTimeoutMs : transport->protocol->settleTimeMs;
+}
+
+void vtxTransportProcess(vtxTransport_t *transport, timeMs_t currentTimeMs)
+{
+    while (serialRxBytesWaiting(transport->port) > 0) {
+        vtxTransportReceive(transport, serialRead(transport->port));
+    }
+
+    if (transport->state != VTX_TRANSPORT_IDLE) {
+        if (!isSerialTransmitBufferEmpty(transport->port)) {
+            // Timeouts count from the end of the request
+            transport->stateChangeMs = currentTimeMs;
+        } else if (currentTimeMs - transport->stateChangeMs >= vtxTransportStateTimeout(transport)) {
+            if (transport->state == VTX_TRANSPORT_WAIT_SETTLE) {
+                vtxTransportComplete(transport);
+            } else if (transport->retries < transport->protocol->maxRetries || (vtxTransportSlot(transport, 0)->flags & VTX_TRANSACTION_PERSIST)) {
+                if (transport->retries < UINT8_MAX) {
+                    transport->retries++;
+                }
+                transport->stats.retries++;
+                vtxTransportSend(transport, currentTimeMs);
+            } else {
+                const uint8_t command = vtxTransportSlot(transport, 0)->command;
+
+                transport->stats.lost++;
+                vtxTransportComplete(transport);
+
+                if (transport->protocol->requestFailed) {
+                    transport->protocol->requestFailed(command);
+                }
+            }
+        }
+    }
+
+    if (transport->state == VTX_TRANSPORT_IDLE && transport->count > 0) {
+        vtxTransportSend(transport, currentTimeMs);
+    }
+}
+
+bool vtxTransportIsProcessPending(const vtxTransport_t *transport, timeMs_t currentTimeMs)
+{
+    if (serialRxBytesWaiting(transport->port) > 0) {
+        return true;
+    }
+
+    if (transport->state == VTX_TRANSPORT_IDLE) {
+        return transport->count > 0;
+    }
+
+    return currentTimeMs - transport->stateChangeMs >= vtxTransportStateTimeout(transport);
+}
+
+bool vtxTransportIsIdle(const vtxTransport_t *transport)
+{
+    return transport->state == VTX_TRANSPORT_IDLE && transport->count == 0;
+}
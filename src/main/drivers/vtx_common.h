@@ -19,6 +19,8 @@
 
 #include "common/time.h"
 
+struct serialPort_s;
+
 #define VTX_SETTINGS_NO_BAND        0 // used for custom frequency selection mode
 #define VTX_SETTINGS_MIN_BAND       1
 #define VTX_SETTINGS_MAX_BAND       5
@@ -126,6 +128,9 @@ typedef struct vtxVTable_s {
 
     bool (*getPower)(const vtxDevice_t *vtxDevice, uint8_t *pIndex, uint16_t *pPowerMw);
     bool (*getOsdInfo)(const  vtxDevice_t *vtxDevice, vtxDeviceOsdInfo_t * pOsdInfo);
+
+    // Optional, true when process() has something to do now
+    bool (*isProcessPending)(const vtxDevice_t *vtxDevice, timeUs_t currentTimeUs);
 } vtxVTable_t;
 
 // 3.1.0
@@ -151,3 +156,95 @@ bool vtxCommonGetFrequency(const vtxDevice_t *vtxDevice, uint16_t *pFreq);
 bool vtxCommonGetDeviceCapability(vtxDevice_t *vtxDevice, vtxDeviceCapability_t *pDeviceCapability);
 bool vtxCommonGetPower(const vtxDevice_t *vtxDevice, uint8_t *pIndex, uint16_t *pPowerMw);
 bool vtxCommonGetOsdInfo(vtxDevice_t *vtxDevice, vtxDeviceOsdInfo_t * pOsdInfo);
+bool vtxCommonIsProcessPending(const vtxDevice_t *vtxDevice, timeUs_t currentTimeUs);
+
+/*
+ * Request/response transport for the serial VTX protocols
+ *
+ *   The drivers queue encoded request frames and the transport sends them
+ * one at a time, matches responses to the request in flight, resends on
+ * timeout and tracks the baud rate. Each protocol only provides the frame
+ * decoder and the response handling. Nothing blocks: everything happens in
+ * vtxTransportProcess(), which only needs to run when
+ * vtxTransportIsProcessPending() says so.
+ */
+
+#define VTX_TRANSPORT_FRAME_SIZE    26
+#define VTX_TRANSPORT_QUEUE_SIZE    8
+
+typedef enum {
+    VTX_TRANSACTION_RESPONSE    = 1 << 0,   // The request is answered, otherwise the line is only held for settleTimeMs
+    VTX_TRANSACTION_REPLACE     = 1 << 1,   // Supersedes a request for the same command that isn't sent yet, and goes last
+    VTX_TRANSACTION_PERSIST     = 1 << 2,   // Resent until answered, maxRetries doesn't apply
+} vtxTransactionFlags_e;
+
+typedef struct vtxTransaction_s {
+    uint8_t frame[VTX_TRANSPORT_FRAME_SIZE];
+    uint8_t length;
+    uint8_t command;
+    uint8_t flags;
+} vtxTransaction_t;
+
+typedef struct vtxProtocol_s {
+    // Length of the frame at the start of buf when complete and valid, 0
+    // when more bytes are needed, -1 when buf doesn't start a frame
+    int (*decodeFrame)(const uint8_t *buf, int len);
+    // Is a valid frame the response to a request for command
+    bool (*isResponse)(uint8_t command, const uint8_t *frame, int len);
+    // Called for every valid frame, answering the request in flight or not
+    void (*processFrame)(const uint8_t *frame, int len);
+    // Optional, called when a request got no response after all retries
+    void (*requestFailed)(uint8_t command);
+
+    timeMs_t responseTimeoutMs;
+    timeMs_t settleTimeMs;
+    uint8_t maxRetries;
+
+    // Baud rate tracking, off when baudStep is 0
+    uint16_t baudMin;
+    uint16_t baudMax;
+    uint16_t baudStep;
+} vtxProtocol_t;
+
+typedef enum {
+    VTX_TRANSPORT_IDLE = 0,
+    VTX_TRANSPORT_WAIT_RESPONSE,
+    VTX_TRANSPORT_WAIT_SETTLE,
+} vtxTransportState_e;
+
+typedef struct vtxTransportStats_s {
+    uint16_t sent;
+    uint16_t received;
+    uint16_t retries;
+    uint16_t lost;
+    uint16_t unexpected;
+} vtxTransportStats_t;
+
+typedef struct vtxTransport_s {
+    const vtxProtocol_t *protocol;
+    struct serialPort_s *port;
+
+    vtxTransaction_t queue[VTX_TRANSPORT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+
+    vtxTransportState_e state;
+    uint8_t retries;
+    timeMs_t stateChangeMs;
+
+    uint8_t rxBuf[VTX_TRANSPORT_FRAME_SIZE];
+    uint8_t rxLen;
+
+    uint32_t baudRate;
+    int8_t baudDirection;
+    uint8_t baudSent;
+    uint8_t baudReceived;
+
+    vtxTransportStats_t stats;
+} vtxTransport_t;
+
+void vtxTransportInit(vtxTransport_t *transport, const vtxProtocol_t *protocol, struct serialPort_s *port, uint32_t baudRate);
+bool vtxTransportQueue(vtxTransport_t *transport, uint8_t command, const uint8_t *frame, uint8_t length, uint8_t flags);
+void vtxTransportProcess(vtxTransport_t *transport, timeMs_t currentTimeMs);
+bool vtxTransportIsProcessPending(const vtxTransport_t *transport, timeMs_t currentTimeMs);
+bool vtxTransportIsIdle(const vtxTransport_t *transport);
@@ -474,18 +474,17 @@ static bool valuePtrEqualsDefault(const setting_t *value, const void *ptr, const
     return result;
 }
 
-static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
+static void dumpPgValue(const setting_t *value, uint8_t profileIndex, uint8_t dumpMask)
 {
     char name[SETTING_MAX_NAME_LENGTH];
     const char *format = "set %s = ";
     const char *defaultFormat = "#set %s = ";
-    // During a dump, the PGs have been backed up to their "copy"
-    // regions and the actual values have been reset to its
-    // defaults. This means that settingGetValuePointer() will
-    // return the default value while settingGetCopyValuePointer()
-    // will return the actual value.
-    const void *valuePointer = settingGetCopyValuePointer(value);
-    const void *defaultValuePointer = settingGetValuePointer(value);
+    // During a dump, the defaults have been loaded into the PG "copy"
+    // regions while the actual values stay in place. This means that
+    // settingGetProfileValuePointer() will return the actual value
+    // while settingGetProfileCopyValuePointer() will return the default.
+    const void *valuePointer = settingGetProfileValuePointer(value, profileIndex);
+    const void *defaultValuePointer = settingGetProfileCopyValuePointer(value, profileIndex);
     const bool equalsDefault = valuePtrEqualsDefault(value, valuePointer, defaultValuePointer);
     if (((dumpMask & DO_DIFF) == 0) || !equalsDefault) {
         settingGetName(value, name);
@@ -505,17 +504,6 @@ static void dumpPgValue(const setting_t *value, uint8_t dumpMask)
     }
 }
 
-static void dumpAllValues(uint16_t valueSection, uint8_t dumpMask)
-{
-    for (unsigned i = 0; i < SETTINGS_TABLE_COUNT; i++) {
-        const setting_t *value = settingGet(i);
-        bufWriterFlush(cliWriter);
-        if (SETTING_SECTION(value) == valueSection) {
-            dumpPgValue(value, dumpMask);
-        }
-    }
-}
-
 static void cliPrintVar(const setting_t *var, uint32_t full)
 {
     const void *ptr = settingGetValuePointer(var);
@@ -1704,7 +1692,7 @@ static void cliDelay(char* cmdLine) {
 static void printServo(uint8_t dumpMask, const servoParam_t *servoParam, const servoParam_t *defaultServoParam)
 {
     // print out servo settings
-    const char *format = "servo %u %d %d %d %d";
+    const char *format = "servo %u %d %d %d %d %u %u %u";
     for (uint32_t i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
         const servoParam_t *servoConf = &servoParam[i];
         bool equalsDefault = false;
@@ -1713,13 +1701,19 @@ static void printServo(uint8_t dumpMask, const servoParam_t *servoParam, const s
             equalsDefault = servoConf->min == servoConfDefault->min
                 && servoConf->max == servoConfDefault->max
                 && servoConf->middle == servoConfDefault->middle
-                && servoConf->rate == servoConfDefault->rate;
+                && servoConf->rate == servoConfDefault->rate
+                && servoConf->updateRate == servoConfDefault->updateRate
+                && servoConf->lpfHz == servoConfDefault->lpfHz
+                && servoConf->slewRate == servoConfDefault->slewRate;
             cliDefaultPrintLinef(dumpMask, equalsDefault, format,
                 i,
                 servoConfDefault->min,
                 servoConfDefault->max,
                 servoConfDefault->middle,
-                servoConfDefault->rate
+                servoConfDefault->rate,
+                servoConfDefault->updateRate,
+                servoConfDefault->lpfHz,
+                servoConfDefault->slewRate
             );
         }
         cliDumpPrintLinef(dumpMask, equalsDefault, format,
@@ -1727,14 +1721,18 @@ static void printServo(uint8_t dumpMask, const servoParam_t *servoParam, const s
             servoConf->min,
             servoConf->max,
             servoConf->middle,
-            servoConf->rate
+            servoConf->rate,
+            servoConf->updateRate,
+            servoConf->lpfHz,
+            servoConf->slewRate
         );
     }
 }
 
 static void cliServo(char *cmdline)
 {
-    enum { SERVO_ARGUMENT_COUNT = 5 };
+    // The output rate, filter cutoff and slew limit are optional
+    enum { SERVO_SHORT_ARGUMENT_COUNT = 5, SERVO_ARGUMENT_COUNT = 8 };
     int16_t arguments[SERVO_ARGUMENT_COUNT];
 
     servoParam_t *servo;
@@ -1772,12 +1770,12 @@ static void cliServo(char *cmdline)
             }
         }
 
-        enum {INDEX = 0, MIN, MAX, MIDDLE, RATE};
+        enum {INDEX = 0, MIN, MAX, MIDDLE, RATE, UPDATE_RATE, LPF_HZ, SLEW_RATE};
 
         i = arguments[INDEX];
 
         // Check we got the right number of args and the servo index is correct (don't validate the other values)
-        if (validArgumentCount != SERVO_ARGUMENT_COUNT || i < 0 || i >= MAX_SUPPORTED_SERVOS) {
+        if ((validArgumentCount != SERVO_ARGUMENT_COUNT && validArgumentCount != SERVO_SHORT_ARGUMENT_COUNT) || i < 0 || i >= MAX_SUPPORTED_SERVOS) {
             cliShowParseError();
             return;
         }
@@ -1795,10 +1793,25 @@ static void cliServo(char *cmdline)
             return;
         }
 
+        if (validArgumentCount == SERVO_ARGUMENT_COUNT && (
+            arguments[UPDATE_RATE] < 0 || arguments[UPDATE_RATE] > 1000 ||
+            arguments[LPF_HZ] < 0 || arguments[LPF_HZ] > 400 ||
+            arguments[SLEW_RATE] < 0 || arguments[SLEW_RATE] > 30000
+        )) {
+            cliShowParseError();
+            return;
+        }
+
         servo->min = arguments[MIN];
         servo->max = arguments[MAX];
         servo->middle = arguments[MIDDLE];
         servo->rate = arguments[RATE];
+        if (validArgumentCount == SERVO_ARGUMENT_COUNT) {
+            servo->updateRate = arguments[UPDATE_RATE];
+            servo->lpfHz = arguments[LPF_HZ];
+            servo->slewRate = arguments[SLEW_RATE];
+        }
+        servoInitOutputStage(i);
     }
 }
 
@@ -2797,6 +2810,7 @@ static void printMap(uint8_t dumpMask, const rxConfig_t *rxConfig, const rxConfi
         }
     }
     buf[i] = '\0';
+    bufDefault[i] = '\0';
 
     const char *formatMap = "map %s";
     cliDefaultPrintLinef(dumpMask, equalsDefault, formatMap, bufDefault);
@@ -3008,19 +3022,6 @@ static void cliProfile(char *cmdline)
     }
 }
 
-static void cliDumpProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigProfile(profileIndex);
-    cliPrintHashLine("profile");
-    cliPrintLinef("profile %d\r\n", getConfigProfile() + 1);
-    dumpAllValues(PROFILE_VALUE, dumpMask);
-    dumpAllValues(CONTROL_RATE_VALUE, dumpMask);
-}
-
 static void cliBatteryProfile(char *cmdline)
 {
     // CLI profile index is 1-based
@@ -3036,18 +3037,6 @@ static void cliBatteryProfile(char *cmdline)
     }
 }
 
-static void cliDumpBatteryProfile(uint8_t profileIndex, uint8_t dumpMask)
-{
-    if (profileIndex >= MAX_BATTERY_PROFILE_COUNT) {
-        // Faulty values
-        return;
-    }
-    setConfigBatteryProfile(profileIndex);
-    cliPrintHashLine("battery_profile");
-    cliPrintLinef("battery_profile %d\r\n", getConfigBatteryProfile() + 1);
-    dumpAllValues(BATTERY_CONFIG_VALUE, dumpMask);
-}
-
 #ifdef USE_CLI_BATCH
 static void cliPrintCommandBatchWarning(const char *warning)
 {
@@ -3273,6 +3262,28 @@ static const char * getBatteryStateString(void)
     return batteryStateStrings[getBatteryState()];
 }
 
+static void cliPrintMemoryUsage(void)
+{
+    cliPrintLinef("Dynamic memory usage:");
+    for (unsigned pool = 0; pool < MEM_POOL_COUNT; pool++) {
+        const uint32_t poolSize = memGetPoolSize(pool);
+
+        // Empty pools are served from MEM_POOL_RAM
+        if (!poolSize) {
+            continue;
+        }
+
+        cliPrintLinef("%s pool: %d of %d bytes free", memPoolNames[pool], memGetPoolAvailableBytes(pool), poolSize);
+        for (unsigned i = OWNER_FREE + 1; i < OWNER_TOTAL_COUNT; i++) {
+            const uint32_t memUsed = memGetPoolUsedBytesByOwner(pool, i);
+
+            if (memUsed) {
+                cliPrintLinef("  %s : %d bytes", ownerNames[i], memUsed);
+            }
+        }
+    }
+}
+
 static void cliStatus(char *cmdline)
 {
     UNUSED(cmdline);
@@ -3375,9 +3386,18 @@ static void cliStatus(char *cmdline)
     cliPrintf("Stack used: %d, ", stackUsedSize());
 #endif
 #if !defined(SITL_BUILD)
-    cliPrintLinef("Stack size: %d, Stack address: 0x%x, Heap available: %d", stackTotalSize(), stackHighMem(), memGetAvailableBytes());
+    cliPrintLinef("Stack size: %d, Stack address: 0x%x", stackTotalSize(), stackHighMem());
 
     cliPrintLinef("I2C Errors: %d, config size: %d, max available config: %d", i2cErrorCounter, getEEPROMConfigSize(), &__config_end - &__config_start);
+#endif
+    cliPrintMemoryUsage();
+#ifdef USE_STATS
+    const statsFlightRecord_t *lastFlight = statsGetLastFlight();
+    if (lastFlight) {
+        cliPrintLinef("Last flight: %ds, %dm, %dmWh, max altitude: %dm, max current: %d.%02dA, min voltage: %d.%02dV",
+            lastFlight->flightTime, lastFlight->distance, lastFlight->energy, lastFlight->maxAltitude / 100,
+            lastFlight->maxCurrent / 100, lastFlight->maxCurrent % 100, lastFlight->minVoltage / 100, lastFlight->minVoltage % 100);
+    }
 #endif
 #if defined(USE_ADC) && !defined(SITL_BUILD)
     static char * adcFunctions[] = { "BATTERY", "RSSI", "CURRENT", "AIRSPEED" };
@@ -3523,15 +3543,7 @@ static void cliVersion(char *cmdline)
 static void cliMemory(char *cmdline)
 {
     UNUSED(cmdline);
-    cliPrintLinef("Dynamic memory usage:");
-    for (unsigned i = 0; i < OWNER_TOTAL_COUNT; i++) {
-        const char * owner = ownerNames[i];
-        const uint32_t memUsed = memGetUsedBytesByOwner(i);
-
-        if (memUsed) {
-            cliPrintLinef("%s : %d bytes", owner, memUsed);
-        }
-    }
+    cliPrintMemoryUsage();
 }
 
 static void cliResource(char *cmdline)
@@ -3565,62 +3577,114 @@ static void backupConfigs(void)
     }
 }
 
-static void restoreConfigs(void)
+// Loads the defaults into the PG copies to do differencing, leaving the
+// actual configuration in place
+static void loadDefaultConfigs(void)
 {
+    const int currentProfileIndexSave = getConfigProfile();
+    const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
+    backupConfigs();
+    // reset all configs to defaults, then swap them with their copies
+    resetConfigs();
     PG_FOREACH(pg) {
-        if (pgIsProfile(pg)) {
-            memcpy(pg->address, pg->copy, pgSize(pg) * MAX_PROFILE_COUNT);
-        } else {
-            memcpy(pg->address, pg->copy, pgSize(pg));
+        const size_t size = pgIsProfile(pg) ? pgSize(pg) * MAX_PROFILE_COUNT : pgSize(pg);
+        for (size_t i = 0; i < size; i++) {
+            const uint8_t value = pg->address[i];
+            pg->address[i] = pg->copy[i];
+            pg->copy[i] = value;
         }
     }
+    // restore the profile indices and what was derived from the defaults
+    setConfigProfile(currentProfileIndexSave);
+    setConfigBatteryProfile(currentBatteryProfileIndexSave);
+#ifdef USE_LED_STRIP
+    reevaluateLedConfig();
+#endif
 }
 
-static void printConfig(const char *cmdline, bool doDiff)
-{
-    uint8_t dumpMask = DUMP_MASTER;
-    const char *options;
-    if ((options = checkCommand(cmdline, "master"))) {
-        dumpMask = DUMP_MASTER; // only
-    } else if ((options = checkCommand(cmdline, "profile"))) {
-        dumpMask = DUMP_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
-        dumpMask = DUMP_BATTERY_PROFILE; // only
-    } else if ((options = checkCommand(cmdline, "all"))) {
-        dumpMask = DUMP_ALL;   // all profiles and rates
-    } else {
-        options = cmdline;
-    }
+/*
+ * dump and diff are run a step at a time from cliProcess(), as fast as
+ * the port takes the output, so the other tasks keep running. A step is
+ * one section or one setting.
+ */
+#define CLI_DUMP_SLICE_US   500     // Longest time spent dumping per cliProcess() call
 
-    if (doDiff) {
-        dumpMask = dumpMask | DO_DIFF;
+typedef enum {
+    DUMP_STEP_IDLE = 0,
+    DUMP_STEP_VERSION,
+    DUMP_STEP_MOTOR_MIX,
+    DUMP_STEP_SERVO_MIX,
+    DUMP_STEP_SERVO,
+    DUMP_STEP_SAFE_HOME,
+    DUMP_STEP_FEATURE,
+    DUMP_STEP_BEEPER,
+    DUMP_STEP_BLACKBOX,
+    DUMP_STEP_MAP,
+    DUMP_STEP_SERIAL,
+    DUMP_STEP_LED,
+    DUMP_STEP_AUX,
+    DUMP_STEP_ADJUSTMENT_RANGE,
+    DUMP_STEP_RX_RANGE,
+    DUMP_STEP_TEMP_SENSOR,
+    DUMP_STEP_WAYPOINTS,
+    DUMP_STEP_OSD_LAYOUT,
+    DUMP_STEP_LOGIC,
+    DUMP_STEP_GVAR,
+    DUMP_STEP_PID,
+    DUMP_STEP_MASTER,
+    DUMP_STEP_PROFILE,
+    DUMP_STEP_BATTERY_PROFILE,
+    DUMP_STEP_END,
+} dumpStep_e;
+
+static struct {
+    dumpStep_e step;
+    uint8_t mask;
+    bool started;           // Header of the step printed
+    uint16_t settingIndex;  // Next setting to compare
+    setting_section_e valueSection;
+    uint8_t profile;
+    uint8_t profileLast;
+    uint8_t batteryProfile;
+    uint8_t batteryProfileLast;
+} dumpState;
+
+// Returns false once all settings of the section have been dumped
+static bool dumpNextValue(setting_section_e valueSection, uint8_t profileIndex)
+{
+    while (dumpState.settingIndex < SETTINGS_TABLE_COUNT) {
+        const setting_t *value = settingGet(dumpState.settingIndex++);
+        if (SETTING_SECTION(value) == valueSection) {
+            dumpPgValue(value, profileIndex, dumpState.mask);
+            return true;
+        }
     }
+    dumpState.settingIndex = 0;
+    return false;
+}
 
-    const int currentProfileIndexSave = getConfigProfile();
-    const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
-    backupConfigs();
-    // reset all configs to defaults to do differencing
-    resetConfigs();
-    // restore the profile indices, since they should not be reset for proper comparison
-    setConfigProfile(currentProfileIndexSave);
-    setConfigBatteryProfile(currentBatteryProfileIndexSave);
+static void dumpNextStep(dumpStep_e step)
+{
+    dumpState.step = step;
+    dumpState.started = false;
+    dumpState.settingIndex = 0;
+}
 
-    if (checkCommand(options, "showdefaults")) {
-        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
-    }
+static void cliDumpStep(void)
+{
+    const uint8_t dumpMask = dumpState.mask;
 
-#ifdef USE_CLI_BATCH
-    bool batchModeEnabled = false;
-#endif
+    switch (dumpState.step) {
+    case DUMP_STEP_IDLE:
+        return;
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+    case DUMP_STEP_VERSION:
         cliPrintHashLine("version");
         cliVersion(NULL);
 
 #ifdef USE_CLI_BATCH
         cliPrintHashLine("start the command batch");
         cliPrintLine("batch start");
-        batchModeEnabled = true;
 #endif
 
         if ((dumpMask & (DUMP_ALL | DO_DIFF)) == (DUMP_ALL | DO_DIFF)) {
@@ -3633,142 +3697,273 @@ static void printConfig(const char *cmdline, bool doDiff)
 
         cliPrintHashLine("resources");
         //printResource(dumpMask, &defaultConfig);
+        break;
 
+    case DUMP_STEP_MOTOR_MIX:
         cliPrintHashLine("Mixer: motor mixer");
-        cliDumpPrintLinef(dumpMask, primaryMotorMixer_CopyArray[0].throttle == 0.0f, "\r\nmmix reset\r\n");
-
-        printMotorMix(dumpMask, primaryMotorMixer_CopyArray, primaryMotorMixer(0));
+        cliDumpPrintLinef(dumpMask, primaryMotorMixer(0)->throttle == 0.0f, "\r\nmmix reset\r\n");
+        printMotorMix(dumpMask, primaryMotorMixer(0), primaryMotorMixer_CopyArray);
+        break;
 
+    case DUMP_STEP_SERVO_MIX:
         // print custom servo mixer if exists
         cliPrintHashLine("Mixer: servo mixer");
-        cliDumpPrintLinef(dumpMask, customServoMixers_CopyArray[0].rate == 0, "smix reset\r\n");
-        printServoMix(dumpMask, customServoMixers_CopyArray, customServoMixers(0));
+        cliDumpPrintLinef(dumpMask, customServoMixers(0)->rate == 0, "smix reset\r\n");
+        printServoMix(dumpMask, customServoMixers(0), customServoMixers_CopyArray);
+        break;
 
+    case DUMP_STEP_SERVO:
         // print servo parameters
         cliPrintHashLine("Outputs [servo]");
-        printServo(dumpMask, servoParams_CopyArray, servoParams(0));
+        printServo(dumpMask, servoParams(0), servoParams_CopyArray);
+        break;
 
 #if defined(USE_SAFE_HOME)
+    case DUMP_STEP_SAFE_HOME:
         cliPrintHashLine("safehome");
-        printSafeHomes(dumpMask, safeHomeConfig_CopyArray, safeHomeConfig(0));
+        printSafeHomes(dumpMask, safeHomeConfig(0), safeHomeConfig_CopyArray);
+        break;
 #endif
 
+    case DUMP_STEP_FEATURE:
         cliPrintHashLine("features");
-        printFeature(dumpMask, &featureConfig_Copy, featureConfig());
+        printFeature(dumpMask, featureConfig(), &featureConfig_Copy);
+        break;
 
 #if defined(BEEPER) || defined(USE_DSHOT)
+    case DUMP_STEP_BEEPER:
         cliPrintHashLine("beeper");
-        printBeeper(dumpMask, &beeperConfig_Copy, beeperConfig());
+        printBeeper(dumpMask, beeperConfig(), &beeperConfig_Copy);
+        break;
 #endif
 
 #ifdef USE_BLACKBOX
+    case DUMP_STEP_BLACKBOX:
         cliPrintHashLine("blackbox");
-        printBlackbox(dumpMask, &blackboxConfig_Copy, blackboxConfig());
+        printBlackbox(dumpMask, blackboxConfig(), &blackboxConfig_Copy);
+        break;
 #endif
 
+    case DUMP_STEP_MAP:
         cliPrintHashLine("Receiver: Channel map");
-        printMap(dumpMask, &rxConfig_Copy, rxConfig());
+        printMap(dumpMask, rxConfig(), &rxConfig_Copy);
+        break;
 
+    case DUMP_STEP_SERIAL:
         cliPrintHashLine("Ports");
-        printSerial(dumpMask, &serialConfig_Copy, serialConfig());
+        printSerial(dumpMask, serialConfig(), &serialConfig_Copy);
+        break;
 
 #ifdef USE_LED_STRIP
+    case DUMP_STEP_LED:
         cliPrintHashLine("LEDs");
-        printLed(dumpMask, ledStripConfig_Copy.ledConfigs, ledStripConfig()->ledConfigs);
+        printLed(dumpMask, ledStripConfig()->ledConfigs, ledStripConfig_Copy.ledConfigs);
 
         cliPrintHashLine("LED color");
-        printColor(dumpMask, ledStripConfig_Copy.colors, ledStripConfig()->colors);
+        printColor(dumpMask, ledStripConfig()->colors, ledStripConfig_Copy.colors);
 
         cliPrintHashLine("LED mode_color");
-        printModeColor(dumpMask, &ledStripConfig_Copy, ledStripConfig());
+        printModeColor(dumpMask, ledStripConfig(), &ledStripConfig_Copy);
+        break;
 #endif
 
+    case DUMP_STEP_AUX:
         cliPrintHashLine("Modes [aux]");
-        printAux(dumpMask, modeActivationConditions_CopyArray, modeActivationConditions(0));
+        printAux(dumpMask, modeActivationConditions(0), modeActivationConditions_CopyArray);
+        break;
 
+    case DUMP_STEP_ADJUSTMENT_RANGE:
         cliPrintHashLine("Adjustments [adjrange]");
-        printAdjustmentRange(dumpMask, adjustmentRanges_CopyArray, adjustmentRanges(0));
+        printAdjustmentRange(dumpMask, adjustmentRanges(0), adjustmentRanges_CopyArray);
+        break;
 
+    case DUMP_STEP_RX_RANGE:
         cliPrintHashLine("Receiver rxrange");
-        printRxRange(dumpMask, rxChannelRangeConfigs_CopyArray, rxChannelRangeConfigs(0));
+        printRxRange(dumpMask, rxChannelRangeConfigs(0), rxChannelRangeConfigs_CopyArray);
+        break;
 
 #ifdef USE_TEMPERATURE_SENSOR
+    case DUMP_STEP_TEMP_SENSOR:
         cliPrintHashLine("temp_sensor");
-        printTempSensor(dumpMask, tempSensorConfig_CopyArray, tempSensorConfig(0));
+        printTempSensor(dumpMask, tempSensorConfig(0), tempSensorConfig_CopyArray);
+        break;
 #endif
 
 #if defined(NAV_NON_VOLATILE_WAYPOINT_STORAGE) && defined(NAV_NON_VOLATILE_WAYPOINT_CLI)
+    case DUMP_STEP_WAYPOINTS:
         cliPrintHashLine("Mission Control Waypoints [wp]");
-        printWaypoints(dumpMask, posControl.waypointList, nonVolatileWaypointList(0));
+        printWaypoints(dumpMask, posControl.waypointList, nonVolatileWaypointList_CopyArray);
+        break;
 #endif
 
 #ifdef USE_OSD
+    case DUMP_STEP_OSD_LAYOUT:
         cliPrintHashLine("OSD [osd_layout]");
-        printOsdLayout(dumpMask, &osdLayoutsConfig_Copy, osdLayoutsConfig(), -1, -1);
+        printOsdLayout(dumpMask, osdLayoutsConfig(), &osdLayoutsConfig_Copy, -1, -1);
+        break;
 #endif
 
 #ifdef USE_PROGRAMMING_FRAMEWORK
+    case DUMP_STEP_LOGIC:
         cliPrintHashLine("Programming: logic");
-        printLogic(dumpMask, logicConditions_CopyArray, logicConditions(0), -1);
+        printLogic(dumpMask, logicConditions(0), logicConditions_CopyArray, -1);
+        break;
 
+    case DUMP_STEP_GVAR:
         cliPrintHashLine("Programming: global variables");
-        printGvar(dumpMask, globalVariableConfigs_CopyArray, globalVariableConfigs(0));
+        printGvar(dumpMask, globalVariableConfigs(0), globalVariableConfigs_CopyArray);
+        break;
 
+    case DUMP_STEP_PID:
         cliPrintHashLine("Programming: PID controllers");
-        printPid(dumpMask, programmingPids_CopyArray, programmingPids(0));
+        printPid(dumpMask, programmingPids(0), programmingPids_CopyArray);
+        break;
 #endif
 
-        cliPrintHashLine("master");
-        dumpAllValues(MASTER_VALUE, dumpMask);
+    case DUMP_STEP_MASTER:
+        if (!dumpState.started) {
+            cliPrintHashLine("master");
+            dumpState.started = true;
+            return;
+        }
+        if (dumpNextValue(MASTER_VALUE, 0)) {
+            return;
+        }
+        break;
 
-        if (dumpMask & DUMP_ALL) {
-            // dump all profiles
-            const int currentProfileIndexSave = getConfigProfile();
-            const int currentBatteryProfileIndexSave = getConfigBatteryProfile();
-            for (int ii = 0; ii < MAX_PROFILE_COUNT; ++ii) {
-                cliDumpProfile(ii, dumpMask);
-            }
-            for (int ii = 0; ii < MAX_BATTERY_PROFILE_COUNT; ++ii) {
-                cliDumpBatteryProfile(ii, dumpMask);
-            }
-            setConfigProfile(currentProfileIndexSave);
-            setConfigBatteryProfile(currentBatteryProfileIndexSave);
+    case DUMP_STEP_PROFILE:
+        if (!dumpState.started) {
+            cliPrintHashLine("profile");
+            cliPrintLinef("profile %d\r\n", dumpState.profile + 1);
+            dumpState.valueSection = PROFILE_VALUE;
+            dumpState.started = true;
+            return;
+        }
+        if (dumpNextValue(dumpState.valueSection, dumpState.profile)) {
+            return;
+        }
+        if (dumpState.valueSection == PROFILE_VALUE) {
+            dumpState.valueSection = CONTROL_RATE_VALUE;
+            return;
+        }
+        if (dumpState.profile < dumpState.profileLast) {
+            dumpState.profile++;
+            dumpState.started = false;
+            return;
+        }
+        // dump just the current profile unless this is part of the master dump
+        dumpNextStep((dumpMask & (DUMP_MASTER | DUMP_ALL)) ? DUMP_STEP_BATTERY_PROFILE : DUMP_STEP_END);
+        return;
 
+    case DUMP_STEP_BATTERY_PROFILE:
+        if (!dumpState.started) {
+            cliPrintHashLine("battery_profile");
+            cliPrintLinef("battery_profile %d\r\n", dumpState.batteryProfile + 1);
+            dumpState.started = true;
+            return;
+        }
+        if (dumpNextValue(BATTERY_CONFIG_VALUE, dumpState.batteryProfile)) {
+            return;
+        }
+        if (dumpState.batteryProfile < dumpState.batteryProfileLast) {
+            dumpState.batteryProfile++;
+            dumpState.started = false;
+            return;
+        }
+        break;
+
+    case DUMP_STEP_END:
+        if (dumpMask & DUMP_ALL) {
             cliPrintHashLine("restore original profile selection");
-            cliPrintLinef("profile %d", currentProfileIndexSave + 1);
-            cliPrintLinef("battery_profile %d", currentBatteryProfileIndexSave + 1);
+            cliPrintLinef("profile %d", getConfigProfile() + 1);
+            cliPrintLinef("battery_profile %d", getConfigBatteryProfile() + 1);
+        }
+
+        if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+            cliPrintHashLine("save configuration\r\nsave");
+        }
 
 #ifdef USE_CLI_BATCH
-            batchModeEnabled = false;
+        // dumping all profiles leaves the batch open
+        if (dumpMask & DUMP_MASTER) {
+            cliPrintHashLine("end the command batch");
+            cliPrintLine("batch end");
+        }
 #endif
-        } else {
-            // dump just the current profiles
-            cliDumpProfile(getConfigProfile(), dumpMask);
-            cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+        dumpNextStep(DUMP_STEP_IDLE);
+        return;
+
+    default:
+        // Section not built in
+        break;
+    }
+
+    dumpNextStep(dumpState.step + 1);
+}
+
+// Returns true once the dump is done
+static bool cliDumpContinue(void)
+{
+    const timeUs_t startUs = micros();
+
+    // Only as fast as the port takes the output, so writing doesn't wait
+    while (dumpState.step != DUMP_STEP_IDLE &&
+            (serialTxBytesFree(cliPort) >= sizeof(cliWriteBuffer) - sizeof(*cliWriter) || isSerialTransmitBufferEmpty(cliPort))) {
+        cliDumpStep();
+        if (cmpTimeUs(micros(), startUs) >= CLI_DUMP_SLICE_US) {
+            break;
         }
     }
+    bufWriterFlush(cliWriter);
 
-    if (dumpMask & DUMP_PROFILE) {
-        cliDumpProfile(getConfigProfile(), dumpMask);
+    return dumpState.step == DUMP_STEP_IDLE;
+}
+
+static void printConfig(const char *cmdline, bool doDiff)
+{
+    uint8_t dumpMask = DUMP_MASTER;
+    const char *options;
+    if ((options = checkCommand(cmdline, "master"))) {
+        dumpMask = DUMP_MASTER; // only
+    } else if ((options = checkCommand(cmdline, "profile"))) {
+        dumpMask = DUMP_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "battery_profile"))) {
+        dumpMask = DUMP_BATTERY_PROFILE; // only
+    } else if ((options = checkCommand(cmdline, "all"))) {
+        dumpMask = DUMP_ALL;   // all profiles and rates
+    } else {
+        options = cmdline;
     }
 
-    if (dumpMask & DUMP_BATTERY_PROFILE) {
-        cliDumpBatteryProfile(getConfigBatteryProfile(), dumpMask);
+    if (doDiff) {
+        dumpMask = dumpMask | DO_DIFF;
     }
 
-    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
-        cliPrintHashLine("save configuration\r\nsave");
+    if (checkCommand(options, "showdefaults")) {
+        dumpMask = dumpMask | SHOW_DEFAULTS;   // add default values as comments for changed values
     }
 
-#ifdef USE_CLI_BATCH
-    if (batchModeEnabled) {
-        cliPrintHashLine("end the command batch");
-        cliPrintLine("batch end");
+    loadDefaultConfigs();
+
+    memset(&dumpState, 0, sizeof(dumpState));
+    dumpState.mask = dumpMask;
+    if (dumpMask & DUMP_ALL) {
+        // dump all profiles
+        dumpState.profileLast = MAX_PROFILE_COUNT - 1;
+        dumpState.batteryProfileLast = MAX_BATTERY_PROFILE_COUNT - 1;
+    } else {
+        // dump just the current profiles
+        dumpState.profile = dumpState.profileLast = getConfigProfile();
+        dumpState.batteryProfile = dumpState.batteryProfileLast = getConfigBatteryProfile();
     }
-#endif
 
-    // restore configs from copies
-    restoreConfigs();
+    if ((dumpMask & DUMP_MASTER) || (dumpMask & DUMP_ALL)) {
+        dumpNextStep(DUMP_STEP_VERSION);
+    } else if (dumpMask & DUMP_PROFILE) {
+        dumpNextStep(DUMP_STEP_PROFILE);
+    } else {
+        dumpNextStep(DUMP_STEP_BATTERY_PROFILE);
+    }
 }
 
 static void cliDump(char *cmdline)
@@ -3979,6 +4174,14 @@ void cliProcess(void)
     // Be a little bit tricky.  Flush the last inputs buffer, if any.
     bufWriterFlush(cliWriter);
 
+    // Input waits until a dump in progress is done
+    if (dumpState.step != DUMP_STEP_IDLE) {
+        if (!cliDumpContinue()) {
+            return;
+        }
+        cliPrompt();
+    }
+
     while (serialRxBytesWaiting(cliPort)) {
         uint8_t c = serialRead(cliPort);
         if (c == '\t' || c == '?') {
@@ -4063,6 +4266,10 @@ void cliProcess(void)
             if (!cliMode)
                 return;
 
+            // dump and diff print the prompt once they are done
+            if (dumpState.step != DUMP_STEP_IDLE)
+                return;
+
             cliPrompt();
         } else if (c == 127) {
             // backspace
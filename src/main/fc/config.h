@@ -19,6 +19,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "build/debug.h"
 #include "common/axis.h"
 #include "common/time.h"
 #include "config/parameter_group.h"
@@ -70,6 +71,7 @@ typedef struct systemConfig_s {
     uint8_t current_profile_index;
     uint8_t current_battery_profile_index;
     uint8_t debug_mode;
+    uint8_t debugModeExtra[DEBUG_CHANNEL_COUNT - 1];   // debug_mode_2..4, observed alongside debug_mode
 #ifdef USE_DEV_TOOLS
     bool groundTestMode;                    // Disables motor ouput, sets heading trusted on FW (for dev use)
 #endif
@@ -849,6 +849,7 @@ void taskMainPidLoop(timeUs_t currentTimeUs)
     if (!ARMING_FLAG(ARMED)) {
         armTime = 0;
 
+        statsProcessDelayedSave();
         processDelayedSave();
     }
 
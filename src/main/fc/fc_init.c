@@ -245,7 +245,10 @@ void init(void)
 
     systemState |= SYSTEM_STATE_CONFIG_LOADED;
 
-    debugMode = systemConfig()->debug_mode;
+    uint8_t debugModes[DEBUG_CHANNEL_COUNT];
+    debugModes[0] = systemConfig()->debug_mode;
+    memcpy(&debugModes[1], systemConfig()->debugModeExtra, sizeof(systemConfig()->debugModeExtra));
+    debugChannelsInit(debugModes, DEBUG_CHANNEL_COUNT);
 
     // Latch active features to be used for feature() in the remainder of init().
     latchActiveFeatures();
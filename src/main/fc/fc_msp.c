@@ -65,6 +65,7 @@
 #include "fc/controlrate_profile.h"
 #include "fc/fc_msp.h"
 #include "fc/fc_msp_box.h"
+#include "fc/fc_msp_replies.h"
 #include "fc/firmware_update.h"
 #include "fc/rc_adjustments.h"
 #include "fc/rc_controls.h"
@@ -448,20 +449,24 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         case MSP2_INAV_STATUS:
         {
             // Preserves full arming flags and box modes
-            boxBitmask_t mspBoxModeFlags;
-            packBoxModeFlags(&mspBoxModeFlags);
+            mspInavStatus_t *status = sbufReserve(dst, sizeof(*status));
+            if (!status) {
+                break;
+            }
 
-            sbufWriteU16(dst, (uint16_t)cycleTime);
+            status->cycleTime = cycleTime;
 #ifdef USE_I2C
-            sbufWriteU16(dst, i2cGetErrorCounter());
+            status->i2cErrors = i2cGetErrorCounter();
 #else
-            sbufWriteU16(dst, 0);
+            status->i2cErrors = 0;
 #endif
-            sbufWriteU16(dst, packSensorStatus());
-            sbufWriteU16(dst, averageSystemLoadPercent);
-            sbufWriteU8(dst, (getConfigBatteryProfile() << 4) | getConfigProfile());
-            sbufWriteU32(dst, armingFlags);
-            sbufWriteData(dst, &mspBoxModeFlags, sizeof(mspBoxModeFlags));
+            status->sensorStatus = packSensorStatus();
+            status->systemLoad = averageSystemLoadPercent;
+            status->profiles = (getConfigBatteryProfile() << 4) | getConfigProfile();
+            status->armingFlags = armingFlags;
+            boxBitmask_t mspBoxModeFlags;
+            packBoxModeFlags(&mspBoxModeFlags);
+            memcpy(&status->modeFlags, &mspBoxModeFlags, sizeof(mspBoxModeFlags));
         }
         break;
 
@@ -487,53 +492,19 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         sbufWriteData(dst, &servo, MAX_SUPPORTED_SERVOS * 2);
         break;
     case MSP_SERVO_CONFIGURATIONS:
-        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-            sbufWriteU16(dst, servoParams(i)->min);
-            sbufWriteU16(dst, servoParams(i)->max);
-            sbufWriteU16(dst, servoParams(i)->middle);
-            sbufWriteU8(dst, servoParams(i)->rate);
-            sbufWriteU8(dst, 0);
-            sbufWriteU8(dst, 0);
-            sbufWriteU8(dst, 255); // used to be forwardFromChannel, not used anymore, send 0xff for compatibility reasons
-            sbufWriteU32(dst, 0); //Input reversing is not required since it can be done on mixer level
-        }
+        mspSerializeServoConfigurations(dst, servoParams(0), MAX_SUPPORTED_SERVOS);
         break;
     case MSP_SERVO_MIX_RULES:
-        for (int i = 0; i < MAX_SERVO_RULES; i++) {
-            sbufWriteU8(dst, customServoMixers(i)->targetChannel);
-            sbufWriteU8(dst, customServoMixers(i)->inputSource);
-            sbufWriteU16(dst, customServoMixers(i)->rate);
-            sbufWriteU8(dst, customServoMixers(i)->speed);
-            sbufWriteU8(dst, 0);
-            sbufWriteU8(dst, 100);
-            sbufWriteU8(dst, 0);
-        }
+        mspSerializeServoMixRules(dst, customServoMixers(0), MAX_SERVO_RULES);
         break;
     case MSP2_INAV_SERVO_MIXER:
-        for (int i = 0; i < MAX_SERVO_RULES; i++) {
-            sbufWriteU8(dst, customServoMixers(i)->targetChannel);
-            sbufWriteU8(dst, customServoMixers(i)->inputSource);
-            sbufWriteU16(dst, customServoMixers(i)->rate);
-            sbufWriteU8(dst, customServoMixers(i)->speed);
-        #ifdef USE_PROGRAMMING_FRAMEWORK
-            sbufWriteU8(dst, customServoMixers(i)->conditionId);
-        #else
-            sbufWriteU8(dst, -1);
-        #endif
-        }
+        mspSerializeServoMixer(dst, customServoMixers(0), MAX_SERVO_RULES);
         break;
 #ifdef USE_PROGRAMMING_FRAMEWORK
     case MSP2_INAV_LOGIC_CONDITIONS:
-        for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
-            sbufWriteU8(dst, logicConditions(i)->enabled);
-            sbufWriteU8(dst, logicConditions(i)->activatorId);
-            sbufWriteU8(dst, logicConditions(i)->operation);
-            sbufWriteU8(dst, logicConditions(i)->operandA.type);
-            sbufWriteU32(dst, logicConditions(i)->operandA.value);
-            sbufWriteU8(dst, logicConditions(i)->operandB.type);
-            sbufWriteU32(dst, logicConditions(i)->operandB.value);
-            sbufWriteU8(dst, logicConditions(i)->flags);
-        }
+        // Too long for the reply buffer of targets without flash, these get
+        // an empty reply and use MSP2_INAV_LOGIC_CONDITIONS_SINGLE
+        mspSerializeLogicConditions(dst, logicConditions(0), MAX_LOGIC_CONDITIONS);
         break;
     case MSP2_INAV_LOGIC_CONDITIONS_STATUS:
         for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
@@ -546,17 +517,7 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         }
         break;
     case MSP2_INAV_PROGRAMMING_PID:
-        for (int i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
-            sbufWriteU8(dst, programmingPids(i)->enabled);
-            sbufWriteU8(dst, programmingPids(i)->setpoint.type);
-            sbufWriteU32(dst, programmingPids(i)->setpoint.value);
-            sbufWriteU8(dst, programmingPids(i)->measurement.type);
-            sbufWriteU32(dst, programmingPids(i)->measurement.value);
-            sbufWriteU16(dst, programmingPids(i)->gains.P);
-            sbufWriteU16(dst, programmingPids(i)->gains.I);
-            sbufWriteU16(dst, programmingPids(i)->gains.D);
-            sbufWriteU16(dst, programmingPids(i)->gains.FF);
-        }
+        mspSerializeProgrammingPids(dst, programmingPids(0), MAX_PROGRAMMING_PID_COUNT);
         break;
     case MSP2_INAV_PROGRAMMING_PID_STATUS:
         for (int i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
@@ -938,6 +899,19 @@ static bool mspFcProcessOutCommand(uint16_t cmdMSP, sbuf_t *dst, mspPostProcessF
         }
         break;
 
+    case MSP2_INAV_DEBUG_CHANNELS:
+        // All debug channels (debug_mode, debug_mode_2..), so the configurator can watch them live
+        sbufWriteU8(dst, DEBUG_CHANNEL_COUNT);
+        sbufWriteU8(dst, DEBUG32_VALUE_COUNT);
+        for (int channel = 0; channel < DEBUG_CHANNEL_COUNT; channel++) {
+            const int32_t *values = debugChannelGetValues(channel);
+            sbufWriteU8(dst, debugChannelGetMode(channel));
+            for (int i = 0; i < DEBUG32_VALUE_COUNT; i++) {
+                sbufWriteU32(dst, values[i]);
+            }
+        }
+        break;
+
     case MSP_UID:
         sbufWriteU32(dst, U_ID_0);
         sbufWriteU32(dst, U_ID_1);
@@ -1594,14 +1568,7 @@ static mspResult_e mspFcSafeHomeOutCommand(sbuf_t *dst, sbuf_t *src)
 static mspResult_e mspFcLogicConditionCommand(sbuf_t *dst, sbuf_t *src) {
     const uint8_t idx = sbufReadU8(src);
     if (idx < MAX_LOGIC_CONDITIONS) {
-        sbufWriteU8(dst, logicConditions(idx)->enabled);
-        sbufWriteU8(dst, logicConditions(idx)->activatorId);
-        sbufWriteU8(dst, logicConditions(idx)->operation);
-        sbufWriteU8(dst, logicConditions(idx)->operandA.type);
-        sbufWriteU32(dst, logicConditions(idx)->operandA.value);
-        sbufWriteU8(dst, logicConditions(idx)->operandB.type);
-        sbufWriteU32(dst, logicConditions(idx)->operandB.value);
-        sbufWriteU8(dst, logicConditions(idx)->flags);
+        mspSerializeLogicConditions(dst, logicConditions(idx), 1);
         return MSP_RESULT_ACK;
     } else {
         return MSP_RESULT_ERROR;
@@ -1613,15 +1580,7 @@ static void mspFcWaypointOutCommand(sbuf_t *dst, sbuf_t *src)
     const uint8_t msp_wp_no = sbufReadU8(src);    // get the wp number
     navWaypoint_t msp_wp;
     getWaypoint(msp_wp_no, &msp_wp);
-    sbufWriteU8(dst, msp_wp_no);      // wp_no
-    sbufWriteU8(dst, msp_wp.action);  // action (WAYPOINT)
-    sbufWriteU32(dst, msp_wp.lat);    // lat
-    sbufWriteU32(dst, msp_wp.lon);    // lon
-    sbufWriteU32(dst, msp_wp.alt);    // altitude (cm)
-    sbufWriteU16(dst, msp_wp.p1);     // P1
-    sbufWriteU16(dst, msp_wp.p2);     // P2
-    sbufWriteU16(dst, msp_wp.p3);     // P3
-    sbufWriteU8(dst, msp_wp.flag);    // flags
+    mspSerializeWaypoint(dst, msp_wp_no, &msp_wp);
 }
 
 #ifdef USE_FLASHFS
@@ -2003,6 +1962,7 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
             sbufReadU8(src); // used to be forwardFromChannel, ignored
             sbufReadU32(src); // used to be reversedSources
             servoComputeScalingFactors(tmp_u8);
+            servoInitOutputStage(tmp_u8);
         }
         break;
 
@@ -2972,11 +2932,15 @@ static mspResult_e mspFcProcessInCommand(uint16_t cmdMSP, sbuf_t *src)
 #endif
 
 #ifdef MSP_FIRMWARE_UPDATE
-    case MSP2_INAV_FWUPDT_PREPARE:
-        if (!firmwareUpdatePrepare(sbufReadU32(src))) {
+    case MSP2_INAV_FWUPDT_PREPARE: {
+        const uint32_t firmwareSize = sbufReadU32(src);
+        // Optional encoding, raw images when omitted
+        const firmwareUpdateEncoding_e encoding = sbufBytesRemaining(src) ? sbufReadU8(src) : FIRMWARE_UPDATE_ENCODING_RAW;
+        if (!firmwareUpdatePrepare(firmwareSize, encoding)) {
             return MSP_RESULT_ERROR;
         }
         break;
+    }
     case MSP2_INAV_FWUPDT_STORE:
         if (!firmwareUpdateStore(sbufPtr(src), sbufBytesRemaining(src))) {
             return MSP_RESULT_ERROR;
@@ -0,0 +1,162 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/utils.h"
+
+#include "fc/fc_msp_replies.h"
+
+// The structs are stored as they are, so both ends have to agree on the
+// byte order and on the layouts the configurator expects
+STATIC_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, msp_replies_need_little_endian);
+STATIC_ASSERT(sizeof(mspInavStatus_t) == 13 + sizeof(boxBitmask_t), mspInavStatus_size);
+STATIC_ASSERT(sizeof(mspServoConfiguration_t) == 14, mspServoConfiguration_size);
+STATIC_ASSERT(sizeof(mspServoMixRule_t) == 8, mspServoMixRule_size);
+STATIC_ASSERT(sizeof(mspServoMixer_t) == 6, mspServoMixer_size);
+STATIC_ASSERT(sizeof(mspLogicCondition_t) == 14, mspLogicCondition_size);
+STATIC_ASSERT(sizeof(mspProgrammingPid_t) == 19, mspProgrammingPid_size);
+STATIC_ASSERT(sizeof(mspWaypoint_t) == 21, mspWaypoint_size);
+
+bool mspSerializeServoConfigurations(sbuf_t *dst, const servoParam_t *params, int count)
+{
+    mspServoConfiguration_t *reply = sbufReserve(dst, count * sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        reply[i].min = params[i].min;
+        reply[i].max = params[i].max;
+        reply[i].middle = params[i].middle;
+        reply[i].rate = params[i].rate;
+        reply[i].reserved[0] = 0;
+        reply[i].reserved[1] = 0;
+        reply[i].forwardFromChannel = 255;
+        reply[i].reversedSources = 0;
+    }
+
+    return true;
+}
+
+bool mspSerializeServoMixRules(sbuf_t *dst, const servoMixer_t *rules, int count)
+{
+    mspServoMixRule_t *reply = sbufReserve(dst, count * sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        reply[i].targetChannel = rules[i].targetChannel;
+        reply[i].inputSource = rules[i].inputSource;
+        reply[i].rate = rules[i].rate;
+        reply[i].speed = rules[i].speed;
+        reply[i].min = 0;
+        reply[i].max = 100;
+        reply[i].box = 0;
+    }
+
+    return true;
+}
+
+bool mspSerializeServoMixer(sbuf_t *dst, const servoMixer_t *rules, int count)
+{
+    mspServoMixer_t *reply = sbufReserve(dst, count * sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        reply[i].targetChannel = rules[i].targetChannel;
+        reply[i].inputSource = rules[i].inputSource;
+        reply[i].rate = rules[i].rate;
+        reply[i].speed = rules[i].speed;
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        reply[i].conditionId = rules[i].conditionId;
+#else
+        reply[i].conditionId = -1;
+#endif
+    }
+
+    return true;
+}
+
+bool mspSerializeLogicConditions(sbuf_t *dst, const logicCondition_t *conditions, int count)
+{
+    mspLogicCondition_t *reply = sbufReserve(dst, count * sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        reply[i].enabled = conditions[i].enabled;
+        reply[i].activatorId = conditions[i].activatorId;
+        reply[i].operation = conditions[i].operation;
+        reply[i].operandAType = conditions[i].operandA.type;
+        reply[i].operandAValue = conditions[i].operandA.value;
+        reply[i].operandBType = conditions[i].operandB.type;
+        reply[i].operandBValue = conditions[i].operandB.value;
+        reply[i].flags = conditions[i].flags;
+    }
+
+    return true;
+}
+
+bool mspSerializeProgrammingPids(sbuf_t *dst, const programmingPid_t *pids, int count)
+{
+    mspProgrammingPid_t *reply = sbufReserve(dst, count * sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        reply[i].enabled = pids[i].enabled;
+        reply[i].setpointType = pids[i].setpoint.type;
+        reply[i].setpointValue = pids[i].setpoint.value;
+        reply[i].measurementType = pids[i].measurement.type;
+        reply[i].measurementValue = pids[i].measurement.value;
+        reply[i].gains[0] = pids[i].gains.P;
+        reply[i].gains[1] = pids[i].gains.I;
+        reply[i].gains[2] = pids[i].gains.D;
+        reply[i].gains[3] = pids[i].gains.FF;
+    }
+
+    return true;
+}
+
+bool mspSerializeWaypoint(sbuf_t *dst, uint8_t number, const navWaypoint_t *wp)
+{
+    mspWaypoint_t *reply = sbufReserve(dst, sizeof(*reply));
+    if (!reply) {
+        return false;
+    }
+
+    reply->number = number;
+    reply->action = wp->action;
+    reply->lat = wp->lat;
+    reply->lon = wp->lon;
+    reply->alt = wp->alt;
+    reply->p1 = wp->p1;
+    reply->p2 = wp->p2;
+    reply->p3 = wp->p3;
+    reply->flag = wp->flag;
+
+    return true;
+}
@@ -0,0 +1,116 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/streambuf.h"
+
+#include "fc/rc_modes.h"
+
+#include "flight/servos.h"
+
+#include "navigation/navigation.h"
+
+#include "programming/logic_condition.h"
+#include "programming/pid.h"
+
+/*
+ * Wire layouts of the fixed size MSP replies. Each one is checked for room
+ * once and filled in place, rather than field by field. MSP is little
+ * endian, as are all the targets.
+ */
+
+typedef struct mspInavStatus_s {
+    uint16_t cycleTime;
+    uint16_t i2cErrors;
+    uint16_t sensorStatus;
+    uint16_t systemLoad;
+    uint8_t profiles;               // Battery profile << 4 | profile
+    uint32_t armingFlags;
+    boxBitmask_t modeFlags;
+} __attribute__((packed)) mspInavStatus_t;
+
+typedef struct mspServoConfiguration_s {
+    int16_t min;
+    int16_t max;
+    int16_t middle;
+    int8_t rate;
+    uint8_t reserved[2];
+    uint8_t forwardFromChannel;     // Not used anymore, 255 for compatibility
+    uint32_t reversedSources;       // Not used anymore, reversing is done by the mixer
+} __attribute__((packed)) mspServoConfiguration_t;
+
+typedef struct mspServoMixRule_s {
+    uint8_t targetChannel;
+    uint8_t inputSource;
+    int16_t rate;
+    uint8_t speed;
+    uint8_t min;
+    uint8_t max;
+    uint8_t box;
+} __attribute__((packed)) mspServoMixRule_t;
+
+typedef struct mspServoMixer_s {
+    uint8_t targetChannel;
+    uint8_t inputSource;
+    int16_t rate;
+    uint8_t speed;
+    int8_t conditionId;
+} __attribute__((packed)) mspServoMixer_t;
+
+typedef struct mspLogicCondition_s {
+    uint8_t enabled;
+    int8_t activatorId;
+    uint8_t operation;
+    uint8_t operandAType;
+    int32_t operandAValue;
+    uint8_t operandBType;
+    int32_t operandBValue;
+    uint8_t flags;
+} __attribute__((packed)) mspLogicCondition_t;
+
+typedef struct mspProgrammingPid_s {
+    uint8_t enabled;
+    uint8_t setpointType;
+    int32_t setpointValue;
+    uint8_t measurementType;
+    int32_t measurementValue;
+    uint16_t gains[4];              // P, I, D, FF
+} __attribute__((packed)) mspProgrammingPid_t;
+
+typedef struct mspWaypoint_s {
+    uint8_t number;
+    uint8_t action;
+    int32_t lat;
+    int32_t lon;
+    int32_t alt;                    // cm
+    int16_t p1;
+    int16_t p2;
+    int16_t p3;
+    uint8_t flag;
+} __attribute__((packed)) mspWaypoint_t;
+
+// All of these write nothing and return false when the reply doesn't fit
+bool mspSerializeServoConfigurations(sbuf_t *dst, const servoParam_t *params, int count);
+bool mspSerializeServoMixRules(sbuf_t *dst, const servoMixer_t *rules, int count);
+bool mspSerializeServoMixer(sbuf_t *dst, const servoMixer_t *rules, int count);
+bool mspSerializeLogicConditions(sbuf_t *dst, const logicCondition_t *conditions, int count);
+bool mspSerializeProgrammingPids(sbuf_t *dst, const programmingPid_t *pids, int count);
+bool mspSerializeWaypoint(sbuf_t *dst, uint8_t number, const navWaypoint_t *wp);
@@ -43,7 +43,6 @@
 #include "fc/rc_controls.h"
 #include "fc/runtime_config.h"
 
-#include "flight/dynamic_lpf.h"
 #include "flight/imu.h"
 #include "flight/mixer.h"
 #include "flight/pid.h"
@@ -307,7 +306,9 @@ void taskUpdateOsd(timeUs_t currentTimeUs)
 void taskUpdateAux(timeUs_t currentTimeUs)
 {
     updatePIDCoefficients();
-    dynamicLpfGyroTask();
+    if (ARMING_FLAG(ARMED)) {
+        statsUpdate();
+    }
 #ifdef USE_SIMULATOR
     if (!ARMING_FLAG(SIMULATOR_MODE_HITL)) {
         updateFixedWingLevelTrim(currentTimeUs);
@@ -615,8 +616,9 @@ cfTask_t cfTasks[TASK_COUNT] = {
 #if defined(USE_VTX_CONTROL)
     [TASK_VTXCTRL] = {
         .taskName = "VTXCTRL",
+        .checkFunc = vtxUpdateCheck,
         .taskFunc = vtxUpdate,
-        .desiredPeriod = TASK_PERIOD_HZ(5),          // 5Hz @200msec
+        .desiredPeriod = TASK_PERIOD_HZ(5),          // Settings at 5Hz @200msec, device events in between
         .staticPriority = TASK_PRIORITY_IDLE,
     },
 #endif
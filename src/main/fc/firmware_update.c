@@ -33,6 +33,7 @@
 
 #include "fc/firmware_update.h"
 #include "fc/firmware_update_common.h"
+#include "fc/firmware_update_stream.h"
 #include "fc/runtime_config.h"
 
 #include "io/asyncfatfs/asyncfatfs.h"
@@ -48,6 +49,8 @@ static firmwareUpdateMetadata_t updateMetadata;
 static uint8_t updateFirmwareCalcCRC = 0;
 static uint32_t receivedSize = 0;
 static bool rollbackPrepared = false;
+static firmwareUpdateEncoding_e updateEncoding = FIRMWARE_UPDATE_ENCODING_RAW;
+static firmwareUpdateStream_t updateStream;
 
 #if defined(USE_SDCARD)
 static uint32_t firmwareSize;
@@ -206,7 +209,45 @@ static bool backupIsValid(void)
     return (calcCRC == updateMetadata.backupCRC);
 }
 
-bool firmwareUpdatePrepare(uint32_t updateSize)
+// Appends decoded image data to the storage
+static bool firmwareUpdateWrite(const uint8_t *data, uint32_t length)
+{
+#if defined(USE_SDCARD)
+
+    if (!updateFile || !firmwareSize || (receivedSize + length > firmwareSize)
+            || (afatfs_fwriteSync(updateFile, (uint8_t *)data, length) != length)) {
+        return false;
+    }
+
+#elif defined(USE_FLASHFS)
+    if  (!updateMetadata.firmwareSize || (receivedSize + length > updateMetadata.firmwareSize)) return false;
+
+    const uint32_t flashAddress = flashStartAddress + receivedSize;
+
+    if ((flashAddress + length > flashOverflowAddress) || (receivedSize + length > updateMetadata.firmwareSize)) {
+        updateMetadata.firmwareSize = 0;
+        return false;
+    }
+
+    const flashGeometry_t *flashGeometry = flashGetGeometry();
+    const uint32_t flashSectorSize = flashGeometry->sectorSize;
+
+    if (flashAddress % flashSectorSize == 0) {
+        flashEraseSector(flashAddress);
+        flashWaitForReady(1000);
+    }
+
+    flashPageProgram(flashAddress, data, length);
+
+#endif
+
+    updateFirmwareCalcCRC = crc8_dvb_s2_update(updateFirmwareCalcCRC, data, length);
+    receivedSize += length;
+
+    return true;
+}
+
+bool firmwareUpdatePrepare(uint32_t updateSize, firmwareUpdateEncoding_e encoding)
 {
     if (ARMING_FLAG(ARMED) || (updateSize > AVAILABLE_FIRMWARE_SPACE)) return false;
 
@@ -214,6 +255,8 @@ bool firmwareUpdatePrepare(uint32_t updateSize)
     if ((afatfs_getFilesystemState() != AFATFS_FILESYSTEM_STATE_READY) || !afatfs_fopen(FIRMWARE_UPDATE_FIRMWARE_FILENAME, "w+", updateFileOpenCallback)) return false;
 
     firmwareSize = updateSize;
+    receivedSize = 0;
+    const uint16_t streamBlockSize = 512;
 
 #elif defined(USE_FLASHFS)
     flashPartition_t *flashUpdatePartition = flashPartitionFindByType(FLASH_PARTITION_TYPE_UPDATE_FIRMWARE);
@@ -232,12 +275,23 @@ bool firmwareUpdatePrepare(uint32_t updateSize)
     }
 
     updateMetadata.firmwareSize = updateSize;
+    const uint16_t streamBlockSize = flashGeometry->pageSize;
 
 #endif
 
     updateFirmwareCalcCRC = 0;
-
-    return true;
+    updateEncoding = encoding;
+
+    switch (encoding) {
+        case FIRMWARE_UPDATE_ENCODING_RAW:
+            return true;
+        case FIRMWARE_UPDATE_ENCODING_STREAM:
+            // Deltas are made against the running firmware, which stays in place until the bootloader runs
+            return firmwareUpdateStreamInit(&updateStream, updateSize, &__firmware_start, AVAILABLE_FIRMWARE_SPACE,
+                    streamBlockSize, firmwareUpdateWrite);
+        default:
+            return false;
+    }
 }
 
 bool firmwareUpdateStore(uint8_t *data, uint16_t length)
@@ -246,53 +300,28 @@ bool firmwareUpdateStore(uint8_t *data, uint16_t length)
         return false;
     }
 
-#if defined(USE_SDCARD)
-
-    if (!updateFile || !firmwareSize || (receivedSize + length > firmwareSize)
-            || (afatfs_fwriteSync(updateFile, data, length) != length)) {
-        return false;
-    }
-
-#elif defined(USE_FLASHFS)
-    if  (!updateMetadata.firmwareSize || (receivedSize + length > updateMetadata.firmwareSize)) return false;
-
-    const uint32_t flashAddress = flashStartAddress + receivedSize;
-
-    if ((flashAddress + length > flashOverflowAddress) || (receivedSize + length > updateMetadata.firmwareSize)) {
-        updateMetadata.firmwareSize = 0;
-        return false;
+    if (updateEncoding == FIRMWARE_UPDATE_ENCODING_STREAM) {
+        return firmwareUpdateStreamFeed(&updateStream, data, length);
     }
 
-    const flashGeometry_t *flashGeometry = flashGetGeometry();
-    const uint32_t flashSectorSize = flashGeometry->sectorSize;
-
-    if (flashAddress % flashSectorSize == 0) {
-        flashEraseSector(flashAddress);
-        flashWaitForReady(1000);
-    }
-
-    flashPageProgram(flashAddress, data, length);
-
-#endif
-
-    updateFirmwareCalcCRC = crc8_dvb_s2_update(updateFirmwareCalcCRC, data, length);
-    receivedSize += length;
-
-    return true;
+    return firmwareUpdateWrite(data, length);
 }
 
 void firmwareUpdateExec(uint8_t expectCRC)
 {
     if (ARMING_FLAG(ARMED)) return;
 
+    // The decoded image is checked against the CRC16 of the stream header as well
+    const bool streamComplete = (updateEncoding != FIRMWARE_UPDATE_ENCODING_STREAM) || firmwareUpdateStreamIsComplete(&updateStream);
+
 #if defined(USE_SDCARD)
     if (!afatfs_fclose(updateFile, NULL)) return;
-    if (firmwareSize && (receivedSize == firmwareSize) &&
+    if (firmwareSize && (receivedSize == firmwareSize) && streamComplete &&
             (updateFirmwareCalcCRC == expectCRC) && fullBackup() && firmwareUpdateMetadataWrite(&updateMetadata)) {
         systemResetRequest(RESET_BOOTLOADER_FIRMWARE_UPDATE);
     }
 #elif defined(USE_FLASHFS)
-    if (updateMetadata.firmwareSize && (receivedSize == updateMetadata.firmwareSize) &&
+    if (updateMetadata.firmwareSize && (receivedSize == updateMetadata.firmwareSize) && streamComplete &&
             (updateFirmwareCalcCRC == expectCRC) && fullBackup() && firmwareUpdateMetadataWrite(&updateMetadata)) {
         systemResetRequest(RESET_BOOTLOADER_FIRMWARE_UPDATE);
     }
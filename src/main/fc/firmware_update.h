@@ -20,7 +20,12 @@
 
 #pragma once
 
-bool firmwareUpdatePrepare(uint32_t firmwareSize);
+typedef enum {
+    FIRMWARE_UPDATE_ENCODING_RAW = 0,       // the image as is
+    FIRMWARE_UPDATE_ENCODING_STREAM = 1,    // compressed or delta encoded, see fc/firmware_update_stream.h
+} firmwareUpdateEncoding_e;
+
+bool firmwareUpdatePrepare(uint32_t firmwareSize, firmwareUpdateEncoding_e encoding);
 bool firmwareUpdateStore(uint8_t *data, uint16_t length);
 void firmwareUpdateExec(uint8_t expectCRC);
 bool firmwareUpdateRollbackPrepare(void);
@@ -0,0 +1,249 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/crc.h"
+
+#include "fc/firmware_update_stream.h"
+
+#ifdef MSP_FIRMWARE_UPDATE
+
+#define WINDOW_MASK     (FIRMWARE_UPDATE_STREAM_WINDOW_SIZE - 1)
+
+static uint16_t readU16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+static uint32_t readU32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static bool streamFail(firmwareUpdateStream_t *stream)
+{
+    stream->state = FIRMWARE_UPDATE_STREAM_STATE_ERROR;
+    return false;
+}
+
+static bool streamFlush(firmwareUpdateStream_t *stream)
+{
+    const uint32_t length = stream->outputPos - stream->flushedPos;
+
+    if (length == 0) {
+        return true;
+    }
+    // Blocks never wrap around the window as the block size divides it
+    if (!stream->writeFn(&stream->window[stream->flushedPos & WINDOW_MASK], length)) {
+        return false;
+    }
+    stream->flushedPos = stream->outputPos;
+    return true;
+}
+
+static bool streamPut(firmwareUpdateStream_t *stream, uint8_t c)
+{
+    stream->window[stream->outputPos & WINDOW_MASK] = c;
+    stream->calcCrc = crc16_ccitt(stream->calcCrc, c);
+    stream->outputPos++;
+
+    if (stream->outputPos - stream->flushedPos == stream->blockSize) {
+        return streamFlush(stream);
+    }
+    return true;
+}
+
+static bool streamParseHeader(firmwareUpdateStream_t *stream)
+{
+    const uint8_t *header = stream->header;
+
+    if (readU32(&header[0]) != FIRMWARE_UPDATE_STREAM_MAGIC || header[4] != FIRMWARE_UPDATE_STREAM_VERSION || header[5] != 0) {
+        return false;
+    }
+
+    stream->outputCrc = readU16(&header[6]);
+    stream->outputSize = readU32(&header[8]);
+    stream->baseSize = readU32(&header[12]);
+
+    if (stream->outputSize == 0 || stream->outputSize != stream->expectedSize || stream->baseSize > stream->baseLimit) {
+        return false;
+    }
+
+    // A delta only applies to the firmware it was made against
+    return stream->baseSize == 0 || crc16_ccitt_update(0, stream->base, stream->baseSize) == readU16(&header[16]);
+}
+
+// Called once the whole image has been produced
+static bool streamFinish(firmwareUpdateStream_t *stream)
+{
+    if (!streamFlush(stream) || stream->calcCrc != stream->outputCrc) {
+        return streamFail(stream);
+    }
+    stream->state = FIRMWARE_UPDATE_STREAM_STATE_DONE;
+    return true;
+}
+
+static bool streamCopy(firmwareUpdateStream_t *stream, uint32_t argument)
+{
+    if (stream->op == FIRMWARE_UPDATE_STREAM_OP_WINDOW) {
+        const uint32_t distance = argument + 1;
+        if (distance > FIRMWARE_UPDATE_STREAM_WINDOW_SIZE || distance > stream->outputPos) {
+            return false;
+        }
+        // Byte by byte, the source may overlap the bytes being produced
+        for (uint32_t i = 0; i < stream->length; i++) {
+            if (!streamPut(stream, stream->window[(stream->outputPos - distance) & WINDOW_MASK])) {
+                return false;
+            }
+        }
+    } else {
+        // Zigzag encoded move relative to the end of the previous base copy
+        const int32_t move = (int32_t)((argument >> 1) ^ -(argument & 1));
+        const uint32_t cursor = stream->baseCursor + move;
+        if (cursor > stream->baseSize || stream->length > stream->baseSize - cursor) {
+            return false;
+        }
+        for (uint32_t i = 0; i < stream->length; i++) {
+            if (!streamPut(stream, stream->base[cursor + i])) {
+                return false;
+            }
+        }
+        stream->baseCursor = cursor + stream->length;
+    }
+    return true;
+}
+
+// Accumulates a little endian base 128 varint, returns true once complete
+static bool streamVarint(firmwareUpdateStream_t *stream, uint8_t c, bool *error)
+{
+    if (stream->varintShift > 28) {
+        *error = true;
+        return false;
+    }
+    stream->varint |= (uint32_t)(c & 0x7F) << stream->varintShift;
+    stream->varintShift += 7;
+    return !(c & 0x80);
+}
+
+bool firmwareUpdateStreamInit(firmwareUpdateStream_t *stream, uint32_t expectedSize, const uint8_t *base, uint32_t baseLimit,
+                              uint16_t blockSize, firmwareUpdateStreamWriteFnPtr writeFn)
+{
+    memset(stream, 0, offsetof(firmwareUpdateStream_t, window));
+
+    if (blockSize == 0 || blockSize > FIRMWARE_UPDATE_STREAM_WINDOW_SIZE || (FIRMWARE_UPDATE_STREAM_WINDOW_SIZE % blockSize) != 0) {
+        return streamFail(stream);
+    }
+
+    stream->state = FIRMWARE_UPDATE_STREAM_STATE_HEADER;
+    stream->expectedSize = expectedSize;
+    stream->base = base;
+    stream->baseLimit = baseLimit;
+    stream->blockSize = blockSize;
+    stream->writeFn = writeFn;
+    return true;
+}
+
+bool firmwareUpdateStreamFeed(firmwareUpdateStream_t *stream, const uint8_t *data, uint32_t length)
+{
+    const uint8_t *end = data + length;
+
+    while (data < end) {
+        switch (stream->state) {
+            case FIRMWARE_UPDATE_STREAM_STATE_HEADER:
+                stream->header[stream->headerPos++] = *data++;
+                if (stream->headerPos == FIRMWARE_UPDATE_STREAM_HEADER_SIZE) {
+                    if (!streamParseHeader(stream)) {
+                        return streamFail(stream);
+                    }
+                    stream->state = FIRMWARE_UPDATE_STREAM_STATE_OP;
+                }
+                break;
+
+            case FIRMWARE_UPDATE_STREAM_STATE_OP: {
+                bool error = false;
+                if (streamVarint(stream, *data++, &error)) {
+                    stream->op = stream->varint & 3;
+                    stream->length = (stream->varint >> 2) + 1;
+                    stream->varint = 0;
+                    stream->varintShift = 0;
+                    if (stream->op > FIRMWARE_UPDATE_STREAM_OP_BASE || stream->length > stream->outputSize - stream->outputPos) {
+                        return streamFail(stream);
+                    }
+                    stream->state = stream->op == FIRMWARE_UPDATE_STREAM_OP_LITERAL ? FIRMWARE_UPDATE_STREAM_STATE_LITERAL : FIRMWARE_UPDATE_STREAM_STATE_ARGUMENT;
+                } else if (error) {
+                    return streamFail(stream);
+                }
+                break;
+            }
+
+            case FIRMWARE_UPDATE_STREAM_STATE_ARGUMENT: {
+                bool error = false;
+                if (streamVarint(stream, *data++, &error)) {
+                    const uint32_t argument = stream->varint;
+                    stream->varint = 0;
+                    stream->varintShift = 0;
+                    if (!streamCopy(stream, argument)) {
+                        return streamFail(stream);
+                    }
+                    stream->state = FIRMWARE_UPDATE_STREAM_STATE_OP;
+                } else if (error) {
+                    return streamFail(stream);
+                }
+                break;
+            }
+
+            case FIRMWARE_UPDATE_STREAM_STATE_LITERAL:
+                if (!streamPut(stream, *data++)) {
+                    return streamFail(stream);
+                }
+                if (--stream->length == 0) {
+                    stream->state = FIRMWARE_UPDATE_STREAM_STATE_OP;
+                }
+                break;
+
+            case FIRMWARE_UPDATE_STREAM_STATE_DONE:
+                // Trailing bytes
+            case FIRMWARE_UPDATE_STREAM_STATE_ERROR:
+            default:
+                return streamFail(stream);
+        }
+
+        if (stream->state == FIRMWARE_UPDATE_STREAM_STATE_OP && stream->outputSize && stream->outputPos == stream->outputSize) {
+            if (!streamFinish(stream)) {
+                return false;
+            }
+        }
+    }
+
+    return stream->state != FIRMWARE_UPDATE_STREAM_STATE_ERROR;
+}
+
+bool firmwareUpdateStreamIsComplete(const firmwareUpdateStream_t *stream)
+{
+    return stream->state == FIRMWARE_UPDATE_STREAM_STATE_DONE;
+}
+
+#endif
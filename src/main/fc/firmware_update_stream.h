@@ -0,0 +1,91 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software. You can redistribute this software
+ * and/or modify this software under the terms of the
+ * GNU General Public License as published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version.
+ *
+ * INAV is distributed in the hope that they will be
+ * useful, but WITHOUT ANY WARRANTY; without even the implied
+ * warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ * See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this software.
+ *
+ * If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Decoder for compressed and delta encoded firmware images, see
+ * docs/development/Firmware_Update_Streams.md for the format. The image is
+ * decoded as the stream arrives, in any split, using a fixed window of the
+ * latest output which also buffers the blocks handed to the storage.
+ */
+
+#define FIRMWARE_UPDATE_STREAM_MAGIC        0x53554649  // "IFUS"
+#define FIRMWARE_UPDATE_STREAM_VERSION      1
+#define FIRMWARE_UPDATE_STREAM_HEADER_SIZE  18
+#define FIRMWARE_UPDATE_STREAM_WINDOW_SIZE  1024        // power of two
+
+typedef enum {
+    FIRMWARE_UPDATE_STREAM_OP_LITERAL = 0,  // <length> bytes follow
+    FIRMWARE_UPDATE_STREAM_OP_WINDOW = 1,   // copy from the output, distance - 1 follows
+    FIRMWARE_UPDATE_STREAM_OP_BASE = 2,     // copy from the running firmware, zigzag cursor move follows
+} firmwareUpdateStreamOp_e;
+
+typedef enum {
+    FIRMWARE_UPDATE_STREAM_STATE_HEADER = 0,
+    FIRMWARE_UPDATE_STREAM_STATE_OP,
+    FIRMWARE_UPDATE_STREAM_STATE_ARGUMENT,
+    FIRMWARE_UPDATE_STREAM_STATE_LITERAL,
+    FIRMWARE_UPDATE_STREAM_STATE_DONE,
+    FIRMWARE_UPDATE_STREAM_STATE_ERROR,
+} firmwareUpdateStreamState_e;
+
+// Stores length bytes of the image, in blocks of the block size except
+// for the last one
+typedef bool (*firmwareUpdateStreamWriteFnPtr)(const uint8_t *data, uint32_t length);
+
+typedef struct firmwareUpdateStream_s {
+    firmwareUpdateStreamState_e state;
+    firmwareUpdateStreamWriteFnPtr writeFn;
+    uint16_t blockSize;
+
+    const uint8_t *base;            // running firmware
+    uint32_t baseLimit;             // readable size of the running firmware
+    uint32_t baseSize;              // size of the base the stream was made against
+    uint32_t baseCursor;
+
+    uint32_t expectedSize;          // image size announced when preparing the update
+    uint32_t outputSize;            // image size from the header
+    uint32_t outputPos;
+    uint32_t flushedPos;
+    uint16_t outputCrc;             // CRC16 CCITT of the image from the header
+    uint16_t calcCrc;
+
+    uint8_t header[FIRMWARE_UPDATE_STREAM_HEADER_SIZE];
+    uint8_t headerPos;
+
+    uint8_t op;
+    uint32_t length;
+    uint32_t varint;
+    uint8_t varintShift;
+
+    uint8_t window[FIRMWARE_UPDATE_STREAM_WINDOW_SIZE];
+} firmwareUpdateStream_t;
+
+// blockSize must divide FIRMWARE_UPDATE_STREAM_WINDOW_SIZE
+bool firmwareUpdateStreamInit(firmwareUpdateStream_t *stream, uint32_t expectedSize, const uint8_t *base, uint32_t baseLimit,
+                              uint16_t blockSize, firmwareUpdateStreamWriteFnPtr writeFn);
+// Returns false once the stream is found invalid or the storage fails
+bool firmwareUpdateStreamFeed(firmwareUpdateStream_t *stream, const uint8_t *data, uint32_t length);
+// True once the whole image has been decoded, stored and its CRC checked
+bool firmwareUpdateStreamIsComplete(const firmwareUpdateStream_t *stream);
@@ -228,21 +228,29 @@ pgn_t settingGetPgn(const setting_t *val)
 	return -1;
 }
 
-static uint16_t getValueOffset(const setting_t *value)
+static uint16_t getProfileValueOffset(const setting_t *value, uint8_t profileIndex)
 {
     switch (SETTING_SECTION(value)) {
     case MASTER_VALUE:
         return value->offset;
     case PROFILE_VALUE:
-        return value->offset + sizeof(pidProfile_t) * getConfigProfile();
+        return value->offset + sizeof(pidProfile_t) * profileIndex;
     case CONTROL_RATE_VALUE:
-        return value->offset + sizeof(controlRateConfig_t) * getConfigProfile();
+        return value->offset + sizeof(controlRateConfig_t) * profileIndex;
     case BATTERY_CONFIG_VALUE:
-        return value->offset + sizeof(batteryProfile_t) * getConfigBatteryProfile();
+        return value->offset + sizeof(batteryProfile_t) * profileIndex;
     }
     return 0;
 }
 
+static uint16_t getValueOffset(const setting_t *value)
+{
+    if (SETTING_SECTION(value) == BATTERY_CONFIG_VALUE) {
+        return getProfileValueOffset(value, getConfigBatteryProfile());
+    }
+    return getProfileValueOffset(value, getConfigProfile());
+}
+
 void *settingGetValuePointer(const setting_t *val)
 {
     const pgRegistry_t *pg = pgFind(settingGetPgn(val));
@@ -255,6 +263,18 @@ const void * settingGetCopyValuePointer(const setting_t *val)
     return pg->copy + getValueOffset(val);
 }
 
+const void * settingGetProfileValuePointer(const setting_t *val, uint8_t profileIndex)
+{
+    const pgRegistry_t *pg = pgFind(settingGetPgn(val));
+    return pg->address + getProfileValueOffset(val, profileIndex);
+}
+
+const void * settingGetProfileCopyValuePointer(const setting_t *val, uint8_t profileIndex)
+{
+    const pgRegistry_t *pg = pgFind(settingGetPgn(val));
+    return pg->copy + getProfileValueOffset(val, profileIndex);
+}
+
 setting_min_t settingGetMin(const setting_t *val)
 {
 	if (SETTING_MODE(val) == MODE_LOOKUP) {
@@ -97,6 +97,12 @@ void * settingGetValuePointer(const setting_t *val);
 // group for the value has been manually performed. Currently, this
 // is only used by cli.c during config dumps.
 const void * settingGetCopyValuePointer(const setting_t *val);
+// As settingGetValuePointer() and settingGetCopyValuePointer(), but for
+// the given profile instead of the active one. profileIndex is the
+// battery profile for BATTERY_CONFIG_VALUE settings and is ignored for
+// MASTER_VALUE ones.
+const void * settingGetProfileValuePointer(const setting_t *val, uint8_t profileIndex);
+const void * settingGetProfileCopyValuePointer(const setting_t *val, uint8_t profileIndex);
 // Returns the minimum valid value for the given setting_t. setting_min_t
 // depends on the target and build options, but will always be a signed
 // integer (e.g. intxx_t,)
@@ -1,8 +1,14 @@
 
+#include <string.h>
+
 #include "platform.h"
 
 #ifdef USE_STATS
 
+#include "common/axis.h"
+
+#include "config/config_eeprom.h"
+
 #include "fc/settings.h"
 #include "fc/stats.h"
 
@@ -32,6 +38,11 @@ PG_RESET_TEMPLATE(statsConfig_t, statsConfig,
 static uint32_t arm_millis;
 static uint32_t arm_distance_cm;
 
+static statsFlightRecord_t flight;      // Being flown, then waiting to be saved
+static bool flightPending;
+static statsFlightRecord_t lastFlight;
+static bool lastFlightValid;
+
 #ifdef USE_ADC
 static uint32_t arm_mWhDrawn;
 static uint32_t flyingEnergy; // energy drawn during flying up to last disarm (ARMED) mWh
@@ -41,6 +52,12 @@ uint32_t getFlyingEnergy() {
 }
 #endif
 
+// NULL until a flight is recorded or loaded
+const statsFlightRecord_t *statsGetLastFlight(void)
+{
+    return lastFlightValid ? &lastFlight : NULL;
+}
+
 void statsOnArm(void)
 {
     arm_millis      = millis();
@@ -48,6 +65,33 @@ void statsOnArm(void)
 #ifdef USE_ADC
     arm_mWhDrawn    = getMWhDrawn();
 #endif
+
+    memset(&flight, 0, sizeof(flight));
+    flight.maxAltitude = getEstimatedActualPosition(Z);
+    flight.minVoltage = UINT16_MAX;
+}
+
+// Runs from the AUX task while armed, tracks the extremes of the flight
+void statsUpdate(void)
+{
+    if (!statsConfig()->stats_enabled) {
+        return;
+    }
+
+    const int32_t altitude = getEstimatedActualPosition(Z);
+    if (altitude > flight.maxAltitude) {
+        flight.maxAltitude = altitude;
+    }
+
+    const int16_t amperage = getAmperage();
+    if (isAmperageConfigured() && amperage > flight.maxCurrent) {
+        flight.maxCurrent = amperage;
+    }
+
+    const uint16_t voltage = getBatteryVoltage();
+    if (isBatteryVoltageConfigured() && voltage && voltage < flight.minVoltage) {
+        flight.minVoltage = voltage;
+    }
 }
 
 void statsOnDisarm(void)
@@ -55,18 +99,64 @@ void statsOnDisarm(void)
     if (statsConfig()->stats_enabled) {
         uint32_t dt = (millis() - arm_millis) / 1000;
         if (dt >= MIN_FLIGHT_TIME_TO_RECORD_STATS_S) {
-            statsConfigMutable()->stats_total_time += dt;   //[s]
-            statsConfigMutable()->stats_total_dist += (getTotalTravelDistance() - arm_distance_cm) / 100;   //[m]
+            flight.flightTime = dt;   //[s]
+            flight.distance = (getTotalTravelDistance() - arm_distance_cm) / 100;   //[m]
 #ifdef USE_ADC
             if (feature(FEATURE_VBAT) && isAmperageConfigured()) {
-                const uint32_t energy = getMWhDrawn() - arm_mWhDrawn;
-                statsConfigMutable()->stats_total_energy += energy;
-                flyingEnergy += energy;
+                flight.energy = getMWhDrawn() - arm_mWhDrawn;
+                flyingEnergy += flight.energy;
             }
 #endif
-            saveConfigAndNotify();
+            if (flight.minVoltage == UINT16_MAX) {
+                flight.minVoltage = 0;
+            }
+
+            lastFlight = flight;
+            lastFlightValid = true;
+            flightPending = true;
         }
     }
 }
 
+static void statsAddToTotals(const statsFlightRecord_t *record)
+{
+    statsConfigMutable()->stats_total_time += record->flightTime;
+    statsConfigMutable()->stats_total_dist += record->distance;
+#ifdef USE_ADC
+    statsConfigMutable()->stats_total_energy += record->energy;
+#endif
+}
+
+static void statsLoadFlightRecord(const void *data, uint8_t size)
+{
+    if (size == sizeof(lastFlight)) {
+        memcpy(&lastFlight, data, sizeof(lastFlight));
+        lastFlightValid = true;
+        statsAddToTotals(&lastFlight);
+    }
+}
+
+// The totals are the ones in the config plus the flights recorded after it
+void statsLoadFlightRecords(void)
+{
+    readEEPROMLog(statsLoadFlightRecord);
+}
+
+// Runs while disarmed. Appending a record programs a few words where
+// saving the config erases a whole sector.
+void statsProcessDelayedSave(void)
+{
+    if (!flightPending) {
+        return;
+    }
+    flightPending = false;
+
+    statsAddToTotals(&flight);
+    if (!appendEEPROMLog(&flight, sizeof(flight))) {
+        // No room left, the config takes the totals and the records
+        // start over after it
+        saveConfigAndNotify();
+    }
+}
+
 #endif
@@ -11,13 +11,30 @@ typedef struct statsConfig_s {
     uint8_t  stats_enabled;
 } statsConfig_t;
 
+// Appended to the config storage after each flight
+typedef struct statsFlightRecord_s {
+    uint32_t flightTime;    // [s]
+    uint32_t distance;      // [m]
+    uint32_t energy;        // [mWh]
+    int32_t  maxAltitude;   // [cm]
+    uint16_t maxCurrent;    // [cA]
+    uint16_t minVoltage;    // [cV]
+} statsFlightRecord_t;
+
 uint32_t getFlyingEnergy(void);
+const statsFlightRecord_t *statsGetLastFlight(void);
 void statsOnArm(void);
+void statsUpdate(void);
 void statsOnDisarm(void);
+void statsLoadFlightRecords(void);
+void statsProcessDelayedSave(void);
 
 #else
 
-#define statsOnArm()    do {} while (0)
-#define statsOnDisarm() do {} while (0)
+#define statsOnArm()                do {} while (0)
+#define statsUpdate()               do {} while (0)
+#define statsOnDisarm()             do {} while (0)
+#define statsLoadFlightRecords()    do {} while (0)
+#define statsProcessDelayedSave()   do {} while (0)
 
 #endif
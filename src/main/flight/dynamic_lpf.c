@@ -22,29 +22,30 @@
  * along with this program. If not, see http://www.gnu.org/licenses/.
  */
 
+#include <stdbool.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
 #include "flight/dynamic_lpf.h"
 #include "sensors/gyro.h"
 #include "flight/mixer.h"
 #include "fc/rc_controls.h"
 #include "build/debug.h"
 
-static float dynLpfCutoffFreq(float throttle, uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo) {
-    const float expof = expo / 10.0f;
-    static float curve;
-    curve = throttle * (1 - throttle) * expof + throttle;
-    return (dynLpfMax - dynLpfMin) * curve + dynLpfMin;
-}
+static EXTENDED_FASTRAM dynLpfTable_t gyroDynLpfTable;
 
-void dynamicLpfGyroTask(void) {
-
-    if (!gyroConfig()->useDynamicLpf) {
-        return;
-    }
+void dynamicLpfGyroInit(uint32_t looptime) {
+    dynLpfTableInit(&gyroDynLpfTable, gyroConfig()->gyro_main_lpf_type, gyroConfig()->gyroDynamicLpfMinHz,
+                    gyroConfig()->gyroDynamicLpfMaxHz, gyroConfig()->gyroDynamicLpfCurveExpo, looptime);
+}
 
+void dynamicLpfGyroUpdate(filter_t *state) {
     const float throttle = scaleRangef((float) rcCommand[THROTTLE], getThrottleIdleValue(), motorConfig()->maxthrottle, 0.0f, 1.0f);
-    const float cutoffFreq = dynLpfCutoffFreq(throttle, gyroConfig()->gyroDynamicLpfMinHz, gyroConfig()->gyroDynamicLpfMaxHz, gyroConfig()->gyroDynamicLpfCurveExpo);
+    const uint8_t index = dynLpfTableIndex(throttle);
 
-    DEBUG_SET(DEBUG_DYNAMIC_GYRO_LPF, 0, cutoffFreq);
+    DEBUG_SET(DEBUG_DYNAMIC_GYRO_LPF, 0, gyroDynLpfTable.cutoffHz[index]);
 
-    gyroUpdateDynamicLpf(cutoffFreq);
-}
\ No newline at end of file
+    dynLpfTableApply(&gyroDynLpfTable, index, state);
+}
@@ -26,4 +26,8 @@
 
 #include <stdint.h>
 
-void dynamicLpfGyroTask(void);
+#include "common/filter.h"
+#include "flight/dynamic_lpf_table.h"
+
+void dynamicLpfGyroInit(uint32_t looptime);
+void dynamicLpfGyroUpdate(filter_t *state);
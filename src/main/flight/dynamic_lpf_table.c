@@ -0,0 +1,95 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+#include "common/maths.h"
+#include "common/time.h"
+
+#include "flight/dynamic_lpf_table.h"
+
+static float dynLpfCutoffFreq(float throttle, uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo) {
+    const float expof = expo / 10.0f;
+    static float curve;
+    curve = throttle * (1 - throttle) * expof + throttle;
+    return (dynLpfMax - dynLpfMin) * curve + dynLpfMin;
+}
+
+void dynLpfTableInit(dynLpfTable_t *table, uint8_t filterType, uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo, uint32_t looptime) {
+    filter_t filter;
+
+    table->filterType = filterType;
+    table->index = UINT8_MAX;
+
+    for (int i = 0; i <= DYN_LPF_TABLE_STEPS; i++) {
+        const float cutoffFreq = dynLpfCutoffFreq((float)i / DYN_LPF_TABLE_STEPS, dynLpfMin, dynLpfMax, expo);
+        float *coefficients = table->coefficients[i];
+
+        table->cutoffHz[i] = lrintf(cutoffFreq);
+
+        // Same coefficients gyroUpdateDynamicLpf() computed on every update
+        if (filterType == FILTER_PT1) {
+            pt1FilterInit(&filter.pt1, cutoffFreq, US2S(looptime));
+            coefficients[0] = filter.pt1.alpha;
+        } else if (filterType == FILTER_BIQUAD) {
+            biquadFilterInit(&filter.biquad, cutoffFreq, looptime, BIQUAD_Q, FILTER_LPF);
+            coefficients[0] = filter.biquad.b0;
+            coefficients[1] = filter.biquad.b1;
+            coefficients[2] = filter.biquad.b2;
+            coefficients[3] = filter.biquad.a1;
+            coefficients[4] = filter.biquad.a2;
+        }
+    }
+}
+
+uint8_t dynLpfTableIndex(float throttle) {
+    return lrintf(constrainf(throttle, 0.0f, 1.0f) * DYN_LPF_TABLE_STEPS);
+}
+
+void dynLpfTableApply(dynLpfTable_t *table, uint8_t index, filter_t *state) {
+    if (index == table->index) {
+        return;
+    }
+    table->index = index;
+
+    const float *coefficients = table->coefficients[index];
+    if (table->filterType == FILTER_PT1) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            state[axis].pt1.alpha = coefficients[0];
+        }
+    } else if (table->filterType == FILTER_BIQUAD) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            state[axis].biquad.b0 = coefficients[0];
+            state[axis].biquad.b1 = coefficients[1];
+            state[axis].biquad.b2 = coefficients[2];
+            state[axis].biquad.a1 = coefficients[3];
+            state[axis].biquad.a2 = coefficients[4];
+        }
+    }
+}
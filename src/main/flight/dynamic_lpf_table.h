@@ -0,0 +1,48 @@
+/*
+ * This file is part of INAV Project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this file,
+ * You can obtain one at http://mozilla.org/MPL/2.0/.
+ *
+ * Alternatively, the contents of this file may be used under the terms
+ * of the GNU General Public License Version 3, as described below:
+ *
+ * This file is free software: you may copy, redistribute and/or modify
+ * it under the terms of the GNU General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * This file is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General
+ * Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see http://www.gnu.org/licenses/.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#include "common/filter.h"
+
+#define DYN_LPF_TABLE_STEPS 64
+
+/*
+ * Filter coefficients for the throttle range quantised to
+ * DYN_LPF_TABLE_STEPS steps, computed once so the dynamic LPF can follow
+ * the throttle on every gyro filter loop without any trig.
+ */
+typedef struct dynLpfTable_s {
+    uint8_t filterType;
+    uint8_t index;                                          // last applied step
+    uint16_t cutoffHz[DYN_LPF_TABLE_STEPS + 1];
+    float coefficients[DYN_LPF_TABLE_STEPS + 1][5];         // biquad b0 b1 b2 a1 a2 or pt1 alpha
+} dynLpfTable_t;
+
+void dynLpfTableInit(dynLpfTable_t *table, uint8_t filterType, uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo, uint32_t looptime);
+uint8_t dynLpfTableIndex(float throttle);
+// Sets the coefficients of step index on the filters of all three axes
+void dynLpfTableApply(dynLpfTable_t *table, uint8_t index, filter_t *state);
@@ -21,98 +21,110 @@
 #ifdef USE_GYRO_KALMAN
 
 #include <string.h>
-#if !defined(SITL_BUILD)
-#include "arm_math.h"
-#else
 #include <math.h>
+#ifdef USE_ARM_MATH
+#include "arm_math.h"
 #endif
 
 #include "kalman.h"
 #include "build/debug.h"
 
-kalman_t kalmanFilterStateRate[XYZ_AXIS_COUNT];
-
-static void gyroKalmanInitAxis(kalman_t *filter, uint16_t q)
-{
-    memset(filter, 0, sizeof(kalman_t));
-    filter->q = q * 0.03f; //add multiplier to make tuning easier
-    filter->r = 88.0f;      //seeding R at 88.0f
-    filter->p = 30.0f;      //seeding P at 30.0f
-    filter->e = 1.0f;
-    filter->w = MAX_KALMAN_WINDOW_SIZE;         
-    filter->inverseN = 1.0f / (float)(filter->w);
-}
+kalman_t kalmanFilterStateRate;
 
 void gyroKalmanInitialize(uint16_t q)
 {
-    gyroKalmanInitAxis(&kalmanFilterStateRate[X], q);
-    gyroKalmanInitAxis(&kalmanFilterStateRate[Y], q);
-    gyroKalmanInitAxis(&kalmanFilterStateRate[Z], q);
-}
+    memset(&kalmanFilterStateRate, 0, sizeof(kalmanFilterStateRate));
+    kalmanFilterStateRate.q = q * 0.03f; //add multiplier to make tuning easier
 
-float kalman_process(kalman_t *kalmanState, float input)
-{
-    //project the state ahead using acceleration
-    kalmanState->x += (kalmanState->x - kalmanState->lastX);
-
-    //update last state
-    kalmanState->lastX = kalmanState->x;
-
-    if (kalmanState->lastX != 0.0f)
-    {
-        kalmanState->e = fabsf(1.0f - (kalmanState->setpoint / kalmanState->lastX));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        kalmanFilterStateRate.p[axis] = 30.0f;    //seeding P at 30.0f
+        kalmanFilterStateRate.eNum[axis] = 1.0f;  //seeding e at 1.0f
+        kalmanFilterStateRate.eDen[axis] = 1.0f;
     }
-
-    //prediction update
-    kalmanState->p = kalmanState->p + (kalmanState->q * kalmanState->e);
-
-    //measurement update
-    kalmanState->k = kalmanState->p / (kalmanState->p + kalmanState->r);
-    kalmanState->x += kalmanState->k * (input - kalmanState->x);
-    kalmanState->p = (1.0f - kalmanState->k) * kalmanState->p;
-    return kalmanState->x;
 }
 
-static void updateAxisVariance(kalman_t *kalmanState, float rate)
+static float updateAxisVariance(kalman_t *kalmanState, float *window, float *varianceWindow, int axis, float rate)
 {
-    kalmanState->axisWindow[kalmanState->windex] = rate;
+    // The oldest sample and variance element leave the sums as the new ones take their slot
+    const float oldRate = window[axis];
+    const float oldVarianceElement = varianceWindow[axis];
 
-    kalmanState->axisSumMean += kalmanState->axisWindow[kalmanState->windex];
-    float varianceElement = kalmanState->axisWindow[kalmanState->windex] - kalmanState->axisMean;
+    float axisSumMean = kalmanState->axisSumMean[axis] + rate;
+    float varianceElement = rate - kalmanState->axisMean[axis];
     varianceElement = varianceElement * varianceElement;
-    kalmanState->axisSumVar += varianceElement;
-    kalmanState->varianceWindow[kalmanState->windex] = varianceElement;
+    float axisSumVar = kalmanState->axisSumVar[axis] + varianceElement;
 
-    kalmanState->windex++;
-    if (kalmanState->windex > kalmanState->w) {
-        kalmanState->windex = 0;
-    }
+    window[axis] = rate;
+    varianceWindow[axis] = varianceElement;
 
-    kalmanState->axisSumMean -= kalmanState->axisWindow[kalmanState->windex];
-    kalmanState->axisSumVar -= kalmanState->varianceWindow[kalmanState->windex];
+    axisSumMean -= oldRate;
+    axisSumVar -= oldVarianceElement;
+    kalmanState->axisSumMean[axis] = axisSumMean;
+    kalmanState->axisSumVar[axis] = axisSumVar;
 
     //New mean
-    kalmanState->axisMean = kalmanState->axisSumMean * kalmanState->inverseN;
-    kalmanState->axisVar = kalmanState->axisSumVar * kalmanState->inverseN;
+    kalmanState->axisMean[axis] = axisSumMean * (1.0f / MAX_KALMAN_WINDOW_SIZE);
+    const float axisVar = axisSumVar * (1.0f / MAX_KALMAN_WINDOW_SIZE);
 
-#if !defined(SITL_BUILD)
+#ifdef USE_ARM_MATH
     float squirt;
-    arm_sqrt_f32(kalmanState->axisVar, &squirt);
+    arm_sqrt_f32(axisVar, &squirt);
 #else
-    float squirt = sqrtf(kalmanState->axisVar);
+    // Rounding can leave the sum slightly negative, arm_sqrt_f32() returns 0 then
+    float squirt = axisVar > 0.0f ? sqrtf(axisVar) : 0.0f;
 #endif
-    
-    kalmanState->r = squirt * VARIANCE_SCALE;
+
+    return squirt * VARIANCE_SCALE;
 }
 
-float NOINLINE gyroKalmanUpdate(uint8_t axis, float input)
+static float kalmanProcess(kalman_t *kalmanState, int axis, float input, float r)
 {
-    updateAxisVariance(&kalmanFilterStateRate[axis], input);
-    return kalman_process(&kalmanFilterStateRate[axis], input);
+    //project the state ahead using acceleration
+    float x = kalmanState->x[axis];
+    x += (x - kalmanState->lastX[axis]);
+
+    //update last state
+    kalmanState->lastX[axis] = x;
+
+    // e = |1 - setpoint / lastX|, as a fraction
+    if (x != 0.0f) {
+        kalmanState->eNum[axis] = fabsf(x - kalmanState->setpoint[axis]);
+        kalmanState->eDen[axis] = fabsf(x);
+    }
+    const float eNum = kalmanState->eNum[axis];
+    const float eDen = kalmanState->eDen[axis];
+
+    /*
+     * Prediction update p' = p + q * e and measurement update
+     * k = p' / (p' + r), p = (1 - k) * p'. Scaling p' by eDen turns both
+     * divides into one, and (1 - k) * p' simplifies to k * r.
+     */
+    const float num = kalmanState->p[axis] * eDen + kalmanState->q * eNum;
+    const float k = num / (num + r * eDen);
+
+    x += k * (input - x);
+    kalmanState->x[axis] = x;
+    kalmanState->p[axis] = k * r;
+    return x;
+}
+
+void NOINLINE gyroKalmanUpdate(float *gyroADCf)
+{
+    kalman_t *kalmanState = &kalmanFilterStateRate;
+    float *window = kalmanState->axisWindow[kalmanState->windex];
+    float *varianceWindow = kalmanState->varianceWindow[kalmanState->windex];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        const float input = gyroADCf[axis];
+        const float r = updateAxisVariance(kalmanState, window, varianceWindow, axis, input);
+        gyroADCf[axis] = kalmanProcess(kalmanState, axis, input, r);
+    }
+
+    kalmanState->windex = (kalmanState->windex + 1) & (MAX_KALMAN_WINDOW_SIZE - 1);
 }
 
 void gyroKalmanUpdateSetpoint(uint8_t axis, float setpoint) {
-    kalmanFilterStateRate[axis].setpoint = setpoint;
+    kalmanFilterStateRate.setpoint[axis] = setpoint;
 }
 
 #endif
\ No newline at end of file
@@ -23,33 +23,30 @@
 #include "sensors/gyro.h"
 #include "common/filter.h"
 
-#define MAX_KALMAN_WINDOW_SIZE 64
+#define MAX_KALMAN_WINDOW_SIZE 64    // power of two
 
 #define VARIANCE_SCALE 0.67f
 
+// State of all three axes, laid out axis by axis so one pass updates them all
 typedef struct kalman
 {
-    float q;     //process noise covariance
-    float r;     //measurement noise covariance
-    float p;     //estimation error covariance matrix
-    float k;     //kalman gain
-    float x;     //state
-    float lastX; //previous state
-    float e;
-
-    float setpoint;
-    
-    float axisVar;
-    uint16_t windex;
-    float axisWindow[MAX_KALMAN_WINDOW_SIZE + 1];
-    float varianceWindow[MAX_KALMAN_WINDOW_SIZE + 1];
-    float axisSumMean;
-    float axisMean;
-    float axisSumVar;
-    float inverseN;
-    uint16_t w;
+    float q;                            //process noise covariance, same for all axes
+    float p[XYZ_AXIS_COUNT];            //estimation error covariance matrix
+    float x[XYZ_AXIS_COUNT];            //state
+    float lastX[XYZ_AXIS_COUNT];        //previous state
+    float eNum[XYZ_AXIS_COUNT];         //error ratio e = eNum / eDen, kept as a fraction so it needs no divide
+    float eDen[XYZ_AXIS_COUNT];
+
+    float setpoint[XYZ_AXIS_COUNT];
+
+    uint8_t windex;
+    float axisSumMean[XYZ_AXIS_COUNT];
+    float axisMean[XYZ_AXIS_COUNT];
+    float axisSumVar[XYZ_AXIS_COUNT];
+    float axisWindow[MAX_KALMAN_WINDOW_SIZE][XYZ_AXIS_COUNT];
+    float varianceWindow[MAX_KALMAN_WINDOW_SIZE][XYZ_AXIS_COUNT];
 } kalman_t;
 
 void gyroKalmanInitialize(uint16_t q);
-float gyroKalmanUpdate(uint8_t axis, float input);
-void gyroKalmanUpdateSetpoint(uint8_t axis, float setpoint);
\ No newline at end of file
+void gyroKalmanUpdate(float *gyroADCf);
+void gyroKalmanUpdateSetpoint(uint8_t axis, float setpoint);
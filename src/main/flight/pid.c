@@ -104,11 +104,12 @@ typedef struct {
     bool itermFreezeActive;
 
     pt3Filter_t rateTargetFilter;
-
-    smithPredictor_t smithPredictor;
 } pidState_t;
 
 STATIC_FASTRAM bool pidFiltersConfigured = false;
+#ifdef USE_SMITH_PREDICTOR
+static EXTENDED_FASTRAM smithPredictor_t smithPredictor;
+#endif
 static EXTENDED_FASTRAM float headingHoldCosZLimit;
 static EXTENDED_FASTRAM int16_t headingHoldTarget;
 static EXTENDED_FASTRAM pt1Filter_t headingHoldRateFilter;
@@ -339,21 +340,7 @@ bool pidInitFilters(void)
 
 #ifdef USE_SMITH_PREDICTOR
     smithPredictorInit(
-        &pidState[FD_ROLL].smithPredictor,
-        pidProfile()->smithPredictorDelay,
-        pidProfile()->smithPredictorStrength,
-        pidProfile()->smithPredictorFilterHz,
-        getLooptime()
-    );
-    smithPredictorInit(
-        &pidState[FD_PITCH].smithPredictor,
-        pidProfile()->smithPredictorDelay,
-        pidProfile()->smithPredictorStrength,
-        pidProfile()->smithPredictorFilterHz,
-        getLooptime()
-    );
-    smithPredictorInit(
-        &pidState[FD_YAW].smithPredictor,
+        &smithPredictor,
         pidProfile()->smithPredictorDelay,
         pidProfile()->smithPredictorStrength,
         pidProfile()->smithPredictorFilterHz,
@@ -374,6 +361,15 @@ void pidResetTPAFilter(void)
     }
 }
 
+#ifdef USE_SMITH_PREDICTOR
+// Overrides smith_predictor_delay until the filters are initialised again,
+// e.g. with the motor response latency measured in flight
+void pidSetSmithPredictorDelay(float delayMs)
+{
+    smithPredictorSetDelay(&smithPredictor, delayMs);
+}
+#endif
+
 void pidResetErrorAccumulators(void)
 {
     // Reset R/P/Y integrator
@@ -1102,11 +1098,15 @@ void FAST_CODE pidController(float dT)
 #ifdef USE_GYRO_KALMAN
         gyroKalmanUpdateSetpoint(axis, pidState[axis].rateTarget);
 #endif
+    }
 
 #ifdef USE_SMITH_PREDICTOR
-        pidState[axis].gyroRate = applySmithPredictor(axis, &pidState[axis].smithPredictor, pidState[axis].gyroRate);
-#endif
+    float gyroRates[XYZ_AXIS_COUNT] = { pidState[FD_ROLL].gyroRate, pidState[FD_PITCH].gyroRate, pidState[FD_YAW].gyroRate };
+    applySmithPredictor(&smithPredictor, gyroRates);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pidState[axis].gyroRate = gyroRates[axis];
     }
+#endif
 
     // Step 3: Run control for ANGLE_MODE, HORIZON_MODE, and HEADING_LOCK
     const float horizonRateMagnitude = calcHorizonRateMagnitude();
@@ -194,6 +194,9 @@ void pidReduceErrorAccumulators(int8_t delta, uint8_t axis);
 float getAxisIterm(uint8_t axis);
 float getTotalRateTarget(void);
 void pidResetTPAFilter(void);
+#ifdef USE_SMITH_PREDICTOR
+void pidSetSmithPredictorDelay(float delayMs);
+#endif
 
 struct controlRateConfig_s;
 struct motorConfig_s;
@@ -0,0 +1,104 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "flight/servo_mixer_rules.h"
+#include "flight/servos.h"
+
+#include "programming/logic_condition.h"
+
+void servoMixerRulesCompile(servoMixerRuleList_t *list, const servoMixer_t *rules)
+{
+    memset(list, 0, sizeof(*list));
+    list->minTarget = 255;
+
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        const servoMixer_t *rule = &rules[i];
+
+        if (rule->rate == 0) {  // Finished loading all rules
+            break;
+        }
+
+        list->configuredCount++;
+        list->minTarget = MIN(list->minTarget, rule->targetChannel);
+        list->maxTarget = MAX(list->maxTarget, rule->targetChannel);
+
+        // Rules set over MSP aren't range checked, leave out the ones that
+        // would mix from or into nothing
+        if (rule->inputSource >= INPUT_SOURCE_COUNT || rule->targetChannel >= MAX_SUPPORTED_SERVOS) {
+            continue;
+        }
+
+        servoMixerRule_t *compiled = &list->rules[list->ruleCount++];
+        compiled->target = rule->targetChannel;
+        compiled->source = rule->inputSource;
+        compiled->rate = rule->rate;
+        compiled->conditionId = -1;
+
+        // 0 = no limiting
+        // 1 = 10us/s -> full servo sweep (from 1000 to 2000) takes 100s
+        // 10 = 100us/s -> full sweep takes 10s
+        compiled->speedLimit = rule->speed * 10;
+        if (rule->speed) {
+            compiled->flags |= SERVO_MIXER_RULE_SPEED_LIMIT;
+        }
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        compiled->conditionId = rule->conditionId;
+        if (rule->conditionId >= 0) {
+            compiled->flags |= SERVO_MIXER_RULE_CONDITION;
+        }
+#endif
+
+        list->inputs |= SERVO_MIXER_INPUT_BIT(rule->inputSource);
+        if (rule->inputSource == INPUT_STABILIZED_THROTTLE || rule->inputSource == INPUT_RC_THROTTLE) {
+            list->throttleTargets |= 1 << rule->targetChannel;
+        }
+    }
+}
+
+void servoMixerRulesApply(const servoMixerRuleList_t *list, const int16_t *input, rateLimitFilter_t *speedLimitFilters, float dT, int16_t *servoOutput)
+{
+    for (int i = 0; i < list->ruleCount; i++) {
+        const servoMixerRule_t *rule = &list->rules[i];
+
+#ifdef USE_PROGRAMMING_FRAMEWORK
+        // Skip rule if its condition is not true
+        if ((rule->flags & SERVO_MIXER_RULE_CONDITION) && !logicConditionGetValue(rule->conditionId)) {
+            continue;
+        }
+#endif
+
+        int16_t inputLimited = input[rule->source];
+        if (rule->flags & SERVO_MIXER_RULE_SPEED_LIMIT) {
+            inputLimited = (int16_t)rateLimitFilterApply4(&speedLimitFilters[i], inputLimited, rule->speedLimit, dT);
+        } else {
+            // Follow the input, so a speed limit set later starts from it
+            speedLimitFilters[i].state = inputLimited;
+        }
+
+        servoOutput[rule->target] += ((int32_t)inputLimited * rule->rate) / 100;
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/filter.h"
+
+#include "flight/servos.h"
+
+/*
+ * Servo mixer rules compiled into a dense list whenever the mix changes,
+ * together with the set of input sources the rules read. servoMixer() only
+ * computes those inputs, and the per rule speed limit and logic condition
+ * are only evaluated for rules that have them.
+ */
+
+typedef uint64_t servoMixerInputMask_t;
+
+#define SERVO_MIXER_INPUT_BIT(source)       ((servoMixerInputMask_t)1 << (source))
+
+#define SERVO_MIXER_RULE_SPEED_LIMIT        (1 << 0)    // speed limited, see rateLimitFilterApply4()
+#define SERVO_MIXER_RULE_CONDITION          (1 << 1)    // only applied while its logic condition is true
+
+typedef struct servoMixerRule_s {
+    uint8_t target;                 // servo
+    uint8_t source;                 // inputSource_e
+    uint8_t flags;                  // SERVO_MIXER_RULE_*
+    int8_t conditionId;
+    int16_t rate;
+    uint16_t speedLimit;            // us/s
+} servoMixerRule_t;
+
+typedef struct servoMixerRuleList_s {
+    uint8_t ruleCount;
+    uint8_t configuredCount;        // rules in the configuration, up to the first one with rate 0
+    uint8_t minTarget;
+    uint8_t maxTarget;
+    servoMixerInputMask_t inputs;   // input sources read by the rules
+    uint16_t throttleTargets;       // servos mixing a throttle input, held at mincommand while disarmed
+    servoMixerRule_t rules[MAX_SERVO_RULES];
+} servoMixerRuleList_t;
+
+// Compiles the configured rules, which end at the first rule with rate 0
+void servoMixerRulesCompile(servoMixerRuleList_t *list, const servoMixer_t *rules);
+
+// Adds the output of every active rule to servoOutput[]. input[] only has
+// to hold the sources in list->inputs. speedLimitFilters[] holds one filter
+// per rule of the list.
+void servoMixerRulesApply(const servoMixerRuleList_t *list, const int16_t *input, rateLimitFilter_t *speedLimitFilters, float dT, int16_t *servoOutput);
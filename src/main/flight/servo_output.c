@@ -0,0 +1,78 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "flight/servo_output.h"
+
+void servoOutputStageInit(servoOutputStage_t *stage, uint8_t phase, uint32_t looptimeUs, uint16_t updateHz, uint16_t lpfHz, uint16_t slewRate, int16_t initial)
+{
+    memset(stage, 0, sizeof(*stage));
+
+    // Never slower than asked for
+    uint32_t divider = 1;
+    if (updateHz > 0 && looptimeUs > 0) {
+        divider = constrain(1000000 / ((uint32_t)updateHz * looptimeUs), 1, SERVO_OUTPUT_MAX_DIVIDER);
+    }
+    const uint32_t updateIntervalUs = looptimeUs * divider;
+
+    stage->divider = divider;
+    stage->countdown = 1 + phase % divider;
+    stage->output = initial;
+
+    if (lpfHz > 0) {
+        // Keep the cutoff below the Nyquist frequency of the update rate
+        const uint32_t maxCutoffHz = MAX(1000000 / (2 * updateIntervalUs), 2U) - 1;
+        stage->filterEnabled = true;
+        biquadFilterInitLPF(&stage->filter, MIN((uint32_t)lpfHz, maxCutoffHz), updateIntervalUs);
+        biquadFilterReset(&stage->filter, initial);
+    }
+
+    if (slewRate > 0) {
+        stage->slewPerUpdate = MAX((uint32_t)slewRate * updateIntervalUs / 1000000, 1U);
+    }
+}
+
+bool servoOutputStageUpdate(servoOutputStage_t *stage, int16_t input, int16_t min, int16_t max)
+{
+    if (stage->countdown > 1) {
+        stage->countdown--;
+        return false;
+    }
+    stage->countdown = stage->divider;
+
+    int16_t output = input;
+    if (stage->filterEnabled) {
+        output = (int16_t)lrintf(biquadFilterApply(&stage->filter, (float)input));
+    }
+
+    if (stage->slewPerUpdate) {
+        output = constrain(output, stage->output - stage->slewPerUpdate, stage->output + stage->slewPerUpdate);
+    }
+
+    // Constrain position to prevent physical damage
+    stage->output = constrain(output, min, max);
+    return true;
+}
@@ -0,0 +1,49 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/filter.h"
+
+/*
+ * Output stage of one servo: low pass filter, slew limit and the travel
+ * limits, run at the rate the servo can follow. A servo updated at 50Hz
+ * from a 1kHz loop is only filtered and written on one loop out of 20.
+ * Servos with the same rate are spread over the loops by their phase.
+ */
+
+#define SERVO_OUTPUT_MAX_DIVIDER    255
+
+typedef struct servoOutputStage_s {
+    biquadFilter_t filter;
+    bool filterEnabled;
+    uint8_t divider;                // updated every divider loops
+    uint8_t countdown;              // loops until the next update
+    uint16_t slewPerUpdate;         // us, 0 = no limit
+    int16_t output;                 // last value written
+} servoOutputStage_t;
+
+// updateHz 0 updates on every loop, lpfHz 0 disables the filter and
+// slewRate (us/s) 0 disables the slew limit
+void servoOutputStageInit(servoOutputStage_t *stage, uint8_t phase, uint32_t looptimeUs, uint16_t updateHz, uint16_t lpfHz, uint16_t slewRate, int16_t initial);
+
+// Returns true, with the new value in stage->output, on the loops the servo
+// is due. On other loops stage->output keeps the value last written.
+bool servoOutputStageUpdate(servoOutputStage_t *stage, int16_t input, int16_t min, int16_t max);
@@ -51,6 +51,8 @@
 #include "flight/mixer.h"
 #include "flight/mixer_tricopter.h"
 #include "flight/pid.h"
+#include "flight/servo_mixer_rules.h"
+#include "flight/servo_output.h"
 #include "flight/servos.h"
 
 #include "io/gps.h"
@@ -88,7 +90,7 @@ void pgResetFn_customServoMixers(servoMixer_t *instance)
     }
 }
 
-PG_REGISTER_ARRAY_WITH_RESET_FN(servoParam_t, MAX_SUPPORTED_SERVOS, servoParams, PG_SERVO_PARAMS, 3);
+PG_REGISTER_ARRAY_WITH_RESET_FN(servoParam_t, MAX_SUPPORTED_SERVOS, servoParams, PG_SERVO_PARAMS, 4);
 
 void pgResetFn_servoParams(servoParam_t *instance)
 {
@@ -97,23 +99,23 @@ void pgResetFn_servoParams(servoParam_t *instance)
             .min = DEFAULT_SERVO_MIN,
             .max = DEFAULT_SERVO_MAX,
             .middle = DEFAULT_SERVO_MIDDLE,
-            .rate = 100
+            .rate = 100,
+            .updateRate = 0,
+            .lpfHz = 0,
+            .slewRate = 0
         );        
     }
 }
 
 int16_t servo[MAX_SUPPORTED_SERVOS];
 
-static uint8_t servoRuleCount = 0;
-static servoMixer_t currentServoMixer[MAX_SERVO_RULES];
+static servoMixerRuleList_t currentServoMixer;
+static servoMixerInputMask_t servoMixerInputs;
 static bool servoOutputEnabled;
 
 static bool mixerUsesServos;
-static uint8_t minServoIndex;
-static uint8_t maxServoIndex;
 
-static biquadFilter_t servoFilter[MAX_SUPPORTED_SERVOS];
-static bool servoFilterIsSet;
+static servoOutputStage_t servoOutputStage[MAX_SUPPORTED_SERVOS];
 
 static servoMetadata_t servoMetadata[MAX_SUPPORTED_SERVOS];
 static rateLimitFilter_t servoSpeedLimitFilter[MAX_SERVO_RULES];
@@ -141,13 +143,15 @@ void servosInit(void)
     loadCustomServoMixer();
 
     // If servo rules exist, enable servo mixer
-    if (servoRuleCount > 0) {
+    if (currentServoMixer.configuredCount > 0) {
         servoOutputEnabled = true;
         mixerUsesServos = true;
     }
 
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++)
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
         servoComputeScalingFactors(i);
+        servoInitOutputStage(i);
+    }
 
     if (feature(FEATURE_TRIFLIGHT) && (mixerConfig()->platformType == PLATFORM_TRICOPTER))
         triMixerInit(servoParamsMutable(SERVO_TRICOPTER_TAIL), &servo[SERVO_TRICOPTER_TAIL]);
@@ -155,63 +159,51 @@ void servosInit(void)
 
 int getServoCount(void)
 {
-    return (servoRuleCount ? (1 + maxServoIndex - minServoIndex) : 0);
+    return (currentServoMixer.configuredCount ? (1 + currentServoMixer.maxTarget - currentServoMixer.minTarget) : 0);
 }
 
 void loadCustomServoMixer(void)
 {
-    // Purge current servo mixer
-    servoRuleCount = 0;
-    minServoIndex = 255;
-    maxServoIndex = 0;
-    memset(currentServoMixer, 0, sizeof(currentServoMixer));
-
-    // Load custom mixer into currentServoMixer
-    for (int i = 0; i < MAX_SERVO_RULES; i++) {
-
-        if (customServoMixers(i)->rate == 0)  // Finished loading all rules
-            break;
-
-        if (customServoMixers(i)->targetChannel < minServoIndex)
-            minServoIndex = customServoMixers(i)->targetChannel;
+    servoMixerRulesCompile(&currentServoMixer, customServoMixers(0));
 
-        if (customServoMixers(i)->targetChannel > maxServoIndex)
-            maxServoIndex = customServoMixers(i)->targetChannel;
+    servoMixerInputs = currentServoMixer.inputs;
+#ifdef USE_SIMULATOR
+    // Sent to the simulator whether the mix uses them or not
+    servoMixerInputs |= SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH) |
+                        SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_THROTTLE);
+#endif
+}
 
-        memcpy(&currentServoMixer[i], customServoMixers(i), sizeof(servoMixer_t));
-        servoRuleCount++;
-    }
+// Sets up the rate, filter and slew limit of the servo output, again
+// whenever its servoParams change
+void servoInitOutputStage(uint8_t servoIndex)
+{
+    // NOTE: Servos are calculated at gyro looptime rate, the output stage
+    // divides that down to the rate of the servo
+    const servoParam_t *params = servoParams(servoIndex);
+    const uint16_t lpfHz = params->lpfHz ? params->lpfHz : servoConfig()->servo_lowpass_freq;
+    servoOutputStageInit(&servoOutputStage[servoIndex], servoIndex, getLooptime(), params->updateRate, lpfHz, params->slewRate,
+                         constrain(servo[servoIndex], params->min, params->max));
 }
 
-static void filterServos(void)
+void writeServos(void)
 {
-    if (servoConfig()->servo_lowpass_freq) {
-
-        // Initialize servo lowpass filters
-        // NOTE: Servos are calculated at gyro looptime rate
-        // TODO: Move this into an init function?
-        if (!servoFilterIsSet) {
-            for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
-                biquadFilterInitLPF(&servoFilter[i], servoConfig()->servo_lowpass_freq, getLooptime());
-                biquadFilterReset(&servoFilter[i], servo[i]);
-            }
-            servoFilterIsSet = true;
+    uint16_t dueServos = 0;
+    int dueServoCount = 0;
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        if (servoOutputStageUpdate(&servoOutputStage[i], servo[i], servoParams(i)->min, servoParams(i)->max)) {
+            dueServos |= 1 << i;
+            dueServoCount++;
         }
-
-        // Apply filters
-        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++)
-            servo[i] = (int16_t)lrintf(biquadFilterApply(&servoFilter[i], (float)servo[i]));
+        // Servos not due this loop hold the value last written
+        servo[i] = servoOutputStage[i].output;
     }
 
-    // Constrain servo positions to prevent physical damage
-    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++)
-        servo[i] = constrain(servo[i], servoParams(i)->min, servoParams(i)->max);
-}
+    DEBUG_SET(DEBUG_SERVO_OUTPUT, 0, dueServoCount);
+    for (int i = 0; i < 7; i++) {
+        DEBUG_SET(DEBUG_SERVO_OUTPUT, i + 1, servo[i]);
+    }
 
-void writeServos(void)
-{
-    filterServos();
-    
 #if !defined(SITL_BUILD)
     int servoIndex = 0;
     bool disableTricopterServo = false;
@@ -222,86 +214,96 @@ void writeServos(void)
         disableTricopterServo = true;
     }
 
-    for (int i = minServoIndex; i <= maxServoIndex; i++) {
+    for (int i = currentServoMixer.minTarget; i <= currentServoMixer.maxTarget; i++, servoIndex++) {
+        if (!(dueServos & (1 << i)))
+            continue;
         if (disableTricopterServo && (i == SERVO_TRICOPTER_TAIL))
-            pwmWriteServo(servoIndex++, servoParams(i)->middle);
+            pwmWriteServo(servoIndex, servoParams(i)->middle);
         else
-            pwmWriteServo(servoIndex++, servo[i]);
+            pwmWriteServo(servoIndex, servo[i]);
     }
 #endif
 }
 
-void servoMixer(float dT)
-{
-    int16_t input[INPUT_SOURCE_COUNT];  // Range [-500, 500]
+#define SERVO_MIXER_STABILIZED_INPUTS ( \
+    SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW) | \
+    SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL_PLUS) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL_MINUS) | \
+    SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH_PLUS) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH_MINUS) | \
+    SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW_PLUS) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW_MINUS))
+
+#define SERVO_MIXER_GIMBAL_INPUTS (SERVO_MIXER_INPUT_BIT(INPUT_GIMBAL_PITCH) | SERVO_MIXER_INPUT_BIT(INPUT_GIMBAL_ROLL))
 
-    if (FLIGHT_MODE(MANUAL_MODE)) {
-        input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
-        input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
-        input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
-    } else {  // Assisted modes (gyro only or gyro+acc according to AUX configuration in GUI)
-        input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
-        input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
-        input[INPUT_STABILIZED_YAW] = axisPID[YAW];
-
-        // Reverse yaw when inverted in 3D mode (only for multirotor and tricopter)
-        if (feature(FEATURE_REVERSIBLE_MOTORS) && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE) &&
-        (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER)) {
-            input[INPUT_STABILIZED_YAW] *= -1;
+// Computes the input sources in inputs, the others are left unset
+static void servoMixerComputeInputs(int16_t *input, servoMixerInputMask_t inputs)
+{
+    if (inputs & SERVO_MIXER_STABILIZED_INPUTS) {
+        if (FLIGHT_MODE(MANUAL_MODE)) {
+            input[INPUT_STABILIZED_ROLL] = rcCommand[ROLL];
+            input[INPUT_STABILIZED_PITCH] = rcCommand[PITCH];
+            input[INPUT_STABILIZED_YAW] = rcCommand[YAW];
+        } else {  // Assisted modes (gyro only or gyro+acc according to AUX configuration in GUI)
+            input[INPUT_STABILIZED_ROLL] = axisPID[ROLL];
+            input[INPUT_STABILIZED_PITCH] = axisPID[PITCH];
+            input[INPUT_STABILIZED_YAW] = axisPID[YAW];
+
+            // Reverse yaw when inverted in 3D mode (only for multirotor and tricopter)
+            if (feature(FEATURE_REVERSIBLE_MOTORS) && (rxGetChannelValue(THROTTLE) < PWM_RANGE_MIDDLE) &&
+            (mixerConfig()->platformType == PLATFORM_MULTIROTOR || mixerConfig()->platformType == PLATFORM_TRICOPTER)) {
+                input[INPUT_STABILIZED_YAW] *= -1;
+            }
         }
-    }
 
-    input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
-    input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
-    input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
-    input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
-    input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
-    input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+        input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
+        input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
+        input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
+        input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
+        input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
+        input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+    }
 
-    input[INPUT_FEATURE_FLAPS] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
+    if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_FEATURE_FLAPS)) {
+        input[INPUT_FEATURE_FLAPS] = FLIGHT_MODE(FLAPERON) ? servoConfig()->flaperon_throw_offset : 0;
+    }
 
     input[INPUT_MAX] = 500;
 #ifdef USE_PROGRAMMING_FRAMEWORK
-    input[INPUT_GVAR_0] = constrain(gvGet(0), -1000, 1000);
-    input[INPUT_GVAR_1] = constrain(gvGet(1), -1000, 1000);
-    input[INPUT_GVAR_2] = constrain(gvGet(2), -1000, 1000);
-    input[INPUT_GVAR_3] = constrain(gvGet(3), -1000, 1000);
-    input[INPUT_GVAR_4] = constrain(gvGet(4), -1000, 1000);
-    input[INPUT_GVAR_5] = constrain(gvGet(5), -1000, 1000);
-    input[INPUT_GVAR_6] = constrain(gvGet(6), -1000, 1000);
-    input[INPUT_GVAR_7] = constrain(gvGet(7), -1000, 1000);
+    for (int i = 0; i <= INPUT_GVAR_7 - INPUT_GVAR_0; i++) {
+        if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_GVAR_0 + i)) {
+            input[INPUT_GVAR_0 + i] = constrain(gvGet(i), -1000, 1000);
+        }
+    }
 #endif
 
-    if (IS_RC_MODE_ACTIVE(BOXCAMSTAB)) {
-        input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -900, 900, -500, +500);
-        input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
-    } else {
-        input[INPUT_GIMBAL_PITCH] = 0;
-        input[INPUT_GIMBAL_ROLL] = 0;
+    if (inputs & SERVO_MIXER_GIMBAL_INPUTS) {
+        if (IS_RC_MODE_ACTIVE(BOXCAMSTAB)) {
+            input[INPUT_GIMBAL_PITCH] = scaleRange(attitude.values.pitch, -900, 900, -500, +500);
+            input[INPUT_GIMBAL_ROLL] = scaleRange(attitude.values.roll, -1800, 1800, -500, +500);
+        } else {
+            input[INPUT_GIMBAL_PITCH] = 0;
+            input[INPUT_GIMBAL_ROLL] = 0;
+        }
     }
 
-    input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
+    if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_THROTTLE)) {
+        input[INPUT_STABILIZED_THROTTLE] = mixerThrottleCommand - 1000 - 500;  // Since it derives from rcCommand or mincommand and must be [-500:+500]
+    }
 
     // Center the RC input value
     // [1000, 2000] -> [-500, 500]
-#define GET_RX_CHANNEL_INPUT(x) (rxGetChannelValue(x) - PWM_RANGE_MIDDLE)
-    input[INPUT_RC_ROLL]     = GET_RX_CHANNEL_INPUT(ROLL);
-    input[INPUT_RC_PITCH]    = GET_RX_CHANNEL_INPUT(PITCH);
-    input[INPUT_RC_YAW]      = GET_RX_CHANNEL_INPUT(YAW);
-    input[INPUT_RC_THROTTLE] = GET_RX_CHANNEL_INPUT(THROTTLE);
-    input[INPUT_RC_CH5]      = GET_RX_CHANNEL_INPUT(AUX1);
-    input[INPUT_RC_CH6]      = GET_RX_CHANNEL_INPUT(AUX2);
-    input[INPUT_RC_CH7]      = GET_RX_CHANNEL_INPUT(AUX3);
-    input[INPUT_RC_CH8]      = GET_RX_CHANNEL_INPUT(AUX4);
-    input[INPUT_RC_CH9]      = GET_RX_CHANNEL_INPUT(AUX5);
-    input[INPUT_RC_CH10]     = GET_RX_CHANNEL_INPUT(AUX6);
-    input[INPUT_RC_CH11]     = GET_RX_CHANNEL_INPUT(AUX7);
-    input[INPUT_RC_CH12]     = GET_RX_CHANNEL_INPUT(AUX8);
-    input[INPUT_RC_CH13]     = GET_RX_CHANNEL_INPUT(AUX9);
-    input[INPUT_RC_CH14]     = GET_RX_CHANNEL_INPUT(AUX10);
-    input[INPUT_RC_CH15]     = GET_RX_CHANNEL_INPUT(AUX11);
-    input[INPUT_RC_CH16]     = GET_RX_CHANNEL_INPUT(AUX12);
-#undef GET_RX_CHANNEL_INPUT
+    // INPUT_RC_ROLL to INPUT_RC_CH8 are channels 1 to 8, INPUT_RC_CH9 to INPUT_RC_CH16 channels 9 to 16
+    for (int channel = ROLL; channel <= AUX12; channel++) {
+        const int source = channel <= AUX4 ? INPUT_RC_ROLL + channel : INPUT_RC_CH9 + channel - AUX5;
+        if (inputs & SERVO_MIXER_INPUT_BIT(source)) {
+            input[source] = rxGetChannelValue(channel) - PWM_RANGE_MIDDLE;
+        }
+    }
+}
+
+void servoMixer(float dT)
+{
+    int16_t input[INPUT_SOURCE_COUNT];  // Range [-500, 500]
+
+    servoMixerComputeInputs(input, servoMixerInputs);
 
     // This bypasses triflight, but that's probably fine since software support is unlikely to ever happen
 #ifdef USE_SIMULATOR
@@ -317,32 +319,13 @@ void servoMixer(float dT)
         servo[i] = 0;
 
     // Mix servos according to rules
-    for (int i = 0; i < servoRuleCount; i++) {
-
-#ifdef USE_PROGRAMMING_FRAMEWORK
-        // Skip rule if its condition is not true
-        if (!logicConditionGetValue(currentServoMixer[i].conditionId))
-            continue;
-#endif
-        const uint8_t target = currentServoMixer[i].targetChannel;
-        const uint8_t from = currentServoMixer[i].inputSource;
-
-        // Limit servo speed
-        // 0 = no limiting
-        // 1 = 10us/s -> full servo sweep (from 1000 to 2000) takes 100s
-        // 10 = 100us/s -> full sweep takes 10s
-        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&servoSpeedLimitFilter[i], input[from], currentServoMixer[i].speed * 10, dT);
-        servo[target] += ((int32_t)inputLimited * currentServoMixer[i].rate) / 100;
-    }
+    servoMixerRulesApply(&currentServoMixer, input, servoSpeedLimitFilter, dT, servo);
 
     // Set all throttle-controlled servos to lowest position if not armed
-    if (!ARMING_FLAG(ARMED)) {
-        for (int i = 0; i < servoRuleCount; i++) {
-            const uint8_t target = currentServoMixer[i].targetChannel;
-            const uint8_t from = currentServoMixer[i].inputSource;
-
-            if (from == INPUT_STABILIZED_THROTTLE || from == INPUT_RC_THROTTLE)
-                servo[target] = motorConfig()->mincommand;
+    if (!ARMING_FLAG(ARMED) && currentServoMixer.throttleTargets) {
+        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+            if (currentServoMixer.throttleTargets & (1 << i))
+                servo[i] = motorConfig()->mincommand;
         }
     }
 
@@ -391,9 +374,9 @@ void processServoAutotrimMode(void)
             case AUTOTRIM_IDLE:
                 if (ARMING_FLAG(ARMED)) {
                     for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                        for (int i = 0; i < servoRuleCount; i++) {
-                            const uint8_t target = currentServoMixer[i].targetChannel;
-                            const uint8_t source = currentServoMixer[i].inputSource;
+                        for (int i = 0; i < currentServoMixer.ruleCount; i++) {
+                            const uint8_t target = currentServoMixer.rules[i].target;
+                            const uint8_t source = currentServoMixer.rules[i].source;
                             if (source == axis) {
                                 servoMiddleBackup[target] = servoParams(target)->middle;
                                 servoMiddleAccum[target] = 0;
@@ -411,9 +394,9 @@ void processServoAutotrimMode(void)
             case AUTOTRIM_COLLECTING:
                 if (ARMING_FLAG(ARMED)) {
                     for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                        for (int i = 0; i < servoRuleCount; i++) {
-                            const uint8_t target = currentServoMixer[i].targetChannel;
-                            const uint8_t source = currentServoMixer[i].inputSource;
+                        for (int i = 0; i < currentServoMixer.ruleCount; i++) {
+                            const uint8_t target = currentServoMixer.rules[i].target;
+                            const uint8_t source = currentServoMixer.rules[i].source;
                             if (source == axis) {
                                 servoMiddleAccum[target] += servo[target];
                                 servoMiddleAccumCount[target]++;
@@ -423,9 +406,9 @@ void processServoAutotrimMode(void)
 
                     if ((millis() - trimStartedAt) > SERVO_AUTOTRIM_TIMER_MS) {
                         for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                            for (int i = 0; i < servoRuleCount; i++) {
-                                const uint8_t target = currentServoMixer[i].targetChannel;
-                                const uint8_t source = currentServoMixer[i].inputSource;
+                            for (int i = 0; i < currentServoMixer.ruleCount; i++) {
+                                const uint8_t target = currentServoMixer.rules[i].target;
+                                const uint8_t source = currentServoMixer.rules[i].source;
                                 if (source == axis)
                                     servoParamsMutable(target)->middle = servoMiddleAccum[target] / servoMiddleAccumCount[target];
                             }
@@ -455,9 +438,9 @@ void processServoAutotrimMode(void)
         // We are deactivating servo trim - restore servo midpoints
         if (trimState == AUTOTRIM_SAVE_PENDING) {
             for (int axis = FD_ROLL; axis <= FD_YAW; axis++) {
-                for (int i = 0; i < servoRuleCount; i++) {
-                    const uint8_t target = currentServoMixer[i].targetChannel;
-                    const uint8_t source = currentServoMixer[i].inputSource;
+                for (int i = 0; i < currentServoMixer.ruleCount; i++) {
+                    const uint8_t target = currentServoMixer.rules[i].target;
+                    const uint8_t source = currentServoMixer.rules[i].source;
                     if (source == axis)
                         servoParamsMutable(target)->middle = servoMiddleBackup[target];
                 }
@@ -505,16 +488,16 @@ void processContinuousServoAutotrim(const float dT)
                     const float axisIterm = getAxisIterm(axis);
                     if (fabsf(axisIterm) > SERVO_AUTOTRIM_UPDATE_SIZE) {
                         const int8_t ItermUpdate = axisIterm > 0.0f ? SERVO_AUTOTRIM_UPDATE_SIZE : -SERVO_AUTOTRIM_UPDATE_SIZE;
-                        for (int i = 0; i < servoRuleCount; i++) {
+                        for (int i = 0; i < currentServoMixer.ruleCount; i++) {
 #ifdef USE_PROGRAMMING_FRAMEWORK
-                            if (!logicConditionGetValue(currentServoMixer[i].conditionId))
+                            if (!logicConditionGetValue(currentServoMixer.rules[i].conditionId))
                                 continue;
 #endif
-                            const uint8_t target = currentServoMixer[i].targetChannel;
-                            const uint8_t source = currentServoMixer[i].inputSource;
+                            const uint8_t target = currentServoMixer.rules[i].target;
+                            const uint8_t source = currentServoMixer.rules[i].source;
                             if (source == axis) {
                                 // Convert axis I-term to servo PWM and add to midpoint
-                                const float mixerRate = currentServoMixer[i].rate / 100.0f;
+                                const float mixerRate = currentServoMixer.rules[i].rate / 100.0f;
                                 const float servoRate = servoParams(target)->rate / 100.0f;
                                 servoParamsMutable(target)->middle += (int16_t)(ItermUpdate * mixerRate * servoRate);
                                 servoParamsMutable(target)->middle = constrain(servoParamsMutable(target)->middle, SERVO_AUTOTRIM_CENTER_MIN, SERVO_AUTOTRIM_CENTER_MAX);
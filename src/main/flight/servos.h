@@ -128,6 +128,9 @@ typedef struct servoParam_s {
     int16_t max;                            // servo max
     int16_t middle;                         // servo middle
     int8_t rate;                            // range [-125;+125] ; can be used to adjust a rate 0-125% and a direction
+    uint16_t updateRate;                    // Hz, how often the output is updated; 0 = every loop
+    uint16_t lpfHz;                         // output filter cutoff in Hz; 0 = servo_lpf_hz
+    uint16_t slewRate;                      // us/s; 0 = no limit
 } servoParam_t;
 
 PG_DECLARE_ARRAY(servoParam_t, MAX_SUPPORTED_SERVOS, servoParams);
@@ -160,5 +163,6 @@ void writeServos(void);
 void loadCustomServoMixer(void);
 void servoMixer(float dT);
 void servoComputeScalingFactors(uint8_t servoIndex);
+void servoInitOutputStage(uint8_t servoIndex);
 void servosInit(void);
 int getServoCount(void);
@@ -29,40 +29,63 @@
 #ifdef USE_SMITH_PREDICTOR
 
 #include <stdbool.h>
+#include <string.h>
 #include "common/axis.h"
+#include "common/maths.h"
 #include "common/utils.h"
 #include "flight/smith_predictor.h"
 #include "build/debug.h"
 
-float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample) {
-    UNUSED(axis);
-    if (predictor->enabled) {
-        predictor->data[predictor->idx] = sample;
+void applySmithPredictor(smithPredictor_t *predictor, float *samples) {
+    if (!predictor->enabled) {
+        return;
+    }
+
+    predictor->idx++;
+    if (predictor->idx > MAX_SMITH_SAMPLES) {
+        predictor->idx = 0;
+    }
+
+    int older = predictor->idx - predictor->delayTaps;
+    if (older < 0) {
+        older += MAX_SMITH_SAMPLES + 1;
+    }
+    const float *delayedNewer = predictor->data[older];
+    older = older ? older - 1 : MAX_SMITH_SAMPLES;
+    const float *delayedOlder = predictor->data[older];
 
-        predictor->idx++;
-        if (predictor->idx > predictor->samples) {
-            predictor->idx = 0;
-        }
+    float *newest = predictor->data[predictor->idx];
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        newest[axis] = samples[axis];
+
+        const float delayedSample = delayedNewer[axis] + predictor->delayFraction * (delayedOlder[axis] - delayedNewer[axis]);
 
         // filter the delayed data to help reduce the overall noise this prediction adds
-        float delayed = pt1FilterApply(&predictor->smithPredictorFilter, predictor->data[predictor->idx]);
-        float delayCompensatedSample = predictor->smithPredictorStrength * (sample - delayed);
+        float delayed = pt1FilterApply(&predictor->smithPredictorFilter[axis], delayedSample);
+        float delayCompensatedSample = predictor->smithPredictorStrength * (samples[axis] - delayed);
 
-        sample += delayCompensatedSample;
+        samples[axis] += delayCompensatedSample;
     }
-    return sample;
+}
+
+void smithPredictorSetDelay(smithPredictor_t *predictor, float delay) {
+    predictor->enabled = delay > 0.1f;
+
+    const float delaySamples = constrainf(delay * 1000.0f / predictor->looptime, 0.0f, MAX_SMITH_SAMPLES);
+    // The older of the two samples has to be in the buffer too
+    predictor->delayTaps = MIN((int)delaySamples, MAX_SMITH_SAMPLES - 1);
+    predictor->delayFraction = delaySamples - predictor->delayTaps;
 }
 
 void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime) {
-    if (delay > 0.1) {
-        predictor->enabled = true;
-        predictor->samples = (delay * 1000) / looptime;
-        predictor->idx = 0;
-        predictor->smithPredictorStrength = strength;
-        pt1FilterInit(&predictor->smithPredictorFilter, filterLpfHz, US2S(looptime));
-    } else {
-        predictor->enabled = false;
+    memset(predictor, 0, sizeof(*predictor));
+
+    predictor->looptime = looptime;
+    predictor->smithPredictorStrength = strength;
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        pt1FilterInit(&predictor->smithPredictorFilter[axis], filterLpfHz, US2S(looptime));
     }
+    smithPredictorSetDelay(predictor, delay);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -27,19 +27,32 @@
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "common/axis.h"
 #include "common/filter.h"
 
+// 8ms, the largest smith_predictor_delay, at 8kHz
 #define MAX_SMITH_SAMPLES 64
 
+/*
+ * One delay line for all three axes, interleaved so a loop writes and reads
+ * adjacent floats. The delay is fractional: the delayed sample is linearly
+ * interpolated between the two samples around it, so the delay isn't
+ * rounded down to a whole number of loops.
+ */
 typedef struct smithPredictor_s {
     bool enabled;
-    uint8_t samples;
-    uint8_t idx;
-    float data[MAX_SMITH_SAMPLES + 1];
-    pt1Filter_t smithPredictorFilter;
+    uint8_t idx;                                        // newest sample
+    uint8_t delayTaps;                                  // whole samples of delay
+    float delayFraction;                                // weight of the sample one older
     float smithPredictorStrength;
+    uint32_t looptime;
+    pt1Filter_t smithPredictorFilter[XYZ_AXIS_COUNT];
+    float data[MAX_SMITH_SAMPLES + 1][XYZ_AXIS_COUNT];
 } smithPredictor_t;
 
-float applySmithPredictor(uint8_t axis, smithPredictor_t *predictor, float sample);
-void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime);
\ No newline at end of file
+void applySmithPredictor(smithPredictor_t *predictor, float *samples);
+void smithPredictorInit(smithPredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime);
+// Can be called between loops, e.g. with a measured motor response latency. In milliseconds
+void smithPredictorSetDelay(smithPredictor_t *predictor, float delay);
@@ -24,10 +24,12 @@
 
 #ifdef  USE_SERIAL_4WAY_BLHELI_INTERFACE
 
+#include "common/crc.h"
+#include "common/maths.h"
+
 #include "drivers/buf_writer.h"
 #include "drivers/io.h"
 #include "drivers/serial.h"
-#include "drivers/timer.h"
 #include "drivers/pwm_mapping.h"
 #include "drivers/pwm_output.h"
 #include "drivers/light_led.h"
@@ -278,51 +280,6 @@ void esc4wayRelease(void)
 #define ACK_I_INVALID_PARAM     0x09
 #define ACK_D_GENERAL_ERROR     0x0F
 
-/* Copyright (c) 2002, 2003, 2004  Marek Michalkiewicz
-   Copyright (c) 2005, 2007 Joerg Wunsch
-   Copyright (c) 2013 Dave Hylands
-   Copyright (c) 2013 Frederic Nadeau
-   All rights reserved.
-
-   Redistribution and use in source and binary forms, with or without
-   modification, are permitted provided that the following conditions are met:
-
-   * Redistributions of source code must retain the above copyright
-     notice, this list of conditions and the following disclaimer.
-
-   * Redistributions in binary form must reproduce the above copyright
-     notice, this list of conditions and the following disclaimer in
-     the documentation and/or other materials provided with the
-     distribution.
-
-   * Neither the name of the copyright holders nor the names of
-     contributors may be used to endorse or promote products derived
-     from this software without specific prior written permission.
-
-  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
-  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
-  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
-  ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
-  LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
-  CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
-  SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
-  INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
-  CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
-  ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
-  POSSIBILITY OF SUCH DAMAGE. */
-uint16_t _crc_xmodem_update (uint16_t crc, uint8_t data) {
-        int i;
-
-        crc = crc ^ ((uint16_t)data << 8);
-        for (i=0; i < 8; i++) {
-            if (crc & 0x8000)
-                crc = (crc << 1) ^ 0x1021;
-            else
-                crc <<= 1;
-        }
-        return crc;
-}
-// * End copyright
 
 
 #define ATMEL_DEVICE_MATCH ((pDeviceInfo->words[0] == 0x9307) || (pDeviceInfo->words[0] == 0x930A) || \
@@ -382,48 +339,38 @@ static uint8_t Connect(uint8_32_u *pDeviceInfo)
     return 0;
 }
 
-static serialPort_t *port;
-
-static uint8_t ReadByte(void)
-{
-    // need timeout?
-    while (!serialRxBytesWaiting(port));
-    return serialRead(port);
-}
+// Escape, command, address high and low, parameter length
+#define FRAME_HEADER_SIZE   5
+// Up to 256 parameter bytes, then ACK and CRC going out or CRC coming in
+#define FRAME_SIZE_MAX      (FRAME_HEADER_SIZE + 256 + 3)
 
-static uint8_16_u CRC_in;
-static uint8_t ReadByteCrc(void)
-{
-    uint8_t b = ReadByte();
-    CRC_in.word = _crc_xmodem_update(CRC_in.word, b);
-    return b;
-}
+static serialPort_t *port;
 
-static void WriteByte(uint8_t b)
-{
-    serialWrite(port, b);
-}
+// Requests and responses are built here whole, parameters in place
+static uint8_t frame[FRAME_SIZE_MAX];
 
-static uint8_16_u CRCout;
-static void WriteByteCrc(uint8_t b)
+static void ReadBuf(uint8_t *buf, uint16_t len)
 {
-    WriteByte(b);
-    CRCout.word = _crc_xmodem_update(CRCout.word, b);
+    // Take everything that has arrived at once, usually the rest of the frame
+    while (len > 0) {
+        uint32_t count = MIN(serialRxBytesWaiting(port), (uint32_t)len);
+        len -= count;
+        while (count--) {
+            *buf++ = serialRead(port);
+        }
+    }
 }
 
 void esc4wayProcess(serialPort_t *mspPort)
 {
-
-    uint8_t ParamBuf[256];
-    uint8_t ESC;
+    uint8_t * const ParamBuf = &frame[FRAME_HEADER_SIZE];
     uint8_t I_PARAM_LEN;
     uint8_t CMD;
     uint8_t ACK_OUT;
-    uint8_16_u CRC_check;
+    uint16_t CRC_check;
     uint8_16_u Dummy;
     uint8_t O_PARAM_LEN;
     uint8_t *O_PARAM;
-    uint8_t *InBuff;
     ioMem_t ioMem;
 
     port = mspPort;
@@ -439,32 +386,26 @@ void esc4wayProcess(serialPort_t *mspPort)
     while (1) {
         // restart looking for new sequence from host
         do {
-            CRC_in.word = 0;
-            ESC = ReadByteCrc();
-        } while (ESC != cmd_Local_Escape);
+            ReadBuf(&frame[0], 1);
+        } while (frame[0] != cmd_Local_Escape);
 
         RX_LED_ON;
 
         Dummy.word = 0;
         O_PARAM = &Dummy.bytes[0];
         O_PARAM_LEN = 1;
-        CMD = ReadByteCrc();
-        ioMem.D_FLASH_ADDR_H = ReadByteCrc();
-        ioMem.D_FLASH_ADDR_L = ReadByteCrc();
-        I_PARAM_LEN = ReadByteCrc();
-
-        InBuff = ParamBuf;
-        uint8_t i = I_PARAM_LEN;
-        do {
-          *InBuff = ReadByteCrc();
-          InBuff++;
-          i--;
-        } while (i != 0);
-
-        CRC_check.bytes[1] = ReadByte();
-        CRC_check.bytes[0] = ReadByte();
-
-        if (CRC_check.word == CRC_in.word) {
+        ReadBuf(&frame[1], FRAME_HEADER_SIZE - 1);
+        CMD = frame[1];
+        ioMem.D_FLASH_ADDR_H = frame[2];
+        ioMem.D_FLASH_ADDR_L = frame[3];
+        I_PARAM_LEN = frame[4];
+
+        // Length 0 means 256, the CRC follows the parameters
+        uint16_t paramLen = I_PARAM_LEN ? I_PARAM_LEN : 256;
+        ReadBuf(ParamBuf, paramLen + 2);
+        CRC_check = (ParamBuf[paramLen] << 8) | ParamBuf[paramLen + 1];
+
+        if (CRC_check == crc16_ccitt_update(0, frame, FRAME_HEADER_SIZE + paramLen)) {
             ACK_OUT = ACK_OK;
         } else {
             ACK_OUT = ACK_I_INVALID_CRC;
@@ -695,7 +636,7 @@ void esc4wayProcess(serialPort_t *mspPort)
                     if (ACK_OUT == ACK_OK)
                     {
                         O_PARAM_LEN = ioMem.D_NUM_BYTES;
-                        O_PARAM = (uint8_t *)&ParamBuf;
+                        O_PARAM = ParamBuf;
                     }
                     break;
                 }
@@ -736,7 +677,7 @@ void esc4wayProcess(serialPort_t *mspPort)
                     if (ACK_OUT == ACK_OK)
                     {
                         O_PARAM_LEN = ioMem.D_NUM_BYTES;
-                        O_PARAM = (uint8_t *)&ParamBuf;
+                        O_PARAM = ParamBuf;
                     }
                     break;
                 }
@@ -861,29 +802,28 @@ void esc4wayProcess(serialPort_t *mspPort)
             }
         }
 
-        CRCout.word = 0;
-
         RX_LED_OFF;
 
-        serialBeginWrite(port);
-        WriteByteCrc(cmd_Remote_Escape);
-        WriteByteCrc(CMD);
-        WriteByteCrc(ioMem.D_FLASH_ADDR_H);
-        WriteByteCrc(ioMem.D_FLASH_ADDR_L);
-        WriteByteCrc(O_PARAM_LEN);
+        frame[0] = cmd_Remote_Escape;
+        frame[1] = CMD;
+        frame[2] = ioMem.D_FLASH_ADDR_H;
+        frame[3] = ioMem.D_FLASH_ADDR_L;
+        frame[4] = O_PARAM_LEN;
 
-        i=O_PARAM_LEN;
-        do {
-            while (!serialTxBytesFree(port));
+        // Read data is already in place
+        paramLen = O_PARAM_LEN ? O_PARAM_LEN : 256;
+        if (O_PARAM != ParamBuf) {
+            memcpy(ParamBuf, O_PARAM, paramLen);
+        }
+        ParamBuf[paramLen] = ACK_OUT;
 
-            WriteByteCrc(*O_PARAM);
-            O_PARAM++;
-            i--;
-        } while (i > 0);
+        const uint16_t frameLen = FRAME_HEADER_SIZE + paramLen + 1;
+        const uint16_t CRC_out = crc16_ccitt_update(0, frame, frameLen);
+        frame[frameLen] = CRC_out >> 8;
+        frame[frameLen + 1] = CRC_out & 0xFF;
 
-        WriteByteCrc(ACK_OUT);
-        WriteByte(CRCout.bytes[1]);
-        WriteByte(CRCout.bytes[0]);
+        serialBeginWrite(port);
+        serialWriteBuf(port, frame, frameLen + 2);
         serialEndWrite(port);
 
         TX_LED_OFF;
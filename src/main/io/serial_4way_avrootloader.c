@@ -29,7 +29,6 @@
 #include "drivers/io.h"
 #include "drivers/serial.h"
 #include "drivers/time.h"
-#include "drivers/timer.h"
 
 #include "io/serial.h"
 #include "io/serial_4way.h"
@@ -62,16 +61,19 @@
 
 #define START_BIT_TIMEOUT_MS 2
 
-#define BIT_TIME (52)       // 52uS
-#define BIT_TIME_HALVE      (BIT_TIME >> 1) // 26uS
-#define BIT_TIME_3_4        (BIT_TIME_HALVE + (BIT_TIME_HALVE >> 1))   // 39uS
-#define START_BIT_TIME      (BIT_TIME_3_4)
-//#define STOP_BIT_TIME     ((BIT_TIME * 9) + BIT_TIME_HALVE)
+// The bootloaders run at a fixed 19200 baud. Bits are timed on the cycle
+// counter, micros() is too coarse and costs a division on every poll.
+#define BIT_RATE            19200
+#define BIT_TICKS           (usTicks * 1000000 / BIT_RATE)
+
+static void waitTicks(uint32_t until)
+{
+    while ((int32_t)(ticks() - until) < 0);
+}
 
 static uint8_t suart_getc_(uint8_t *bt)
 {
-    uint32_t btime;
-    uint32_t start_time;
+    const uint32_t bitTicks = BIT_TICKS;
 
     uint32_t wait_time = millis() + START_BIT_TIMEOUT_MS;
     while (ESC_IS_HI) {
@@ -80,21 +82,15 @@ static uint8_t suart_getc_(uint8_t *bt)
             return 0;
         }
     }
-    // start bit
-    start_time = micros();
-    btime = start_time + START_BIT_TIME;
+    // start bit, sample 3/4 into each bit from its falling edge
+    uint32_t btime = ticks() + bitTicks * 3 / 4;
     uint16_t bitmask = 0;
-    uint8_t bit = 0;
-    while (micros() < btime);
-    while (1) {
-        if (ESC_IS_HI)
-        {
+    for (uint8_t bit = 0; bit < 10; bit++) {
+        waitTicks(btime);
+        if (ESC_IS_HI) {
             bitmask |= (1 << bit);
         }
-        btime = btime + BIT_TIME;
-        bit++;
-        if (bit == 10) break;
-        while (micros() < btime);
+        btime += bitTicks;
     }
     // check start bit and stop bit
     if ((bitmask & 1) || (!(bitmask & (1 << 9)))) {
@@ -104,11 +100,13 @@ static uint8_t suart_getc_(uint8_t *bt)
     return 1;
 }
 
-static void suart_putc_(uint8_t *tx_b)
+static void suart_putc_(uint8_t tx_b)
 {
+    const uint32_t bitTicks = BIT_TICKS;
+
     // shift out stopbit first
-    uint16_t bitmask = (*tx_b << 2) | 1 | (1 << 10);
-    uint32_t btime = micros();
+    uint16_t bitmask = (tx_b << 2) | 1 | (1 << 10);
+    uint32_t btime = ticks();
     while (1) {
         if (bitmask & 1) {
             ESC_SET_HI; // 1
@@ -116,50 +114,47 @@ static void suart_putc_(uint8_t *tx_b)
         else {
             ESC_SET_LO; // 0
         }
-        btime = btime + BIT_TIME;
+        btime += bitTicks;
         bitmask = (bitmask >> 1);
         if (bitmask == 0) break; // stopbit shifted out - but don't wait
-        while (micros() < btime);
+        waitTicks(btime);
     }
 }
 
-static uint8_16_u CRC_16;
-static uint8_16_u LastCRC_16;
-
-static void ByteCrc(uint8_t *bt)
+// CRC16 with polynomial 0xA001, bytes are only CRCed once a whole buffer
+// has gone by so nothing runs between the bits
+static uint16_t BL_Crc(const uint8_t *pstring, uint16_t len)
 {
-    uint8_t xb = *bt;
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        if (((xb & 0x01) ^ (CRC_16.word & 0x0001)) !=0 ) {
-            CRC_16.word = CRC_16.word >> 1;
-            CRC_16.word = CRC_16.word ^ 0xA001;
-        } else {
-            CRC_16.word = CRC_16.word >> 1;
+    uint16_t crc = 0;
+    while (len--) {
+        crc ^= *pstring++;
+        for (uint8_t i = 0; i < 8; i++) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc = crc >> 1;
+            }
         }
-        xb = xb >> 1;
     }
+    return crc;
 }
 
 static uint8_t BL_ReadBuf(uint8_t *pstring, uint8_t len)
 {
     // len 0 means 256
-    CRC_16.word = 0;
-    LastCRC_16.word = 0;
-    uint8_t  LastACK = brNONE;
-    do {
-        if (!suart_getc_(pstring)) goto timeout;
-        ByteCrc(pstring);
-        pstring++;
-        len--;
-    } while (len > 0);
+    const uint16_t count = len ? len : 256;
+    uint8_16_u LastCRC_16;
+    uint8_t LastACK = brNONE;
+    for (uint16_t i = 0; i < count; i++) {
+        if (!suart_getc_(&pstring[i])) goto timeout;
+    }
 
     if (isMcuConnected()) {
         //With CRC read 3 more
         if (!suart_getc_(&LastCRC_16.bytes[0])) goto timeout;
         if (!suart_getc_(&LastCRC_16.bytes[1])) goto timeout;
         if (!suart_getc_(&LastACK)) goto timeout;
-        if (CRC_16.word != LastCRC_16.word) {
+        if (BL_Crc(pstring, count) != LastCRC_16.word) {
             LastACK = brERRORCRC;
         }
     } else {
@@ -171,18 +166,19 @@ timeout:
 
 static void BL_SendBuf(uint8_t *pstring, uint8_t len)
 {
+    // len 0 means 256
+    const uint16_t count = len ? len : 256;
+    uint8_16_u CRC_16;
+    CRC_16.word = BL_Crc(pstring, count);
+
     ESC_OUTPUT;
-    CRC_16.word=0;
-    do {
-        suart_putc_(pstring);
-        ByteCrc(pstring);
-        pstring++;
-        len--;
-    } while (len > 0);
+    for (uint16_t i = 0; i < count; i++) {
+        suart_putc_(pstring[i]);
+    }
 
     if (isMcuConnected()) {
-        suart_putc_(&CRC_16.bytes[0]);
-        suart_putc_(&CRC_16.bytes[1]);
+        suart_putc_(CRC_16.bytes[0]);
+        suart_putc_(CRC_16.bytes[1]);
     }
     ESC_INPUT;
 }
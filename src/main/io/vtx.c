@@ -57,6 +57,9 @@ PG_RESET_TEMPLATE(vtxSettingsConfig_t, vtxSettingsConfig,
     .frequencyGroup = SETTING_VTX_FREQUENCY_GROUP_DEFAULT,
 );
 
+// Settings are checked at 5Hz, the device is processed as soon as it needs to
+#define VTX_SETTINGS_UPDATE_INTERVAL_US     200000
+
 typedef enum {
     VTX_PARAM_POWER = 0,
     VTX_PARAM_BANDCHAN,
@@ -160,39 +163,60 @@ static bool vtxProcessPitMode(vtxDevice_t *vtxDevice, const vtxSettingsConfig_t
     return false;
 }
 
+static timeUs_t lastSettingsUpdateUs = 0;
+
+bool vtxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTimeUs)
+{
+    UNUSED(currentDeltaTimeUs);
+
+    if (cmpTimeUs(currentTimeUs, lastSettingsUpdateUs) >= VTX_SETTINGS_UPDATE_INTERVAL_US) {
+        return true;
+    }
+
+    // Responses, timeouts and queued commands don't wait for the next settings update
+    return !cliMode && vtxCommonIsProcessPending(vtxCommonDevice(), currentTimeUs);
+}
+
 void vtxUpdate(timeUs_t currentTimeUs)
 {
     static uint8_t currentSchedule = 0;
 
     if (cliMode) {
+        lastSettingsUpdateUs = currentTimeUs;
         return;
     }
 
     vtxDevice_t *vtxDevice = vtxCommonDevice();
     if (vtxDevice) {
-        // Check input sources for config updates
-        vtxControlInputPoll();
-
-        // Build runtime settings
-        const vtxSettingsConfig_t * runtimeSettings = vtxGetRuntimeSettings();
-
-        switch (currentSchedule) {
-            case VTX_PARAM_POWER:
-                vtxProcessPower(vtxDevice, runtimeSettings);
-                break;
-            case VTX_PARAM_BANDCHAN:
-                vtxProcessBandAndChannel(vtxDevice, runtimeSettings);
-                break;
-            case VTX_PARAM_PITMODE:
-                vtxProcessPitMode(vtxDevice, runtimeSettings);
-                break;
-            default:
-                break;
+        if (cmpTimeUs(currentTimeUs, lastSettingsUpdateUs) >= VTX_SETTINGS_UPDATE_INTERVAL_US) {
+            lastSettingsUpdateUs = currentTimeUs;
+
+            // Check input sources for config updates
+            vtxControlInputPoll();
+
+            // Build runtime settings
+            const vtxSettingsConfig_t * runtimeSettings = vtxGetRuntimeSettings();
+
+            switch (currentSchedule) {
+                case VTX_PARAM_POWER:
+                    vtxProcessPower(vtxDevice, runtimeSettings);
+                    break;
+                case VTX_PARAM_BANDCHAN:
+                    vtxProcessBandAndChannel(vtxDevice, runtimeSettings);
+                    break;
+                case VTX_PARAM_PITMODE:
+                    vtxProcessPitMode(vtxDevice, runtimeSettings);
+                    break;
+                default:
+                    break;
+            }
+
+            currentSchedule = (currentSchedule + 1) % VTX_PARAM_COUNT;
         }
 
         vtxCommonProcess(vtxDevice, currentTimeUs);
-
-        currentSchedule = (currentSchedule + 1) % VTX_PARAM_COUNT;
+    } else {
+        lastSettingsUpdateUs = currentTimeUs;
     }
 }
 
@@ -34,6 +34,7 @@
 
 #include "cms/cms.h"
 
+#include "common/crc.h"
 #include "common/log.h"
 #include "common/maths.h"
 #include "common/printf.h"
@@ -53,12 +54,13 @@
 
 
 // Timing parameters
-// Note that vtxSAProcess() is normally called at 200ms interval
 #define SMARTAUDIO_CMD_TIMEOUT       120    // Time until the command is considered lost
+#define SMARTAUDIO_CMD_RETRIES         4    // Resends before giving up on a command
 #define SMARTAUDIO_POLLING_INTERVAL  150    // Minimum time between state polling
 #define SMARTAUDIO_POLLING_WINDOW   1000    // Time window after command polling for state change
 
 static serialPort_t *smartAudioSerialPort = NULL;
+static vtxTransport_t saTransport;
 
 uint8_t saPowerCount = VTX_SMARTAUDIO_DEFAULT_POWER_COUNT;
 const char * saPowerNames[VTX_SMARTAUDIO_MAX_POWER_COUNT + 1] = {
@@ -149,37 +151,8 @@ static uint8_t saLockMode = SA_MODE_SET_UNLOCK; // saCms variable?
 // XXX Should be configurable by user?
 bool saDeferred = true; // saCms variable?
 
-// Receive frame reassembly buffer
+// Longest response frame, without preamble and CRC
 #define SA_MAX_RCVLEN 21
-static uint8_t sa_rbuf[SA_MAX_RCVLEN+4]; // XXX delete 4 byte guard
-
-//
-// CRC8 computations
-//
-
-#define POLYGEN 0xd5
-
-static uint8_t CRC8(const uint8_t *data, const int8_t len)
-{
-    uint8_t crc = 0; /* start with 0 so first byte can be 'xored' in */
-    uint8_t currByte;
-
-    for (int i = 0 ; i < len ; i++) {
-        currByte = data[i];
-
-        crc ^= currByte; /* XOR-in the next input byte */
-
-        for (int i = 0; i < 8; i++) {
-            if ((crc & 0x80) != 0) {
-                crc = (uint8_t)((crc << 1) ^ POLYGEN);
-            } else {
-                crc <<= 1;
-            }
-        }
-    }
-    return crc;
-}
-
 
 static void saPrintSettings(void)
 {
@@ -226,63 +199,11 @@ int saDbiToMw(uint16_t dbi) {
 #define SMARTBAUD_MIN 4800
 #define SMARTBAUD_MAX 4950
 uint16_t sa_smartbaud = SMARTBAUD_MIN;
-static int sa_adjdir = 1; // -1=going down, 1=going up
-static int sa_baudstep = 50;
-
-static void saAutobaud(void)
-{
-    if (saStat.pktsent < 10) {
-        // Not enough samples collected
-        return;
-    }
-
-    if (((saStat.pktrcvd * 100) / saStat.pktsent) >= 70) {
-        // This is okay
-        saStat.pktsent = 0; // Should be more moderate?
-        saStat.pktrcvd = 0;
-        return;
-    }
-
-    LOG_DEBUG(VTX, "autobaud: adjusting");
-
-    if ((sa_adjdir == 1) && (sa_smartbaud == SMARTBAUD_MAX)) {
-       sa_adjdir = -1;
-       LOG_DEBUG(VTX, "autobaud: now going down");
-    } else if ((sa_adjdir == -1 && sa_smartbaud == SMARTBAUD_MIN)) {
-       sa_adjdir = 1;
-       LOG_DEBUG(VTX, "autobaud: now going up");
-    }
-
-    sa_smartbaud += sa_baudstep * sa_adjdir;
-
-    LOG_DEBUG(VTX, "autobaud: %d", sa_smartbaud);
-
-    smartAudioSerialPort->vTable->serialSetBaudRate(smartAudioSerialPort, sa_smartbaud);
-
-    saStat.pktsent = 0;
-    saStat.pktrcvd = 0;
-}
-
-// Transport level variables
-
-static timeUs_t sa_lastTransmissionMs = 0;
-static uint8_t sa_outstanding = SA_CMD_NONE; // Outstanding command
-static uint8_t sa_osbuf[32]; // Outstanding comamnd frame for retransmission
-static int sa_oslen;         // And associate length
 
-static void saProcessResponse(uint8_t *buf, int len)
+static void saProcessResponse(const uint8_t *buf, int len)
 {
     uint8_t resp = buf[0];
 
-    if (resp == sa_outstanding) {
-        sa_outstanding = SA_CMD_NONE;
-    } else if ((resp == SA_CMD_GET_SETTINGS_V2 || resp == SA_CMD_GET_SETTINGS_V21) && (sa_outstanding == SA_CMD_GET_SETTINGS)) {
-        sa_outstanding = SA_CMD_NONE;
-    } else {
-        saStat.ooopresp++;
-        LOG_DEBUG(VTX, "processResponse: outstanding %d got %d", sa_outstanding, resp);
-    }
-
     switch (resp) {
     case SA_CMD_GET_SETTINGS_V21: // Version 2.1 Get Settings
     case SA_CMD_GET_SETTINGS_V2: // Version 2 Get Settings
@@ -407,203 +328,144 @@ static void saProcessResponse(uint8_t *buf, int len)
 // Datalink
 //
 
-static void saReceiveFramer(uint8_t c)
+// Frames are 0xAA 0x55, response code, length, data and a CRC of all
+// but the preamble
+static int saDecodeFrame(const uint8_t *buf, int len)
 {
+    if (buf[0] != 0xAA) {
+        return -1;
+    }
 
-    static enum saFramerState_e {
-        S_WAITPRE1, // Waiting for preamble 1 (0xAA)
-        S_WAITPRE2, // Waiting for preamble 2 (0x55)
-        S_WAITRESP, // Waiting for response code
-        S_WAITLEN,  // Waiting for length
-        S_DATA,     // Receiving data
-        S_WAITCRC,  // Waiting for CRC
-    } state = S_WAITPRE1;
-
-    static int len;
-    static int dlen;
-
-    switch (state) {
-    case S_WAITPRE1:
-        if (c == 0xAA) {
-            state = S_WAITPRE2;
-        } else {
-            state = S_WAITPRE1; // Don't need this (no change)
-        }
-        break;
-
-    case S_WAITPRE2:
-        if (c == 0x55) {
-            state = S_WAITRESP;
-        } else {
-            saStat.badpre++;
-            state = S_WAITPRE1;
-        }
-        break;
+    if (len < 2) {
+        return 0;
+    }
 
-    case S_WAITRESP:
-        sa_rbuf[0] = c;
-        state = S_WAITLEN;
-        break;
+    if (buf[1] != 0x55) {
+        saStat.badpre++;
+        return -1;
+    }
 
-    case S_WAITLEN:
-        sa_rbuf[1] = c;
-        len = c;
+    if (len < 4) {
+        return 0;
+    }
 
-        if (len > SA_MAX_RCVLEN - 2) {
-            saStat.badlen++;
-            state = S_WAITPRE1;
-        } else if (len == 0) {
-            state = S_WAITCRC;
-        } else {
-            dlen = 0;
-            state = S_DATA;
-        }
-        break;
+    const int dataLen = buf[3];
+    if (dataLen > SA_MAX_RCVLEN - 2) {
+        saStat.badlen++;
+        return -1;
+    }
 
-    case S_DATA:
-        // XXX Should check buffer overflow (-> saerr_overflow)
-        sa_rbuf[2 + dlen] = c;
-        if (++dlen == len) {
-            state = S_WAITCRC;
-        }
-        break;
+    if (len < 5 + dataLen) {
+        return 0;
+    }
 
-    case S_WAITCRC:
-        if (CRC8(sa_rbuf, 2 + len) == c) {
-            // Got a response
-            saProcessResponse(sa_rbuf, len + 2);
-            saStat.pktrcvd++;
-        } else if (sa_rbuf[0] & 1) {
-            // Command echo
-            // XXX There is an exceptional case (V2 response)
-            // XXX Should check crc in the command format?
-        } else {
+    if (crc8_dvb_s2_update(0, &buf[2], 2 + dataLen) != buf[4 + dataLen]) {
+        // Command echoes have the CRC over the preamble too
+        // XXX There is an exceptional case (V2 response)
+        if ((buf[2] & 1) == 0) {
             saStat.crc++;
         }
-        state = S_WAITPRE1;
-        break;
+        return -1;
     }
+
+    return 5 + dataLen;
 }
 
-static void saSendFrame(uint8_t *buf, int len)
+static bool saIsResponse(uint8_t command, const uint8_t *frame, int len)
 {
-    if ( (vtxConfig()->smartAudioAltSoftSerialMethod && 
-          (smartAudioSerialPort->identifier == SERIAL_PORT_SOFTSERIAL1 || smartAudioSerialPort->identifier == SERIAL_PORT_SOFTSERIAL2))
-         == false) {
-        // TBS SA definition requires that the line is low before frame is sent
-        // (for both soft and hard serial). It can be done by sending first 0x00
-        serialWrite(smartAudioSerialPort, 0x00);
-    }
+    UNUSED(len);
 
-    for (int i = 0 ; i < len ; i++) {
-        serialWrite(smartAudioSerialPort, buf[i]);
-    }
+    const uint8_t resp = frame[2];
 
-    // XXX: Workaround for early AKK SAudio-enabled VTX bug,
-    // shouldn't cause any problems with VTX with properly
-    // implemented SAudio.
-	//Update: causes problem with new AKK AIO camera connected to SoftUART
-    if (vtxConfig()->smartAudioEarlyAkkWorkaroundEnable) serialWrite(smartAudioSerialPort, 0x00);
+    return resp == command ||
+        ((resp == SA_CMD_GET_SETTINGS_V2 || resp == SA_CMD_GET_SETTINGS_V21) && command == SA_CMD_GET_SETTINGS);
+}
 
-    sa_lastTransmissionMs = millis();
-    saStat.pktsent++;
+static void saProcessFrame(const uint8_t *frame, int len)
+{
+    saProcessResponse(&frame[2], len - 3);
 }
 
+static const vtxProtocol_t saProtocol = {
+    .decodeFrame = saDecodeFrame,
+    .isResponse = saIsResponse,
+    .processFrame = saProcessFrame,
+    .requestFailed = NULL,
+    .responseTimeoutMs = SMARTAUDIO_CMD_TIMEOUT,
+    .settleTimeMs = 0,
+    .maxRetries = SMARTAUDIO_CMD_RETRIES,
+    .baudMin = SMARTBAUD_MIN,
+    .baudMax = SMARTBAUD_MAX,
+    .baudStep = 50,
+};
+
 /*
- * Retransmission and command queuing
+ * Command queuing
  *
- *   The transport level support includes retransmission on response timeout
- * and command queueing.
+ *   Retransmission on response timeout, queueing and autobauding are done by
+ * the VTX transport (drivers/vtx_common.c); commands are queued as complete
+ * frames here.
  *
- * Resend buffer:
  *   The smartaudio returns response for valid command frames in no less
- * than 60msec, which we can't wait. So there's a need for a resend buffer.
- *
- * Command queueing:
- *   The driver autonomously sends GetSettings command for auto-bauding,
- * asynchronous to user initiated commands; commands issued while another
- * command is outstanding must be queued for later processing.
- *   The queueing also handles the case in which multiple commands are
- * required to implement a user level command.
+ * than 60msec. The driver autonomously sends GetSettings command for
+ * auto-bauding and for polling state changes, asynchronous to user
+ * initiated commands, and a user level command may need several commands.
  */
 
-// Retransmission
+static timeMs_t saLastCommandMs = 0;    // Last non-GET_SETTINGS queued
+static timeMs_t saLastPollMs = 0;
 
-static void saResendCmd(void)
+static void saQueueCmd(uint8_t cmd, const uint8_t *payload, uint8_t payloadLen, uint8_t flags)
 {
-    saSendFrame(sa_osbuf, sa_oslen);
-}
+    uint8_t frame[VTX_TRANSPORT_FRAME_SIZE];
+    uint8_t len = 0;
 
-static void saSendCmd(uint8_t *buf, int len)
-{
-    for (int i = 0 ; i < len ; i++) {
-        sa_osbuf[i] = buf[i];
+    if ( (vtxConfig()->smartAudioAltSoftSerialMethod &&
+          (smartAudioSerialPort->identifier == SERIAL_PORT_SOFTSERIAL1 || smartAudioSerialPort->identifier == SERIAL_PORT_SOFTSERIAL2))
+         == false) {
+        // TBS SA definition requires that the line is low before frame is sent
+        // (for both soft and hard serial). It can be done by sending first 0x00
+        frame[len++] = 0x00;
     }
 
-    sa_oslen = len;
-    sa_outstanding = (buf[2] >> 1);
-
-    saSendFrame(sa_osbuf, sa_oslen);
-}
-
-// Command queue management
+    const uint8_t frameStart = len;
+    frame[len++] = 0xAA;
+    frame[len++] = 0x55;
+    frame[len++] = SACMD(cmd);
+    frame[len++] = payloadLen;
+    memcpy(&frame[len], payload, payloadLen);
+    len += payloadLen;
+    frame[len] = crc8_dvb_s2_update(0, &frame[frameStart], len - frameStart);
+    len++;
 
-typedef struct saCmdQueue_s {
-    uint8_t *buf;
-    int len;
-} saCmdQueue_t;
-
-#define SA_QSIZE 6     // 1 heartbeat (GetSettings) + 2 commands + 1 slack
-static saCmdQueue_t sa_queue[SA_QSIZE];
-static uint8_t sa_qhead = 0;
-static uint8_t sa_qtail = 0;
-
-static bool saQueueEmpty(void)
-{
-    return sa_qhead == sa_qtail;
-}
-
-static bool saQueueFull(void)
-{
-    return ((sa_qhead + 1) % SA_QSIZE) == sa_qtail;
-}
-
-static void saQueueCmd(uint8_t *buf, int len)
-{
-    if (saQueueFull()) {
-         return;
+    // XXX: Workaround for early AKK SAudio-enabled VTX bug,
+    // shouldn't cause any problems with VTX with properly
+    // implemented SAudio.
+    //Update: causes problem with new AKK AIO camera connected to SoftUART
+    if (vtxConfig()->smartAudioEarlyAkkWorkaroundEnable) {
+        frame[len++] = 0x00;
     }
 
-    sa_queue[sa_qhead].buf = buf;
-    sa_queue[sa_qhead].len = len;
-    sa_qhead = (sa_qhead + 1) % SA_QSIZE;
-}
-
-static void saSendQueue(void)
-{
-    if (saQueueEmpty()) {
-         return;
+    if (cmd != SA_CMD_GET_SETTINGS) {
+        saLastCommandMs = millis();
+        // Settings are resent until the device takes them
+        flags |= VTX_TRANSACTION_PERSIST;
     }
 
-    saSendCmd(sa_queue[sa_qtail].buf, sa_queue[sa_qtail].len);
-    sa_qtail = (sa_qtail + 1) % SA_QSIZE;
+    vtxTransportQueue(&saTransport, cmd, frame, len, VTX_TRANSACTION_RESPONSE | flags);
 }
 
 // Individual commands
 
 static void saGetSettings(void)
 {
-    static uint8_t bufGetSettings[5] = {0xAA, 0x55, SACMD(SA_CMD_GET_SETTINGS), 0x00, 0x9F};
-
     LOG_DEBUG(VTX, "smartAudioGetSettings\r\n");
-    saQueueCmd(bufGetSettings, 5);
+    saQueueCmd(SA_CMD_GET_SETTINGS, NULL, 0, VTX_TRANSACTION_REPLACE);
+    saLastPollMs = millis();
 }
 
 void saSetFreq(uint16_t freq)
 {
-    static uint8_t buf[7] = { 0xAA, 0x55, SACMD(SA_CMD_SET_FREQ), 2 };
-    static uint8_t switchBuf[7];
-
     if (freq & SA_FREQ_GETPIT) {
         LOG_DEBUG(VTX, "smartAudioSetFreq: GETPIT");
     } else if (freq & SA_FREQ_SETPIT) {
@@ -612,24 +474,18 @@ void saSetFreq(uint16_t freq)
         LOG_DEBUG(VTX, "smartAudioSetFreq: SET %d", freq);
     }
 
-    buf[4] = (freq >> 8) & 0xff;
-    buf[5] = freq & 0xff;
-    buf[6] = CRC8(buf, 6);
-
     // Need to work around apparent SmartAudio bug when going from 'channel'
     // to 'user-freq' mode, where the set-freq command will fail if the freq
     // value is unchanged from the previous 'user-freq' mode
     if ((saDevice.mode & SA_MODE_GET_FREQ_BY_FREQ) == 0 && freq == saDevice.freq) {
-        memcpy(&switchBuf, &buf, sizeof(buf));
         const uint16_t switchFreq = freq + ((freq == VTX_SMARTAUDIO_MAX_FREQUENCY_MHZ) ? -1 : 1);
-        switchBuf[4] = (switchFreq >> 8);
-        switchBuf[5] = switchFreq & 0xff;
-        switchBuf[6] = CRC8(switchBuf, 6);
+        const uint8_t switchPayload[2] = { (switchFreq >> 8) & 0xff, switchFreq & 0xff };
 
-        saQueueCmd(switchBuf, 7);
+        saQueueCmd(SA_CMD_SET_FREQ, switchPayload, 2, 0);
     }
 
-    saQueueCmd(buf, 7);
+    const uint8_t payload[2] = { (freq >> 8) & 0xff, freq & 0xff };
+    saQueueCmd(SA_CMD_SET_FREQ, payload, 2, 0);
 }
 
 void saSetPitFreq(uint16_t freq)
@@ -645,21 +501,18 @@ static bool saValidateBandAndChannel(uint8_t band, uint8_t channel)
 
 void saSetBandAndChannel(uint8_t band, uint8_t channel)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_CHAN), 1 };
+    const uint8_t chval = SA_BANDCHAN_TO_DEVICE_CHVAL(band, channel);
 
-    buf[4] = SA_BANDCHAN_TO_DEVICE_CHVAL(band, channel);
-    buf[5] = CRC8(buf, 5);
-    LOG_DEBUG(VTX, "vtxSASetBandAndChannel set index band %d channel %d value sent 0x%x\r\n", band, channel, buf[4]);
+    LOG_DEBUG(VTX, "vtxSASetBandAndChannel set index band %d channel %d value sent 0x%x\r\n", band, channel, chval);
 
     //this will clear saDevice.mode & SA_MODE_GET_FREQ_BY_FREQ
-    saQueueCmd(buf, 6);
+    saQueueCmd(SA_CMD_SET_CHAN, &chval, 1, VTX_TRANSACTION_REPLACE);
 }
 
 void saSetMode(int mode)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_MODE), 1 };
+    const uint8_t modeval = (mode & 0x3f) | saLockMode;
 
-    buf[4] = (mode & 0x3f) | saLockMode;
     if (saDevice.version >= SA_2_1 && (mode & SA_MODE_CLR_PITMODE) &&
         ((mode & SA_MODE_SET_IN_RANGE_PITMODE) || (mode & SA_MODE_SET_OUT_RANGE_PITMODE))) {
         saDevice.willBootIntoPitMode = true;//quit pitmode without unsetting flag.
@@ -669,8 +522,7 @@ void saSetMode(int mode)
     LOG_DEBUG(VTX, "saSetMode(0x%x): pir=%s por=%s pitdsbl=%s %s\r\n", mode, (mode & 1) ? "on " : "off", (mode & 2) ? "on " : "off",
             (mode & 4)? "on " : "off", (mode & 8) ? "locked" : "unlocked");
 
-    buf[5] = CRC8(buf, 5);
-    saQueueCmd(buf, 6);
+    saQueueCmd(SA_CMD_SET_MODE, &modeval, 1, VTX_TRANSACTION_REPLACE);
 }
 
 bool vtxSmartAudioInit(void)
@@ -686,6 +538,7 @@ bool vtxSmartAudioInit(void)
         return false;
     }
 
+    vtxTransportInit(&saTransport, &saProtocol, smartAudioSerialPort, SMARTBAUD_MIN);
     vtxCommonSetDevice(&vtxSmartAudio);
 
     return true;
@@ -696,30 +549,47 @@ bool vtxSmartAudioInit(void)
 #define SA_INITPHASE_WAIT_PITFREQ  2 // SA_FREQ_GETPIT sent and waiting for reply.
 #define SA_INITPHASE_DONE          3
 
+static uint8_t saInitPhase = SA_INITPHASE_START;
+
+// True when vtxSAProcess() has an init step to take or a command to queue for it
+static bool saIsInitStepDue(void)
+{
+    switch (saInitPhase) {
+    case SA_INITPHASE_START:
+        return true;
+    case SA_INITPHASE_WAIT_SETTINGS:
+        return saDevice.version || vtxTransportIsIdle(&saTransport);
+    case SA_INITPHASE_WAIT_PITFREQ:
+        return saDevice.orfreq || vtxTransportIsIdle(&saTransport);
+    default:
+        return false;
+    }
+}
+
+static bool saIsPollDue(timeMs_t nowMs)
+{
+    return vtxTransportIsIdle(&saTransport) &&
+        (nowMs - saLastCommandMs < SMARTAUDIO_POLLING_WINDOW) && (nowMs - saLastPollMs >= SMARTAUDIO_POLLING_INTERVAL);
+}
+
 static void vtxSAProcess(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
 {
     UNUSED(vtxDevice);
     UNUSED(currentTimeUs);
 
-    static char initPhase = SA_INITPHASE_START;
-
     if (smartAudioSerialPort == NULL) {
         return;
     }
 
-    while (serialRxBytesWaiting(smartAudioSerialPort) > 0) {
-        uint8_t c = serialRead(smartAudioSerialPort);
-        saReceiveFramer((uint16_t)c);
-    }
+    timeMs_t nowMs = millis();             // Don't substitute with "currentTimeUs / 1000"; the transport timeouts are based on millis().
 
-    // Re-evaluate baudrate after each frame reception
-    saAutobaud();
+    // Receive, resend or send the next command
+    vtxTransportProcess(&saTransport, nowMs);
 
-    switch (initPhase) {
+    switch (saInitPhase) {
     case SA_INITPHASE_START:
         saGetSettings();
-        //saSendQueue();
-        initPhase = SA_INITPHASE_WAIT_SETTINGS;
+        saInitPhase = SA_INITPHASE_WAIT_SETTINGS;
         break;
 
     case SA_INITPHASE_WAIT_SETTINGS:
@@ -728,21 +598,27 @@ static void vtxSAProcess(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
         if (saDevice.version) {
             if (saDevice.version == SA_2_0) {
                 saSetFreq(SA_FREQ_GETPIT);
-                initPhase = SA_INITPHASE_WAIT_PITFREQ;
+                saInitPhase = SA_INITPHASE_WAIT_PITFREQ;
             } else {
-                initPhase = SA_INITPHASE_DONE;
+                saInitPhase = SA_INITPHASE_DONE;
             }
             if (saDevice.version >= SA_2_0 ) {
                 //did the device boot up in pit mode on its own?
                 saDevice.willBootIntoPitMode = (saDevice.mode & SA_MODE_GET_PITMODE) ? true : false;
                 LOG_DEBUG(VTX, "sainit: willBootIntoPitMode is %s\r\n", saDevice.willBootIntoPitMode ? "true" : "false");
             }
+        } else if (vtxTransportIsIdle(&saTransport)) {
+            // GetSettings was lost, keep asking
+            saGetSettings();
         }
         break;
 
     case SA_INITPHASE_WAIT_PITFREQ:
         if (saDevice.orfreq) {
-            initPhase = SA_INITPHASE_DONE;
+            saInitPhase = SA_INITPHASE_DONE;
+        } else if (vtxTransportIsIdle(&saTransport)) {
+            // GetPitFreq was lost, keep asking
+            saSetFreq(SA_FREQ_GETPIT);
         }
         break;
 
@@ -750,27 +626,32 @@ static void vtxSAProcess(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
         break;
     }
 
-    // Command queue control
+    // Poll for the state change after a command
+    if (saIsPollDue(nowMs)) {
+        saGetSettings();
+    }
+
+    // Commands queued above go out now rather than on the next call
+    vtxTransportProcess(&saTransport, nowMs);
 
-    timeMs_t nowMs = millis();             // Don't substitute with "currentTimeUs / 1000"; sa_lastTransmissionMs is based on millis().
-    static timeMs_t lastCommandSentMs = 0; // Last non-GET_SETTINGS sent
+    saStat.pktsent = saTransport.stats.sent;
+    saStat.pktrcvd = saTransport.stats.received;
+    saStat.ooopresp = saTransport.stats.unexpected;
+    sa_smartbaud = saTransport.baudRate;
+}
 
-    if ((sa_outstanding != SA_CMD_NONE) && (nowMs - sa_lastTransmissionMs > SMARTAUDIO_CMD_TIMEOUT)) {
-        // Last command timed out
-        // LOG_DEBUG(VTX, "process: resending 0x%x", sa_outstanding);
-        // XXX Todo: Resend termination and possible offline transition
-        saResendCmd();
-    lastCommandSentMs = nowMs;
-    } else if (!saQueueEmpty()) {
-        // Command pending. Send it.
-        // LOG_DEBUG(VTX, "process: sending queue");
-        saSendQueue();
-        lastCommandSentMs = nowMs;
-    } else if ((nowMs - lastCommandSentMs < SMARTAUDIO_POLLING_WINDOW) && (nowMs - sa_lastTransmissionMs >= SMARTAUDIO_POLLING_INTERVAL)) {
-    //LOG_DEBUG(VTX, "process: sending status change polling");
-    saGetSettings();
-    saSendQueue();
+static bool vtxSAIsProcessPending(const vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
+{
+    UNUSED(vtxDevice);
+    UNUSED(currentTimeUs);
+
+    if (smartAudioSerialPort == NULL) {
+        return false;
     }
+
+    const timeMs_t nowMs = millis();
+
+    return vtxTransportIsProcessPending(&saTransport, nowMs) || saIsPollDue(nowMs) || saIsInitStepDue();
 }
 
 // Interface to common VTX API
@@ -794,9 +675,9 @@ void vtxSASetBandAndChannel(vtxDevice_t *vtxDevice, uint8_t band, uint8_t channe
         saSetBandAndChannel(band - 1, channel - 1);
     }
 }
- static void vtxSASetPowerByIndex(vtxDevice_t *vtxDevice, uint8_t index)
+static void vtxSASetPowerByIndex(vtxDevice_t *vtxDevice, uint8_t index)
 {
-    static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_POWER), 1 };
+    uint8_t powerval = 0;
 
     if (!vtxSAIsReady(vtxDevice)) {
         return;
@@ -812,26 +693,25 @@ void vtxSASetBandAndChannel(vtxDevice_t *vtxDevice, uint8_t band, uint8_t channe
         return;
     }
 
-    LOG_DEBUG(VTX, "saSetPowerByIndex: index %d, value %d\r\n", index, buf[4]);
-
     index--;
     switch (saDevice.version) {
         case SA_1_0:
-            buf[4] = saPowerTable[index].dbi;
+            powerval = saPowerTable[index].dbi;
             break;
         case SA_2_0:
-            buf[4] = index;
+            powerval = index;
             break;
         case SA_2_1:
-            buf[4] = saPowerTable[index].dbi;
-            buf[4] |= 128; //set MSB to indicate set power by dbm
+            powerval = saPowerTable[index].dbi;
+            powerval |= 128; //set MSB to indicate set power by dbm
             break;
         default:
             break;
     }
 
-    buf[5] = CRC8(buf, 5);
-    saQueueCmd(buf, 6);
+    LOG_DEBUG(VTX, "saSetPowerByIndex: index %d, value %d\r\n", index + 1, powerval);
+
+    saQueueCmd(SA_CMD_SET_POWER, &powerval, 1, VTX_TRANSACTION_REPLACE);
 }
 
 static void vtxSASetPitMode(vtxDevice_t *vtxDevice, uint8_t onoff)
@@ -849,10 +729,8 @@ static void vtxSASetPitMode(vtxDevice_t *vtxDevice, uint8_t onoff)
         if (onoff) {
             // enable pitmode using SET_POWER command with 0 dbm.
             // This enables pitmode without causing the device to boot into pitmode next power-up
-            static uint8_t buf[6] = { 0xAA, 0x55, SACMD(SA_CMD_SET_POWER), 1 };
-            buf[4] = 0 | 128;
-            buf[5] = CRC8(buf, 5);
-            saQueueCmd(buf, 6);
+            const uint8_t powerval = 0 | 128;
+            saQueueCmd(SA_CMD_SET_POWER, &powerval, 1, VTX_TRANSACTION_REPLACE);
             LOG_DEBUG(VTX, "vtxSASetPitMode: set power to 0 dbm\r\n");
         } else {
             saSetMode(SA_MODE_CLR_PITMODE);
@@ -985,6 +863,7 @@ static const vtxVTable_t saVTable = {
     .getFrequency = vtxSAGetFreq,
     .getPower = vtxSAGetPower,
     .getOsdInfo = vtxSAGetOsdInfo,
+    .isProcessPending = vtxSAIsProcessPending,
 };
 
 
@@ -44,36 +44,27 @@
 #include "io/vtx_string.h"
 
 #define VTX_PKT_SIZE                16
-#define VTX_PROTO_STATE_TIMEOUT_MS  1000
+#define VTX_RESPONSE_TIMEOUT_MS     200     // Time until a query is considered lost
+#define VTX_QUERY_RETRIES           3       // Resends before giving up on a query
+#define VTX_SETTLE_TIME_MS          200     // Time for the VTX to apply a command before the next request
 #define VTX_STATUS_INTERVAL_MS      2000
 
-#define VTX_UPDATE_REQ_NONE         0x00
-#define VTX_UPDATE_REQ_FREQUENCY    0x01
-#define VTX_UPDATE_REQ_POWER        0x02
-#define VTX_UPDATE_REQ_PITMODE      0x04
+#define VTX_CMD_QUERY_CAPABILITIES  0x72
+#define VTX_CMD_QUERY_STATUS        0x76
+#define VTX_CMD_SET_FREQUENCY       0x46
+#define VTX_CMD_SET_POWER           0x50
+#define VTX_CMD_SET_PITMODE         0x73
 
 typedef enum {
-    VTX_STATE_RESET         = 0,
-    VTX_STATE_OFFILE        = 1,    // Not detected
-    VTX_STATE_DETECTING     = 2,    // 
-    VTX_STATE_IDLE          = 3,    // Idle, ready to sent commands
-    VTX_STATE_QUERY_DELAY   = 4,
-    VTX_STATE_QUERY_STATUS  = 5,
-    VTX_STATE_WAIT_STATUS   = 6,    // Wait for VTX state
+    VTX_STATE_OFFLINE       = 0,    // Not detected
+    VTX_STATE_DETECTING     = 1,    // Capabilities requested
+    VTX_STATE_ONLINE        = 2,    // Capabilities known, waiting for status
+    VTX_STATE_READY         = 3,    // Ready to send commands
 } vtxProtoState_e;
 
-typedef enum {
-    VTX_RESPONSE_TYPE_NONE,
-    VTX_RESPONSE_TYPE_CAPABILITIES,
-    VTX_RESPONSE_TYPE_STATUS,
-} vtxProtoResponseType_e;
-
 typedef struct {
     vtxProtoState_e protoState;
-    timeMs_t        lastStateChangeMs;
     timeMs_t        lastStatusQueryMs;
-    int             protoTimeoutCount;
-    unsigned        updateReqMask;
 
     // VTX capabilities
     struct {
@@ -107,10 +98,8 @@ typedef struct {
         const uint16_t * powerTablePtr;
     } metadata;
 
-    // Comms flags and state
-    uint8_t         sendPkt[VTX_PKT_SIZE];
-    uint8_t         recvPkt[VTX_PKT_SIZE];
-    unsigned        recvPtr;
+    // Comms
+    vtxTransport_t  transport;
     serialPort_t *  port;
 } vtxProtoState_t;
 
@@ -123,111 +112,95 @@ static bool trampIsValidResponseCode(uint8_t code)
     return (code == 'r' || code == 'v' || code == 's');
 }
 
-static bool vtxProtoRecv(void)
+// Frames are 0x0F, command or response code, 12 bytes of payload, a sum of
+// all but the sync byte and 0x00
+static int vtxProtoDecodeFrame(const uint8_t *buf, int len)
 {
-    uint8_t * bufPtr = (uint8_t*)&vtxState.recvPkt;
-    while (serialRxBytesWaiting(vtxState.port)) {
-        const uint8_t c = serialRead(vtxState.port);
-
-        if (vtxState.recvPtr == 0) {
-            // Wait for sync byte
-            if (c == 0x0F) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-        }
-        else if (vtxState.recvPtr == 1) {
-            // Check if we received a valid response code
-            if (trampIsValidResponseCode(c)) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
-            else {
-                vtxState.recvPtr = 0;
-            }
-        }
-        else {
-            // Consume character and check if we have got a full packet
-            if (vtxState.recvPtr < VTX_PKT_SIZE) {
-                bufPtr[vtxState.recvPtr++] = c;
-            }
+    if (buf[0] != 0x0F) {
+        return -1;
+    }
 
-            if (vtxState.recvPtr == VTX_PKT_SIZE) {
-                // Full packet received - validate packet, make sure it's the one we expect
-                const bool pktValid = ((bufPtr[14] == crc8_sum_update(0, &bufPtr[1], 13)) && (bufPtr[15] == 0));
+    if (len < 2) {
+        return 0;
+    }
 
-                if (!pktValid) {
-                    // Reset the receiver state - keep waiting
-                    vtxState.recvPtr = 0;
-                }
-                // Make sure it's not the echo one (half-duplex serial might receive it's own data)
-                else if (memcmp(&vtxState.recvPkt, &vtxState.sendPkt, VTX_PKT_SIZE) == 0) {
-                    vtxState.recvPtr = 0;
-                }
-                // Valid receive packet
-                else {
-                    return true;
-                }
-            }
-        }
+    if (!trampIsValidResponseCode(buf[1])) {
+        return -1;
     }
 
-    return false;
-}
+    if (len < VTX_PKT_SIZE) {
+        return 0;
+    }
 
-static void vtxProtoSend(uint8_t cmd, uint16_t param)
-{
-    // Craft the packet
-    memset(vtxState.sendPkt, 0, ARRAYLEN(vtxState.sendPkt));
-    vtxState.sendPkt[0] = 15;
-    vtxState.sendPkt[1] = cmd;
-    vtxState.sendPkt[2] = param & 0xff;
-    vtxState.sendPkt[3] = (param >> 8) & 0xff;
-    vtxState.sendPkt[14] = crc8_sum_update(0, &vtxState.sendPkt[1], 13);
-
-    // Send data 
-    serialWriteBuf(vtxState.port, (uint8_t *)&vtxState.sendPkt, sizeof(vtxState.sendPkt));
-
-    // Reset cmd response state
-    vtxState.recvPtr = 0;
+    if (buf[14] != crc8_sum_update(0, &buf[1], 13) || buf[15] != 0) {
+        return -1;
+    }
+
+    return VTX_PKT_SIZE;
 }
 
-static void vtxProtoSetState(vtxProtoState_e newState)
+static bool vtxProtoIsResponse(uint8_t command, const uint8_t *frame, int len)
 {
-    vtxState.lastStateChangeMs = millis();
-    vtxState.protoState = newState;
+    UNUSED(len);
+    return frame[1] == command;
 }
 
-static bool vtxProtoTimeout(void)
+static void vtxProtoSend(uint8_t cmd, uint16_t param, uint8_t flags)
 {
-    return (millis() - vtxState.lastStateChangeMs) > VTX_PROTO_STATE_TIMEOUT_MS;
+    // Craft the packet
+    uint8_t frame[VTX_PKT_SIZE];
+
+    memset(frame, 0, sizeof(frame));
+    frame[0] = 15;
+    frame[1] = cmd;
+    frame[2] = param & 0xff;
+    frame[3] = (param >> 8) & 0xff;
+    frame[14] = crc8_sum_update(0, &frame[1], 13);
+
+    vtxTransportQueue(&vtxState.transport, cmd, frame, sizeof(frame), flags | VTX_TRANSACTION_REPLACE);
 }
 
 static void vtxProtoQueryCapabilities(void)
 {
-    vtxProtoSend(0x72, 0);
+    vtxProtoSend(VTX_CMD_QUERY_CAPABILITIES, 0, VTX_TRANSACTION_RESPONSE);
+    vtxState.protoState = VTX_STATE_DETECTING;
 }
 
 static void vtxProtoQueryStatus(void)
 {
-    vtxProtoSend(0x76, 0);
+    vtxProtoSend(VTX_CMD_QUERY_STATUS, 0, VTX_TRANSACTION_RESPONSE);
     vtxState.lastStatusQueryMs = millis();
 }
 
-/*
-static void vtxProtoQueryTemperature(void)
+// The VTX doesn't answer commands, the status query after one confirms it
+
+static void vtxProtoSetPitMode(uint16_t mode)
+{
+    vtxProtoSend(VTX_CMD_SET_PITMODE, mode, 0);
+    vtxProtoQueryStatus();
+}
+
+static void vtxProtoSetPower(uint16_t power)
+{
+    vtxProtoSend(VTX_CMD_SET_POWER, power, 0);
+    vtxProtoQueryStatus();
+}
+
+static void vtxProtoSetFrequency(uint16_t freq)
 {
-    vtxProtoSend('s', 0);
+    vtxProtoSend(VTX_CMD_SET_FREQUENCY, freq, 0);
+    vtxProtoQueryStatus();
 }
-*/
 
-static vtxProtoResponseType_e vtxProtoProcessResponse(void)
+static void vtxProtoProcessFrame(const uint8_t *frame, int len)
 {
-    const uint8_t respCode = vtxState.recvPkt[1];
+    UNUSED(len);
 
-    switch (respCode) {
-        case 0x72:
-            vtxState.capabilities.freqMin = vtxState.recvPkt[2] | (vtxState.recvPkt[3] << 8);
-            vtxState.capabilities.freqMax = vtxState.recvPkt[4] | (vtxState.recvPkt[5] << 8);
-            vtxState.capabilities.powerMax = vtxState.recvPkt[6] | (vtxState.recvPkt[7] << 8);
+    switch (frame[1]) {
+        case VTX_CMD_QUERY_CAPABILITIES:
+            vtxState.capabilities.freqMin = frame[2] | (frame[3] << 8);
+            vtxState.capabilities.freqMax = frame[4] | (frame[5] << 8);
+            vtxState.capabilities.powerMax = frame[6] | (frame[7] << 8);
 
             if (vtxState.capabilities.freqMin != 0 && vtxState.capabilities.freqMin < vtxState.capabilities.freqMax) {
                 // Some TRAMP VTXes may report max power incorrectly (i.e. 200mW for a 600mW VTX)
@@ -239,39 +212,63 @@ static vtxProtoResponseType_e vtxProtoProcessResponse(void)
                 // Update max power metadata so OSD settings would match VTX capabilities
                 vtxProtoUpdatePowerMetadata(vtxState.capabilities.powerMax);
 
-                return VTX_RESPONSE_TYPE_CAPABILITIES;
+                // VTX sent capabilities. Query status now
+                if (vtxState.protoState < VTX_STATE_ONLINE) {
+                    vtxState.protoState = VTX_STATE_ONLINE;
+                    vtxProtoQueryStatus();
+                }
             }
             break;
 
-        case 0x76:
-            vtxState.state.freq = vtxState.recvPkt[2] | (vtxState.recvPkt[3] << 8);
-            vtxState.state.power = vtxState.recvPkt[4]|(vtxState.recvPkt[5] << 8);
-            vtxState.state.pitMode = vtxState.recvPkt[7];
-            //vtxState.state.power = vtxState.recvPkt[8]|(vtxState.recvPkt[9] << 8);
-            return VTX_RESPONSE_TYPE_STATUS;
-    }
+        case VTX_CMD_QUERY_STATUS:
+            vtxState.state.freq = frame[2] | (frame[3] << 8);
+            vtxState.state.power = frame[4] | (frame[5] << 8);
+            vtxState.state.pitMode = frame[7];
 
-    return VTX_RESPONSE_TYPE_NONE;
-}
+            if (vtxState.protoState >= VTX_STATE_ONLINE) {
+                // Resend what the VTX didn't apply
+                if (vtxState.request.freq && vtxState.state.freq != vtxState.request.freq) {
+                    vtxProtoSetFrequency(vtxState.request.freq);
+                }
 
-static void vtxProtoSetPitMode(uint16_t mode)
-{
-    vtxProtoSend(0x73, mode);
+                if (vtxState.request.power && vtxState.state.power != vtxState.request.power) {
+                    vtxProtoSetPower(vtxState.request.power);
+                }
+
+                vtxState.protoState = VTX_STATE_READY;
+            }
+            break;
+    }
 }
 
-static void vtxProtoSetPower(uint16_t power)
+static void vtxProtoRequestFailed(uint8_t command)
 {
-    vtxProtoSend(0x50, power);
+    if (command == VTX_CMD_QUERY_CAPABILITIES || command == VTX_CMD_QUERY_STATUS) {
+        // VTX lost or not there yet, detect it again
+        vtxState.protoState = VTX_STATE_OFFLINE;
+    }
 }
 
-static void vtxProtoSetFrequency(uint16_t freq)
+static const vtxProtocol_t vtxProtocol = {
+    .decodeFrame = vtxProtoDecodeFrame,
+    .isResponse = vtxProtoIsResponse,
+    .processFrame = vtxProtoProcessFrame,
+    .requestFailed = vtxProtoRequestFailed,
+    .responseTimeoutMs = VTX_RESPONSE_TIMEOUT_MS,
+    .settleTimeMs = VTX_SETTLE_TIME_MS,
+    .maxRetries = VTX_QUERY_RETRIES,
+    .baudStep = 0,
+};
+
+static bool vtxProtoIsStatusDue(timeMs_t nowMs)
 {
-    vtxProtoSend(0x46, freq);
+    return vtxState.protoState == VTX_STATE_OFFLINE ||
+        (vtxState.protoState >= VTX_STATE_ONLINE && (nowMs - vtxState.lastStatusQueryMs) > VTX_STATUS_INTERVAL_MS);
 }
 
 static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
 {
-    // Glue function betwen VTX VTable and actual driver protothread
+    // Glue function betwen VTX VTable and the transport
     UNUSED(vtxDevice);
     UNUSED(currentTimeUs);
 
@@ -279,113 +276,35 @@ static void impl_Process(vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
         return;
     }
 
-    switch((int)vtxState.protoState) {
-        case VTX_STATE_RESET:
-            vtxState.protoTimeoutCount = 0;
-            vtxState.updateReqMask = VTX_UPDATE_REQ_NONE;
-            vtxProtoSetState(VTX_STATE_OFFILE);
-            break;
-
-        // Send request for capabilities
-        case VTX_STATE_OFFILE:
-            vtxProtoQueryCapabilities();
-            vtxProtoSetState(VTX_STATE_DETECTING);
-            break;
-
-        // Detect VTX. We only accept VTX_RESPONSE_TYPE_CAPABILITIES here
-        case VTX_STATE_DETECTING:
-            if (vtxProtoRecv()) {
-                if (vtxProtoProcessResponse() == VTX_RESPONSE_TYPE_CAPABILITIES) {
-                    // VTX sent capabilities. Query status now
-                    vtxState.protoTimeoutCount = 0;
-                    vtxProtoSetState(VTX_STATE_QUERY_STATUS);
-                }
-                else {
-                    // Unexpected response. Re-initialize
-                    vtxProtoSetState(VTX_STATE_RESET);
-                }
-            }
-            else if (vtxProtoTimeout()) {
-                // Time-out while waiting for capabilities. Reset the state
-                vtxProtoSetState(VTX_STATE_RESET);
-            }
-            break;
+    const timeMs_t nowMs = millis();
 
-        // Send requests to update freqnecy and power, periodically poll device for liveness
-        case VTX_STATE_IDLE:
-            if (vtxState.updateReqMask != VTX_UPDATE_REQ_NONE) {
-                // Updates pending. Send an appropriate command
-                if (vtxState.updateReqMask & VTX_UPDATE_REQ_PITMODE) {
-                    // Only disabling PIT mode supported
-                    vtxState.updateReqMask &= ~VTX_UPDATE_REQ_PITMODE;
-                    vtxProtoSetPitMode(0);
-                    vtxProtoSetState(VTX_STATE_QUERY_DELAY);
-                }
-                else if (vtxState.updateReqMask & VTX_UPDATE_REQ_FREQUENCY) {
-                    vtxState.updateReqMask &= ~VTX_UPDATE_REQ_FREQUENCY;
-                    vtxProtoSetFrequency(vtxState.request.freq);
-                    vtxProtoSetState(VTX_STATE_QUERY_DELAY);
-                }
-                else if (vtxState.updateReqMask & VTX_UPDATE_REQ_POWER) {
-                    vtxState.updateReqMask &= ~VTX_UPDATE_REQ_POWER;
-                    vtxProtoSetPower(vtxState.request.power);
-                    vtxProtoSetState(VTX_STATE_QUERY_DELAY);
-                }
-            }
-            else if ((millis() - vtxState.lastStatusQueryMs) > VTX_STATUS_INTERVAL_MS) {
-                // Poll VTX for status updates
-                vtxProtoSetState(VTX_STATE_QUERY_STATUS);
-            }
-            break;
+    vtxTransportProcess(&vtxState.transport, nowMs);
 
-        case VTX_STATE_QUERY_DELAY:
-            // We get here after sending the command. We give VTX some time to process the command
-            // and switch to VTX_STATE_QUERY_STATUS
-            if (vtxProtoTimeout()) {
-                // We gave VTX some time to process the command. Query status to confirm success
-                vtxProtoSetState(VTX_STATE_QUERY_STATUS);
-            }
-            break;
-
-        case VTX_STATE_QUERY_STATUS:
-            // Just query status, nothing special
+    if (vtxTransportIsIdle(&vtxState.transport) && vtxProtoIsStatusDue(nowMs)) {
+        if (vtxState.protoState == VTX_STATE_OFFLINE) {
+            // Send request for capabilities
+            vtxProtoQueryCapabilities();
+        } else {
+            // Poll VTX for status updates
             vtxProtoQueryStatus();
-            vtxProtoSetState(VTX_STATE_WAIT_STATUS);
-            break;
+        }
+        vtxTransportProcess(&vtxState.transport, nowMs);
+    }
+}
 
-        case VTX_STATE_WAIT_STATUS:
-            if (vtxProtoRecv()) {
-                vtxState.protoTimeoutCount = 0;
+static bool impl_IsProcessPending(const vtxDevice_t *vtxDevice, timeUs_t currentTimeUs)
+{
+    UNUSED(vtxDevice);
+    UNUSED(currentTimeUs);
 
-                if (vtxProtoProcessResponse() == VTX_RESPONSE_TYPE_STATUS) {
-                    // Check if VTX state matches VTX request
-                    if (!(vtxState.updateReqMask & VTX_UPDATE_REQ_FREQUENCY) && (vtxState.state.freq != vtxState.request.freq)) {
-                        vtxState.updateReqMask |= VTX_UPDATE_REQ_FREQUENCY;
-                    }
+    if (!vtxState.port) {
+        return false;
+    }
 
-                    if (!(vtxState.updateReqMask & VTX_UPDATE_REQ_POWER) && (vtxState.state.power != vtxState.request.power)) {
-                        vtxState.updateReqMask |= VTX_UPDATE_REQ_POWER;
-                    }
+    const timeMs_t nowMs = millis();
 
-                    // We got the status response - proceed to IDLE
-                    vtxProtoSetState(VTX_STATE_IDLE);
-                }
-                else {
-                    // Unexpected response. Query for STATUS again
-                    vtxProtoSetState(VTX_STATE_QUERY_STATUS);
-                }
-            }
-            else if (vtxProtoTimeout()) {
-                vtxState.protoTimeoutCount++;
-                if (vtxState.protoTimeoutCount > 3) {
-                    vtxProtoSetState(VTX_STATE_RESET);
-                }
-                else {
-                    vtxProtoSetState(VTX_STATE_QUERY_STATUS);
-                }
-            }
-            break;
-    }
+    return vtxTransportIsProcessPending(&vtxState.transport, nowMs) ||
+        (vtxTransportIsIdle(&vtxState.transport) && vtxProtoIsStatusDue(nowMs));
 }
 
 static vtxDevType_e impl_GetDeviceType(const vtxDevice_t *vtxDevice)
@@ -396,7 +315,7 @@ static vtxDevType_e impl_GetDeviceType(const vtxDevice_t *vtxDevice)
 
 static bool impl_IsReady(const vtxDevice_t *vtxDevice)
 {
-    return vtxDevice != NULL && vtxState.port != NULL && vtxState.protoState >= VTX_STATE_IDLE;
+    return vtxDevice != NULL && vtxState.port != NULL && vtxState.protoState >= VTX_STATE_READY;
 }
 
 static void impl_SetBandAndChannel(vtxDevice_t * vtxDevice, uint8_t band, uint8_t channel)
@@ -422,7 +341,7 @@ static void impl_SetBandAndChannel(vtxDevice_t * vtxDevice, uint8_t band, uint8_
     vtxState.request.band = band;
     vtxState.request.channel = channel;
     vtxState.request.freq = newFreqMhz;
-    vtxState.updateReqMask |= VTX_UPDATE_REQ_FREQUENCY;
+    vtxProtoSetFrequency(newFreqMhz);
 }
 
 static void impl_SetPowerByIndex(vtxDevice_t * vtxDevice, uint8_t index)
@@ -439,15 +358,16 @@ static void impl_SetPowerByIndex(vtxDevice_t * vtxDevice, uint8_t index)
     vtxState.request.power = MIN(reqPower, vtxState.capabilities.powerMax);
     vtxState.request.powerIndex = index;
 
-    vtxState.updateReqMask |= VTX_UPDATE_REQ_POWER;
+    vtxProtoSetPower(vtxState.request.power);
 }
 
 static void impl_SetPitMode(vtxDevice_t *vtxDevice, uint8_t onoff)
 {
     UNUSED(vtxDevice);
 
+    // Only disabling PIT mode supported
     if (onoff == 0) {
-        vtxState.updateReqMask |= VTX_UPDATE_REQ_PITMODE;
+        vtxProtoSetPitMode(0);
     }
 }
 
@@ -548,6 +468,7 @@ static const vtxVTable_t impl_vtxVTable = {
     .getFrequency = impl_GetFreq,
     .getPower = impl_GetPower,
     .getOsdInfo = impl_GetOsdInfo,
+    .isProcessPending = impl_IsProcessPending,
 };
 
 static vtxDevice_t impl_vtxDevice = {
@@ -637,6 +558,8 @@ static void vtxProtoUpdatePowerMetadata(uint16_t maxPower)
 
 bool vtxTrampInit(void)
 {
+    memset(&vtxState, 0, sizeof(vtxState));
+
     serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_VTX_TRAMP);
 
     if (portConfig) {
@@ -653,7 +576,8 @@ bool vtxTrampInit(void)
     vtxProtoUpdatePowerMetadata(600);
     vtxCommonSetDevice(&impl_vtxDevice);
 
-    vtxState.protoState = VTX_STATE_RESET;
+    vtxTransportInit(&vtxState.transport, &vtxProtocol, vtxState.port, 9600);
+    vtxState.protoState = VTX_STATE_OFFLINE;
 
     return true;
 }
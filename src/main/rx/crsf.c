@@ -32,7 +32,6 @@
 
 #include "drivers/time.h"
 #include "drivers/serial.h"
-#include "drivers/serial_uart.h"
 
 #include "io/serial.h"
 #include "io/osd.h"
@@ -43,19 +42,31 @@
 #include "telemetry/crsf.h"
 #define CRSF_TIME_NEEDED_PER_FRAME_US   1100 // 700 ms + 400 ms for potential ad-hoc request
 #define CRSF_TIME_BETWEEN_FRAMES_US     6667 // At fastest, frames are sent by the transmitter every 6.667 milliseconds, 150 Hz
+#define CRSF_TIME_PER_BYTE_US           24   // 10 bits at 420000 baud, used to date the bytes of a chunk
 
 #define CRSF_DIGITAL_CHANNEL_MIN 172
 #define CRSF_DIGITAL_CHANNEL_MAX 1811
 #define CRSF_PAYLOAD_OFFSET offsetof(crsfFrameDef_t, type)
 #define CRSF_POWER_COUNT 9
 
-STATIC_UNIT_TESTED bool crsfFrameDone = false;
+// Frame being assembled by the parser
 STATIC_UNIT_TESTED crsfFrame_t crsfFrame;
 
+// Payloads of the latest valid RC channels and link statistics frames,
+// kept apart so a link statistics frame can't replace unprocessed channels
+STATIC_UNIT_TESTED uint8_t crsfChannelsPayload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE];
+STATIC_UNIT_TESTED uint8_t crsfLinkStatisticsPayload[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE];
+static volatile bool crsfChannelsPending = false;
+static volatile bool crsfLinkStatisticsPending = false;
+static volatile timeUs_t crsfChannelsReceivedAt = 0;
+static timeUs_t crsfChannelsFrameTimeUs = 0;
+
 STATIC_UNIT_TESTED uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
 
 static serialPort_t *serialPort;
 static timeUs_t crsfFrameStartAt = 0;
+static uint8_t crsfFramePosition = 0;
+static uint8_t crsfFrameCrc = 0;
 static uint8_t telemetryBuf[CRSF_FRAME_SIZE_MAX];
 static uint8_t telemetryBufLen = 0;
 
@@ -125,142 +136,173 @@ typedef struct crsfPayloadLinkStatistics_s {
 
 typedef struct crsfPayloadLinkStatistics_s crsfPayloadLinkStatistics_t;
 
-STATIC_UNIT_TESTED uint8_t crsfFrameCRC(void)
+// Called when the last byte of a frame with a valid CRC has been received
+static void crsfFrameReceived(timeUs_t lastByteAt)
+{
+    const uint8_t payloadLength = crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC;
+
+    switch (crsfFrame.frame.type) {
+        case CRSF_FRAMETYPE_RC_CHANNELS_PACKED:
+            if (payloadLength == CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE) {
+                memcpy(crsfChannelsPayload, crsfFrame.frame.payload, CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE);
+                crsfChannelsReceivedAt = lastByteAt;
+                crsfChannelsPending = true;
+            }
+            break;
+        case CRSF_FRAMETYPE_LINK_STATISTICS:
+            if (payloadLength == CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE) {
+                memcpy(crsfLinkStatisticsPayload, crsfFrame.frame.payload, CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE);
+                crsfLinkStatisticsPending = true;
+            }
+            break;
+#if defined(USE_MSP_OVER_TELEMETRY)
+        case CRSF_FRAMETYPE_MSP_REQ:
+        case CRSF_FRAMETYPE_MSP_WRITE: {
+            uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
+            if (bufferCrsfMspFrame(frameStart, CRSF_FRAME_RX_MSP_FRAME_SIZE)) {
+                crsfScheduleMspResponse();
+            }
+            break;
+        }
+#endif
+        default:
+            break;
+    }
+}
+
+/*
+ * Feeds a run of received bytes to the frame parser. lastByteAt is the
+ * capture time of the last byte, the other bytes are dated back from it at
+ * the nominal byte time. The CRC is updated as bytes arrive, so completed
+ * frames are checked without another pass over them.
+ */
+STATIC_UNIT_TESTED void crsfParseBytes(const uint8_t *data, int len, timeUs_t lastByteAt)
 {
-    // CRC includes type and payload
-    uint8_t crc = crc8_dvb_s2(0, crsfFrame.frame.type);
-    for (int ii = 0; ii < crsfFrame.frame.frameLength - CRSF_FRAME_LENGTH_TYPE_CRC; ++ii) {
-        crc = crc8_dvb_s2(crc, crsfFrame.frame.payload[ii]);
+    for (int i = 0; i < len; i++) {
+        const uint8_t c = data[i];
+        const timeUs_t byteAt = lastByteAt - (timeUs_t)(len - 1 - i) * CRSF_TIME_PER_BYTE_US;
+
+        if (cmpTimeUs(byteAt, crsfFrameStartAt) > CRSF_TIME_NEEDED_PER_FRAME_US) {
+            // We've received a character after max time needed to complete a frame,
+            // so this must be the start of a new frame.
+            crsfFramePosition = 0;
+        }
+
+        if (crsfFramePosition == 0) {
+            crsfFrameStartAt = byteAt;
+        }
+
+        crsfFrame.bytes[crsfFramePosition++] = c;
+
+        if (crsfFramePosition <= CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH) {
+            // Address and frame length aren't covered by the CRC
+            if (crsfFramePosition == CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH) {
+                const uint8_t frameLength = crsfFrame.frame.frameLength;
+                if (frameLength < CRSF_FRAME_LENGTH_TYPE_CRC || frameLength > CRSF_FRAME_SIZE_MAX - CRSF_FRAME_LENGTH_ADDRESS - CRSF_FRAME_LENGTH_FRAMELENGTH) {
+                    // Can't be a frame, wait for the next one
+                    crsfFramePosition = 0;
+                }
+                crsfFrameCrc = 0;
+            }
+            continue;
+        }
+
+        // full frame length includes the length of the address and framelength fields
+        const int fullFrameLength = crsfFrame.frame.frameLength + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
+
+        if (crsfFramePosition < fullFrameLength) {
+            // CRC includes type and payload
+            crsfFrameCrc = crc8_dvb_s2(crsfFrameCrc, c);
+        } else {
+            crsfFramePosition = 0;
+            if (crsfFrameCrc == c) {
+                crsfFrameReceived(byteAt);
+            }
+        }
     }
-    return crc;
 }
 
 // Receive ISR callback, called back from serial port
-STATIC_UNIT_TESTED void crsfDataReceive(uint16_t c, void *rxCallbackData)
+static void crsfDataReceive(uint16_t c, void *rxCallbackData)
 {
     UNUSED(rxCallbackData);
 
-    static uint8_t crsfFramePosition = 0;
+    const uint8_t byte = c;
     const timeUs_t now = micros();
 
 #ifdef DEBUG_CRSF_PACKETS
     debug[2] = now - crsfFrameStartAt;
 #endif
 
-    if (now > crsfFrameStartAt + CRSF_TIME_NEEDED_PER_FRAME_US) {
-        // We've received a character after max time needed to complete a frame,
-        // so this must be the start of a new frame.
-        crsfFramePosition = 0;
-    }
-
-    if (crsfFramePosition == 0) {
-        crsfFrameStartAt = now;
-    }
-    // assume frame is 5 bytes long until we have received the frame length
-    // full frame length includes the length of the address and framelength fields
-    const int fullFrameLength = crsfFramePosition < 3 ? 5 : crsfFrame.frame.frameLength + CRSF_FRAME_LENGTH_ADDRESS + CRSF_FRAME_LENGTH_FRAMELENGTH;
-
-    if (crsfFramePosition < fullFrameLength) {
-        crsfFrame.bytes[crsfFramePosition++] = (uint8_t)c;
-        crsfFrameDone = crsfFramePosition < fullFrameLength ? false : true;
-        if (crsfFrameDone) {
-            crsfFramePosition = 0;
-            if (crsfFrame.frame.type != CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
-                const uint8_t crc = crsfFrameCRC();
-                if (crc == crsfFrame.bytes[fullFrameLength - 1]) {
-                    switch (crsfFrame.frame.type)
-                    {
-#if defined(USE_MSP_OVER_TELEMETRY)
-                        case CRSF_FRAMETYPE_MSP_REQ:
-                        case CRSF_FRAMETYPE_MSP_WRITE: {
-                            uint8_t *frameStart = (uint8_t *)&crsfFrame.frame.payload + CRSF_FRAME_ORIGIN_DEST_SIZE;
-                            if (bufferCrsfMspFrame(frameStart, CRSF_FRAME_RX_MSP_FRAME_SIZE)) {
-                                crsfScheduleMspResponse();
-                            }
-                            break;
-                        }
-#endif
-                        default:
-                            break;
-                    }
-                }
-            }
-        }
-    }
+    crsfParseBytes(&byte, 1, now);
 }
 
 STATIC_UNIT_TESTED uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig)
 {
     UNUSED(rxRuntimeConfig);
 
-    if (crsfFrameDone) {
-        crsfFrameDone = false;
-        if (crsfFrame.frame.type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
-            // CRC includes type and payload of each frame
-            const uint8_t crc = crsfFrameCRC();
-            if (crc != crsfFrame.frame.payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE]) {
-                return RX_FRAME_PENDING;
-            }
-            crsfFrame.frame.frameLength = CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
-
-            // unpack the RC channels
-            const crsfPayloadRcChannelsPacked_t* rcChannels = (crsfPayloadRcChannelsPacked_t*)&crsfFrame.frame.payload;
-            crsfChannelData[0] = rcChannels->chan0;
-            crsfChannelData[1] = rcChannels->chan1;
-            crsfChannelData[2] = rcChannels->chan2;
-            crsfChannelData[3] = rcChannels->chan3;
-            crsfChannelData[4] = rcChannels->chan4;
-            crsfChannelData[5] = rcChannels->chan5;
-            crsfChannelData[6] = rcChannels->chan6;
-            crsfChannelData[7] = rcChannels->chan7;
-            crsfChannelData[8] = rcChannels->chan8;
-            crsfChannelData[9] = rcChannels->chan9;
-            crsfChannelData[10] = rcChannels->chan10;
-            crsfChannelData[11] = rcChannels->chan11;
-            crsfChannelData[12] = rcChannels->chan12;
-            crsfChannelData[13] = rcChannels->chan13;
-            crsfChannelData[14] = rcChannels->chan14;
-            crsfChannelData[15] = rcChannels->chan15;
-            return RX_FRAME_COMPLETE;
-        }
-        else if (crsfFrame.frame.type == CRSF_FRAMETYPE_LINK_STATISTICS) {
-            // CRC includes type and payload of each frame
-            const uint8_t crc = crsfFrameCRC();
-            if (crc != crsfFrame.frame.payload[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE]) {
-                return RX_FRAME_PENDING;
-            }
-            crsfFrame.frame.frameLength = CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE + CRSF_FRAME_LENGTH_TYPE_CRC;
+    if (crsfLinkStatisticsPending) {
+        crsfLinkStatisticsPending = false;
 
-            const crsfPayloadLinkStatistics_t* linkStats = (crsfPayloadLinkStatistics_t*)&crsfFrame.frame.payload;
-            const uint8_t crsftxpowerindex = (linkStats->uplinkTXPower < CRSF_POWER_COUNT) ? linkStats->uplinkTXPower : 0;
+        const crsfPayloadLinkStatistics_t* linkStats = (crsfPayloadLinkStatistics_t*)crsfLinkStatisticsPayload;
+        const uint8_t crsftxpowerindex = (linkStats->uplinkTXPower < CRSF_POWER_COUNT) ? linkStats->uplinkTXPower : 0;
 
-            rxLinkStatistics.uplinkRSSI = -1* (linkStats->activeAntenna ? linkStats->uplinkRSSIAnt2 : linkStats->uplinkRSSIAnt1);
-            rxLinkStatistics.uplinkLQ = linkStats->uplinkLQ;
-            rxLinkStatistics.uplinkSNR = linkStats->uplinkSNR;
-            rxLinkStatistics.rfMode = linkStats->rfMode;
-            rxLinkStatistics.uplinkTXPower = crsfTxPowerStatesmW[crsftxpowerindex];
-            rxLinkStatistics.activeAntenna = linkStats->activeAntenna;
+        rxLinkStatistics.uplinkRSSI = -1* (linkStats->activeAntenna ? linkStats->uplinkRSSIAnt2 : linkStats->uplinkRSSIAnt1);
+        rxLinkStatistics.uplinkLQ = linkStats->uplinkLQ;
+        rxLinkStatistics.uplinkSNR = linkStats->uplinkSNR;
+        rxLinkStatistics.rfMode = linkStats->rfMode;
+        rxLinkStatistics.uplinkTXPower = crsfTxPowerStatesmW[crsftxpowerindex];
+        rxLinkStatistics.activeAntenna = linkStats->activeAntenna;
 
 #ifdef USE_OSD
-            if (rxLinkStatistics.uplinkLQ > 0) {
-                int16_t uplinkStrength;   // RSSI dBm converted to %
-                uplinkStrength = constrain((100 * sq((osdConfig()->rssi_dbm_max - osdConfig()->rssi_dbm_min)) - (100 * sq((osdConfig()->rssi_dbm_max  - rxLinkStatistics.uplinkRSSI)))) / sq((osdConfig()->rssi_dbm_max - osdConfig()->rssi_dbm_min)),0,100);
-                if (rxLinkStatistics.uplinkRSSI >= osdConfig()->rssi_dbm_max )
-                    uplinkStrength = 99;
-                else if (rxLinkStatistics.uplinkRSSI < osdConfig()->rssi_dbm_min)
-                    uplinkStrength = 0;
-                lqTrackerSet(rxRuntimeConfig->lqTracker, scaleRange(uplinkStrength, 0, 99, 0, RSSI_MAX_VALUE));
-            } else {
-                lqTrackerSet(rxRuntimeConfig->lqTracker, 0);
-            }
-#endif
-            // This is not RC channels frame, update channel value but don't indicate frame completion
-            return RX_FRAME_PENDING;
+        if (rxLinkStatistics.uplinkLQ > 0) {
+            int16_t uplinkStrength;   // RSSI dBm converted to %
+            uplinkStrength = constrain((100 * sq((osdConfig()->rssi_dbm_max - osdConfig()->rssi_dbm_min)) - (100 * sq((osdConfig()->rssi_dbm_max  - rxLinkStatistics.uplinkRSSI)))) / sq((osdConfig()->rssi_dbm_max - osdConfig()->rssi_dbm_min)),0,100);
+            if (rxLinkStatistics.uplinkRSSI >= osdConfig()->rssi_dbm_max )
+                uplinkStrength = 99;
+            else if (rxLinkStatistics.uplinkRSSI < osdConfig()->rssi_dbm_min)
+                uplinkStrength = 0;
+            lqTrackerSet(rxRuntimeConfig->lqTracker, scaleRange(uplinkStrength, 0, 99, 0, RSSI_MAX_VALUE));
+        } else {
+            lqTrackerSet(rxRuntimeConfig->lqTracker, 0);
         }
+#endif
+        // Link statistics alone update the channel values but don't indicate frame completion
+    }
+
+    if (crsfChannelsPending) {
+        crsfChannelsPending = false;
+        crsfChannelsFrameTimeUs = crsfChannelsReceivedAt;
+
+        // unpack the RC channels
+        const crsfPayloadRcChannelsPacked_t* rcChannels = (crsfPayloadRcChannelsPacked_t*)crsfChannelsPayload;
+        crsfChannelData[0] = rcChannels->chan0;
+        crsfChannelData[1] = rcChannels->chan1;
+        crsfChannelData[2] = rcChannels->chan2;
+        crsfChannelData[3] = rcChannels->chan3;
+        crsfChannelData[4] = rcChannels->chan4;
+        crsfChannelData[5] = rcChannels->chan5;
+        crsfChannelData[6] = rcChannels->chan6;
+        crsfChannelData[7] = rcChannels->chan7;
+        crsfChannelData[8] = rcChannels->chan8;
+        crsfChannelData[9] = rcChannels->chan9;
+        crsfChannelData[10] = rcChannels->chan10;
+        crsfChannelData[11] = rcChannels->chan11;
+        crsfChannelData[12] = rcChannels->chan12;
+        crsfChannelData[13] = rcChannels->chan13;
+        crsfChannelData[14] = rcChannels->chan14;
+        crsfChannelData[15] = rcChannels->chan15;
+        return RX_FRAME_COMPLETE;
     }
+
     return RX_FRAME_PENDING;
 }
 
+STATIC_UNIT_TESTED timeUs_t crsfFrameTimeUs(void)
+{
+    return crsfChannelsFrameTimeUs;
+}
+
 STATIC_UNIT_TESTED uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
 {
     UNUSED(rxRuntimeConfig);
@@ -275,6 +317,14 @@ STATIC_UNIT_TESTED uint16_t crsfReadRawRC(const rxRuntimeConfig_t *rxRuntimeConf
     return (crsfChannelData[chan] * 1024 / 1639) + 881;
 }
 
+static void crsfReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    UNUSED(rxRuntimeConfig);
+    for (int chan = 0; chan < count; chan++) {
+        raw[chan] = (crsfChannelData[chan] * 1024 / 1639) + 881;
+    }
+}
+
 void crsfRxWriteTelemetryData(const void *data, int len)
 {
     len = MIN(len, (int)sizeof(telemetryBuf));
@@ -308,7 +358,9 @@ bool crsfRxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
 
     rxRuntimeConfig->channelCount = CRSF_MAX_CHANNEL;
     rxRuntimeConfig->rcReadRawFn = crsfReadRawRC;
+    rxRuntimeConfig->rcReadRawChannelsFn = crsfReadRawChannels;
     rxRuntimeConfig->rcFrameStatusFn = crsfFrameStatus;
+    rxRuntimeConfig->rcFrameTimeUsFn = crsfFrameTimeUs;
 
     const serialPortConfig_t *portConfig = findSerialPortConfig(FUNCTION_RX_SERIAL);
     if (!portConfig) {
@@ -222,10 +222,12 @@ static void smartPortWriteFrameFport(const smartPortPayload_t *payload)
 {
     framePosition = 0;
 
+    uint8_t frame[2 * 2 + SMARTPORT_FRAME_ENCODED_MAX];
     uint16_t checksum = 0;
-    smartPortSendByte(FPORT_RESPONSE_FRAME_LENGTH, &checksum, fportPort);
-    smartPortSendByte(FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, &checksum, fportPort);
-    smartPortWriteFrameSerial(payload, fportPort, checksum);
+    uint8_t *ptr = smartPortEncodeByte(frame, FPORT_RESPONSE_FRAME_LENGTH, &checksum);
+    ptr = smartPortEncodeByte(ptr, FPORT_FRAME_TYPE_TELEMETRY_RESPONSE, &checksum);
+    ptr = smartPortEncodeFrame(ptr, payload, checksum);
+    serialWriteBuf(fportPort, frame, ptr - frame);
 }
 #endif
 
@@ -343,7 +345,7 @@ static bool fportProcessFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
     }
 
     if (clearToSend) {
-        processSmartPortTelemetry(mspPayload, &clearToSend, NULL);
+        processSmartPortTelemetry(mspPayload, &clearToSend);
 
         if (clearToSend) {
             smartPortWriteFrameFport(&emptySmartPortFrame);
@@ -555,7 +555,7 @@ static bool processFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
                             static firmwareUpdateHeader_t *header = (firmwareUpdateHeader_t *)otaDataBuffer;
                             firmwareUpdateSize = header->size;
                             firmwareUpdateCRC = header->crc;
-                            firmwareUpdateError = !firmwareUpdatePrepare(firmwareUpdateSize);
+                            firmwareUpdateError = !firmwareUpdatePrepare(firmwareUpdateSize, FIRMWARE_UPDATE_ENCODING_RAW);
                         } else if (receivedSize < firmwareUpdateSize) {
                             uint8_t firmwareDataSize = MIN((uint8_t)FPORT2_OTA_DATA_FRAME_BYTES, firmwareUpdateSize - receivedSize);
                             firmwareUpdateError = !firmwareUpdateStore(otaDataBuffer, firmwareDataSize);
@@ -589,7 +589,7 @@ static bool processFrame(const rxRuntimeConfig_t *rxRuntimeConfig)
             if ((downlinkPhyID == FPORT2_FC_MSP_ID) && !mspPayload) {
                 clearToSend = false;
             } else if (!sendNullFrame) {
-                processSmartPortTelemetry(mspPayload, &clearToSend, NULL);
+                processSmartPortTelemetry(mspPayload, &clearToSend);
                 mspPayload = NULL;
             }
 
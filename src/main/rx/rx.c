@@ -50,6 +50,7 @@
 #include "io/serial.h"
 
 #include "rx/rx.h"
+#include "rx/rx_pipeline.h"
 #include "rx/crsf.h"
 #include "rx/ibus.h"
 #include "rx/jetiexbus.h"
@@ -93,6 +94,7 @@ static timeUs_t needRxSignalBefore = 0;
 static bool isRxSuspended = false;
 
 static rcChannel_t rcChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+static rxChannelPipeline_t rxChannelPipeline;
 
 rxLinkStatistics_t rxLinkStatistics;
 rxRuntimeConfig_t rxRuntimeConfig;
@@ -260,7 +262,9 @@ void rxInit(void)
 
     rxRuntimeConfig.lqTracker = &rxLQTracker;
     rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
+    rxRuntimeConfig.rcReadRawChannelsFn = NULL;
     rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+    rxRuntimeConfig.rcFrameTimeUsFn = NULL;
     rxRuntimeConfig.rxSignalTimeout = DELAY_10_HZ;
     rcSampleIndex = 0;
 
@@ -299,7 +303,9 @@ void rxInit(void)
             if (!serialRxInit(rxConfig(), &rxRuntimeConfig)) {
                 rxConfigMutable()->receiverType = RX_TYPE_NONE;
                 rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
+                rxRuntimeConfig.rcReadRawChannelsFn = NULL;
                 rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+                rxRuntimeConfig.rcFrameTimeUsFn = NULL;
             }
             break;
 #endif
@@ -320,7 +326,9 @@ void rxInit(void)
         case RX_TYPE_NONE:
             rxConfigMutable()->receiverType = RX_TYPE_NONE;
             rxRuntimeConfig.rcReadRawFn = nullReadRawRC;
+            rxRuntimeConfig.rcReadRawChannelsFn = NULL;
             rxRuntimeConfig.rcFrameStatusFn = nullFrameStatus;
+            rxRuntimeConfig.rcFrameTimeUsFn = NULL;
             break;
     }
 
@@ -410,7 +418,9 @@ bool rxUpdateCheck(timeUs_t currentTimeUs, timeDelta_t currentDeltaTime)
     if (frameStatus & RX_FRAME_COMPLETE) {
         // RX_FRAME_COMPLETE updated the failsafe status regardless
         rxSignalReceived = (frameStatus & RX_FRAME_FAILSAFE) == 0;
-        needRxSignalBefore = currentTimeUs + rxRuntimeConfig.rxSignalTimeout;
+        // Count the signal timeout from the arrival of the frame when the driver knows it
+        const timeUs_t frameTimeUs = rxRuntimeConfig.rcFrameTimeUsFn ? rxRuntimeConfig.rcFrameTimeUsFn() : currentTimeUs;
+        needRxSignalBefore = frameTimeUs + rxRuntimeConfig.rxSignalTimeout;
         rxDataProcessingRequired = true;
     }
     else if ((frameStatus & RX_FRAME_FAILSAFE) && rxSignalReceived) {
@@ -465,37 +475,16 @@ bool calculateRxChannelsAndUpdateFailsafe(timeUs_t currentTimeUs)
         return true;
     }
 
-    rxFlightChannelsValid = true;
+    // Recompile the channel table if the channel map, rxrange or the valid
+    // pulse range changed
+    if (!rxChannelPipelineIsCurrent(&rxChannelPipeline, rxChannelCount, rxConfig(), rxChannelRangeConfigs(0))) {
+        rxChannelPipelineCompile(&rxChannelPipeline, rxChannelCount, rxConfig(), rxChannelRangeConfigs(0));
+    }
 
     // Read and process channel data
-    for (int channel = 0; channel < rxChannelCount; channel++) {
-        const uint8_t rawChannel = calculateChannelRemapping(rxConfig()->rcmap, REMAPPABLE_CHANNEL_COUNT, channel);
-
-        // sample the channel
-        uint16_t sample = (*rxRuntimeConfig.rcReadRawFn)(&rxRuntimeConfig, rawChannel);
-
-        // apply the rx calibration to flight channel
-        if (channel < NON_AUX_CHANNEL_COUNT && sample != 0) {
-            sample = scaleRange(sample, rxChannelRangeConfigs(channel)->min, rxChannelRangeConfigs(channel)->max, PWM_RANGE_MIN, PWM_RANGE_MAX);
-            sample = MIN(MAX(PWM_PULSE_MIN, sample), PWM_PULSE_MAX);
-        }
-
-        // Store as rxRaw
-        rcChannels[channel].raw = sample;
-
-        // Apply invalid pulse value logic
-        if (!isRxPulseValid(sample)) {
-            sample = rcChannels[channel].data;   // hold channel, replace with old value
-            if ((currentTimeMs > rcChannels[channel].expiresAt) && (channel < NON_AUX_CHANNEL_COUNT)) {
-                rxFlightChannelsValid = false;
-            }
-        } else {
-            rcChannels[channel].expiresAt = currentTimeMs + MAX_INVALID_RX_PULSE_TIME;
-        }
-
-        // Save channel value
-        rcStaging[channel] = sample;
-    }
+    uint16_t rxRaw[RX_RAW_CHANNEL_COUNT];
+    rxChannelPipelineReadRaw(&rxChannelPipeline, &rxRuntimeConfig, rxRaw);
+    rxFlightChannelsValid = rxChannelPipelineRun(&rxChannelPipeline, rxRaw, rcChannels, rcStaging, currentTimeMs);
 
     // Update channel input value if receiver is not in failsafe mode
     // If receiver is in failsafe (not receiving signal or sending invalid channel values) - last good input values are retained
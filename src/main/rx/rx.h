@@ -149,16 +149,20 @@ struct rxRuntimeConfig_s;
 typedef struct rxRuntimeConfig_s rxRuntimeConfig_t;
 
 typedef uint16_t (*rcReadRawDataFnPtr)(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan); // used by receiver driver to return channel data
+typedef void (*rcReadRawChannelsFnPtr)(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count); // optional, returns channels [0;count) at once
 typedef uint8_t (*rcFrameStatusFnPtr)(rxRuntimeConfig_t *rxRuntimeConfig);
 typedef bool (*rcProcessFrameFnPtr)(const rxRuntimeConfig_t *rxRuntimeConfig);
 typedef uint16_t (*rcGetLinkQualityPtr)(const rxRuntimeConfig_t *rxRuntimeConfig);
+typedef timeUs_t (*rcFrameTimeUsFnPtr)(void); // optional, capture time of the last byte of the latest complete frame
 
 typedef struct rxRuntimeConfig_s {
     uint8_t channelCount;                  // number of rc channels as reported by current input driver
     timeUs_t rxSignalTimeout;
     rcReadRawDataFnPtr rcReadRawFn;
+    rcReadRawChannelsFnPtr rcReadRawChannelsFn;
     rcFrameStatusFnPtr rcFrameStatusFn;
     rcProcessFrameFnPtr rcProcessFrameFn;
+    rcFrameTimeUsFnPtr rcFrameTimeUsFn;
     rxLinkQualityTracker_e * lqTracker;     // Pointer to a
     uint16_t *channelData;
     void *frameData;
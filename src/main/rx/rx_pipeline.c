@@ -0,0 +1,116 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "rx/rx.h"
+#include "rx/rx_pipeline.h"
+
+void rxChannelPipelineCompile(rxChannelPipeline_t *pipeline, uint8_t channelCount, const rxConfig_t *rxConfig, const rxChannelRangeConfig_t *ranges)
+{
+    channelCount = MIN(channelCount, MAX_SUPPORTED_RC_CHANNEL_COUNT);
+
+    pipeline->channelCount = channelCount;
+    pipeline->pulseMin = rxConfig->rx_min_usec;
+    pipeline->pulseMax = rxConfig->rx_max_usec;
+    memcpy(pipeline->rcmap, rxConfig->rcmap, sizeof(pipeline->rcmap));
+    memcpy(pipeline->ranges, ranges, sizeof(pipeline->ranges));
+
+    for (int channel = 0; channel < channelCount; channel++) {
+        rxChannelStage_t *stage = &pipeline->stages[channel];
+        uint8_t source = channel < (int)REMAPPABLE_CHANNEL_COUNT ? rxConfig->rcmap[channel] : channel;
+
+        // Channels the receiver doesn't provide read as 0, an invalid pulse
+        if (source >= channelCount) {
+            source = RX_RAW_CHANNEL_NONE;
+        }
+
+        stage->source = source;
+        stage->flags = 0;
+        stage->srcMin = 0;
+        stage->srcRange = 0;
+
+        if (channel < NON_AUX_CHANNEL_COUNT) {
+            stage->flags = RX_CHANNEL_STAGE_SCALE | RX_CHANNEL_STAGE_FLIGHT;
+            stage->srcMin = ranges[channel].min;
+            stage->srcRange = (int32_t)ranges[channel].max - ranges[channel].min;
+        }
+    }
+}
+
+bool rxChannelPipelineIsCurrent(const rxChannelPipeline_t *pipeline, uint8_t channelCount, const rxConfig_t *rxConfig, const rxChannelRangeConfig_t *ranges)
+{
+    return pipeline->channelCount == MIN(channelCount, MAX_SUPPORTED_RC_CHANNEL_COUNT) &&
+           pipeline->pulseMin == rxConfig->rx_min_usec &&
+           pipeline->pulseMax == rxConfig->rx_max_usec &&
+           memcmp(pipeline->rcmap, rxConfig->rcmap, sizeof(pipeline->rcmap)) == 0 &&
+           memcmp(pipeline->ranges, ranges, sizeof(pipeline->ranges)) == 0;
+}
+
+void rxChannelPipelineReadRaw(const rxChannelPipeline_t *pipeline, const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw)
+{
+    if (rxRuntimeConfig->rcReadRawChannelsFn) {
+        rxRuntimeConfig->rcReadRawChannelsFn(rxRuntimeConfig, raw, pipeline->channelCount);
+    } else {
+        for (int channel = 0; channel < pipeline->channelCount; channel++) {
+            raw[channel] = rxRuntimeConfig->rcReadRawFn(rxRuntimeConfig, channel);
+        }
+    }
+    raw[RX_RAW_CHANNEL_NONE] = 0;
+}
+
+bool rxChannelPipelineRun(const rxChannelPipeline_t *pipeline, const uint16_t *raw, rcChannel_t *channels, int16_t *staging, timeMs_t currentTimeMs)
+{
+    const uint16_t pulseMin = pipeline->pulseMin;
+    const uint16_t pulseMax = pipeline->pulseMax;
+    bool flightChannelsValid = true;
+
+    for (int channel = 0; channel < pipeline->channelCount; channel++) {
+        const rxChannelStage_t *stage = &pipeline->stages[channel];
+        uint16_t sample = raw[stage->source];
+
+        // Same as scaleRange() to [PWM_RANGE_MIN;PWM_RANGE_MAX], including
+        // the truncation to 16 bits before the constrain
+        if ((stage->flags & RX_CHANNEL_STAGE_SCALE) && sample != 0) {
+            sample = (int32_t)(PWM_RANGE_MAX - PWM_RANGE_MIN) * ((int32_t)sample - stage->srcMin) / stage->srcRange + PWM_RANGE_MIN;
+            sample = MIN(MAX(PWM_PULSE_MIN, sample), PWM_PULSE_MAX);
+        }
+
+        channels[channel].raw = sample;
+
+        if (sample < pulseMin || sample > pulseMax) {
+            // Hold the last value. Flight channels fail after MAX_INVALID_RX_PULSE_TIME
+            sample = channels[channel].data;
+            if ((stage->flags & RX_CHANNEL_STAGE_FLIGHT) && currentTimeMs > channels[channel].expiresAt) {
+                flightChannelsValid = false;
+            }
+        } else {
+            channels[channel].expiresAt = currentTimeMs + MAX_INVALID_RX_PULSE_TIME;
+        }
+
+        staging[channel] = sample;
+    }
+
+    return flightChannelsValid;
+}
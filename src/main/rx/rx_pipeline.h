@@ -0,0 +1,69 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "common/time.h"
+
+#include "rx/rx.h"
+
+/*
+ * Per channel processing of received RC frames. The channel map, the rx
+ * calibration and the valid pulse range are compiled into a flat table
+ * whenever they change, so processing a frame is one pass over an array
+ * of raw values.
+ */
+
+// Raw channel array size. The extra entry always reads 0 and is used for
+// channel map entries pointing past the channels of the receiver.
+#define RX_RAW_CHANNEL_COUNT        (MAX_SUPPORTED_RC_CHANNEL_COUNT + 1)
+#define RX_RAW_CHANNEL_NONE         MAX_SUPPORTED_RC_CHANNEL_COUNT
+
+#define RX_CHANNEL_STAGE_SCALE      (1 << 0)    // apply the rx calibration (rxrange)
+#define RX_CHANNEL_STAGE_FLIGHT     (1 << 1)    // invalid pulses on this channel trigger failsafe
+
+typedef struct rxChannelStage_s {
+    uint8_t source;                 // index into the raw channel array
+    uint8_t flags;                  // RX_CHANNEL_STAGE_*
+    uint16_t srcMin;                // rxrange min
+    int32_t srcRange;               // rxrange max - min
+} rxChannelStage_t;
+
+typedef struct rxChannelPipeline_s {
+    uint8_t channelCount;
+    uint16_t pulseMin;              // rx_min_usec
+    uint16_t pulseMax;              // rx_max_usec
+    rxChannelStage_t stages[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    // Configuration the table was compiled from
+    uint8_t rcmap[MAX_MAPPABLE_RX_INPUTS];
+    rxChannelRangeConfig_t ranges[NON_AUX_CHANNEL_COUNT];
+} rxChannelPipeline_t;
+
+void rxChannelPipelineCompile(rxChannelPipeline_t *pipeline, uint8_t channelCount, const rxConfig_t *rxConfig, const rxChannelRangeConfig_t *ranges);
+bool rxChannelPipelineIsCurrent(const rxChannelPipeline_t *pipeline, uint8_t channelCount, const rxConfig_t *rxConfig, const rxChannelRangeConfig_t *ranges);
+
+// Reads the channel values of the receiver in us into raw[], which must
+// hold RX_RAW_CHANNEL_COUNT values
+void rxChannelPipelineReadRaw(const rxChannelPipeline_t *pipeline, const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw);
+
+// Stores the raw value of every channel in channels[].raw and the value to
+// use in staging[], holding the last value of channels with invalid pulses.
+// Returns false if a flight channel has been invalid for too long.
+bool rxChannelPipelineRun(const rxChannelPipeline_t *pipeline, const uint16_t *raw, rcChannel_t *channels, int16_t *staging, timeMs_t currentTimeMs);
@@ -467,6 +467,13 @@ static uint16_t srxl2ReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t
     return SPEKTRUM_PULSE_OFFSET + ((rxRuntimeConfig->channelData[channelIdx] >> SRXL2_CHANNEL_SHIFT) >> 1);
 }
 
+static void srxl2ReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    for (int channelIdx = 0; channelIdx < count; channelIdx++) {
+        raw[channelIdx] = SPEKTRUM_PULSE_OFFSET + ((rxRuntimeConfig->channelData[channelIdx] >> SRXL2_CHANNEL_SHIFT) >> 1);
+    }
+}
+
 void srxl2RxWriteData(const void *data, int len)
 {
     const uint16_t crc = crc16_ccitt_update(0, (uint8_t*)data, len - 2);
@@ -491,6 +498,7 @@ bool srxl2RxInit(const rxConfig_t *rxConfig, rxRuntimeConfig_t *rxRuntimeConfig)
     rxRuntimeConfig->channelData = channelData;
     rxRuntimeConfig->channelCount = SRXL2_MAX_CHANNELS;
     rxRuntimeConfig->rcReadRawFn = srxl2ReadRawRC;
+    rxRuntimeConfig->rcReadRawChannelsFn = srxl2ReadRawChannels;
     rxRuntimeConfig->rcFrameStatusFn = srxl2FrameStatus;
     rxRuntimeConfig->rcProcessFrameFn = srxl2ProcessFrame;
 
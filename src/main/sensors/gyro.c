@@ -30,6 +30,7 @@
 #include "common/filter.h"
 #include "common/log.h"
 #include "common/maths.h"
+#include "common/memory.h"
 #include "common/utils.h"
 
 #include "config/parameter_group.h"
@@ -65,6 +66,7 @@
 #include "sensors/gyro.h"
 #include "sensors/sensors.h"
 
+#include "flight/dynamic_lpf.h"
 #include "flight/gyroanalyse.h"
 #include "flight/rpm_filter.h"
 #include "flight/kalman.h"
@@ -89,7 +91,9 @@ STATIC_FASTRAM filter_t gyroLpf2State[XYZ_AXIS_COUNT];
 
 #ifdef USE_DYNAMIC_FILTERS
 
-EXTENDED_FASTRAM gyroAnalyseState_t gyroAnalyseState;
+// Allocated from MEM_POOL_FAST when the dynamic notch is enabled
+STATIC_FASTRAM gyroAnalyseState_t *gyroAnalyseState;
+MEM_POOL_RESERVE(FAST, gyroAnalyseState, sizeof(gyroAnalyseState_t));
 EXTENDED_FASTRAM dynamicGyroNotchState_t dynamicGyroNotchState;
 EXTENDED_FASTRAM secondaryDynamicGyroNotchState_t secondaryDynamicGyroNotchState;
 
@@ -263,6 +267,10 @@ static void gyroInitFilters(void)
     //Second gyro LPF runnig and PID frequency - this filter is dynamic when gyro_use_dyn_lpf = ON
     initGyroFilter(&gyroLpf2ApplyFn, gyroLpf2State, gyroConfig()->gyro_main_lpf_type, gyroConfig()->gyro_main_lpf_hz, getLooptime());
 
+    // Built whether gyro_use_dyn_lpf is on or not, gyroFilter() checks the
+    // setting on every loop and it can be turned on without a filter reinit
+    dynamicLpfGyroInit(getLooptime());
+
 #ifdef USE_GYRO_KALMAN
     if (gyroConfig()->kalmanEnabled) {
         gyroKalmanInitialize(gyroConfig()->kalman_q);
@@ -311,11 +319,19 @@ bool gyroInit(void)
 
     secondaryDynamicGyroNotchFiltersInit(&secondaryDynamicGyroNotchState);
 
-    gyroDataAnalyseStateInit(
-        &gyroAnalyseState,
-        gyroConfig()->dynamicGyroNotchMinHz,
-        getLooptime()
-    );
+    if (dynamicGyroNotchState.enabled) {
+        gyroAnalyseState = memAllocateFromPool(MEM_POOL_FAST, sizeof(gyroAnalyseState_t), OWNER_GYRO_ANALYSE);
+    }
+
+    if (gyroAnalyseState) {
+        gyroDataAnalyseStateInit(
+            gyroAnalyseState,
+            gyroConfig()->dynamicGyroNotchMinHz,
+            getLooptime()
+        );
+    } else {
+        dynamicGyroNotchState.enabled = false;
+    }
 #endif
     return true;
 }
@@ -448,6 +464,10 @@ void FAST_CODE NOINLINE gyroFilter()
         return;
     }
 
+    if (gyroConfig()->useDynamicLpf) {
+        dynamicLpfGyroUpdate(gyroLpf2State);
+    }
+
     for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
         float gyroADCf = gyro.gyroADCf[axis];
 
@@ -459,7 +479,7 @@ void FAST_CODE NOINLINE gyroFilter()
 
 #ifdef USE_DYNAMIC_FILTERS
         if (dynamicGyroNotchState.enabled) {
-            gyroDataAnalysePush(&gyroAnalyseState, axis, gyroADCf);
+            gyroDataAnalysePush(gyroAnalyseState, axis, gyroADCf);
             gyroADCf = dynamicGyroNotchFiltersApply(&dynamicGyroNotchState, axis, gyroADCf);
         }
 
@@ -472,30 +492,31 @@ void FAST_CODE NOINLINE gyroFilter()
 
 #endif
 
-#ifdef USE_GYRO_KALMAN
-        if (gyroConfig()->kalmanEnabled) {
-            gyroADCf = gyroKalmanUpdate(axis, gyroADCf);
-        }
-#endif
-
         gyro.gyroADCf[axis] = gyroADCf;
     }
 
+#ifdef USE_GYRO_KALMAN
+    // Last in the chain, all axes in one pass
+    if (gyroConfig()->kalmanEnabled) {
+        gyroKalmanUpdate(gyro.gyroADCf);
+    }
+#endif
+
 #ifdef USE_DYNAMIC_FILTERS
     if (dynamicGyroNotchState.enabled) {
-        gyroDataAnalyse(&gyroAnalyseState);
+        gyroDataAnalyse(gyroAnalyseState);
 
-        if (gyroAnalyseState.filterUpdateExecute) {
+        if (gyroAnalyseState->filterUpdateExecute) {
             dynamicGyroNotchFiltersUpdate(
                 &dynamicGyroNotchState,
-                gyroAnalyseState.filterUpdateAxis,
-                gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
+                gyroAnalyseState->filterUpdateAxis,
+                gyroAnalyseState->centerFrequency[gyroAnalyseState->filterUpdateAxis]
             );
 
             secondaryDynamicGyroNotchFiltersUpdate(
                 &secondaryDynamicGyroNotchState, 
-                gyroAnalyseState.filterUpdateAxis,
-                gyroAnalyseState.centerFrequency[gyroAnalyseState.filterUpdateAxis]
+                gyroAnalyseState->filterUpdateAxis,
+                gyroAnalyseState->centerFrequency[gyroAnalyseState->filterUpdateAxis]
             );
 
         }
@@ -569,18 +590,6 @@ int16_t gyroRateDps(int axis)
     return lrintf(gyro.gyroADCf[axis]);
 }
 
-void gyroUpdateDynamicLpf(float cutoffFreq) {
-    if (gyroConfig()->gyro_main_lpf_type == FILTER_PT1) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            pt1FilterUpdateCutoff(&gyroLpf2State[axis].pt1, cutoffFreq);
-        }
-    } else if (gyroConfig()->gyro_main_lpf_type == FILTER_BIQUAD) {
-        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
-            biquadFilterUpdate(&gyroLpf2State[axis].biquad, cutoffFreq, getLooptime(), BIQUAD_Q, FILTER_LPF);
-        }
-    }
-}
-
 float averageAbsGyroRates(void)
 {
     return (fabsf(gyro.gyroADCf[ROLL]) + fabsf(gyro.gyroADCf[PITCH]) + fabsf(gyro.gyroADCf[YAW])) / 3.0f;
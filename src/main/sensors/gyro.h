@@ -104,5 +104,4 @@ bool gyroIsCalibrationComplete(void);
 bool gyroReadTemperature(void);
 int16_t gyroGetTemperature(void);
 int16_t gyroRateDps(int axis);
-void gyroUpdateDynamicLpf(float cutoffFreq);
 float averageAbsGyroRates(void);
@@ -23,6 +23,7 @@
 
 #include "common/maths.h"
 #include "common/printf.h"
+#include "common/utils.h"
 
 #include "config/parameter_group.h"
 #include "config/parameter_group_ids.h"
@@ -40,6 +41,7 @@
 #include "sensors/barometer.h"
 
 #include "scheduler/protothreads.h"
+#include "scheduler/scheduler.h"
 
 
 PG_REGISTER_ARRAY(tempSensorConfig_t, MAX_TEMP_SENSORS, tempSensorConfig, PG_TEMP_SENSOR_CONFIG, 2);
@@ -192,8 +194,11 @@ static uint8_t temperatureUpdateSensorIndex;
 static bool temperatureUpdateValueValid;
 
 #ifdef DS18B20_DRIVER_AVAILABLE
-static uint8_t temperatureUpdateIndex;
-static uint8_t temperatureUpdateBuf[9];
+// A scratchpad read for each sensor and the conversion for the next update
+static owTransaction_t temperatureUpdateTransactions[MAX_TEMP_SENSORS + 1];
+static owQueue_t temperatureUpdateQueue;
+static owTransaction_t *temperatureUpdateRead[MAX_TEMP_SENSORS];
+static uint8_t temperatureUpdateBuf[MAX_TEMP_SENSORS][DS18B20_SCRATCHPAD_SIZE];
 #endif
 
 #endif /* defined(USE_TEMPERATURE_SENSOR) */
@@ -220,8 +225,30 @@ PROTOTHREAD(temperatureUpdate)
 
 #ifdef USE_TEMPERATURE_SENSOR
 
-        temperatureUpdateSensorIndex = 0;
-        do {
+#ifdef DS18B20_DRIVER_AVAILABLE
+        if (owDev) {
+            // Read every sensor, then start the next conversion on all of
+            // them at once, as one batch run while the task polls at the
+            // pace of the 1-Wire bus
+            owQueueInit(&temperatureUpdateQueue, owDev, temperatureUpdateTransactions, ARRAYLEN(temperatureUpdateTransactions));
+
+            for (uint8_t configIndex = 0; configIndex < MAX_TEMP_SENSORS; ++configIndex) {
+                const tempSensorConfig_t *configSlot = tempSensorConfig(configIndex);
+                temperatureUpdateRead[configIndex] = NULL;
+                if (configSlot->type == TEMP_SENSOR_DS18B20) {
+                    temperatureUpdateRead[configIndex] = ds18b20QueueReadScratchpad(&temperatureUpdateQueue, configSlot->address, temperatureUpdateBuf[configIndex]);
+                }
+            }
+
+            ds18b20QueueStartConversion(&temperatureUpdateQueue);
+
+            rescheduleTask(TASK_TEMPERATURE, TASK_PERIOD_US(OW_BYTE_TIME_US / 4));
+            ptWait(owQueueProcess(&temperatureUpdateQueue));
+            rescheduleTask(TASK_TEMPERATURE, TASK_PERIOD_HZ(100));
+        }
+#endif
+
+        for (temperatureUpdateSensorIndex = 0; temperatureUpdateSensorIndex < MAX_TEMP_SENSORS; ++temperatureUpdateSensorIndex) {
             const tempSensorConfig_t *configSlot = tempSensorConfig(temperatureUpdateSensorIndex);
             temperatureUpdateValueValid = false;
 
@@ -235,37 +262,10 @@ PROTOTHREAD(temperatureUpdate)
 #endif
 
 #ifdef DS18B20_DRIVER_AVAILABLE
-            if ((configSlot->type == TEMP_SENSOR_DS18B20) && owDev) {
-                bool ack = owDev->owResetCommand(owDev);
-                if (!ack) goto temperatureUpdateError;
-                ptWait(owDev->owBusReady(owDev));
-
-                ack = owDev->owMatchRomCommand(owDev);
-                if (!ack) goto temperatureUpdateError;
-                ptWait(owDev->owBusReady(owDev));
-
-                temperatureUpdateIndex = 0;
-                do {
-                    ack = owDev->owWriteByteCommand(owDev, ((uint8_t *)&tempSensorConfig(temperatureUpdateSensorIndex)->address)[temperatureUpdateIndex]);
-                    if (!ack) goto temperatureUpdateError;
-                    ptWait(owDev->owBusReady(owDev));
-                } while (++temperatureUpdateIndex < 8);
-
-                ack = ds18b20ReadScratchpadCommand(owDev);
-                if (!ack) goto temperatureUpdateError;
-                ptWait(owDev->owBusReady(owDev));
-
-                temperatureUpdateIndex = 0;
-                do {
-                    ack = owDev->owReadByteCommand(owDev);
-                    if (!ack) goto temperatureUpdateError;
-                    ptWait(owDev->owBusReady(owDev));
-                    ack = owDev->owReadByteResult(owDev, temperatureUpdateBuf + temperatureUpdateIndex);
-                    if (!ack) goto temperatureUpdateError;
-                } while (++temperatureUpdateIndex < 9);
-
+            const owTransaction_t *read = temperatureUpdateRead[temperatureUpdateSensorIndex];
+            if ((configSlot->type == TEMP_SENSOR_DS18B20) && owDev && read && (read->state == OW_TRANSACTION_DONE)) {
                 int16_t temperature;
-                if (ds18b20ReadTemperatureFromScratchPadBuf(temperatureUpdateBuf, &temperature)) {
+                if (ds18b20ReadTemperatureFromScratchPadBuf(temperatureUpdateBuf[temperatureUpdateSensorIndex], &temperature)) {
                     if (temperatureSensorValueIsValid(temperatureUpdateSensorIndex) || (tempSensorValue[temperatureUpdateSensorIndex] == -1240)) {
                         tempSensorValue[temperatureUpdateSensorIndex] = temperature;
                         temperatureUpdateValueValid = true;
@@ -274,8 +274,6 @@ PROTOTHREAD(temperatureUpdate)
                 } else
                     tempSensorValue[temperatureUpdateSensorIndex] = TEMPERATURE_INVALID_VALUE;
             }
-
-temperatureUpdateError:;
 #endif
 
            uint8_t statusMask = 1 << (temperatureUpdateSensorIndex % 8);
@@ -285,25 +283,11 @@ temperatureUpdateError:;
            else
                sensorStatus[byteIndex] &= ~statusMask;
 
-           ptYield();
-
-        } while (++temperatureUpdateSensorIndex < MAX_TEMP_SENSORS);
-
-#ifdef DS18B20_DRIVER_AVAILABLE
-        if (owDev) {
-            bool ack = owDev->owResetCommand(owDev);
-            if (!ack) goto ds18b20StartConversionError;
-            ptWait(owDev->owBusReady(owDev));
-
-            ack = owDev->owSkipRomCommand(owDev);
-            if (!ack) goto ds18b20StartConversionError;
-            ptWait(owDev->owBusReady(owDev));
-
-            ds18b20StartConversionCommand(owDev);
-        }
-
-ds18b20StartConversionError:;
+#ifdef USE_TEMPERATURE_LM75
+           // One I2C read per run
+           if (configSlot->type == TEMP_SENSOR_LM75) ptYield();
 #endif
+        }
 
 #endif /* defined(USE_TEMPERATURE_SENSOR) */
 
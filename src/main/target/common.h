@@ -29,8 +29,6 @@
 #define NOINLINE
 #endif
 
-#define DYNAMIC_HEAP_SIZE   2048
-
 #define I2C1_OVERCLOCK false
 #define I2C2_OVERCLOCK false
 #define USE_I2C_PULLUP          // Enable built-in pullups on all boards in case external ones are too week
@@ -118,9 +118,14 @@ static uint32_t txDelayUs = HOTT_TX_DELAY_US;
 static hottState_e  hottState = HOTT_WAITING_FOR_REQUEST;
 static timeUs_t     hottStateChangeUs = 0;
 
-static uint8_t *hottTxMsg = NULL;
+static const uint8_t *hottTxMsg = NULL;
 static uint8_t hottTxMsgSize;
+static uint8_t hottTxMsgSent;
 static uint8_t hottTxMsgCrc;
+static uint32_t hottTxByteSpacingUs = 0;    // Spacing the port keeps by itself, 0 to send a byte per call
+static bool hottTxPaced;                    // The message being sent was handed to the port in one go
+static timeUs_t hottTxStartUs;
+static timeUs_t hottMessagesPreparedUs = 0;
 
 #define HOTT_BAUDRATE 19200
 #define HOTT_INITIAL_PORT_MODE MODE_RXTX
@@ -131,8 +136,13 @@ static serialPortConfig_t *portConfig;
 static bool hottTelemetryEnabled =  false;
 static portSharing_e hottPortSharing;
 
-static HOTT_GPS_MSG_t hottGPSMessage;
-static HOTT_EAM_MSG_t hottEAMMessage;
+// On a port that spaces the bytes itself, responses are prepared ahead of
+// the requests into the back buffer and a request sends the front one as it
+// is. Otherwise the front one is prepared when the request comes in.
+static HOTT_GPS_MSG_t hottGPSMessages[2];
+static HOTT_EAM_MSG_t hottEAMMessages[2];
+static uint8_t hottGPSMessageFront;
+static uint8_t hottEAMMessageFront;
 
 #if defined (USE_HOTT_TEXTMODE) && defined (USE_CMS)
 static hottTextModeMsg_t hottTextModeMessage;
@@ -185,10 +195,13 @@ static void initialiseGPSMessage(HOTT_GPS_MSG_t *msg, size_t size)
 
 static void initialiseMessages(void)
 {
-    initialiseEAMMessage(&hottEAMMessage, sizeof(hottEAMMessage));
+    for (int i = 0; i < 2; i++) {
+        initialiseEAMMessage(&hottEAMMessages[i], sizeof(hottEAMMessages[i]));
 #ifdef USE_GPS
-    initialiseGPSMessage(&hottGPSMessage, sizeof(hottGPSMessage));
+        initialiseGPSMessage(&hottGPSMessages[i], sizeof(hottGPSMessages[i]));
 #endif
+    }
+    hottMessagesPreparedUs = 0;
 #if defined (USE_HOTT_TEXTMODE) && defined (USE_CMS)
     initialiseTextmodeMessage(&hottTextModeMessage);
 #endif
@@ -332,6 +345,32 @@ void hottPrepareEAMResponse(HOTT_EAM_MSG_t *hottEAMMessage)
     hottEAMUpdateAltitudeAndClimbrate(hottEAMMessage);
 }
 
+static bool hottMessageInFlight(const void *msg)
+{
+    return hottTxMsg == msg && (hottState == HOTT_WAITING_FOR_TX_WINDOW || hottState == HOTT_TRANSMITTING);
+}
+
+static void hottPrepareMessages(void)
+{
+    // The back buffer starts from the front one, so what a prepare function
+    // leaves alone (GPS position without a fix) carries over as before
+    const uint8_t eamBack = hottEAMMessageFront ^ 1;
+    if (!hottMessageInFlight(&hottEAMMessages[eamBack])) {
+        hottEAMMessages[eamBack] = hottEAMMessages[hottEAMMessageFront];
+        hottPrepareEAMResponse(&hottEAMMessages[eamBack]);
+        hottEAMMessageFront = eamBack;
+    }
+
+#ifdef USE_GPS
+    const uint8_t gpsBack = hottGPSMessageFront ^ 1;
+    if (sensors(SENSOR_GPS) && !hottMessageInFlight(&hottGPSMessages[gpsBack])) {
+        hottGPSMessages[gpsBack] = hottGPSMessages[hottGPSMessageFront];
+        hottPrepareGPSResponse(&hottGPSMessages[gpsBack]);
+        hottGPSMessageFront = gpsBack;
+    }
+#endif
+}
+
 static void hottSerialWrite(uint8_t c)
 {
     static uint8_t serialWrites = 0;
@@ -376,13 +415,16 @@ void configureHoTTTelemetryPort(void)
         return;
     }
 
+    hottTxByteSpacingUs = serialSetTxByteSpacing(hottPort, txDelayUs);
     hottTelemetryEnabled = true;
 }
 
-static void hottQueueSendResponse(uint8_t *buffer, int length)
+static void hottQueueSendResponse(const uint8_t *buffer, int length)
 {
     hottTxMsg = buffer;
     hottTxMsgSize = length;
+    hottTxMsgSent = 0;
+    hottTxPaced = false;
 }
 
 #if defined (USE_HOTT_TEXTMODE) && defined (USE_CMS)
@@ -396,6 +438,7 @@ static void hottTextmodeStart(void)
 
     rxSchedule = HOTT_TEXTMODE_RX_SCHEDULE;
     txDelayUs = HOTT_TEXTMODE_TX_DELAY_US;
+    hottTxByteSpacingUs = serialSetTxByteSpacing(hottPort, txDelayUs);
 }
 
 static void hottTextmodeStop(void)
@@ -408,6 +451,7 @@ static void hottTextmodeStop(void)
 
     rxSchedule = HOTT_RX_SCHEDULE;
     txDelayUs = HOTT_TX_DELAY_US;
+    hottTxByteSpacingUs = serialSetTxByteSpacing(hottPort, txDelayUs);
 }
 
 bool hottTextmodeIsAlive(void)
@@ -458,7 +502,7 @@ static bool processHottTextModeRequest(const uint8_t cmd)
     }
 
     hottSetCmsKey(cmd & 0x0f, hottTextModeMessage.esc == HOTT_TEXTMODE_ESC);
-    hottQueueSendResponse((uint8_t *)&hottTextModeMessage, sizeof(hottTextModeMessage));
+    hottQueueSendResponse((const uint8_t *)&hottTextModeMessage, sizeof(hottTextModeMessage));
 
     return true;
 }
@@ -477,15 +521,19 @@ static bool processBinaryModeRequest(uint8_t address)
 #ifdef USE_GPS
     case 0x8A:
         if (sensors(SENSOR_GPS)) {
-            hottPrepareGPSResponse(&hottGPSMessage);
-            hottQueueSendResponse((uint8_t *)&hottGPSMessage, sizeof(hottGPSMessage));
+            if (!hottTxByteSpacingUs) {
+                hottPrepareGPSResponse(&hottGPSMessages[hottGPSMessageFront]);
+            }
+            hottQueueSendResponse((const uint8_t *)&hottGPSMessages[hottGPSMessageFront], sizeof(HOTT_GPS_MSG_t));
             return true;
         }
         break;
 #endif
     case 0x8E:
-        hottPrepareEAMResponse(&hottEAMMessage);
-        hottQueueSendResponse((uint8_t *)&hottEAMMessage, sizeof(hottEAMMessage));
+        if (!hottTxByteSpacingUs) {
+            hottPrepareEAMResponse(&hottEAMMessages[hottEAMMessageFront]);
+        }
+        hottQueueSendResponse((const uint8_t *)&hottEAMMessages[hottEAMMessageFront], sizeof(HOTT_EAM_MSG_t));
         return true;
     }
 
@@ -499,25 +547,43 @@ static void flushHottRxBuffer(void)
     }
 }
 
-static bool hottSendTelemetryDataByte(timeUs_t currentTimeUs)
+static void hottStartTransmission(timeUs_t currentTimeUs)
 {
-    static timeUs_t byteSentTimeUs = 0;
+    hottTxMsgSent = 0;
+    hottTxMsgCrc = 0;
+    hottTxStartUs = currentTimeUs;
+
+    // Ports that space the bytes themselves get the message and its CRC in
+    // one go, the line is then busy for as long as sending byte by byte
+    hottTxPaced = hottTxByteSpacingUs && serialTxBytesFree(hottPort) > hottTxMsgSize;
+    if (hottTxPaced) {
+        for (int i = 0; i < hottTxMsgSize; i++) {
+            hottTxMsgCrc += hottTxMsg[i];
+        }
+        serialBeginWrite(hottPort);
+        serialWriteBuf(hottPort, hottTxMsg, hottTxMsgSize);
+        serialWrite(hottPort, hottTxMsgCrc);
+        serialEndWrite(hottPort);
+    }
+}
 
-    // Guard intra-byte interval
-    if (currentTimeUs - byteSentTimeUs < HOTT_TX_DELAY_US) {
-        return false;
+static bool hottSendTelemetryData(timeUs_t currentTimeUs)
+{
+    if (hottTxPaced) {
+        // Done when the CRC byte starts, as in the byte by byte case
+        return (currentTimeUs - hottTxStartUs) >= hottTxMsgSize * hottTxByteSpacingUs;
     }
 
-    if (hottTxMsgSize == 0) {
+    // One byte per call, the task period keeps them apart
+    if (hottTxMsgSent == hottTxMsgSize) {
         // Send CRC byte
         hottSerialWrite(hottTxMsgCrc);
         return true;
     } else {
         // Send data byte
-        hottTxMsgCrc += *hottTxMsg;
-        hottSerialWrite(*hottTxMsg);
-        hottTxMsg++;
-        hottTxMsgSize--;
+        const uint8_t c = hottTxMsg[hottTxMsgSent++];
+        hottTxMsgCrc += c;
+        hottSerialWrite(c);
         return false;
     }
 }
@@ -546,6 +612,11 @@ void handleHoTTTelemetry(timeUs_t currentTimeUs)
         return;
     }
 
+    if (hottTxByteSpacingUs && (hottMessagesPreparedUs == 0 || (currentTimeUs - hottMessagesPreparedUs) >= HOTT_MESSAGE_PREPARATION_FREQUENCY_5_HZ)) {
+        hottPrepareMessages();
+        hottMessagesPreparedUs = currentTimeUs;
+    }
+
     bool reprocessState;
     do {
         reprocessState = false;
@@ -611,13 +682,15 @@ void handleHoTTTelemetry(timeUs_t currentTimeUs)
 
         case HOTT_WAITING_FOR_TX_WINDOW:
             if ((currentTimeUs - hottStateChangeUs) >= HOTT_TX_SCHEDULE) {
-                hottTxMsgCrc = 0;
                 hottSwitchState(HOTT_TRANSMITTING, currentTimeUs);
             }
             break;
 
         case HOTT_TRANSMITTING:
-            if (hottSendTelemetryDataByte(currentTimeUs)) {
+            if (hottTxMsgSent == 0 && !hottTxPaced) {
+                hottStartTransmission(currentTimeUs);
+            }
+            if (hottSendTelemetryData(currentTimeUs)) {
                 hottSwitchState(HOTT_ENDING_TRANSMISSION, currentTimeUs);
             }
             break;
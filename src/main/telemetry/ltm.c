@@ -29,6 +29,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
 
 #include "platform.h"
 
@@ -77,36 +78,13 @@
 
 
 #define TELEMETRY_LTM_INITIAL_PORT_MODE MODE_TX
-#define LTM_CYCLETIME   100
-#define LTM_SCHEDULE_SIZE (1000/LTM_CYCLETIME)
 
 static serialPort_t *ltmPort;
 static serialPortConfig_t *portConfig;
 static bool ltmEnabled;
 static portSharing_e ltmPortSharing;
-static uint8_t ltmFrame[LTM_MAX_MESSAGE_SIZE];
 static uint8_t ltm_x_counter;
 
-static void ltm_initialise_packet(sbuf_t *dst)
-{
-    dst->ptr = ltmFrame;
-    dst->end = ARRAYEND(ltmFrame);
-
-    sbufWriteU8(dst, '$');
-    sbufWriteU8(dst, 'T');
-}
-
-static void ltm_finalise(sbuf_t *dst)
-{
-    uint8_t crc = 0;
-    for (const uint8_t *ptr = &ltmFrame[3]; ptr < dst->ptr; ++ptr) {
-        crc ^= *ptr;
-    }
-    sbufWriteU8(dst, crc);
-    sbufSwitchToReader(dst, ltmFrame);
-    serialWriteBuf(ltmPort, sbufPtr(dst), sbufBytesRemaining(dst));
-}
-
 #if defined(USE_GPS)
 /*
  * GPS G-frame 5Hhz at > 2400 baud
@@ -244,7 +222,6 @@ void ltm_xframe(sbuf_t *dst)
     sbufWriteU8(dst, ltm_x_counter);
     sbufWriteU8(dst, getDisarmReason());
     sbufWriteU8(dst, 0);
-    ltm_x_counter++; // overflow is OK
 }
 
 /** OSD additional data frame, ~4 Hz rate, navigation system status
@@ -260,128 +237,217 @@ void ltm_nframe(sbuf_t *dst)
     sbufWriteU8(dst, NAV_Status.flags);
 }
 
-#define LTM_BIT_AFRAME  (1 << 0)
-#define LTM_BIT_GFRAME  (1 << 1)
-#define LTM_BIT_SFRAME  (1 << 2)
-#define LTM_BIT_OFRAME  (1 << 3)
-#define LTM_BIT_NFRAME  (1 << 4)
-#define LTM_BIT_XFRAME  (1 << 5)
-
 /*
- * This is the normal (default) scheduler, needs c. 4800 baud or faster
- * Equates to c. 303 bytes / second
+ * Frames a second for each frame type. The table is fitted to the baud rate
+ * of the port when it's configured, all rates scaled down alike until they
+ * take at most LTM_BAUD_USAGE_PERCENT of the line.
  */
-static uint8_t ltm_normal_schedule[LTM_SCHEDULE_SIZE] = {
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_OFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_XFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME | LTM_BIT_NFRAME
-};
+#define LTM_BAUD_USAGE_PERCENT  90
 
-/*
- * This is the medium scheduler, needs c. 2400 baud or faster
- * Equates to c. 164 bytes / second
- */
-static uint8_t ltm_medium_schedule[LTM_SCHEDULE_SIZE] = {
-    LTM_BIT_AFRAME,
-    LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME,
-    LTM_BIT_OFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_XFRAME,
-    LTM_BIT_OFRAME,
-    LTM_BIT_AFRAME | LTM_BIT_SFRAME,
-    LTM_BIT_GFRAME,
-    LTM_BIT_AFRAME,
-    LTM_BIT_NFRAME
+static const uint8_t ltmRateTables[][LTM_FRAME_COUNT] = {
+    // Legacy rate, c. 303 bytes / second, 4800 baud or faster
+    [LTM_RATE_NORMAL] = {
+        [LTM_AFRAME] = 10, [LTM_SFRAME] = 5, [LTM_NFRAME] = 3,
+#if defined(USE_GPS)
+        [LTM_GFRAME] = 5, [LTM_OFRAME] = 1, [LTM_XFRAME] = 1,
+#endif
+    },
+    // c. 164 bytes / second, 2400 baud or faster
+    [LTM_RATE_MEDIUM] = {
+        [LTM_AFRAME] = 5, [LTM_SFRAME] = 2, [LTM_NFRAME] = 1,
+#if defined(USE_GPS)
+        [LTM_GFRAME] = 2, [LTM_OFRAME] = 2, [LTM_XFRAME] = 1,
+#endif
+    },
+    // c. 105 bytes / second, 1200 baud or faster
+    [LTM_RATE_SLOW] = {
+        [LTM_AFRAME] = 2, [LTM_SFRAME] = 1, [LTM_NFRAME] = 1,
+#if defined(USE_GPS)
+        [LTM_GFRAME] = 2, [LTM_OFRAME] = 1, [LTM_XFRAME] = 1,
+#endif
+    },
+    // Attitude for trackers and HUDs, c. 473 bytes / second, 9600 baud or faster
+    [LTM_RATE_FAST] = {
+        [LTM_AFRAME] = 25, [LTM_SFRAME] = 5, [LTM_NFRAME] = 5,
+#if defined(USE_GPS)
+        [LTM_GFRAME] = 5, [LTM_OFRAME] = 1, [LTM_XFRAME] = 1,
+#endif
+    },
 };
 
-/*
- * This is the slow scheduler, needs c. 1200 baud or faster
- * Equates to c. 105 bytes / second (91 b/s if the second GFRAME is zeroed)
- */
-static uint8_t ltm_slow_schedule[LTM_SCHEDULE_SIZE] = {
-    LTM_BIT_GFRAME,
-    LTM_BIT_SFRAME,
-    LTM_BIT_AFRAME,
-    0,
-    LTM_BIT_OFRAME,
-    LTM_BIT_XFRAME,
-    LTM_BIT_GFRAME, // consider zeroing this for even lower bytes/sec
-    0,
-    LTM_BIT_AFRAME,
-    LTM_BIT_NFRAME,
+// Order of the frames within a write, as they were always sent
+static const ltm_frame_e ltmFrameOrder[] = {
+    LTM_AFRAME,
+#if defined(USE_GPS)
+    LTM_GFRAME,
+    LTM_OFRAME,
+    LTM_XFRAME,
+#endif
+    LTM_SFRAME,
+    LTM_NFRAME,
 };
 
-/* Set by initialisation */
-static uint8_t *ltm_schedule;
+typedef struct ltmFrameSlot_s {
+    uint8_t data[LTM_MAX_MESSAGE_SIZE];     // Last encoding sent, '$T' to checksum
+    uint8_t size;
+    bool due;                               // Waiting for room on the line
+    bool dirty;                             // Encoding differs from the one last sent
+    timeMs_t nextDueMs;
+    uint16_t periodMs;                      // 0 if the frame isn't sent
+} ltmFrameSlot_t;
+
+static ltmFrameSlot_t ltmFrameSlots[LTM_FRAME_COUNT];
+static uint32_t ltmBytesPerSecond;
+static uint32_t ltmTxCredit;                // Bytes the line can take, in byte-milliseconds
+static timeMs_t ltmTxCreditMs;
+static uint8_t ltmTxBuffer[LTM_FRAME_COUNT * LTM_MAX_MESSAGE_SIZE];
+
+static uint8_t ltmFrameSize(ltm_frame_e frameType)
+{
+    static const uint8_t payloadSizes[LTM_FRAME_COUNT] = {
+        [LTM_AFRAME] = LTM_AFRAME_PAYLOAD_SIZE,
+        [LTM_SFRAME] = LTM_SFRAME_PAYLOAD_SIZE,
+#if defined(USE_GPS)
+        [LTM_GFRAME] = LTM_GFRAME_PAYLOAD_SIZE,
+        [LTM_OFRAME] = LTM_OFRAME_PAYLOAD_SIZE,
+        [LTM_XFRAME] = LTM_XFRAME_PAYLOAD_SIZE,
+#endif
+        [LTM_NFRAME] = LTM_NFRAME_PAYLOAD_SIZE,
+    };
+
+    return payloadSizes[frameType] + 4;
+}
 
-static void process_ltm(void)
+static void configureLtmScheduler(uint32_t baudRate)
 {
-    static uint8_t ltm_scheduler = 0;
-    uint8_t current_schedule = ltm_schedule[ltm_scheduler];
+    const uint8_t *rates = ltmRateTables[telemetryConfig()->ltmUpdateRate < ARRAYLEN(ltmRateTables) ? telemetryConfig()->ltmUpdateRate : LTM_RATE_NORMAL];
 
-    sbuf_t ltmFrameBuf;
-    sbuf_t *dst = &ltmFrameBuf;
+    uint32_t demand = 0;
+    for (int i = 0; i < LTM_FRAME_COUNT; i++) {
+        demand += rates[i] * ltmFrameSize(i);
+    }
 
-    if (current_schedule & LTM_BIT_AFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_aframe(dst);
-        ltm_finalise(dst);
+    // 10 bits a byte on the line
+    ltmBytesPerSecond = MAX(baudRate / 10 * LTM_BAUD_USAGE_PERCENT / 100, 1U);
+    const uint32_t scaledDemand = MAX(demand, ltmBytesPerSecond);
+
+    const timeMs_t now = millis();
+    for (int i = 0; i < LTM_FRAME_COUNT; i++) {
+        ltmFrameSlot_t *slot = &ltmFrameSlots[i];
+        slot->periodMs = rates[i] ? 1000 * scaledDemand / (rates[i] * ltmBytesPerSecond) : 0;
+        slot->nextDueMs = now;
+        slot->due = false;
+        slot->size = 0;
     }
 
-#if defined(USE_GPS)
-    if (current_schedule & LTM_BIT_GFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_gframe(dst);
-        ltm_finalise(dst);
+    // The line starts idle, the first pass can send every frame
+    ltmTxCredit = sizeof(ltmTxBuffer) * 1000;
+    ltmTxCreditMs = now;
+}
+
+static void ltmEncodeFrame(ltm_frame_e frameType, uint8_t *frame)
+{
+    frame[0] = '$';
+    frame[1] = 'T';
+    getLtmFrame(&frame[2], frameType);
+
+    // Checksum over the payload, after the function byte
+    const int size = ltmFrameSize(frameType);
+    uint8_t crc = 0;
+    for (int i = 3; i < size - 1; i++) {
+        crc ^= frame[i];
     }
+    frame[size - 1] = crc;
+}
+
+// Encodes the frames that are due and checks them against the encoding
+// last sent, which is all most of them need when little is moving
+static void ltmUpdateDueFrames(timeMs_t now)
+{
+    for (int i = 0; i < LTM_FRAME_COUNT; i++) {
+        ltmFrameSlot_t *slot = &ltmFrameSlots[i];
+
+        if (!slot->periodMs || (!slot->due && (int32_t)(now - slot->nextDueMs) < 0)) {
+            continue;
+        }
+
+        uint8_t frame[LTM_MAX_MESSAGE_SIZE];
+        const uint8_t size = ltmFrameSize(i);
+        ltmEncodeFrame(i, frame);
+
+        if (slot->size != size || memcmp(slot->data, frame, size) != 0) {
+            memcpy(slot->data, frame, size);
+            slot->size = size;
+            slot->dirty = true;
+        }
 
-    if (current_schedule & LTM_BIT_OFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_oframe(dst);
-        ltm_finalise(dst);
+        if (!slot->due) {
+            slot->due = true;
+            // Catch up by one period at most after a stall
+            slot->nextDueMs = (int32_t)(now - slot->nextDueMs) >= slot->periodMs ? now + slot->periodMs : slot->nextDueMs + slot->periodMs;
+        }
     }
+}
+
+static void process_ltm(timeMs_t now)
+{
+    ltmTxCredit = MIN(ltmTxCredit + (now - ltmTxCreditMs) * ltmBytesPerSecond, sizeof(ltmTxBuffer) * 1000);
+    ltmTxCreditMs = now;
 
-    if (current_schedule & LTM_BIT_XFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_xframe(dst);
-        ltm_finalise(dst);
+    ltmUpdateDueFrames(now);
+
+    // Frames that changed go first when the line is short of room, the
+    // others wait for the next pass
+    const uint32_t room = MIN(ltmTxCredit / 1000, serialTxBytesFree(ltmPort));
+    bool send[LTM_FRAME_COUNT] = { false };
+    uint32_t length = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < LTM_FRAME_COUNT; i++) {
+            const ltmFrameSlot_t *slot = &ltmFrameSlots[i];
+
+            if (slot->due && !send[i] && slot->dirty == (pass == 0) && length + slot->size <= room) {
+                send[i] = true;
+                length += slot->size;
+            }
+        }
     }
-#endif
 
-    if (current_schedule & LTM_BIT_SFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_sframe(dst);
-        ltm_finalise(dst);
+    if (!length) {
+        return;
     }
 
-    if (current_schedule & LTM_BIT_NFRAME) {
-        ltm_initialise_packet(dst);
-        ltm_nframe(dst);
-        ltm_finalise(dst);
+    uint8_t *ptr = ltmTxBuffer;
+    for (unsigned i = 0; i < ARRAYLEN(ltmFrameOrder); i++) {
+        const ltm_frame_e frameType = ltmFrameOrder[i];
+        ltmFrameSlot_t *slot = &ltmFrameSlots[frameType];
+
+        if (!send[frameType]) {
+            continue;
+        }
+
+        memcpy(ptr, slot->data, slot->size);
+        ptr += slot->size;
+        slot->due = false;
+        slot->dirty = false;
+#if defined(USE_GPS)
+        if (frameType == LTM_XFRAME) {
+            ltm_x_counter++; // overflow is OK
+        }
+#endif
     }
 
-    ltm_scheduler = (ltm_scheduler + 1) % 10;
+    ltmTxCredit -= length * 1000;
+    serialWriteBuf(ltmPort, ltmTxBuffer, length);
 }
 
 void handleLtmTelemetry(void)
 {
-    static uint32_t ltm_lastCycleTime;
     if (!ltmEnabled)
         return;
     if (!ltmPort)
         return;
-    const uint32_t now = millis();
-    if ((now - ltm_lastCycleTime) >= LTM_CYCLETIME) {
-        process_ltm();
-        ltm_lastCycleTime = now;
-    }
+    process_ltm(millis());
 }
 
 void freeLtmTelemetryPort(void)
@@ -397,21 +463,6 @@ void initLtmTelemetry(void)
     ltmPortSharing = determinePortSharing(portConfig, FUNCTION_TELEMETRY_LTM);
 }
 
-
-
-static void configureLtmScheduler(void)
-{
-
-    /* setup scheduler, default to 'normal' */
-    if (telemetryConfig()->ltmUpdateRate == LTM_RATE_MEDIUM)
-        ltm_schedule = ltm_medium_schedule;
-    else if (telemetryConfig()->ltmUpdateRate == LTM_RATE_SLOW)
-        ltm_schedule = ltm_slow_schedule;
-    else
-        ltm_schedule = ltm_normal_schedule;
-
-}
-
 void configureLtmTelemetryPort(void)
 {
     if (!portConfig) {
@@ -422,15 +473,10 @@ void configureLtmTelemetryPort(void)
         baudRateIndex = BAUD_19200;
     }
 
-    /* Sanity check that we can support the scheduler */
-    if (baudRateIndex == BAUD_2400 && telemetryConfig()->ltmUpdateRate == LTM_RATE_NORMAL)
-         ltm_schedule = ltm_medium_schedule;
-    if (baudRateIndex == BAUD_1200)
-         ltm_schedule = ltm_slow_schedule;
-
     ltmPort = openSerialPort(portConfig->identifier, FUNCTION_TELEMETRY_LTM, NULL, NULL, baudRates[baudRateIndex], TELEMETRY_LTM_INITIAL_PORT_MODE, SERIAL_NOT_INVERTED);
     if (!ltmPort)
         return;
+    configureLtmScheduler(serialGetBaudRate(ltmPort));
     ltm_x_counter = 0;
     ltmEnabled = true;
 }
@@ -440,28 +486,25 @@ void checkLtmTelemetryState(void)
     if (portConfig && telemetryCheckRxPortShared(portConfig)) {
         if (!ltmEnabled && telemetrySharedPort != NULL) {
             ltmPort = telemetrySharedPort;
-            configureLtmScheduler();
+            configureLtmScheduler(serialGetBaudRate(ltmPort));
             ltmEnabled = true;
         }
     } else {
         bool newTelemetryEnabledValue = telemetryDetermineEnabledState(ltmPortSharing);
         if (newTelemetryEnabledValue == ltmEnabled)
             return;
-        if (newTelemetryEnabledValue){
-            configureLtmScheduler();
+        if (newTelemetryEnabledValue)
             configureLtmTelemetryPort();
-
-    }
         else
             freeLtmTelemetryPort();
     }
 }
 
+// Writes the function byte and the payload, at most LTM_MAX_PAYLOAD_SIZE + 1
+// bytes
 int getLtmFrame(uint8_t *frame, ltm_frame_e ltmFrameType)
 {
-    static uint8_t ltmFrame[LTM_MAX_MESSAGE_SIZE];
-
-    sbuf_t ltmFrameBuf = { .ptr = ltmFrame, .end =ARRAYEND(ltmFrame) };
+    sbuf_t ltmFrameBuf = { .ptr = frame, .end = frame + LTM_MAX_PAYLOAD_SIZE + 1 };
     sbuf_t * const sbuf = &ltmFrameBuf;
 
     switch (ltmFrameType) {
@@ -479,19 +522,15 @@ int getLtmFrame(uint8_t *frame, ltm_frame_e ltmFrameType)
     case LTM_OFRAME:
         ltm_oframe(sbuf);
         break;
-#endif
     case LTM_XFRAME:
         ltm_xframe(sbuf);
         break;
+#endif
     case LTM_NFRAME:
         ltm_nframe(sbuf);
         break;
     }
-    sbufSwitchToReader(sbuf, ltmFrame);
-    const int frameSize = sbufBytesRemaining(sbuf);
-    for (int ii = 0; sbufBytesRemaining(sbuf); ++ii) {
-        frame[ii] = sbufReadU8(sbuf);
-    }
-    return frameSize;
+
+    return sbuf->ptr - frame;
 }
 #endif
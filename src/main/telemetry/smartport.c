@@ -24,7 +24,6 @@
 #include "drivers/accgyro/accgyro.h"
 #include "drivers/compass/compass.h"
 #include "drivers/sensor.h"
-#include "drivers/time.h"
 
 #include "fc/config.h"
 #include "fc/controlrate_profile.h"
@@ -93,43 +92,9 @@ enum
     FSSP_DATAID_AZIMUTH    = 0x0460
 };
 
-const uint16_t frSkyDataIdTable[] = {
-    FSSP_DATAID_SPEED     ,
-    FSSP_DATAID_VFAS      ,
-    FSSP_DATAID_CURRENT   ,
-    //FSSP_DATAID_RPM       ,
-    FSSP_DATAID_ALTITUDE  ,
-    FSSP_DATAID_FUEL      ,
-    //FSSP_DATAID_ADC1      ,
-    //FSSP_DATAID_ADC2      ,
-    FSSP_DATAID_LATLONG   ,
-    FSSP_DATAID_LATLONG   , // twice
-    //FSSP_DATAID_CAP_USED  ,
-    FSSP_DATAID_VARIO     ,
-    //FSSP_DATAID_CELLS     ,
-    //FSSP_DATAID_CELLS_LAST,
-    FSSP_DATAID_HEADING   ,
-    FSSP_DATAID_FPV       ,
-    FSSP_DATAID_PITCH     ,
-    FSSP_DATAID_ROLL      ,
-    FSSP_DATAID_ACCX      ,
-    FSSP_DATAID_ACCY      ,
-    FSSP_DATAID_ACCZ      ,
-    FSSP_DATAID_T1        ,
-    FSSP_DATAID_T2        ,
-    FSSP_DATAID_HOME_DIST ,
-    FSSP_DATAID_GPS_ALT   ,
-    FSSP_DATAID_ASPD      ,
-    // FSSP_DATAID_A3        ,
-    FSSP_DATAID_A4        ,
-    FSSP_DATAID_AZIMUTH ,
-    0
-};
-
 #define __USE_C99_MATH // for roundf()
 #define SMARTPORT_BAUD 57600
 #define SMARTPORT_UART_MODE MODE_RXTX
-#define SMARTPORT_SERVICE_TIMEOUT_MS 1 // max allowed time to find a value to send
 
 static serialPort_t *smartPortSerialPort = NULL; // The 'SmartPort'(tm) Port.
 static serialPortConfig_t *portConfig;
@@ -144,7 +109,6 @@ enum
 };
 
 static uint8_t telemetryState = TELEMETRY_STATE_UNINITIALIZED;
-static uint8_t smartPortIdCnt = 0;
 
 typedef struct smartPortFrame_s {
     uint8_t  sensorId;
@@ -294,19 +258,31 @@ smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPor
     return NULL;
 }
 
-void smartPortSendByte(uint8_t c, uint16_t *checksum, serialPort_t *port)
+uint8_t *smartPortEncodeByte(uint8_t *ptr, uint8_t c, uint16_t *checksum)
 {
     // smart port escape sequence
     if (c == FSSP_DLE || c == FSSP_START_STOP) {
-        serialWrite(port, FSSP_DLE);
-        serialWrite(port, c ^ FSSP_DLE_XOR);
+        *ptr++ = FSSP_DLE;
+        *ptr++ = c ^ FSSP_DLE_XOR;
     } else {
-        serialWrite(port, c);
+        *ptr++ = c;
     }
 
     if (checksum != NULL) {
         frskyCheckSumStep(checksum, c);
     }
+
+    return ptr;
+}
+
+uint8_t *smartPortEncodeFrame(uint8_t *ptr, const smartPortPayload_t *payload, uint16_t checksum)
+{
+    const uint8_t *data = (const uint8_t *)payload;
+    for (unsigned i = 0; i < sizeof(smartPortPayload_t); i++) {
+        ptr = smartPortEncodeByte(ptr, *data++, &checksum);
+    }
+    frskyCheckSumFini(&checksum);
+    return smartPortEncodeByte(ptr, checksum, NULL);
 }
 
 bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload)
@@ -316,12 +292,9 @@ bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload)
 
 void smartPortWriteFrameSerial(const smartPortPayload_t *payload, serialPort_t *port, uint16_t checksum)
 {
-    uint8_t *data = (uint8_t *)payload;
-    for (unsigned i = 0; i < sizeof(smartPortPayload_t); i++) {
-        smartPortSendByte(*data++, &checksum, port);
-    }
-    frskyCheckSumFini(&checksum);
-    smartPortSendByte(checksum, NULL, port);
+    uint8_t frame[SMARTPORT_FRAME_ENCODED_MAX];
+    const uint8_t *end = smartPortEncodeFrame(frame, payload, checksum);
+    serialWriteBuf(port, frame, end - frame);
 }
 
 static void smartPortWriteFrameInternal(const smartPortPayload_t *payload)
@@ -417,7 +390,307 @@ static bool smartPortShouldSendGPSData(void)
     return feature(FEATURE_GPS) && (STATE(GPS_FIX) || !ARMING_FLAG(WAS_EVER_ARMED));
 }
 
-void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clearToSend, const uint32_t *requestTimeout)
+// Polls a sensor gets relative to the others, and what it needs to be sent.
+// The needs that come from the configuration are checked once when the
+// schedule is built, the others on every poll.
+typedef enum {
+    SMARTPORT_NEEDS_VOLTAGE     = 1 << 0,
+    SMARTPORT_NEEDS_AMPERAGE    = 1 << 1,
+    SMARTPORT_NEEDS_FUEL        = 1 << 2,
+    SMARTPORT_NEEDS_PITCH_ROLL  = 1 << 3,
+    SMARTPORT_NEEDS_ACC         = 1 << 4,
+    SMARTPORT_NEEDS_BARO        = 1 << 5,
+    SMARTPORT_NEEDS_GPS         = 1 << 6,
+    SMARTPORT_NEEDS_PITOT       = 1 << 7,
+} smartPortNeeds_e;
+
+#define SMARTPORT_NEEDS_CONFIG  (SMARTPORT_NEEDS_VOLTAGE | SMARTPORT_NEEDS_AMPERAGE | SMARTPORT_NEEDS_FUEL | SMARTPORT_NEEDS_PITCH_ROLL | SMARTPORT_NEEDS_ACC)
+
+typedef struct smartPortSensor_s {
+    uint16_t id;
+    uint8_t weight;
+    uint8_t needs;              // smartPortNeeds_e
+    uint32_t (*value)(void);
+} smartPortSensor_t;
+
+static uint32_t smartPortVfas(void)
+{
+    return telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage();
+}
+
+static uint32_t smartPortCurrent(void)
+{
+    return getAmperage() / 10; // given in 10mA steps, unknown requested unit
+}
+
+static uint32_t smartPortAltitude(void)
+{
+    return getEstimatedActualPosition(Z); // unknown given unit, requested 100 = 1 meter
+}
+
+static uint32_t smartPortVario(void)
+{
+    return lrintf(getEstimatedActualVelocity(Z)); // unknown given unit but requested in 100 = 1m/s
+}
+
+static uint32_t smartPortFuel(void)
+{
+    switch (telemetryConfig()->smartportFuelUnit) {
+        case SMARTPORT_FUEL_UNIT_PERCENT:
+            return calculateBatteryPercentage(); // Show remaining battery % if smartport_fuel_percent=ON
+        case SMARTPORT_FUEL_UNIT_MAH:
+            return getMAhDrawn();
+        default:
+            return getMWhDrawn();
+    }
+}
+
+static uint32_t smartPortCellVoltage(void)
+{
+    return getBatteryAverageCellVoltage();
+}
+
+static uint32_t smartPortHeading(void)
+{
+    return attitude.values.yaw * 10; // given in 10*deg, requested in 10000 = 100 deg
+}
+
+static uint32_t smartPortPitch(void)
+{
+    return attitude.values.pitch; // given in 10*deg
+}
+
+static uint32_t smartPortRoll(void)
+{
+    return attitude.values.roll; // given in 10*deg
+}
+
+static uint32_t smartPortAccX(void)
+{
+    return lrintf(100 * acc.accADCf[X]);
+}
+
+static uint32_t smartPortAccY(void)
+{
+    return lrintf(100 * acc.accADCf[Y]);
+}
+
+static uint32_t smartPortAccZ(void)
+{
+    return lrintf(100 * acc.accADCf[Z]);
+}
+
+// Only worked out again when the flags it's made of change
+static uint32_t smartPortFlightMode(void)
+{
+    static uint32_t cachedArmingFlags;
+    static uint32_t cachedFlightModeFlags;
+    static uint16_t cachedFlightMode;
+    static bool cached = false;
+
+    if (!cached || armingFlags != cachedArmingFlags || flightModeFlags != cachedFlightModeFlags) {
+        cachedArmingFlags = armingFlags;
+        cachedFlightModeFlags = flightModeFlags;
+        cachedFlightMode = frskyGetFlightMode();
+        cached = true;
+    }
+
+    return cachedFlightMode;
+}
+
+#ifdef USE_GPS
+static uint32_t smartPortGpsState(void)
+{
+    return frskyGetGPSState();
+}
+
+static uint32_t smartPortSpeed(void)
+{
+    //convert to knots: 1cm/s = 0.0194384449 knots
+    //Speed should be sent in knots/1000 (GPS speed is in cm/s)
+    return gpsSol.groundSpeed * 1944 / 100;
+}
+
+// The same ID is sent for both, the MSB tells longitude from latitude
+static uint32_t smartPortLatitude(void)
+{
+    uint32_t tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
+    tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
+    if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
+    return tmpui;
+}
+
+static uint32_t smartPortLongitude(void)
+{
+    uint32_t tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
+    tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
+    if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
+    return tmpui;
+}
+
+static uint32_t smartPortHomeDistance(void)
+{
+    return GPS_distanceToHome;
+}
+
+static uint32_t smartPortGpsAltitude(void)
+{
+    return gpsSol.llh.alt; // cm
+}
+
+static uint32_t smartPortCourse(void)
+{
+    return gpsSol.groundCourse; // given in 10*deg
+}
+
+static uint32_t smartPortAzimuth(void)
+{
+    int16_t h = GPS_directionToHome;
+    if (h < 0) {
+        h += 360;
+    }
+    if(h >= 180)
+        h = h - 180;
+    else
+        h = h + 180;
+    return h * 10; // given in 10*deg
+}
+#endif
+
+#ifdef USE_PITOT
+static uint32_t smartPortAirspeed(void)
+{
+    return getAirspeedEstimate() * 0.194384449f; // cm/s to knots*1
+}
+#endif
+
+// In order of priority, which breaks ties between sensors that are due
+static const smartPortSensor_t smartPortSensors[] = {
+    { FSSP_DATAID_VARIO,     4, SMARTPORT_NEEDS_BARO,       smartPortVario },
+    { FSSP_DATAID_ALTITUDE,  3, SMARTPORT_NEEDS_BARO,       smartPortAltitude },
+    { FSSP_DATAID_VFAS,      2, SMARTPORT_NEEDS_VOLTAGE,    smartPortVfas },
+    { FSSP_DATAID_CURRENT,   2, SMARTPORT_NEEDS_AMPERAGE,   smartPortCurrent },
+    { FSSP_DATAID_T1,        2, 0,                          smartPortFlightMode },
+    { FSSP_DATAID_HEADING,   2, 0,                          smartPortHeading },
+    { FSSP_DATAID_PITCH,     2, SMARTPORT_NEEDS_PITCH_ROLL, smartPortPitch },
+    { FSSP_DATAID_ROLL,      2, SMARTPORT_NEEDS_PITCH_ROLL, smartPortRoll },
+    { FSSP_DATAID_ACCX,      1, SMARTPORT_NEEDS_ACC,        smartPortAccX },
+    { FSSP_DATAID_ACCY,      1, SMARTPORT_NEEDS_ACC,        smartPortAccY },
+    { FSSP_DATAID_ACCZ,      1, SMARTPORT_NEEDS_ACC,        smartPortAccZ },
+#ifdef USE_GPS
+    { FSSP_DATAID_LATLONG,   2, SMARTPORT_NEEDS_GPS,        smartPortLatitude },
+    { FSSP_DATAID_LATLONG,   2, SMARTPORT_NEEDS_GPS,        smartPortLongitude },
+    { FSSP_DATAID_SPEED,     2, SMARTPORT_NEEDS_GPS,        smartPortSpeed },
+    { FSSP_DATAID_T2,        1, SMARTPORT_NEEDS_GPS,        smartPortGpsState },
+    { FSSP_DATAID_GPS_ALT,   1, SMARTPORT_NEEDS_GPS,        smartPortGpsAltitude },
+    { FSSP_DATAID_HOME_DIST, 1, SMARTPORT_NEEDS_GPS,        smartPortHomeDistance },
+    { FSSP_DATAID_FPV,       1, SMARTPORT_NEEDS_GPS,        smartPortCourse },
+    { FSSP_DATAID_AZIMUTH,   1, SMARTPORT_NEEDS_GPS,        smartPortAzimuth },
+#endif
+#ifdef USE_PITOT
+    { FSSP_DATAID_ASPD,      2, SMARTPORT_NEEDS_PITOT,      smartPortAirspeed },
+#endif
+    { FSSP_DATAID_FUEL,      1, SMARTPORT_NEEDS_FUEL,       smartPortFuel },
+    { FSSP_DATAID_A4,        1, SMARTPORT_NEEDS_VOLTAGE,    smartPortCellVoltage },
+};
+
+typedef struct smartPortScheduleEntry_s {
+    const smartPortSensor_t *sensor;
+    int16_t credit;
+} smartPortScheduleEntry_t;
+
+static smartPortScheduleEntry_t smartPortSchedule[ARRAYLEN(smartPortSensors)];
+static uint8_t smartPortScheduleCount;
+static bool smartPortScheduleBuilt = false;
+
+static uint8_t smartPortConfigNeeds(void)
+{
+    uint8_t met = 0;
+
+    if (isBatteryVoltageConfigured()) {
+        met |= SMARTPORT_NEEDS_VOLTAGE;
+    }
+    if (isAmperageConfigured()) {
+        met |= SMARTPORT_NEEDS_AMPERAGE;
+    }
+    if (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_PERCENT || isAmperageConfigured()) {
+        met |= SMARTPORT_NEEDS_FUEL;
+    }
+    met |= telemetryConfig()->frsky_pitch_roll ? SMARTPORT_NEEDS_PITCH_ROLL : SMARTPORT_NEEDS_ACC;
+
+    return met;
+}
+
+static uint8_t smartPortPollNeeds(void)
+{
+    uint8_t met = 0;
+
+    if (sensors(SENSOR_BARO)) {
+        met |= SMARTPORT_NEEDS_BARO;
+    }
+    if (smartPortShouldSendGPSData()) {
+        met |= SMARTPORT_NEEDS_GPS;
+    }
+#ifdef USE_PITOT
+    if (sensors(SENSOR_PITOT) && pitotIsHealthy()) {
+        met |= SMARTPORT_NEEDS_PITOT;
+    }
+#endif
+
+    return met;
+}
+
+// Built on the first poll, once the sensors have been detected
+static void smartPortBuildSchedule(void)
+{
+    const uint8_t met = smartPortConfigNeeds();
+
+    smartPortScheduleCount = 0;
+    for (unsigned i = 0; i < ARRAYLEN(smartPortSensors); i++) {
+        const uint8_t configNeeds = smartPortSensors[i].needs & SMARTPORT_NEEDS_CONFIG;
+        if ((configNeeds & met) == configNeeds) {
+            smartPortSchedule[smartPortScheduleCount].sensor = &smartPortSensors[i];
+            smartPortSchedule[smartPortScheduleCount].credit = 0;
+            smartPortScheduleCount++;
+        }
+    }
+
+    smartPortScheduleBuilt = true;
+}
+
+// Smooth weighted round robin over the sensors that can be sent: each one
+// gets its weight worth of credit per poll and the richest one is sent,
+// paying for it with the credit handed out. Every sensor gets its share of
+// the polls, evenly spread, and an unavailable sensor's share goes to the
+// others.
+static const smartPortSensor_t *smartPortNextSensor(void)
+{
+    const uint8_t met = smartPortPollNeeds() | SMARTPORT_NEEDS_CONFIG;
+    smartPortScheduleEntry_t *next = NULL;
+    int16_t handedOut = 0;
+
+    for (unsigned i = 0; i < smartPortScheduleCount; i++) {
+        smartPortScheduleEntry_t *entry = &smartPortSchedule[i];
+        if ((entry->sensor->needs & met) != entry->sensor->needs) {
+            continue;
+        }
+
+        entry->credit += entry->sensor->weight;
+        handedOut += entry->sensor->weight;
+        if (!next || entry->credit > next->credit) {
+            next = entry;
+        }
+    }
+
+    if (!next) {
+        return NULL;
+    }
+
+    next->credit -= handedOut;
+    return next->sensor;
+}
+
+void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clearToSend)
 {
     if (payload) {
         // do not check the physical ID here again
@@ -432,202 +705,28 @@ void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *clear
 #endif
     }
 
-    bool doRun = true;
-    while (doRun && *clearToSend) {
-        // Ensure we won't get stuck in the loop if there happens to be nothing available to send in a timely manner - dump the slot if we loop in there for too long.
-        if (requestTimeout) {
-            if (millis() >= *requestTimeout) {
-                *clearToSend = false;
-
-                return;
-            }
-        } else {
-            doRun = false;
-        }
+    if (!*clearToSend) {
+        return;
+    }
 
 #if defined(USE_MSP_OVER_TELEMETRY)
-        if (smartPortMspReplyPending) {
-            smartPortMspReplyPending = sendMspReply(SMARTPORT_MSP_PAYLOAD_SIZE, &smartPortSendMspResponse);
-            *clearToSend = false;
+    if (smartPortMspReplyPending) {
+        smartPortMspReplyPending = sendMspReply(SMARTPORT_MSP_PAYLOAD_SIZE, &smartPortSendMspResponse);
+        *clearToSend = false;
 
-            return;
-        }
+        return;
+    }
 #endif
 
-        // we can send back any data we want, our table keeps track of the order and frequency of each data type we send
-        uint16_t id = frSkyDataIdTable[smartPortIdCnt];
-        if (id == 0) { // end of table reached, loop back
-            smartPortIdCnt = 0;
-            id = frSkyDataIdTable[smartPortIdCnt];
-        }
-        smartPortIdCnt++;
-
-        switch (id) {
-            case FSSP_DATAID_VFAS       :
-                if (isBatteryVoltageConfigured()) {
-                    uint16_t vfasVoltage = telemetryConfig()->report_cell_voltage ? getBatteryAverageCellVoltage() : getBatteryVoltage();
-                    smartPortSendPackage(id, vfasVoltage);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_CURRENT    :
-                if (isAmperageConfigured()) {
-                    smartPortSendPackage(id, getAmperage() / 10); // given in 10mA steps, unknown requested unit
-                    *clearToSend = false;
-                }
-                break;
-            //case FSSP_DATAID_RPM        :
-            case FSSP_DATAID_ALTITUDE   :
-                if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, getEstimatedActualPosition(Z)); // unknown given unit, requested 100 = 1 meter
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_FUEL       :
-                if (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_PERCENT) {
-                    smartPortSendPackage(id, calculateBatteryPercentage()); // Show remaining battery % if smartport_fuel_percent=ON
-                    *clearToSend = false;
-                } else if (isAmperageConfigured()) {
-                    smartPortSendPackage(id, (telemetryConfig()->smartportFuelUnit == SMARTPORT_FUEL_UNIT_MAH ? getMAhDrawn() : getMWhDrawn()));
-                    *clearToSend = false;
-                }
-                break;
-            //case FSSP_DATAID_ADC1       :
-            //case FSSP_DATAID_ADC2       :
-            //case FSSP_DATAID_CAP_USED   :
-            case FSSP_DATAID_VARIO      :
-                if (sensors(SENSOR_BARO)) {
-                    smartPortSendPackage(id, lrintf(getEstimatedActualVelocity(Z))); // unknown given unit but requested in 100 = 1m/s
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_HEADING    :
-                smartPortSendPackage(id, attitude.values.yaw * 10); // given in 10*deg, requested in 10000 = 100 deg
-                *clearToSend = false;
-                break;
-            case FSSP_DATAID_PITCH      :
-                if (telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, attitude.values.pitch); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ROLL       :
-                if (telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, attitude.values.roll); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCX       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[X]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCY       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[Y]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ACCZ       :
-                if (!telemetryConfig()->frsky_pitch_roll) {
-                    smartPortSendPackage(id, lrintf(100 * acc.accADCf[Z]));
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_T1         :
-                {
-                    smartPortSendPackage(id, frskyGetFlightMode());
-                    *clearToSend = false;
-                    break;
-                }
-#ifdef USE_GPS
-            case FSSP_DATAID_T2         :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, frskyGetGPSState());
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_SPEED      :
-                if (smartPortShouldSendGPSData()) {
-                    //convert to knots: 1cm/s = 0.0194384449 knots
-                    //Speed should be sent in knots/1000 (GPS speed is in cm/s)
-                    uint32_t tmpui = gpsSol.groundSpeed * 1944 / 100;
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_LATLONG    :
-                if (smartPortShouldSendGPSData()) {
-                    uint32_t tmpui = 0;
-                    // the same ID is sent twice, one for longitude, one for latitude
-                    // the MSB of the sent uint32_t helps FrSky keep track
-                    // the even/odd bit of our counter helps us keep track
-                    if (smartPortIdCnt & 1) {
-                        tmpui = abs(gpsSol.llh.lon);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25 | 0x80000000;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lon < 0) tmpui |= 0x40000000;
-                    }
-                    else {
-                        tmpui = abs(gpsSol.llh.lat);  // now we have unsigned value and one bit to spare
-                        tmpui = (tmpui + tmpui / 2) / 25;  // 6/100 = 1.5/25, division by power of 2 is fast
-                        if (gpsSol.llh.lat < 0) tmpui |= 0x40000000;
-                    }
-                    smartPortSendPackage(id, tmpui);
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_HOME_DIST  :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, GPS_distanceToHome);
-                     *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_GPS_ALT    :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, gpsSol.llh.alt); // cm
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_FPV       :
-                if (smartPortShouldSendGPSData()) {
-                    smartPortSendPackage(id, gpsSol.groundCourse); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_AZIMUTH    :
-                if (smartPortShouldSendGPSData()) {
-                    int16_t h = GPS_directionToHome;
-                    if (h < 0) {
-                        h += 360;
-                    }
-                    if(h >= 180)
-                        h = h - 180;
-                    else
-                        h = h + 180;
-                    smartPortSendPackage(id, h *10); // given in 10*deg
-                    *clearToSend = false;
-                }
-                break;
-#endif
-            case FSSP_DATAID_A4         :
-                if (isBatteryVoltageConfigured()) {
-                    smartPortSendPackage(id, getBatteryAverageCellVoltage());
-                    *clearToSend = false;
-                }
-                break;
-            case FSSP_DATAID_ASPD       :
-#ifdef USE_PITOT
-                if (sensors(SENSOR_PITOT) && pitotIsHealthy()) {
-                    smartPortSendPackage(id, getAirspeedEstimate() * 0.194384449f); // cm/s to knots*1
-                    *clearToSend = false;
-                }
-#endif
-                break;
-            default:
-                break;
-                // if nothing is sent, hasRequest isn't cleared, we already incremented the counter, just loop back to the start
-        }
+    if (!smartPortScheduleBuilt) {
+        smartPortBuildSchedule();
+    }
+
+    // With nothing to send the slot is left alone, FPort answers it empty
+    const smartPortSensor_t *sensor = smartPortNextSensor();
+    if (sensor) {
+        smartPortSendPackage(sensor->id, sensor->value());
+        *clearToSend = false;
     }
 }
 
@@ -641,13 +740,12 @@ void handleSmartPortTelemetry(void)
     if (telemetryState == TELEMETRY_STATE_INITIALIZED_SERIAL && smartPortSerialPort) {
         bool clearToSend = false;
         smartPortPayload_t *payload = NULL;
-        const uint32_t requestTimeout = millis() + SMARTPORT_SERVICE_TIMEOUT_MS;
         while (serialRxBytesWaiting(smartPortSerialPort) > 0 && !payload) {
             uint8_t c = serialRead(smartPortSerialPort);
             payload = smartPortDataReceive(c, &clearToSend, serialCheckQueueEmpty, true);
         }
 
-        processSmartPortTelemetry(payload, &clearToSend, &requestTimeout);
+        processSmartPortTelemetry(payload, &clearToSend);
     }
 }
 #endif
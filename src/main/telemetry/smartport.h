@@ -50,11 +50,18 @@ void checkSmartPortTelemetryState(void);
 bool initSmartPortTelemetryExternal(smartPortWriteFrameFn *smartPortWriteFrameExternal);
 
 void handleSmartPortTelemetry(void);
-void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *hasRequest, const uint32_t *requestTimeout);
+void processSmartPortTelemetry(smartPortPayload_t *payload, volatile bool *hasRequest);
 
 smartPortPayload_t *smartPortDataReceive(uint16_t c, bool *clearToSend, smartPortCheckQueueEmptyFn *checkQueueEmpty, bool withChecksum);
 
+// Frame bytes escaped on the way out, so at most twice as many of them
+#define SMARTPORT_FRAME_ENCODED_MAX (2 * (sizeof(smartPortPayload_t) + 1))
+
+// Both return the end of what they wrote. The frame is the payload and the
+// checksum, which starts from checksum to cover any bytes encoded before.
+uint8_t *smartPortEncodeByte(uint8_t *ptr, uint8_t c, uint16_t *checksum);
+uint8_t *smartPortEncodeFrame(uint8_t *ptr, const smartPortPayload_t *payload, uint16_t checksum);
+
 struct serialPort_s;
 void smartPortWriteFrameSerial(const smartPortPayload_t *payload, struct serialPort_s *port, uint16_t checksum);
-void smartPortSendByte(uint8_t c, uint16_t *checksum, struct serialPort_s *port);
 bool smartPortPayloadContainsMSP(const smartPortPayload_t *payload);
@@ -39,7 +39,8 @@ typedef enum {
 typedef enum {
     LTM_RATE_NORMAL,
     LTM_RATE_MEDIUM,
-    LTM_RATE_SLOW
+    LTM_RATE_SLOW,
+    LTM_RATE_FAST
 } ltmUpdateRate_e;
 
 typedef enum {
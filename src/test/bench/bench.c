@@ -0,0 +1,114 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "bench.h"
+#include "bench_suites.h"
+
+volatile float benchSinkF;
+volatile uint32_t benchSinkU;
+
+static uint32_t benchRandomState = 0x12345678;
+
+static const char * const benchUnitNames[] = {
+    [BENCH_UNIT_NS] = "ns",
+    [BENCH_UNIT_INSN] = "insn",
+    [BENCH_UNIT_CYCLES] = "cycles",
+};
+
+void benchRandomSeed(uint32_t seed)
+{
+    benchRandomState = seed ? seed : 0x12345678;
+}
+
+// xorshift32, so inputs are the same on every platform
+uint32_t benchRandom(void)
+{
+    uint32_t x = benchRandomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    benchRandomState = x;
+    return x;
+}
+
+float benchRandomFloat(float min, float max)
+{
+    return min + (max - min) * ((benchRandom() & 0xFFFFFF) / (float)0xFFFFFF);
+}
+
+static void benchEmpty(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = i;
+    }
+}
+
+static uint64_t benchMeasure(void (*run)(uint32_t), uint32_t iterations)
+{
+    const uint64_t start = benchPlatformNow();
+    run(iterations);
+    return benchPlatformNow() - start;
+}
+
+static bool benchMatches(const char *filter, const char *suite, const char *kernel)
+{
+    if (!filter || !*filter) {
+        return true;
+    }
+    return strstr(suite, filter) || strstr(kernel, filter);
+}
+
+int benchRunAll(const char *filter)
+{
+    const char *unit = benchUnitNames[benchPlatformUnit()];
+
+    // Cost of the loop and the sink store, subtracted from every kernel
+    const uint64_t overhead = benchMeasure(benchEmpty, BENCH_DEFAULT_ITERATIONS);
+
+    // Output is line based so runs can be diffed by src/utils/bench_compare.py
+    printf("# platform: %s, unit: %s/call, iterations: %d\n", benchPlatformName(), unit, BENCH_DEFAULT_ITERATIONS);
+
+    for (unsigned s = 0; s < BENCH_SUITE_COUNT; s++) {
+        const benchSuite_t *suite = benchSuites[s];
+        for (unsigned k = 0; k < suite->kernelCount; k++) {
+            const benchKernel_t *kernel = &suite->kernels[k];
+            if (!benchMatches(filter, suite->name, kernel->name)) {
+                continue;
+            }
+
+            benchRandomSeed(0);
+            if (kernel->init) {
+                kernel->init();
+            }
+
+            // Warm up caches and branch predictors, then time
+            kernel->run(BENCH_DEFAULT_ITERATIONS / 10);
+            const uint64_t total = benchMeasure(kernel->run, BENCH_DEFAULT_ITERATIONS);
+            const uint64_t net = total > overhead ? total - overhead : 0;
+
+            // Fixed point with one decimal, newlib-nano printf has no float support
+            const uint32_t perCallX10 = (uint32_t)((net * 10) / BENCH_DEFAULT_ITERATIONS);
+            printf("BENCH %s.%s %lu.%lu %s\n", suite->name, kernel->name,
+                (unsigned long)(perCallX10 / 10), (unsigned long)(perCallX10 % 10), unit);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,68 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Hot kernel benchmark harness. The same kernels are built for the host
+ * (wall clock, ns) and for Cortex-M4F/M7 running under QEMU with
+ * -icount shift=0 (one virtual ns per instruction) or on real hardware
+ * with the DWT cycle counter.
+ */
+
+#define BENCH_DEFAULT_ITERATIONS    10000
+
+typedef struct benchKernel_s {
+    const char *name;
+    void (*init)(void);                 // optional, called once before timing
+    void (*run)(uint32_t iterations);   // must run the kernel `iterations` times
+} benchKernel_t;
+
+typedef struct benchSuite_s {
+    const char *name;
+    const benchKernel_t *kernels;
+    uint8_t kernelCount;
+} benchSuite_t;
+
+#define BENCH_SUITE(suiteName, kernelTable) \
+    const benchSuite_t suiteName ## BenchSuite = { #suiteName, kernelTable, sizeof(kernelTable) / sizeof(kernelTable[0]) }
+
+typedef enum {
+    BENCH_UNIT_NS = 0,      // host wall clock
+    BENCH_UNIT_INSN,        // QEMU icount virtual time
+    BENCH_UNIT_CYCLES,      // DWT->CYCCNT on hardware
+} benchUnit_e;
+
+// Results of benchmarked code are written here so they can't be optimised out
+extern volatile float benchSinkF;
+extern volatile uint32_t benchSinkU;
+
+// Deterministic pseudo random input generator, identical on all platforms
+void benchRandomSeed(uint32_t seed);
+uint32_t benchRandom(void);
+float benchRandomFloat(float min, float max);
+
+// Provided by the platform layer (bench_host.c or cortex-m/bench_cortex_m.c)
+void benchPlatformInit(void);
+benchUnit_e benchPlatformUnit(void);
+uint64_t benchPlatformNow(void);    // in benchPlatformUnit() units
+const char *benchPlatformName(void);
+
+int benchRunAll(const char *filter);
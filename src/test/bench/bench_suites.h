@@ -0,0 +1,52 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "bench.h"
+
+// Keep these alphabetically sorted, one per *_bench.c file
+
+extern const benchSuite_t circularQueueBenchSuite;
+extern const benchSuite_t crcBenchSuite;
+extern const benchSuite_t dynamicLpfBenchSuite;
+extern const benchSuite_t filterBenchSuite;
+extern const benchSuite_t kalmanBenchSuite;
+extern const benchSuite_t mathsBenchSuite;
+extern const benchSuite_t mspBenchSuite;
+extern const benchSuite_t rxBenchSuite;
+extern const benchSuite_t sbusBenchSuite;
+extern const benchSuite_t servoMixerBenchSuite;
+extern const benchSuite_t servoOutputBenchSuite;
+extern const benchSuite_t smithPredictorBenchSuite;
+
+static const benchSuite_t * const benchSuites[] = {
+    &circularQueueBenchSuite,
+    &crcBenchSuite,
+    &dynamicLpfBenchSuite,
+    &filterBenchSuite,
+    &kalmanBenchSuite,
+    &mathsBenchSuite,
+    &mspBenchSuite,
+    &rxBenchSuite,
+    &sbusBenchSuite,
+    &servoMixerBenchSuite,
+    &servoOutputBenchSuite,
+    &smithPredictorBenchSuite,
+};
+
+#define BENCH_SUITE_COUNT (sizeof(benchSuites) / sizeof(benchSuites[0]))
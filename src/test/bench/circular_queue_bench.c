@@ -0,0 +1,90 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/circular_queue.h"
+
+#include "bench.h"
+
+#define QUEUE_BENCH_CAPACITY    64
+#define QUEUE_BENCH_BURST       16  // Bytes moved per iteration, like a short serial frame
+
+static uint8_t queueBenchData[QUEUE_BENCH_BURST];
+static uint8_t queueBenchStorage[QUEUE_BENCH_CAPACITY];
+static circularBuffer_t queueBenchLegacy;
+static spscRing_t queueBenchRing;
+
+static void queueBenchInit(void)
+{
+    for (int i = 0; i < QUEUE_BENCH_BURST; i++) {
+        queueBenchData[i] = benchRandom();
+    }
+    circularBufferInit(&queueBenchLegacy, queueBenchStorage, QUEUE_BENCH_CAPACITY, 1);
+    spscRingInit(&queueBenchRing, queueBenchStorage, QUEUE_BENCH_CAPACITY, 1);
+}
+
+static void circularBufferRun(uint32_t iterations)
+{
+    uint8_t byte;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (int j = 0; j < QUEUE_BENCH_BURST; j++) {
+            circularBufferPushElement(&queueBenchLegacy, &queueBenchData[j]);
+        }
+        for (int j = 0; j < QUEUE_BENCH_BURST; j++) {
+            circularBufferPopHead(&queueBenchLegacy, &byte);
+            benchSinkU = byte;
+        }
+    }
+}
+
+static void spscRingRun(uint32_t iterations)
+{
+    uint8_t byte;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        for (int j = 0; j < QUEUE_BENCH_BURST; j++) {
+            spscRingPush(&queueBenchRing, &queueBenchData[j]);
+        }
+        for (int j = 0; j < QUEUE_BENCH_BURST; j++) {
+            spscRingPop(&queueBenchRing, &byte);
+            benchSinkU = byte;
+        }
+    }
+}
+
+static void spscRingBulkRun(uint32_t iterations)
+{
+    uint8_t burst[QUEUE_BENCH_BURST];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        spscRingPushBulk(&queueBenchRing, queueBenchData, QUEUE_BENCH_BURST);
+        spscRingPopBulk(&queueBenchRing, burst, QUEUE_BENCH_BURST);
+        benchSinkU = burst[QUEUE_BENCH_BURST - 1];
+    }
+}
+
+static const benchKernel_t circularQueueBenchKernels[] = {
+    { "circularBuffer_push_pop", queueBenchInit, circularBufferRun },
+    { "spscRing_push_pop", queueBenchInit, spscRingRun },
+    { "spscRing_bulk", queueBenchInit, spscRingBulkRun },
+};
+
+BENCH_SUITE(circularQueue, circularQueueBenchKernels);
@@ -0,0 +1,155 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "bench.h"
+
+/*
+ * Minimal bare metal runtime for the benchmark image. Output goes through
+ * semihosting (newlib rdimon), so the same ELF runs under
+ * qemu-system-arm -semihosting or on a board attached to a debug probe.
+ */
+
+#define REG32(addr)             (*(volatile uint32_t *)(addr))
+
+#define SCB_CPACR               REG32(0xE000ED88)
+#define SYST_CSR                REG32(0xE000E010)
+#define SYST_RVR                REG32(0xE000E014)
+#define SYST_CVR                REG32(0xE000E018)
+#define DEMCR                   REG32(0xE000EDFC)
+#define DWT_CTRL                REG32(0xE0001000)
+#define DWT_CYCCNT              REG32(0xE0001004)
+
+#define SYST_CSR_ENABLE         (1 << 0)
+#define SYST_CSR_TICKINT        (1 << 1)
+#define SYST_CSR_CLKSOURCE      (1 << 2)
+#define SYST_RELOAD             0x00FFFFFF
+#define DEMCR_TRCENA            (1 << 24)
+#define DWT_CTRL_CYCCNTENA      (1 << 0)
+
+extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss, _estack;
+
+extern void initialise_monitor_handles(void);
+extern int main(int argc, char *argv[]);
+
+static volatile uint32_t sysTickWraps;
+static uint32_t cycCntHigh;
+static uint32_t cycCntLast;
+static bool useCycleCounter;
+
+void SysTick_Handler(void)
+{
+    sysTickWraps++;
+}
+
+static void Default_Handler(void)
+{
+    // Report the fault to the simulator instead of spinning forever
+    exit(1);
+}
+
+void Reset_Handler(void)
+{
+    uint32_t *src = &_sidata;
+    for (uint32_t *dst = &_sdata; dst < &_edata; ) {
+        *dst++ = *src++;
+    }
+    for (uint32_t *dst = &_sbss; dst < &_ebss; ) {
+        *dst++ = 0;
+    }
+
+    // Full access to CP10 and CP11 (FPU)
+    SCB_CPACR |= (0xF << 20);
+    __asm volatile ("dsb\n\tisb" ::: "memory");
+
+    initialise_monitor_handles();
+    exit(main(0, NULL));
+}
+
+__attribute__((section(".isr_vector"), used))
+static void (* const benchVectors[16])(void) = {
+    (void (*)(void))&_estack,
+    Reset_Handler,
+    Default_Handler,    // NMI
+    Default_Handler,    // HardFault
+    Default_Handler,    // MemManage
+    Default_Handler,    // BusFault
+    Default_Handler,    // UsageFault
+    0, 0, 0, 0,
+    Default_Handler,    // SVC
+    Default_Handler,    // DebugMon
+    0,
+    Default_Handler,    // PendSV
+    SysTick_Handler,
+};
+
+void benchPlatformInit(void)
+{
+    // DWT is only modelled on real silicon. QEMU reads it as zero, in which
+    // case SysTick is used and, with -icount shift=0, counts instructions.
+    DEMCR |= DEMCR_TRCENA;
+    DWT_CYCCNT = 0;
+    DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+    __asm volatile ("nop\n\tnop\n\tnop\n\tnop" ::: "memory");
+    useCycleCounter = DWT_CYCCNT != 0;
+
+    SYST_RVR = SYST_RELOAD;
+    SYST_CVR = 0;
+    SYST_CSR = SYST_CSR_CLKSOURCE | SYST_CSR_TICKINT | SYST_CSR_ENABLE;
+}
+
+benchUnit_e benchPlatformUnit(void)
+{
+    return useCycleCounter ? BENCH_UNIT_CYCLES : BENCH_UNIT_INSN;
+}
+
+static uint64_t sysTickNow(void)
+{
+    uint32_t wraps;
+    uint32_t value;
+
+    do {
+        wraps = sysTickWraps;
+        value = SYST_CVR;
+    } while (wraps != sysTickWraps);
+
+    return ((uint64_t)wraps << 24) + (SYST_RELOAD - value);
+}
+
+uint64_t benchPlatformNow(void)
+{
+    if (useCycleCounter) {
+        // Kernels run for far less than a counter period, so extending
+        // on read is enough to get a monotonic 64 bit value
+        const uint32_t now = DWT_CYCCNT;
+        if (now < cycCntLast) {
+            cycCntHigh++;
+        }
+        cycCntLast = now;
+        return ((uint64_t)cycCntHigh << 32) | now;
+    }
+
+    // One instruction per virtual ns with -icount shift=0
+    return sysTickNow() * 1000000000ULL / BENCH_SYSTICK_HZ;
+}
+
+const char *benchPlatformName(void)
+{
+    return BENCH_PLATFORM_NAME;
+}
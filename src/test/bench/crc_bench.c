@@ -0,0 +1,64 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/crc.h"
+
+#include "bench.h"
+
+#define CRC_BENCH_FRAME_SIZE    64  // Largest CRSF frame
+
+static uint8_t crcBenchFrame[CRC_BENCH_FRAME_SIZE];
+
+static void crcBenchInit(void)
+{
+    for (int i = 0; i < CRC_BENCH_FRAME_SIZE; i++) {
+        crcBenchFrame[i] = benchRandom();
+    }
+}
+
+static void crc8DvbS2Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = crc8_dvb_s2_update(0, crcBenchFrame, CRC_BENCH_FRAME_SIZE);
+    }
+}
+
+static void crc16CcittRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = crc16_ccitt_update(0, crcBenchFrame, CRC_BENCH_FRAME_SIZE);
+    }
+}
+
+static void crc8Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = crc8_update(0, crcBenchFrame, CRC_BENCH_FRAME_SIZE);
+    }
+}
+
+static const benchKernel_t crcBenchKernels[] = {
+    { "crc8_dvb_s2_update", crcBenchInit, crc8DvbS2Run },
+    { "crc16_ccitt_update", crcBenchInit, crc16CcittRun },
+    { "crc8_update", crcBenchInit, crc8Run },
+};
+
+BENCH_SUITE(crc, crcBenchKernels);
@@ -0,0 +1,96 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+
+#include "flight/dynamic_lpf_table.h"
+
+#include "bench.h"
+
+/*
+ * Cost of one dynamic gyro LPF update, all three axes, biquad with the
+ * default 200-500Hz range at 1kHz: the cutoff from the throttle curve and
+ * the coefficients recomputed with trig, as the AUX task did at 100Hz, and
+ * the table lookup gyroFilter() now does on every loop. The throttle
+ * changes on every update, so the table never skips one.
+ */
+
+#define DYN_LPF_BENCH_SAMPLES   256
+#define DYN_LPF_BENCH_LOOPTIME  1000
+#define DYN_LPF_BENCH_MIN_HZ    200
+#define DYN_LPF_BENCH_MAX_HZ    500
+#define DYN_LPF_BENCH_EXPO      5
+
+static float dynLpfBenchThrottle[DYN_LPF_BENCH_SAMPLES];
+static filter_t dynLpfBenchState[XYZ_AXIS_COUNT];
+static dynLpfTable_t dynLpfBenchTable;
+
+static void dynLpfBenchInit(void)
+{
+    for (int i = 0; i < DYN_LPF_BENCH_SAMPLES; i++) {
+        dynLpfBenchThrottle[i] = benchRandomFloat(0.0f, 1.0f);
+    }
+    // Consecutive samples on different steps
+    for (int i = 1; i < DYN_LPF_BENCH_SAMPLES; i++) {
+        if (dynLpfTableIndex(dynLpfBenchThrottle[i]) == dynLpfTableIndex(dynLpfBenchThrottle[i - 1])) {
+            dynLpfBenchThrottle[i] = dynLpfBenchThrottle[i - 1] > 0.5f ? dynLpfBenchThrottle[i - 1] - 0.25f : dynLpfBenchThrottle[i - 1] + 0.25f;
+        }
+    }
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInitLPF(&dynLpfBenchState[axis].biquad, DYN_LPF_BENCH_MIN_HZ, DYN_LPF_BENCH_LOOPTIME);
+    }
+    dynLpfTableInit(&dynLpfBenchTable, FILTER_BIQUAD, DYN_LPF_BENCH_MIN_HZ, DYN_LPF_BENCH_MAX_HZ, DYN_LPF_BENCH_EXPO, DYN_LPF_BENCH_LOOPTIME);
+}
+
+static void recomputeRun(uint32_t iterations)
+{
+    const float expof = DYN_LPF_BENCH_EXPO / 10.0f;
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        const float throttle = dynLpfBenchThrottle[i % DYN_LPF_BENCH_SAMPLES];
+        const float curve = throttle * (1 - throttle) * expof + throttle;
+        const float cutoffFreq = (DYN_LPF_BENCH_MAX_HZ - DYN_LPF_BENCH_MIN_HZ) * curve + DYN_LPF_BENCH_MIN_HZ;
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            biquadFilterUpdate(&dynLpfBenchState[axis].biquad, cutoffFreq, DYN_LPF_BENCH_LOOPTIME, BIQUAD_Q, FILTER_LPF);
+        }
+        benchSinkF = dynLpfBenchState[Z].biquad.b0;
+    }
+}
+
+static void tableRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint8_t index = dynLpfTableIndex(dynLpfBenchThrottle[i % DYN_LPF_BENCH_SAMPLES]);
+        dynLpfTableApply(&dynLpfBenchTable, index, dynLpfBenchState);
+        benchSinkF = dynLpfBenchState[Z].biquad.b0;
+    }
+}
+
+static const benchKernel_t dynamicLpfBenchKernels[] = {
+    { "recompute", dynLpfBenchInit, recomputeRun },
+    { "table", dynLpfBenchInit, tableRun },
+};
+
+BENCH_SUITE(dynamicLpf, dynamicLpfBenchKernels);
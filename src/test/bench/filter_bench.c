@@ -0,0 +1,107 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+
+#include "bench.h"
+
+#define FILTER_BENCH_SAMPLES        256
+#define FILTER_BENCH_LOOPTIME_US    250     // 4kHz gyro loop
+#define FILTER_BENCH_CUTOFF_HZ      90
+
+static float filterBenchInput[FILTER_BENCH_SAMPLES];
+
+static pt1Filter_t pt1;
+static pt2Filter_t pt2;
+static pt3Filter_t pt3;
+static biquadFilter_t biquad;
+static biquadFilter_t notch;
+
+static void filterBenchInit(void)
+{
+    const float dT = FILTER_BENCH_LOOPTIME_US * 1e-6f;
+
+    for (int i = 0; i < FILTER_BENCH_SAMPLES; i++) {
+        filterBenchInput[i] = benchRandomFloat(-2000.0f, 2000.0f);
+    }
+
+    pt1FilterInit(&pt1, FILTER_BENCH_CUTOFF_HZ, dT);
+    pt2FilterInit(&pt2, pt2FilterGain(FILTER_BENCH_CUTOFF_HZ, dT));
+    pt3FilterInit(&pt3, pt3FilterGain(FILTER_BENCH_CUTOFF_HZ, dT));
+    biquadFilterInitLPF(&biquad, FILTER_BENCH_CUTOFF_HZ, FILTER_BENCH_LOOPTIME_US);
+    biquadFilterInitNotch(&notch, FILTER_BENCH_LOOPTIME_US, 200, 150);
+}
+
+static void pt1Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = pt1FilterApply(&pt1, filterBenchInput[i % FILTER_BENCH_SAMPLES]);
+    }
+}
+
+static void pt2Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = pt2FilterApply(&pt2, filterBenchInput[i % FILTER_BENCH_SAMPLES]);
+    }
+}
+
+static void pt3Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = pt3FilterApply(&pt3, filterBenchInput[i % FILTER_BENCH_SAMPLES]);
+    }
+}
+
+static void biquadRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = biquadFilterApply(&biquad, filterBenchInput[i % FILTER_BENCH_SAMPLES]);
+    }
+}
+
+static void biquadNotchDF1Run(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = biquadFilterApplyDF1(&notch, filterBenchInput[i % FILTER_BENCH_SAMPLES]);
+    }
+}
+
+static void biquadUpdateRun(uint32_t iterations)
+{
+    // Coefficient recalculation as done by the dynamic notch and dynamic LPF
+    for (uint32_t i = 0; i < iterations; i++) {
+        biquadFilterUpdate(&biquad, 80 + (i & 127), FILTER_BENCH_LOOPTIME_US, BIQUAD_Q, FILTER_LPF);
+    }
+    benchSinkF = biquad.b0;
+}
+
+static const benchKernel_t filterBenchKernels[] = {
+    { "pt1FilterApply", filterBenchInit, pt1Run },
+    { "pt2FilterApply", filterBenchInit, pt2Run },
+    { "pt3FilterApply", filterBenchInit, pt3Run },
+    { "biquadFilterApply", filterBenchInit, biquadRun },
+    { "biquadFilterApplyDF1", filterBenchInit, biquadNotchDF1Run },
+    { "biquadFilterUpdate", filterBenchInit, biquadUpdateRun },
+};
+
+BENCH_SUITE(filter, filterBenchKernels);
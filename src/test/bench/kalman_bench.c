@@ -0,0 +1,143 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+
+#include "flight/kalman.h"
+
+#include "bench.h"
+
+/*
+ * Per PID loop cost of the setpoint Kalman filter on the gyro, all three
+ * axes, with the per axis filter used before the axes were processed in one
+ * pass (two divides per axis and a window of MAX_KALMAN_WINDOW_SIZE + 1
+ * slots) and with gyroKalmanUpdate(). Default setpoint_kalman_q.
+ */
+
+#define KALMAN_BENCH_SAMPLES    256
+#define KALMAN_BENCH_Q          100
+
+static float kalmanBenchGyro[KALMAN_BENCH_SAMPLES][XYZ_AXIS_COUNT];
+static float kalmanBenchSetpoint[KALMAN_BENCH_SAMPLES][XYZ_AXIS_COUNT];
+
+typedef struct {
+    float q, r, p, k, x, lastX, e;
+    float setpoint;
+    float axisVar;
+    uint16_t windex;
+    float axisWindow[MAX_KALMAN_WINDOW_SIZE + 1];
+    float varianceWindow[MAX_KALMAN_WINDOW_SIZE + 1];
+    float axisSumMean, axisMean, axisSumVar, inverseN;
+    uint16_t w;
+} kalmanBenchPerAxis_t;
+
+static kalmanBenchPerAxis_t kalmanBenchPerAxis[XYZ_AXIS_COUNT];
+
+static void kalmanBenchInit(void)
+{
+    for (int i = 0; i < KALMAN_BENCH_SAMPLES; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            kalmanBenchSetpoint[i][axis] = benchRandomFloat(-400.0f, 400.0f);
+            kalmanBenchGyro[i][axis] = kalmanBenchSetpoint[i][axis] + benchRandomFloat(-30.0f, 30.0f);
+        }
+    }
+
+    gyroKalmanInitialize(KALMAN_BENCH_Q);
+
+    memset(kalmanBenchPerAxis, 0, sizeof(kalmanBenchPerAxis));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        kalmanBenchPerAxis[axis].q = KALMAN_BENCH_Q * 0.03f;
+        kalmanBenchPerAxis[axis].r = 88.0f;
+        kalmanBenchPerAxis[axis].p = 30.0f;
+        kalmanBenchPerAxis[axis].e = 1.0f;
+        kalmanBenchPerAxis[axis].w = MAX_KALMAN_WINDOW_SIZE;
+        kalmanBenchPerAxis[axis].inverseN = 1.0f / MAX_KALMAN_WINDOW_SIZE;
+    }
+}
+
+static void kalmanBenchPerAxisVariance(kalmanBenchPerAxis_t *s, float rate)
+{
+    s->axisWindow[s->windex] = rate;
+    s->axisSumMean += s->axisWindow[s->windex];
+    float varianceElement = s->axisWindow[s->windex] - s->axisMean;
+    varianceElement = varianceElement * varianceElement;
+    s->axisSumVar += varianceElement;
+    s->varianceWindow[s->windex] = varianceElement;
+    s->windex++;
+    if (s->windex > s->w) {
+        s->windex = 0;
+    }
+    s->axisSumMean -= s->axisWindow[s->windex];
+    s->axisSumVar -= s->varianceWindow[s->windex];
+    s->axisMean = s->axisSumMean * s->inverseN;
+    s->axisVar = s->axisSumVar * s->inverseN;
+    s->r = sqrtf(s->axisVar) * VARIANCE_SCALE;
+}
+
+static float kalmanBenchPerAxisProcess(kalmanBenchPerAxis_t *s, float input)
+{
+    s->x += (s->x - s->lastX);
+    s->lastX = s->x;
+    if (s->lastX != 0.0f) {
+        s->e = fabsf(1.0f - (s->setpoint / s->lastX));
+    }
+    s->p = s->p + (s->q * s->e);
+    s->k = s->p / (s->p + s->r);
+    s->x += s->k * (input - s->x);
+    s->p = (1.0f - s->k) * s->p;
+    return s->x;
+}
+
+static void perAxisRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint32_t sample = i % KALMAN_BENCH_SAMPLES;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            kalmanBenchPerAxis[axis].setpoint = kalmanBenchSetpoint[sample][axis];
+            kalmanBenchPerAxisVariance(&kalmanBenchPerAxis[axis], kalmanBenchGyro[sample][axis]);
+            benchSinkF = kalmanBenchPerAxisProcess(&kalmanBenchPerAxis[axis], kalmanBenchGyro[sample][axis]);
+        }
+    }
+}
+
+static void gyroKalmanUpdateRun(uint32_t iterations)
+{
+    float gyroADCf[XYZ_AXIS_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        const uint32_t sample = i % KALMAN_BENCH_SAMPLES;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            gyroKalmanUpdateSetpoint(axis, kalmanBenchSetpoint[sample][axis]);
+            gyroADCf[axis] = kalmanBenchGyro[sample][axis];
+        }
+        gyroKalmanUpdate(gyroADCf);
+        benchSinkF = gyroADCf[Z];
+    }
+}
+
+static const benchKernel_t kalmanBenchKernels[] = {
+    { "perAxis", kalmanBenchInit, perAxisRun },
+    { "gyroKalmanUpdate", kalmanBenchInit, gyroKalmanUpdateRun },
+};
+
+BENCH_SUITE(kalman, kalmanBenchKernels);
@@ -0,0 +1,91 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+
+#include "bench.h"
+
+#define MATHS_BENCH_SAMPLES     256
+
+static float mathsBenchA[MATHS_BENCH_SAMPLES];
+static float mathsBenchB[MATHS_BENCH_SAMPLES];
+
+static void mathsBenchInit(void)
+{
+    for (int i = 0; i < MATHS_BENCH_SAMPLES; i++) {
+        mathsBenchA[i] = benchRandomFloat(-M_PIf, M_PIf);
+        mathsBenchB[i] = benchRandomFloat(-1000.0f, 1000.0f);
+    }
+}
+
+static void sinApproxRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = sin_approx(mathsBenchA[i % MATHS_BENCH_SAMPLES]);
+    }
+}
+
+static void atan2ApproxRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = atan2_approx(mathsBenchA[i % MATHS_BENCH_SAMPLES], mathsBenchB[i % MATHS_BENCH_SAMPLES]);
+    }
+}
+
+static void acosApproxRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = acos_approx(mathsBenchA[i % MATHS_BENCH_SAMPLES] / M_PIf);
+    }
+}
+
+static void fastFsqrtfRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkF = fast_fsqrtf(mathsBenchB[i % MATHS_BENCH_SAMPLES] + 1000.0f);
+    }
+}
+
+static void pythagorean3DRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const unsigned n = i % MATHS_BENCH_SAMPLES;
+        benchSinkF = calc_length_pythagorean_3D(mathsBenchA[n], mathsBenchB[n], mathsBenchA[(n + 1) % MATHS_BENCH_SAMPLES]);
+    }
+}
+
+static void scaleRangeRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = scaleRange(1000 + (i & 1023), 1000, 2000, -500, 500);
+    }
+}
+
+static const benchKernel_t mathsBenchKernels[] = {
+    { "sin_approx", mathsBenchInit, sinApproxRun },
+    { "atan2_approx", mathsBenchInit, atan2ApproxRun },
+    { "acos_approx", mathsBenchInit, acosApproxRun },
+    { "fast_fsqrtf", mathsBenchInit, fastFsqrtfRun },
+    { "calc_length_pythagorean_3D", mathsBenchInit, pythagorean3DRun },
+    { "scaleRange", mathsBenchInit, scaleRangeRun },
+};
+
+BENCH_SUITE(maths, mathsBenchKernels);
@@ -0,0 +1,130 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+
+#include "platform.h"
+
+#include "common/streambuf.h"
+
+#include "fc/fc_msp_replies.h"
+
+#include "flight/servos.h"
+
+#include "navigation/navigation.h"
+
+#include "bench.h"
+
+// Each reply built field by field, the way fc_msp.c used to, and filled
+// in place through fc_msp_replies
+
+#define MSP_BENCH_BUFFER_SIZE   512     // MSP_PORT_OUTBUF_SIZE without flash
+#define MSP_BENCH_WAYPOINTS     NAV_MAX_WAYPOINTS
+
+static uint8_t mspBenchBuffer[MSP_BENCH_BUFFER_SIZE];
+static servoParam_t mspBenchServos[MAX_SUPPORTED_SERVOS];
+static navWaypoint_t mspBenchWaypoints[MSP_BENCH_WAYPOINTS];
+
+static void mspBenchInit(void)
+{
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        mspBenchServos[i].min = 1000 + benchRandom() % 100;
+        mspBenchServos[i].max = 2000 - benchRandom() % 100;
+        mspBenchServos[i].middle = 1500 + benchRandom() % 50;
+        mspBenchServos[i].rate = benchRandom() % 125;
+    }
+    for (int i = 0; i < MSP_BENCH_WAYPOINTS; i++) {
+        mspBenchWaypoints[i].lat = benchRandom();
+        mspBenchWaypoints[i].lon = benchRandom();
+        mspBenchWaypoints[i].alt = benchRandom() % 100000;
+        mspBenchWaypoints[i].p1 = benchRandom();
+        mspBenchWaypoints[i].action = 1;
+        mspBenchWaypoints[i].flag = i == MSP_BENCH_WAYPOINTS - 1 ? 0xA5 : 0;
+    }
+}
+
+static void servoConfigurationsFieldsRun(uint32_t iterations)
+{
+    for (uint32_t n = 0; n < iterations; n++) {
+        sbuf_t buf;
+        sbuf_t *dst = sbufInit(&buf, mspBenchBuffer, mspBenchBuffer + MSP_BENCH_BUFFER_SIZE);
+        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+            sbufWriteU16(dst, mspBenchServos[i].min);
+            sbufWriteU16(dst, mspBenchServos[i].max);
+            sbufWriteU16(dst, mspBenchServos[i].middle);
+            sbufWriteU8(dst, mspBenchServos[i].rate);
+            sbufWriteU8(dst, 0);
+            sbufWriteU8(dst, 0);
+            sbufWriteU8(dst, 255);
+            sbufWriteU32(dst, 0);
+        }
+        benchSinkU = dst->ptr[-1];
+    }
+}
+
+// A whole mission download, one MSP_WP reply per waypoint
+static void waypointListFieldsRun(uint32_t iterations)
+{
+    for (uint32_t n = 0; n < iterations; n++) {
+        for (int i = 0; i < MSP_BENCH_WAYPOINTS; i++) {
+            sbuf_t buf;
+            sbuf_t *dst = sbufInit(&buf, mspBenchBuffer, mspBenchBuffer + MSP_BENCH_BUFFER_SIZE);
+            const navWaypoint_t *wp = &mspBenchWaypoints[i];
+            sbufWriteU8(dst, i);
+            sbufWriteU8(dst, wp->action);
+            sbufWriteU32(dst, wp->lat);
+            sbufWriteU32(dst, wp->lon);
+            sbufWriteU32(dst, wp->alt);
+            sbufWriteU16(dst, wp->p1);
+            sbufWriteU16(dst, wp->p2);
+            sbufWriteU16(dst, wp->p3);
+            sbufWriteU8(dst, wp->flag);
+            benchSinkU = dst->ptr[-1];
+        }
+    }
+}
+
+static void servoConfigurationsPackedRun(uint32_t iterations)
+{
+    for (uint32_t n = 0; n < iterations; n++) {
+        sbuf_t buf;
+        sbuf_t *dst = sbufInit(&buf, mspBenchBuffer, mspBenchBuffer + MSP_BENCH_BUFFER_SIZE);
+        mspSerializeServoConfigurations(dst, mspBenchServos, MAX_SUPPORTED_SERVOS);
+        benchSinkU = dst->ptr[-1];
+    }
+}
+
+static void waypointListPackedRun(uint32_t iterations)
+{
+    for (uint32_t n = 0; n < iterations; n++) {
+        for (int i = 0; i < MSP_BENCH_WAYPOINTS; i++) {
+            sbuf_t buf;
+            sbuf_t *dst = sbufInit(&buf, mspBenchBuffer, mspBenchBuffer + MSP_BENCH_BUFFER_SIZE);
+            mspSerializeWaypoint(dst, i, &mspBenchWaypoints[i]);
+            benchSinkU = dst->ptr[-1];
+        }
+    }
+}
+
+static const benchKernel_t mspBenchKernels[] = {
+    { "servo_configurations_fields", mspBenchInit, servoConfigurationsFieldsRun },
+    { "servo_configurations_packed", mspBenchInit, servoConfigurationsPackedRun },
+    { "waypoint_list_fields", mspBenchInit, waypointListFieldsRun },
+    { "waypoint_list_packed", mspBenchInit, waypointListPackedRun },
+};
+
+BENCH_SUITE(msp, mspBenchKernels);
@@ -0,0 +1,242 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "rx/rx.h"
+#include "rx/rx_pipeline.h"
+
+#include "bench.h"
+
+/*
+ * Per frame cost of turning received channel data into rcChannels, with the
+ * per channel chain used before the channel table (remap, read through
+ * rcReadRawFn, scaleRange, pulse check) and with the table. The readers
+ * use the same conversions as the SBUS, CRSF and SRXL2 drivers.
+ */
+
+#define RX_BENCH_FRAMES             16
+#define RX_BENCH_SBUS_VALUE(x)      (173 + (x) % (1812 - 173))
+#define RX_BENCH_CRSF_VALUE(x)      (172 + (x) % (1811 - 172))
+#define RX_BENCH_SRXL2_VALUE(x)     ((x) & 0xffe0)
+
+static uint16_t rxBenchFrames[RX_BENCH_FRAMES][MAX_SUPPORTED_RC_CHANNEL_COUNT];
+static uint32_t rxBenchFrames32[RX_BENCH_FRAMES][MAX_SUPPORTED_RC_CHANNEL_COUNT];
+static uint16_t rxBenchChannelData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+static uint32_t rxBenchChannelData32[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+static rxConfig_t rxBenchConfig;
+static rxChannelRangeConfig_t rxBenchRanges[NON_AUX_CHANNEL_COUNT];
+static rxRuntimeConfig_t rxBenchRuntime;
+static rxChannelPipeline_t rxBenchPipeline;
+static rcChannel_t rxBenchChannels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+static uint16_t sbusBenchReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+{
+    return (5 * constrain(rxRuntimeConfig->channelData[chan], 0, 2047) / 8) + 880;
+}
+
+static void sbusBenchReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    for (int chan = 0; chan < count; chan++) {
+        raw[chan] = (5 * constrain(rxRuntimeConfig->channelData[chan], 0, 2047) / 8) + 880;
+    }
+}
+
+static uint16_t crsfBenchReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+{
+    UNUSED(rxRuntimeConfig);
+    return (rxBenchChannelData32[chan] * 1024 / 1639) + 881;
+}
+
+static void crsfBenchReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    UNUSED(rxRuntimeConfig);
+    for (int chan = 0; chan < count; chan++) {
+        raw[chan] = (rxBenchChannelData32[chan] * 1024 / 1639) + 881;
+    }
+}
+
+static uint16_t srxl2BenchReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t channelIdx)
+{
+    if (channelIdx >= rxRuntimeConfig->channelCount) {
+        return 0;
+    }
+    return 988 + ((rxRuntimeConfig->channelData[channelIdx] >> 5) >> 1);
+}
+
+static void srxl2BenchReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    for (int channelIdx = 0; channelIdx < count; channelIdx++) {
+        raw[channelIdx] = 988 + ((rxRuntimeConfig->channelData[channelIdx] >> 5) >> 1);
+    }
+}
+
+static void rxBenchInit(void)
+{
+    memset(&rxBenchConfig, 0, sizeof(rxBenchConfig));
+    rxBenchConfig.rcmap[0] = 0;     // AETR
+    rxBenchConfig.rcmap[1] = 1;
+    rxBenchConfig.rcmap[2] = 3;
+    rxBenchConfig.rcmap[3] = 2;
+    rxBenchConfig.rx_min_usec = 885;
+    rxBenchConfig.rx_max_usec = 2115;
+    for (int i = 0; i < NON_AUX_CHANNEL_COUNT; i++) {
+        rxBenchRanges[i].min = 988;
+        rxBenchRanges[i].max = 2012;
+    }
+
+    for (int i = 0; i < RX_BENCH_FRAMES; i++) {
+        for (int j = 0; j < MAX_SUPPORTED_RC_CHANNEL_COUNT; j++) {
+            const uint32_t value = benchRandom();
+            rxBenchFrames[i][j] = value;
+            rxBenchFrames32[i][j] = value;
+        }
+    }
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        rxBenchChannels[i].raw = PWM_RANGE_MIDDLE;
+        rxBenchChannels[i].data = PWM_RANGE_MIDDLE;
+        rxBenchChannels[i].expiresAt = 0;
+    }
+
+    memset(&rxBenchRuntime, 0, sizeof(rxBenchRuntime));
+    rxBenchRuntime.channelData = rxBenchChannelData;
+}
+
+static void rxBenchSetup(uint8_t channelCount, rcReadRawDataFnPtr readRawFn, rcReadRawChannelsFnPtr readRawChannelsFn)
+{
+    rxBenchRuntime.channelCount = channelCount;
+    rxBenchRuntime.rcReadRawFn = readRawFn;
+    rxBenchRuntime.rcReadRawChannelsFn = readRawChannelsFn;
+    rxChannelPipelineCompile(&rxBenchPipeline, channelCount, &rxBenchConfig, rxBenchRanges);
+}
+
+// Decoder output of the next frame, in the units of each protocol
+static void rxBenchReceive(uint32_t frame, uint8_t channelCount, int protocol)
+{
+    const uint16_t *src = rxBenchFrames[frame % RX_BENCH_FRAMES];
+    const uint32_t *src32 = rxBenchFrames32[frame % RX_BENCH_FRAMES];
+
+    for (int i = 0; i < channelCount; i++) {
+        switch (protocol) {
+            case 0:
+                rxBenchChannelData[i] = RX_BENCH_SBUS_VALUE(src[i]);
+                break;
+            case 1:
+                rxBenchChannelData32[i] = RX_BENCH_CRSF_VALUE(src32[i]);
+                break;
+            default:
+                rxBenchChannelData[i] = RX_BENCH_SRXL2_VALUE(src[i]);
+                break;
+        }
+    }
+}
+
+static bool rxBenchPerChannel(uint8_t channelCount, int16_t *staging, timeMs_t currentTimeMs)
+{
+    bool valid = true;
+
+    for (int channel = 0; channel < channelCount; channel++) {
+        const uint8_t rawChannel = channel < (int)REMAPPABLE_CHANNEL_COUNT ? rxBenchConfig.rcmap[channel] : channel;
+        uint16_t sample = (*rxBenchRuntime.rcReadRawFn)(&rxBenchRuntime, rawChannel);
+
+        if (channel < NON_AUX_CHANNEL_COUNT && sample != 0) {
+            sample = scaleRange(sample, rxBenchRanges[channel].min, rxBenchRanges[channel].max, PWM_RANGE_MIN, PWM_RANGE_MAX);
+            sample = MIN(MAX(PWM_PULSE_MIN, sample), PWM_PULSE_MAX);
+        }
+
+        rxBenchChannels[channel].raw = sample;
+
+        if (!(sample >= rxBenchConfig.rx_min_usec && sample <= rxBenchConfig.rx_max_usec)) {
+            sample = rxBenchChannels[channel].data;
+            if ((currentTimeMs > rxBenchChannels[channel].expiresAt) && (channel < NON_AUX_CHANNEL_COUNT)) {
+                valid = false;
+            }
+        } else {
+            rxBenchChannels[channel].expiresAt = currentTimeMs + MAX_INVALID_RX_PULSE_TIME;
+        }
+
+        staging[channel] = sample;
+    }
+
+    return valid;
+}
+
+static void rxBenchRunPerChannel(uint32_t iterations, uint8_t channelCount, int protocol)
+{
+    int16_t staging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        rxBenchReceive(i, channelCount, protocol);
+        benchSinkU = rxBenchPerChannel(channelCount, staging, i);
+        benchSinkU = staging[channelCount - 1];
+    }
+}
+
+static void rxBenchRunPipeline(uint32_t iterations, int protocol)
+{
+    int16_t staging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    uint16_t raw[RX_RAW_CHANNEL_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        rxBenchReceive(i, rxBenchPipeline.channelCount, protocol);
+        rxChannelPipelineReadRaw(&rxBenchPipeline, &rxBenchRuntime, raw);
+        benchSinkU = rxChannelPipelineRun(&rxBenchPipeline, raw, rxBenchChannels, staging, i);
+        benchSinkU = staging[rxBenchPipeline.channelCount - 1];
+    }
+}
+
+#define RX_BENCH_KERNELS(protocol, index, count) \
+    static void protocol ## PerChannel ## count ## Run(uint32_t iterations) \
+    { \
+        rxBenchSetup(count, protocol ## BenchReadRawRC, NULL); \
+        rxBenchRunPerChannel(iterations, count, index); \
+    } \
+    static void protocol ## Pipeline ## count ## Run(uint32_t iterations) \
+    { \
+        rxBenchSetup(count, protocol ## BenchReadRawRC, protocol ## BenchReadRawChannels); \
+        rxBenchRunPipeline(iterations, index); \
+    }
+
+// CRSF carries 16 channels, SBUS 16 plus two digital ones
+RX_BENCH_KERNELS(sbus, 0, 16)
+RX_BENCH_KERNELS(sbus, 0, 18)
+RX_BENCH_KERNELS(crsf, 1, 16)
+RX_BENCH_KERNELS(srxl2, 2, 16)
+RX_BENCH_KERNELS(srxl2, 2, 18)
+
+static const benchKernel_t rxBenchKernels[] = {
+    { "per_channel_sbus_16", rxBenchInit, sbusPerChannel16Run },
+    { "pipeline_sbus_16", rxBenchInit, sbusPipeline16Run },
+    { "per_channel_sbus_18", rxBenchInit, sbusPerChannel18Run },
+    { "pipeline_sbus_18", rxBenchInit, sbusPipeline18Run },
+    { "per_channel_crsf_16", rxBenchInit, crsfPerChannel16Run },
+    { "pipeline_crsf_16", rxBenchInit, crsfPipeline16Run },
+    { "per_channel_srxl2_16", rxBenchInit, srxl2PerChannel16Run },
+    { "pipeline_srxl2_16", rxBenchInit, srxl2Pipeline16Run },
+    { "per_channel_srxl2_18", rxBenchInit, srxl2PerChannel18Run },
+    { "pipeline_srxl2_18", rxBenchInit, srxl2Pipeline18Run },
+};
+
+BENCH_SUITE(rx, rxBenchKernels);
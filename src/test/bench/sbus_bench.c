@@ -0,0 +1,77 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "rx/rx.h"
+#include "rx/sbus_channels.h"
+
+#include "bench.h"
+
+#define SBUS_BENCH_FRAMES   16
+
+static sbusFrame_t sbusBenchFrames[SBUS_BENCH_FRAMES];
+static uint16_t sbusBenchChannelData[SBUS_MAX_CHANNEL];
+static rxRuntimeConfig_t sbusBenchRuntime;
+
+static void sbusBenchInit(void)
+{
+    for (int i = 0; i < SBUS_BENCH_FRAMES; i++) {
+        uint8_t *bytes = (uint8_t *)&sbusBenchFrames[i];
+        for (unsigned j = 0; j < sizeof(sbusFrame_t); j++) {
+            bytes[j] = benchRandom();
+        }
+        sbusBenchFrames[i].syncByte = SBUS_FRAME_BEGIN_BYTE;
+        sbusBenchFrames[i].channels.flags = 0;
+    }
+
+    memset(&sbusBenchRuntime, 0, sizeof(sbusBenchRuntime));
+    sbusBenchRuntime.channelData = sbusBenchChannelData;
+    sbusChannelsInit(&sbusBenchRuntime);
+    sbusBenchRuntime.channelCount = SBUS_MAX_CHANNEL;
+}
+
+static void sbusChannelsDecodeRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        benchSinkU = sbusChannelsDecode(&sbusBenchRuntime, &sbusBenchFrames[i % SBUS_BENCH_FRAMES].channels);
+        benchSinkU = sbusBenchChannelData[15];
+    }
+}
+
+static void sbusReadRawRCRun(uint32_t iterations)
+{
+    uint16_t raw[SBUS_MAX_CHANNEL];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        sbusBenchChannelData[i % SBUS_MAX_CHANNEL] = i & 0x7FF;
+        for (int chan = 0; chan < SBUS_MAX_CHANNEL; chan++) {
+            raw[chan] = sbusBenchRuntime.rcReadRawFn(&sbusBenchRuntime, chan);
+        }
+        benchSinkU = raw[i % SBUS_MAX_CHANNEL];
+    }
+}
+
+static const benchKernel_t sbusBenchKernels[] = {
+    { "sbusChannelsDecode", sbusBenchInit, sbusChannelsDecodeRun },
+    { "rcReadRawFn_18", sbusBenchInit, sbusReadRawRCRun },
+};
+
+BENCH_SUITE(sbus, sbusBenchKernels);
@@ -0,0 +1,158 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "flight/servo_mixer_rules.h"
+#include "flight/servos.h"
+
+#include "bench.h"
+
+/*
+ * Per loop cost of the servo mixer for a plane (two ailerons, elevator,
+ * rudder with a speed limit, throttle servo): computing the inputs and
+ * walking the rules, with every input and a per rule speed limit as
+ * before the rules were compiled, and with the compiled rule list. The
+ * inputs are computed from arrays standing in for axisPID, the RC
+ * channels and the global variables, so the real saving is larger.
+ */
+
+#define SERVO_BENCH_LOOPS           64
+#define SERVO_BENCH_DT              0.001f
+
+static int16_t servoBenchPid[SERVO_BENCH_LOOPS][3];
+static int16_t servoBenchRc[SERVO_BENCH_LOOPS][16];
+static int16_t servoBenchGvar[SERVO_BENCH_LOOPS][8];
+
+static servoMixer_t servoBenchRules[MAX_SERVO_RULES];
+static servoMixerRuleList_t servoBenchList;
+static rateLimitFilter_t servoBenchFilters[MAX_SERVO_RULES];
+static int16_t servoBenchOutput[MAX_SUPPORTED_SERVOS];
+
+static void servoBenchInit(void)
+{
+    for (int i = 0; i < SERVO_BENCH_LOOPS; i++) {
+        for (int axis = 0; axis < 3; axis++) {
+            servoBenchPid[i][axis] = benchRandom() % 1000 - 500;
+        }
+        for (int channel = 0; channel < 16; channel++) {
+            servoBenchRc[i][channel] = 1000 + benchRandom() % 1000;
+        }
+        for (int gvar = 0; gvar < 8; gvar++) {
+            servoBenchGvar[i][gvar] = benchRandom() % 4000 - 2000;
+        }
+    }
+
+    memset(servoBenchRules, 0, sizeof(servoBenchRules));
+    servoBenchRules[0] = (servoMixer_t){ .targetChannel = 1, .inputSource = INPUT_STABILIZED_ROLL, .rate = 100 };
+    servoBenchRules[1] = (servoMixer_t){ .targetChannel = 2, .inputSource = INPUT_STABILIZED_ROLL, .rate = 100 };
+    servoBenchRules[2] = (servoMixer_t){ .targetChannel = 3, .inputSource = INPUT_STABILIZED_PITCH, .rate = 100 };
+    servoBenchRules[3] = (servoMixer_t){ .targetChannel = 4, .inputSource = INPUT_STABILIZED_YAW, .rate = -100, .speed = 50 };
+    servoBenchRules[4] = (servoMixer_t){ .targetChannel = 5, .inputSource = INPUT_RC_THROTTLE, .rate = 100 };
+    servoMixerRulesCompile(&servoBenchList, servoBenchRules);
+
+    memset(servoBenchFilters, 0, sizeof(servoBenchFilters));
+}
+
+static void servoBenchComputeInputs(int16_t *input, servoMixerInputMask_t inputs, uint32_t loop)
+{
+    const int16_t *pid = servoBenchPid[loop % SERVO_BENCH_LOOPS];
+    const int16_t *rc = servoBenchRc[loop % SERVO_BENCH_LOOPS];
+    const int16_t *gvar = servoBenchGvar[loop % SERVO_BENCH_LOOPS];
+
+    if (inputs & (SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW))) {
+        input[INPUT_STABILIZED_ROLL] = pid[0];
+        input[INPUT_STABILIZED_PITCH] = pid[1];
+        input[INPUT_STABILIZED_YAW] = pid[2];
+        input[INPUT_STABILIZED_ROLL_PLUS] = constrain(input[INPUT_STABILIZED_ROLL], 0, 1000);
+        input[INPUT_STABILIZED_ROLL_MINUS] = constrain(input[INPUT_STABILIZED_ROLL], -1000, 0);
+        input[INPUT_STABILIZED_PITCH_PLUS] = constrain(input[INPUT_STABILIZED_PITCH], 0, 1000);
+        input[INPUT_STABILIZED_PITCH_MINUS] = constrain(input[INPUT_STABILIZED_PITCH], -1000, 0);
+        input[INPUT_STABILIZED_YAW_PLUS] = constrain(input[INPUT_STABILIZED_YAW], 0, 1000);
+        input[INPUT_STABILIZED_YAW_MINUS] = constrain(input[INPUT_STABILIZED_YAW], -1000, 0);
+    }
+    if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_FEATURE_FLAPS)) {
+        input[INPUT_FEATURE_FLAPS] = 0;
+    }
+    input[INPUT_MAX] = 500;
+    for (int i = 0; i < 8; i++) {
+        if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_GVAR_0 + i)) {
+            input[INPUT_GVAR_0 + i] = constrain(gvar[i], -1000, 1000);
+        }
+    }
+    if (inputs & (SERVO_MIXER_INPUT_BIT(INPUT_GIMBAL_PITCH) | SERVO_MIXER_INPUT_BIT(INPUT_GIMBAL_ROLL))) {
+        input[INPUT_GIMBAL_PITCH] = scaleRange(pid[1], -900, 900, -500, +500);
+        input[INPUT_GIMBAL_ROLL] = scaleRange(pid[0], -1800, 1800, -500, +500);
+    }
+    if (inputs & SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_THROTTLE)) {
+        input[INPUT_STABILIZED_THROTTLE] = rc[3] - 1000 - 500;
+    }
+    for (int channel = 0; channel < 16; channel++) {
+        const int source = channel < 8 ? INPUT_RC_ROLL + channel : INPUT_RC_CH9 + channel - 8;
+        if (inputs & SERVO_MIXER_INPUT_BIT(source)) {
+            input[source] = rc[channel] - 1500;
+        }
+    }
+}
+
+static void perRuleRun(uint32_t iterations)
+{
+    int16_t input[INPUT_SOURCE_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        servoBenchComputeInputs(input, ~(servoMixerInputMask_t)0, i);
+
+        for (int servo = 0; servo < MAX_SUPPORTED_SERVOS; servo++) {
+            servoBenchOutput[servo] = 0;
+        }
+        for (int rule = 0; rule < servoBenchList.configuredCount; rule++) {
+            const uint8_t target = servoBenchRules[rule].targetChannel;
+            const uint8_t from = servoBenchRules[rule].inputSource;
+            int16_t inputLimited = (int16_t)rateLimitFilterApply4(&servoBenchFilters[rule], input[from], servoBenchRules[rule].speed * 10, SERVO_BENCH_DT);
+            servoBenchOutput[target] += ((int32_t)inputLimited * servoBenchRules[rule].rate) / 100;
+        }
+        benchSinkU = servoBenchOutput[4];
+    }
+}
+
+static void compiledRun(uint32_t iterations)
+{
+    int16_t input[INPUT_SOURCE_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        servoBenchComputeInputs(input, servoBenchList.inputs, i);
+
+        for (int servo = 0; servo < MAX_SUPPORTED_SERVOS; servo++) {
+            servoBenchOutput[servo] = 0;
+        }
+        servoMixerRulesApply(&servoBenchList, input, servoBenchFilters, SERVO_BENCH_DT, servoBenchOutput);
+        benchSinkU = servoBenchOutput[4];
+    }
+}
+
+static const benchKernel_t servoMixerBenchKernels[] = {
+    { "perRule", servoBenchInit, perRuleRun },
+    { "compiled", servoBenchInit, compiledRun },
+};
+
+BENCH_SUITE(servoMixer, servoMixerBenchKernels);
@@ -0,0 +1,107 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "platform.h"
+
+#include "common/filter.h"
+#include "common/maths.h"
+
+#include "flight/servo_output.h"
+
+#include "bench.h"
+
+/*
+ * Per loop cost of the servo outputs of a plane with eight servos on a 1kHz
+ * loop: a biquad and a timer write for every servo on every loop as
+ * filterServos() and writeServos() did, and the output stages with four
+ * analog servos at 50Hz and four digital ones at 333Hz. The timer write is
+ * a store to a volatile register stand-in.
+ */
+
+#define SERVO_BENCH_SERVOS          8
+#define SERVO_BENCH_LOOPS           64
+#define SERVO_BENCH_LOOPTIME        1000
+#define SERVO_BENCH_LPF_HZ          20
+
+static int16_t servoBenchInput[SERVO_BENCH_LOOPS][SERVO_BENCH_SERVOS];
+static volatile uint32_t servoBenchCcr[SERVO_BENCH_SERVOS];
+
+static biquadFilter_t servoBenchFilter[SERVO_BENCH_SERVOS];
+static servoOutputStage_t servoBenchStage[SERVO_BENCH_SERVOS];
+
+static void servoBenchInitInputs(void)
+{
+    for (int i = 0; i < SERVO_BENCH_LOOPS; i++) {
+        for (int servo = 0; servo < SERVO_BENCH_SERVOS; servo++) {
+            servoBenchInput[i][servo] = 1000 + benchRandom() % 1000;
+        }
+    }
+}
+
+static void everyLoopInit(void)
+{
+    servoBenchInitInputs();
+    for (int servo = 0; servo < SERVO_BENCH_SERVOS; servo++) {
+        biquadFilterInitLPF(&servoBenchFilter[servo], SERVO_BENCH_LPF_HZ, SERVO_BENCH_LOOPTIME);
+        biquadFilterReset(&servoBenchFilter[servo], 1500);
+    }
+}
+
+static void everyLoopRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const int16_t *input = servoBenchInput[i % SERVO_BENCH_LOOPS];
+
+        for (int servo = 0; servo < SERVO_BENCH_SERVOS; servo++) {
+            const int16_t output = (int16_t)lrintf(biquadFilterApply(&servoBenchFilter[servo], (float)input[servo]));
+            servoBenchCcr[servo] = constrain(output, 1000, 2000);
+        }
+    }
+}
+
+static void decimatedInit(void)
+{
+    servoBenchInitInputs();
+    for (int servo = 0; servo < SERVO_BENCH_SERVOS; servo++) {
+        const uint16_t updateHz = servo < 4 ? 50 : 333;
+        servoOutputStageInit(&servoBenchStage[servo], servo, SERVO_BENCH_LOOPTIME, updateHz, SERVO_BENCH_LPF_HZ, 0, 1500);
+    }
+}
+
+static void decimatedRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const int16_t *input = servoBenchInput[i % SERVO_BENCH_LOOPS];
+
+        for (int servo = 0; servo < SERVO_BENCH_SERVOS; servo++) {
+            if (servoOutputStageUpdate(&servoBenchStage[servo], input[servo], 1000, 2000)) {
+                servoBenchCcr[servo] = servoBenchStage[servo].output;
+            }
+        }
+    }
+}
+
+static const benchKernel_t servoOutputBenchKernels[] = {
+    { "everyLoop", everyLoopInit, everyLoopRun },
+    { "decimated", decimatedInit, decimatedRun },
+};
+
+BENCH_SUITE(servoOutput, servoOutputBenchKernels);
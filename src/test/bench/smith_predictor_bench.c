@@ -0,0 +1,123 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "platform.h"
+
+#include "common/axis.h"
+#include "common/filter.h"
+
+#include "flight/smith_predictor.h"
+
+#include "bench.h"
+
+/*
+ * Per PID loop cost of the Smith predictor on all three axes at 8kHz with a
+ * 2.7ms delay: one delay line per axis rounded down to whole loops, as
+ * before the axes shared a delay line, and the interleaved delay line with
+ * the delayed sample interpolated between two loops.
+ */
+
+#define SMITH_BENCH_SAMPLES     256
+#define SMITH_BENCH_LOOPTIME    125
+#define SMITH_BENCH_DELAY       2.7f
+#define SMITH_BENCH_STRENGTH    0.5f
+#define SMITH_BENCH_LPF_HZ      50
+
+static float smithBenchGyro[SMITH_BENCH_SAMPLES][XYZ_AXIS_COUNT];
+
+typedef struct {
+    bool enabled;
+    uint8_t samples;
+    uint8_t idx;
+    float data[MAX_SMITH_SAMPLES + 1];
+    pt1Filter_t smithPredictorFilter;
+    float smithPredictorStrength;
+} smithBenchPerAxis_t;
+
+static smithBenchPerAxis_t smithBenchPerAxis[XYZ_AXIS_COUNT];
+static smithPredictor_t smithBenchPredictor;
+
+static void smithBenchInit(void)
+{
+    for (int i = 0; i < SMITH_BENCH_SAMPLES; i++) {
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            smithBenchGyro[i][axis] = benchRandomFloat(-400.0f, 400.0f);
+        }
+    }
+
+    memset(smithBenchPerAxis, 0, sizeof(smithBenchPerAxis));
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        smithBenchPerAxis[axis].enabled = true;
+        smithBenchPerAxis[axis].samples = (SMITH_BENCH_DELAY * 1000) / SMITH_BENCH_LOOPTIME;
+        smithBenchPerAxis[axis].smithPredictorStrength = SMITH_BENCH_STRENGTH;
+        pt1FilterInit(&smithBenchPerAxis[axis].smithPredictorFilter, SMITH_BENCH_LPF_HZ, SMITH_BENCH_LOOPTIME * 1e-6f);
+    }
+
+    smithPredictorInit(&smithBenchPredictor, SMITH_BENCH_DELAY, SMITH_BENCH_STRENGTH, SMITH_BENCH_LPF_HZ, SMITH_BENCH_LOOPTIME);
+}
+
+static float smithBenchPerAxisApply(smithBenchPerAxis_t *predictor, float sample)
+{
+    if (predictor->enabled) {
+        predictor->data[predictor->idx] = sample;
+
+        predictor->idx++;
+        if (predictor->idx > predictor->samples) {
+            predictor->idx = 0;
+        }
+
+        float delayed = pt1FilterApply(&predictor->smithPredictorFilter, predictor->data[predictor->idx]);
+        float delayCompensatedSample = predictor->smithPredictorStrength * (sample - delayed);
+
+        sample += delayCompensatedSample;
+    }
+    return sample;
+}
+
+static void perAxisRun(uint32_t iterations)
+{
+    for (uint32_t i = 0; i < iterations; i++) {
+        const float *gyro = smithBenchGyro[i % SMITH_BENCH_SAMPLES];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            benchSinkF = smithBenchPerAxisApply(&smithBenchPerAxis[axis], gyro[axis]);
+        }
+    }
+}
+
+static void interleavedRun(uint32_t iterations)
+{
+    float rates[XYZ_AXIS_COUNT];
+
+    for (uint32_t i = 0; i < iterations; i++) {
+        const float *gyro = smithBenchGyro[i % SMITH_BENCH_SAMPLES];
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            rates[axis] = gyro[axis];
+        }
+        applySmithPredictor(&smithBenchPredictor, rates);
+        benchSinkF = rates[Z];
+    }
+}
+
+static const benchKernel_t smithPredictorBenchKernels[] = {
+    { "perAxis", smithBenchInit, perAxisRun },
+    { "interleaved", smithBenchInit, interleavedRun },
+};
+
+BENCH_SUITE(smithPredictor, smithPredictorBenchKernels);
@@ -4,6 +4,8 @@
 
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
+#include <sched.h>
 
 extern "C" {
     #include "common/circular_queue.h"
@@ -163,4 +165,185 @@ TEST(CircularQueue, CheckIsEmptyAndIsFull32){  //check with uint32_t
     EXPECT_EQ(circularBufferIsFull(&buffer),false);
     EXPECT_EQ(circularBufferIsEmpty(&buffer),true);
     EXPECT_EQ(circularBufferIsEmpty(&buffer),queue.empty());
-}
\ No newline at end of file
+}
+
+TEST(SpscRing, RejectsCapacityNotPowerOfTwo){
+    spscRing_t ring;
+    uint8_t buff[12];
+
+    EXPECT_FALSE(spscRingInit(&ring, buff, 12, 1));
+    EXPECT_FALSE(spscRingInit(&ring, buff, 0, 1));
+    EXPECT_TRUE(spscRingInit(&ring, buff, 8, 1));
+}
+
+TEST(SpscRing, WholeCapacityIsUsable){
+    spscRing_t ring;
+    uint32_t buff[16];
+
+    spscRingInit(&ring, buff, 16, sizeof(uint32_t));
+
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+    for (uint32_t i = 0; i < 16; i++) {
+        EXPECT_TRUE(spscRingPush(&ring, &i));
+    }
+    EXPECT_TRUE(spscRingIsFull(&ring));
+    EXPECT_EQ(spscRingFree(&ring), 0u);
+
+    uint32_t value = 99;
+    EXPECT_FALSE(spscRingPush(&ring, &value));
+
+    for (uint32_t i = 0; i < 16; i++) {
+        EXPECT_TRUE(spscRingPop(&ring, &value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(spscRingPop(&ring, &value));
+    EXPECT_TRUE(spscRingIsEmpty(&ring));
+}
+
+TEST(SpscRing, MatchesQueueAcrossWraps){
+    srand (time(NULL));
+
+    spscRing_t ring;
+    uint16_t buff[8];
+    std::queue<uint16_t> queue;
+
+    spscRingInit(&ring, buff, 8, sizeof(uint16_t));
+
+    for (int step = 0; step < 1000; step++) {
+        if (rand() % 2) {
+            uint16_t value = rand();
+            if (spscRingPush(&ring, &value)) {
+                queue.push(value);
+            } else {
+                EXPECT_EQ(queue.size(), 8u);
+            }
+        } else {
+            uint16_t value;
+            if (spscRingPop(&ring, &value)) {
+                EXPECT_EQ(value, queue.front());
+                queue.pop();
+            } else {
+                EXPECT_TRUE(queue.empty());
+            }
+        }
+        EXPECT_EQ(spscRingCount(&ring), queue.size());
+    }
+}
+
+TEST(SpscRing, SpansStopAtTheEndOfTheBuffer){
+    spscRing_t ring;
+    uint8_t buff[8];
+    uint8_t data[8] = {0, 1, 2, 3, 4, 5, 6, 7};
+
+    spscRingInit(&ring, buff, 8, 1);
+
+    // Leave head and tail at 6
+    EXPECT_EQ(spscRingPushBulk(&ring, data, 6), 6u);
+    uint8_t out[8];
+    EXPECT_EQ(spscRingPopBulk(&ring, out, 6), 6u);
+
+    void *writeSpan;
+    EXPECT_EQ(spscRingWriteSpan(&ring, &writeSpan), 2u);
+    EXPECT_EQ(writeSpan, (void *)&buff[6]);
+
+    // A bulk push wraps into a second span
+    EXPECT_EQ(spscRingPushBulk(&ring, data, 5), 5u);
+    const void *readSpan;
+    EXPECT_EQ(spscRingReadSpan(&ring, &readSpan), 2u);
+    EXPECT_EQ(readSpan, (const void *)&buff[6]);
+    spscRingConsume(&ring, 2);
+    EXPECT_EQ(spscRingReadSpan(&ring, &readSpan), 3u);
+    EXPECT_EQ(readSpan, (const void *)&buff[0]);
+    EXPECT_EQ(memcmp(readSpan, &data[2], 3), 0);
+
+    // Only what fits is taken
+    EXPECT_EQ(spscRingPushBulk(&ring, data, 8), 5u);
+    EXPECT_TRUE(spscRingIsFull(&ring));
+    EXPECT_EQ(spscRingPopBulk(&ring, out, 8), 8u);
+    const uint8_t expected[8] = {2, 3, 4, 0, 1, 2, 3, 4};
+    EXPECT_EQ(memcmp(out, expected, 8), 0);
+}
+
+#define STRESS_ELEMENTS     (1 << 18)
+#define STRESS_CAPACITY     64
+
+typedef struct {
+    spscRing_t ring;
+    uint32_t buff[STRESS_CAPACITY];
+    uint32_t errors;
+} stressState_t;
+
+static void *stressProducer(void *arg)
+{
+    stressState_t *state = (stressState_t *)arg;
+    uint32_t batch[STRESS_CAPACITY];
+    uint32_t next = 0;
+    unsigned seed = 1;
+
+    while (next < STRESS_ELEMENTS) {
+        if (rand_r(&seed) % 2) {
+            if (spscRingPush(&state->ring, &next)) {
+                next++;
+            } else {
+                sched_yield();
+            }
+        } else {
+            uint32_t count = 1 + rand_r(&seed) % STRESS_CAPACITY;
+            if (count > STRESS_ELEMENTS - next) {
+                count = STRESS_ELEMENTS - next;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                batch[i] = next + i;
+            }
+            next += spscRingPushBulk(&state->ring, batch, count);
+        }
+    }
+
+    return NULL;
+}
+
+static void *stressConsumer(void *arg)
+{
+    stressState_t *state = (stressState_t *)arg;
+    uint32_t expected = 0;
+    unsigned seed = 2;
+
+    while (expected < STRESS_ELEMENTS) {
+        if (rand_r(&seed) % 2) {
+            uint32_t value;
+            if (spscRingPop(&state->ring, &value)) {
+                state->errors += value != expected;
+                expected++;
+            } else {
+                sched_yield();
+            }
+        } else {
+            const void *span;
+            const uint32_t count = spscRingReadSpan(&state->ring, &span);
+            for (uint32_t i = 0; i < count; i++) {
+                state->errors += ((const uint32_t *)span)[i] != expected + i;
+            }
+            spscRingConsume(&state->ring, count);
+            expected += count;
+        }
+    }
+
+    return NULL;
+}
+
+TEST(SpscRing, ProducerAndConsumerThreads){
+    static stressState_t state;
+    pthread_t producer;
+    pthread_t consumer;
+
+    spscRingInit(&state.ring, state.buff, STRESS_CAPACITY, sizeof(uint32_t));
+    state.errors = 0;
+
+    ASSERT_EQ(pthread_create(&consumer, NULL, stressConsumer, &state), 0);
+    ASSERT_EQ(pthread_create(&producer, NULL, stressProducer, &state), 0);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    EXPECT_EQ(state.errors, 0u);
+    EXPECT_TRUE(spscRingIsEmpty(&state.ring));
+}
@@ -0,0 +1,259 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cstring>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/streambuf.h"
+
+    #include "fc/fc_msp_replies.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define REPLY_BUFFER_SIZE   1024
+
+static uint32_t replyRandomState = 1;
+
+static uint32_t replyRandom(void)
+{
+    replyRandomState = replyRandomState * 1664525 + 1013904223;
+    return replyRandomState >> 8;
+}
+
+static void fillRandom(void *data, size_t size)
+{
+    uint8_t *bytes = (uint8_t *)data;
+    for (size_t i = 0; i < size; i++) {
+        bytes[i] = replyRandom();
+    }
+}
+
+// Both builders get the same buffer contents to start from, so bytes
+// one of them leaves alone can't hide a difference
+class MspReplyTest : public ::testing::Test {
+protected:
+    uint8_t expected[REPLY_BUFFER_SIZE];
+    uint8_t actual[REPLY_BUFFER_SIZE];
+    sbuf_t expectedBuf;
+    sbuf_t actualBuf;
+
+    void SetUp() override
+    {
+        memset(expected, 0xCC, sizeof(expected));
+        memset(actual, 0xCC, sizeof(actual));
+        sbufInit(&expectedBuf, expected, expected + sizeof(expected));
+        sbufInit(&actualBuf, actual, actual + sizeof(actual));
+    }
+
+    void expectSameReply(void)
+    {
+        EXPECT_EQ(expectedBuf.ptr - expected, actualBuf.ptr - actual);
+        EXPECT_EQ(0, memcmp(expected, actual, sizeof(expected)));
+    }
+};
+
+// The reference builders are the field by field writes fc_msp.c used before
+
+TEST_F(MspReplyTest, InavStatus)
+{
+    boxBitmask_t modes;
+    fillRandom(&modes, sizeof(modes));
+
+    sbuf_t *dst = &expectedBuf;
+    sbufWriteU16(dst, 1000);
+    sbufWriteU16(dst, 3);
+    sbufWriteU16(dst, 0x1234);
+    sbufWriteU16(dst, 42);
+    sbufWriteU8(dst, (2 << 4) | 1);
+    sbufWriteU32(dst, 0x80402010);
+    sbufWriteData(dst, &modes, sizeof(modes));
+
+    mspInavStatus_t *status = (mspInavStatus_t *)sbufReserve(&actualBuf, sizeof(*status));
+    ASSERT_NE(nullptr, status);
+    status->cycleTime = 1000;
+    status->i2cErrors = 3;
+    status->sensorStatus = 0x1234;
+    status->systemLoad = 42;
+    status->profiles = (2 << 4) | 1;
+    status->armingFlags = 0x80402010;
+    memcpy(&status->modeFlags, &modes, sizeof(modes));
+
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, ServoConfigurations)
+{
+    servoParam_t params[MAX_SUPPORTED_SERVOS];
+    fillRandom(params, sizeof(params));
+
+    sbuf_t *dst = &expectedBuf;
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        sbufWriteU16(dst, params[i].min);
+        sbufWriteU16(dst, params[i].max);
+        sbufWriteU16(dst, params[i].middle);
+        sbufWriteU8(dst, params[i].rate);
+        sbufWriteU8(dst, 0);
+        sbufWriteU8(dst, 0);
+        sbufWriteU8(dst, 255);
+        sbufWriteU32(dst, 0);
+    }
+
+    EXPECT_TRUE(mspSerializeServoConfigurations(&actualBuf, params, MAX_SUPPORTED_SERVOS));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, ServoMixRules)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    fillRandom(rules, sizeof(rules));
+
+    sbuf_t *dst = &expectedBuf;
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        sbufWriteU8(dst, rules[i].targetChannel);
+        sbufWriteU8(dst, rules[i].inputSource);
+        sbufWriteU16(dst, rules[i].rate);
+        sbufWriteU8(dst, rules[i].speed);
+        sbufWriteU8(dst, 0);
+        sbufWriteU8(dst, 100);
+        sbufWriteU8(dst, 0);
+    }
+
+    EXPECT_TRUE(mspSerializeServoMixRules(&actualBuf, rules, MAX_SERVO_RULES));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, ServoMixer)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    fillRandom(rules, sizeof(rules));
+
+    sbuf_t *dst = &expectedBuf;
+    for (int i = 0; i < MAX_SERVO_RULES; i++) {
+        sbufWriteU8(dst, rules[i].targetChannel);
+        sbufWriteU8(dst, rules[i].inputSource);
+        sbufWriteU16(dst, rules[i].rate);
+        sbufWriteU8(dst, rules[i].speed);
+        sbufWriteU8(dst, rules[i].conditionId);
+    }
+
+    EXPECT_TRUE(mspSerializeServoMixer(&actualBuf, rules, MAX_SERVO_RULES));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, LogicConditions)
+{
+    logicCondition_t conditions[MAX_LOGIC_CONDITIONS];
+    fillRandom(conditions, sizeof(conditions));
+
+    sbuf_t *dst = &expectedBuf;
+    for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+        sbufWriteU8(dst, conditions[i].enabled);
+        sbufWriteU8(dst, conditions[i].activatorId);
+        sbufWriteU8(dst, conditions[i].operation);
+        sbufWriteU8(dst, conditions[i].operandA.type);
+        sbufWriteU32(dst, conditions[i].operandA.value);
+        sbufWriteU8(dst, conditions[i].operandB.type);
+        sbufWriteU32(dst, conditions[i].operandB.value);
+        sbufWriteU8(dst, conditions[i].flags);
+    }
+
+    EXPECT_TRUE(mspSerializeLogicConditions(&actualBuf, conditions, MAX_LOGIC_CONDITIONS));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, ProgrammingPids)
+{
+    programmingPid_t pids[MAX_PROGRAMMING_PID_COUNT];
+    fillRandom(pids, sizeof(pids));
+
+    sbuf_t *dst = &expectedBuf;
+    for (int i = 0; i < MAX_PROGRAMMING_PID_COUNT; i++) {
+        sbufWriteU8(dst, pids[i].enabled);
+        sbufWriteU8(dst, pids[i].setpoint.type);
+        sbufWriteU32(dst, pids[i].setpoint.value);
+        sbufWriteU8(dst, pids[i].measurement.type);
+        sbufWriteU32(dst, pids[i].measurement.value);
+        sbufWriteU16(dst, pids[i].gains.P);
+        sbufWriteU16(dst, pids[i].gains.I);
+        sbufWriteU16(dst, pids[i].gains.D);
+        sbufWriteU16(dst, pids[i].gains.FF);
+    }
+
+    EXPECT_TRUE(mspSerializeProgrammingPids(&actualBuf, pids, MAX_PROGRAMMING_PID_COUNT));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, Waypoint)
+{
+    navWaypoint_t wp;
+    fillRandom(&wp, sizeof(wp));
+
+    sbuf_t *dst = &expectedBuf;
+    sbufWriteU8(dst, 7);
+    sbufWriteU8(dst, wp.action);
+    sbufWriteU32(dst, wp.lat);
+    sbufWriteU32(dst, wp.lon);
+    sbufWriteU32(dst, wp.alt);
+    sbufWriteU16(dst, wp.p1);
+    sbufWriteU16(dst, wp.p2);
+    sbufWriteU16(dst, wp.p3);
+    sbufWriteU8(dst, wp.flag);
+
+    EXPECT_TRUE(mspSerializeWaypoint(&actualBuf, 7, &wp));
+    expectSameReply();
+}
+
+TEST_F(MspReplyTest, ReplyThatDoesNotFitWritesNothing)
+{
+    logicCondition_t conditions[MAX_LOGIC_CONDITIONS];
+    fillRandom(conditions, sizeof(conditions));
+
+    // The reply buffer of targets without flash
+    sbufInit(&actualBuf, actual, actual + 512);
+    EXPECT_FALSE(mspSerializeLogicConditions(&actualBuf, conditions, MAX_LOGIC_CONDITIONS));
+    EXPECT_EQ(actual, actualBuf.ptr);
+    expectSameReply();
+
+    EXPECT_TRUE(mspSerializeLogicConditions(&actualBuf, conditions, 512 / sizeof(mspLogicCondition_t)));
+    EXPECT_EQ(nullptr, sbufReserve(&actualBuf, sizeof(mspLogicCondition_t)));
+}
+
+TEST(StreamBufferTest, WritersAreLittleEndianAtAnyAlignment)
+{
+    uint8_t data[16];
+
+    for (int offset = 0; offset < 4; offset++) {
+        sbuf_t buf;
+        sbufInit(&buf, data + offset, data + sizeof(data));
+        sbufWriteU32(&buf, 0x04030201);
+        sbufWriteU16(&buf, 0x0605);
+        sbufWriteU8(&buf, 0x07);
+        sbufWriteU16BigEndian(&buf, 0x0809);
+        sbufWriteU32BigEndian(&buf, 0x0A0B0C0D);
+
+        const uint8_t expected[] = { 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D };
+        EXPECT_EQ(sizeof(expected), (size_t)(buf.ptr - (data + offset)));
+        EXPECT_EQ(0, memcmp(expected, data + offset, sizeof(expected)));
+    }
+}
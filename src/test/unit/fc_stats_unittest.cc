@@ -0,0 +1,279 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "config/config_eeprom.h"
+    #include "config/config_streamer.h"
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "drivers/system.h"
+
+    #include "fc/config.h"
+    #include "fc/stats.h"
+
+    #include "navigation/navigation.h"
+
+    #include "sensors/battery.h"
+
+    // Stands in for the rest of the config, which sets where the records
+    // start in the sector
+    typedef struct testConfig_s {
+        uint8_t data[4000];
+    } testConfig_t;
+
+    PG_REGISTER(testConfig_t, testConfig, PG_RESERVED_FOR_TESTING_1, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Config sector of a 16K flash sector, erased as a whole
+#define FLASH_SECTOR_SIZE   EEPROM_SIZE
+
+static uint32_t flashErases;
+static uint32_t flashWordsProgrammed;
+static bool flashProgrammedTwice;
+
+// Flight state the stats read
+static uint32_t testMillis;
+static uint32_t testTravelDistance;
+static int32_t testMWhDrawn;
+static float testAltitude;
+static int16_t testAmperage;
+static uint16_t testVoltage;
+static bool testSaveRequested;
+
+typedef struct {
+    uint32_t time;
+    uint32_t distance;
+    uint32_t energy;
+} testTotals_t;
+
+static void boot(void)
+{
+    if (!isEEPROMContentValid()) {
+        pgResetAll(MAX_PROFILE_COUNT);
+        statsConfigMutable()->stats_enabled = 1;
+        writeConfigToEEPROM();
+    }
+
+    loadEEPROM();
+    statsLoadFlightRecords();
+
+    flashErases = 0;
+    flashWordsProgrammed = 0;
+    flashProgrammedTwice = false;
+    testSaveRequested = false;
+}
+
+// What the config keeps for the old totals
+static testTotals_t totals(void)
+{
+    return { statsConfig()->stats_total_time, statsConfig()->stats_total_dist, statsConfig()->stats_total_energy };
+}
+
+// One flight of durationS, then the disarmed main loop. The battery drops
+// and the current and altitude peak halfway through.
+static void fly(uint32_t durationS, uint16_t seed)
+{
+    testAltitude = 0;
+    statsOnArm();
+
+    const uint32_t startMillis = testMillis;
+    for (uint32_t t = 0; t <= durationS; t++) {
+        if (t > 0) {
+            testMillis = startMillis + t * 1000;
+            testTravelDistance += 1500;
+            testMWhDrawn += 40;
+        }
+        testAltitude = (t < durationS / 2 ? t : durationS - t) * 100.0f + seed % 100;
+        testAmperage = (t == durationS / 2) ? 3000 + seed % 1000 : 1500;
+        testVoltage = 1680 - t * 400 / durationS - seed % 10;
+        statsUpdate();
+    }
+
+    statsOnDisarm();
+
+    statsProcessDelayedSave();
+    if (testSaveRequested) {
+        // processDelayedSave()
+        writeConfigToEEPROM();
+        loadEEPROM();
+        statsLoadFlightRecords();
+        testSaveRequested = false;
+    }
+}
+
+class StatsTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        memset(eepromData, 0xFF, sizeof(eepromData));
+        testMillis = 1000000;
+        testTravelDistance = 0;
+        testMWhDrawn = 0;
+        boot();
+    }
+};
+
+TEST_F(StatsTest, TotalsSurviveReboot)
+{
+    fly(120, 1);
+    fly(300, 2);
+    fly(60, 3);
+
+    // The config wasn't written again
+    EXPECT_EQ(0u, flashErases);
+    EXPECT_FALSE(flashProgrammedTwice);
+
+    boot();
+    EXPECT_EQ(480u, totals().time);
+    EXPECT_EQ(480u * 15, totals().distance);
+    EXPECT_EQ(480u * 40, totals().energy);
+
+    const statsFlightRecord_t *last = statsGetLastFlight();
+    ASSERT_NE(nullptr, last);
+    EXPECT_EQ(60u, last->flightTime);
+    EXPECT_EQ(60u * 15, last->distance);
+    EXPECT_EQ(60u * 40, last->energy);
+    EXPECT_EQ(30 * 100 + 3, last->maxAltitude);
+    EXPECT_EQ(3003, last->maxCurrent);
+    EXPECT_EQ(1680 - 400 - 3, last->minVoltage);
+}
+
+TEST_F(StatsTest, ShortFlightsAreNotRecorded)
+{
+    fly(5, 1);
+
+    boot();
+    EXPECT_EQ(0u, totals().time);
+    EXPECT_EQ(0u, flashWordsProgrammed);
+}
+
+TEST_F(StatsTest, TornRecordIsSkipped)
+{
+    fly(100, 1);
+    fly(200, 2);
+
+    // Power lost while the second record was programmed: its checksum
+    // never made it
+    const uint32_t slot = (getEEPROMConfigSize() + 31) / 32 * 32 + 32;
+    eepromData[slot + 2 + sizeof(statsFlightRecord_t)] = 0xFF;
+    eepromData[slot + 3 + sizeof(statsFlightRecord_t)] = 0xFF;
+
+    boot();
+    EXPECT_EQ(100u, totals().time);
+
+    // The next one goes after it
+    fly(50, 3);
+    boot();
+    EXPECT_EQ(150u, totals().time);
+    EXPECT_FALSE(flashProgrammedTwice);
+}
+
+TEST_F(StatsTest, ErasesOverTenThousandFlights)
+{
+    const uint32_t flights = 10000;
+
+    testTotals_t expected = totals();
+    for (uint32_t i = 0; i < flights; i++) {
+        const uint32_t duration = 60 + (i * 37) % 900;
+        fly(duration, i);
+        expected.time += duration;
+        expected.distance += duration * 15;
+        expected.energy += duration * 40;
+    }
+
+    const uint32_t erases = flashErases;
+    const uint32_t words = flashWordsProgrammed;
+    EXPECT_FALSE(flashProgrammedTwice);
+
+    const uint32_t logSlots = (FLASH_SECTOR_SIZE - (getEEPROMConfigSize() + 31) / 32 * 32) / 32;
+    printf("%u flights, %u byte config, %u records a sector: %u sector erases, %u words programmed\n",
+        flights, getEEPROMConfigSize(), logSlots, erases, words);
+
+    // One erase each time the records fill the sector, where saving the
+    // config on every disarm erased it every flight
+    EXPECT_LE(erases, flights / logSlots + 1);
+
+    boot();
+    EXPECT_EQ(expected.time, totals().time);
+    EXPECT_EQ(expected.distance, totals().distance);
+    EXPECT_EQ(expected.energy, totals().energy);
+    EXPECT_EQ(60 + ((flights - 1) * 37) % 900, statsGetLastFlight()->flightTime);
+}
+
+// STUBS
+
+extern "C" {
+
+// Simulated NOR flash: erased bytes read 0xFF, a word can only be
+// programmed once between erases
+void config_streamer_impl_unlock(void) {}
+void config_streamer_impl_lock(void) {}
+
+uint32_t config_streamer_impl_erase_size(void)
+{
+    return FLASH_SECTOR_SIZE;
+}
+
+int config_streamer_impl_write_word(config_streamer_t *c, config_streamer_buffer_align_type_t *buffer)
+{
+    const uint32_t offset = c->address - (uintptr_t)eepromData;
+
+    if (offset % FLASH_SECTOR_SIZE == 0) {
+        memset(&eepromData[offset], 0xFF, FLASH_SECTOR_SIZE);
+        flashErases++;
+    }
+
+    for (unsigned i = 0; i < CONFIG_STREAMER_BUFFER_SIZE; i++) {
+        if (eepromData[offset + i] != 0xFF) {
+            flashProgrammedTwice = true;
+        }
+    }
+    memcpy(&eepromData[offset], buffer, CONFIG_STREAMER_BUFFER_SIZE);
+    flashWordsProgrammed++;
+
+    c->address += CONFIG_STREAMER_BUFFER_SIZE;
+    return 0;
+}
+
+void failureMode(failureMode_e) { ADD_FAILURE() << "failureMode"; }
+
+void saveConfigAndNotify(void) { testSaveRequested = true; }
+bool feature(uint32_t) { return true; }
+
+uint32_t millis(void) { return testMillis; }
+
+uint32_t getTotalTravelDistance(void) { return testTravelDistance; }
+float getEstimatedActualPosition(int) { return testAltitude; }
+
+bool isAmperageConfigured(void) { return true; }
+int16_t getAmperage(void) { return testAmperage; }
+int32_t getMWhDrawn(void) { return testMWhDrawn; }
+bool isBatteryVoltageConfigured(void) { return true; }
+uint16_t getBatteryVoltage(void) { return testVoltage; }
+
+}
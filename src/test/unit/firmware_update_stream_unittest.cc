@@ -0,0 +1,554 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "platform.h"
+
+#include "common/crc.h"
+
+#include "fc/firmware_update_stream.h"
+}
+
+#include "gtest/gtest.h"
+
+typedef std::vector<uint8_t> bytes_t;
+
+/*
+ * Reference encoder, the same greedy matcher as
+ * src/utils/firmware_update_encode.py
+ */
+
+#define ENCODER_HASH_BITS       16
+#define ENCODER_MAX_CHAIN       64
+#define ENCODER_MAX_LENGTH      65536
+
+static void putVarint(bytes_t *out, uint32_t value)
+{
+    while (value >= 0x80) {
+        out->push_back((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out->push_back(value);
+}
+
+static int varintSize(uint32_t value)
+{
+    int size = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+static void putU16(bytes_t *out, uint16_t value)
+{
+    out->push_back(value & 0xFF);
+    out->push_back(value >> 8);
+}
+
+static void putU32(bytes_t *out, uint32_t value)
+{
+    putU16(out, value & 0xFFFF);
+    putU16(out, value >> 16);
+}
+
+static uint32_t hash4(const uint8_t *p)
+{
+    const uint32_t v = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    return (v * 2654435761u) >> (32 - ENCODER_HASH_BITS);
+}
+
+static uint32_t zigzag(int32_t value)
+{
+    return ((uint32_t)value << 1) ^ (uint32_t)(value >> 31);
+}
+
+typedef struct {
+    std::vector<int32_t> head;
+    std::vector<int32_t> prev;
+} hashChain_t;
+
+static void chainInit(hashChain_t *chain, size_t size)
+{
+    chain->head.assign(1 << ENCODER_HASH_BITS, -1);
+    chain->prev.assign(size, -1);
+}
+
+static void chainInsert(hashChain_t *chain, const bytes_t &data, size_t pos)
+{
+    if (pos + 4 <= data.size()) {
+        const uint32_t h = hash4(&data[pos]);
+        chain->prev[pos] = chain->head[h];
+        chain->head[h] = pos;
+    }
+}
+
+static uint32_t matchLength(const bytes_t &a, size_t aPos, const bytes_t &b, size_t bPos)
+{
+    uint32_t length = 0;
+    const size_t limit = std::min(std::min(a.size() - aPos, b.size() - bPos), (size_t)ENCODER_MAX_LENGTH);
+    while (length < limit && a[aPos + length] == b[bPos + length]) {
+        length++;
+    }
+    return length;
+}
+
+static bytes_t encodeStream(const bytes_t &image, const bytes_t *base)
+{
+    bytes_t out;
+    putU32(&out, FIRMWARE_UPDATE_STREAM_MAGIC);
+    out.push_back(FIRMWARE_UPDATE_STREAM_VERSION);
+    out.push_back(0);
+    putU16(&out, crc16_ccitt_update(0, image.data(), image.size()));
+    putU32(&out, image.size());
+    putU32(&out, base ? base->size() : 0);
+    putU16(&out, base ? crc16_ccitt_update(0, base->data(), base->size()) : 0);
+
+    hashChain_t windowChain;
+    hashChain_t baseChain;
+    chainInit(&windowChain, image.size());
+    if (base) {
+        chainInit(&baseChain, base->size());
+        for (size_t i = 0; i < base->size(); i++) {
+            chainInsert(&baseChain, *base, i);
+        }
+    }
+
+    uint32_t baseCursor = 0;
+    bytes_t literals;
+
+    auto flushLiterals = [&]() {
+        size_t pos = 0;
+        while (pos < literals.size()) {
+            const uint32_t length = std::min(literals.size() - pos, (size_t)ENCODER_MAX_LENGTH);
+            putVarint(&out, ((length - 1) << 2) | FIRMWARE_UPDATE_STREAM_OP_LITERAL);
+            out.insert(out.end(), literals.begin() + pos, literals.begin() + pos + length);
+            pos += length;
+        }
+        literals.clear();
+    };
+
+    size_t pos = 0;
+    while (pos < image.size()) {
+        int bestGain = 0;
+        uint32_t bestLength = 0;
+        uint32_t bestOp = 0;
+        uint32_t bestArgument = 0;
+
+        auto consider = [&](uint32_t op, uint32_t length, uint32_t argument) {
+            if (length < 3) {
+                return;
+            }
+            const int gain = (int)length - varintSize(((length - 1) << 2) | op) - varintSize(argument);
+            if (gain > bestGain) {
+                bestGain = gain;
+                bestLength = length;
+                bestOp = op;
+                bestArgument = argument;
+            }
+        };
+
+        if (base) {
+            // Where the image continues in the base after the copy or after
+            // an edit of the same size, then anywhere else
+            const uint32_t predicted[] = { baseCursor, (uint32_t)(baseCursor + literals.size()) };
+            for (uint32_t candidate : predicted) {
+                if (candidate < base->size()) {
+                    consider(FIRMWARE_UPDATE_STREAM_OP_BASE, matchLength(image, pos, *base, candidate), zigzag(candidate - baseCursor));
+                }
+            }
+            if (pos + 4 <= image.size()) {
+                int chain = 0;
+                for (int32_t candidate = baseChain.head[hash4(&image[pos])]; candidate >= 0 && chain < ENCODER_MAX_CHAIN; candidate = baseChain.prev[candidate], chain++) {
+                    consider(FIRMWARE_UPDATE_STREAM_OP_BASE, matchLength(image, pos, *base, candidate), zigzag(candidate - baseCursor));
+                }
+            }
+        }
+
+        if (pos + 4 <= image.size()) {
+            int chain = 0;
+            for (int32_t candidate = windowChain.head[hash4(&image[pos])]; candidate >= 0 && chain < ENCODER_MAX_CHAIN; candidate = windowChain.prev[candidate], chain++) {
+                const uint32_t distance = pos - candidate;
+                if (distance > FIRMWARE_UPDATE_STREAM_WINDOW_SIZE) {
+                    break;
+                }
+                consider(FIRMWARE_UPDATE_STREAM_OP_WINDOW, matchLength(image, pos, image, candidate), distance - 1);
+            }
+        }
+
+        if (bestLength == 0) {
+            literals.push_back(image[pos]);
+            chainInsert(&windowChain, image, pos);
+            pos++;
+            continue;
+        }
+
+        flushLiterals();
+        putVarint(&out, ((bestLength - 1) << 2) | bestOp);
+        putVarint(&out, bestArgument);
+        if (bestOp == FIRMWARE_UPDATE_STREAM_OP_BASE) {
+            const int32_t move = (int32_t)((bestArgument >> 1) ^ -(bestArgument & 1));
+            baseCursor += move + bestLength;
+        }
+        for (uint32_t i = 0; i < bestLength; i++) {
+            chainInsert(&windowChain, image, pos + i);
+        }
+        pos += bestLength;
+    }
+    flushLiterals();
+
+    return out;
+}
+
+/*
+ * Synthetic release to release image pair. Functions are made of a skewed
+ * mix of 16 bit instructions and end in a literal pool with the absolute
+ * addresses of other functions, followed by the strings.
+ * The next release edits a few functions and inserts new ones, which moves
+ * most functions and so changes most literal pools, as in a real release.
+ */
+
+typedef struct {
+    bytes_t code;
+    std::vector<int> calls;         // functions in the literal pool
+} syntheticFunction_t;
+
+typedef struct {
+    std::vector<syntheticFunction_t> functions;
+    std::vector<bytes_t> strings;
+} syntheticFirmware_t;
+
+static uint16_t randomInstruction(void)
+{
+    // Few instructions are frequent, like in compiled code
+    static const uint16_t common[] = { 0x4770, 0xB510, 0xBD10, 0x2000, 0x2001, 0x6800, 0x6008, 0x4618, 0x4601, 0x3001, 0xE7F0, 0xD1F8, 0xF000 };
+    if (rand() % 3) {
+        return common[rand() % (rand() % 2 ? 4 : sizeof(common) / sizeof(common[0]))];
+    }
+    return rand() & 0xFFFF;
+}
+
+static syntheticFunction_t randomFunction(int functionCount)
+{
+    syntheticFunction_t function;
+    const int instructions = 8 + rand() % 200;
+    for (int i = 0; i < instructions; i++) {
+        const uint16_t insn = randomInstruction();
+        function.code.push_back(insn & 0xFF);
+        function.code.push_back(insn >> 8);
+    }
+    const int calls = rand() % 6;
+    for (int i = 0; i < calls; i++) {
+        function.calls.push_back(rand() % functionCount);
+    }
+    return function;
+}
+
+static syntheticFirmware_t randomFirmware(int functionCount)
+{
+    static const char *words[] = { "gyro", "acc", "nav", "pid", "rate", "osd", "rx", "serial", "motor", "servo", "baro", "mag", "_", " ", "%d", "\n" };
+    syntheticFirmware_t firmware;
+    for (int i = 0; i < functionCount; i++) {
+        firmware.functions.push_back(randomFunction(functionCount));
+    }
+    for (int i = 0; i < functionCount / 4; i++) {
+        bytes_t str;
+        const int count = 1 + rand() % 6;
+        for (int j = 0; j < count; j++) {
+            const char *word = words[rand() % (sizeof(words) / sizeof(words[0]))];
+            str.insert(str.end(), word, word + strlen(word));
+        }
+        str.push_back(0);
+        firmware.strings.push_back(str);
+    }
+    return firmware;
+}
+
+static bytes_t linkFirmware(const syntheticFirmware_t *firmware)
+{
+    std::vector<uint32_t> addresses;
+    uint32_t address = 0x08000000;
+    for (const syntheticFunction_t &function : firmware->functions) {
+        addresses.push_back(address);
+        address += (function.code.size() + 3) / 4 * 4 + function.calls.size() * 4;
+    }
+
+    bytes_t image;
+    for (const syntheticFunction_t &function : firmware->functions) {
+        image.insert(image.end(), function.code.begin(), function.code.end());
+        while (image.size() % 4) {
+            image.push_back(0);
+        }
+        for (int call : function.calls) {
+            putU32(&image, addresses[call % addresses.size()] | 1);
+        }
+    }
+    for (const bytes_t &str : firmware->strings) {
+        image.insert(image.end(), str.begin(), str.end());
+    }
+    return image;
+}
+
+static syntheticFirmware_t nextRelease(const syntheticFirmware_t *firmware, int edits, int insertions)
+{
+    syntheticFirmware_t next = *firmware;
+    const int functionCount = next.functions.size();
+
+    for (int i = 0; i < edits; i++) {
+        syntheticFunction_t *function = &next.functions[rand() % functionCount];
+        const int offset = rand() % function->code.size() & ~1;
+        const int added = (rand() % 16) * 2;
+        for (int j = 0; j < added; j++) {
+            function->code.insert(function->code.begin() + offset, rand());
+        }
+        function->code[rand() % function->code.size()] ^= 0x40;
+    }
+    for (int i = 0; i < insertions; i++) {
+        next.functions.insert(next.functions.begin() + rand() % next.functions.size(), randomFunction(functionCount));
+    }
+    next.strings[rand() % next.strings.size()].back() = '!';
+    return next;
+}
+
+/*
+ * Storage backend with the geometry and typical timings of an SPI NOR flash
+ * update partition, programming whole pages and erasing sectors on entry
+ */
+
+#define FLASH_PAGE_SIZE             256
+#define FLASH_SECTOR_SIZE           (64 * 1024)
+#define FLASH_PAGE_PROGRAM_US       700
+#define FLASH_SECTOR_ERASE_US       150000
+
+static bytes_t storage;
+static uint32_t storageWrites;
+static uint32_t storageShortWrites;
+static uint64_t storageTimeUs;
+static uint16_t storageBlockSize;
+static bool storageFail;
+
+static void storageReset(uint16_t blockSize)
+{
+    storage.clear();
+    storageWrites = 0;
+    storageShortWrites = 0;
+    storageTimeUs = 0;
+    storageBlockSize = blockSize;
+    storageFail = false;
+}
+
+static bool storageWrite(const uint8_t *data, uint32_t length)
+{
+    if (storageFail) {
+        return false;
+    }
+    if (storage.size() % FLASH_SECTOR_SIZE == 0) {
+        storageTimeUs += FLASH_SECTOR_ERASE_US;
+    }
+    storageTimeUs += FLASH_PAGE_PROGRAM_US * ((length + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE);
+    storage.insert(storage.end(), data, data + length);
+    storageWrites++;
+    if (length != storageBlockSize) {
+        storageShortWrites++;
+    }
+    return true;
+}
+
+static firmwareUpdateStream_t stream;
+
+// Feeds the stream in chunks of random size up to maxChunk
+static bool feedStream(const bytes_t &encoded, const bytes_t *base, uint32_t imageSize, uint16_t blockSize, int maxChunk)
+{
+    storageReset(blockSize);
+    EXPECT_TRUE(firmwareUpdateStreamInit(&stream, imageSize, base ? base->data() : NULL, base ? base->size() : 0, blockSize, storageWrite));
+
+    for (size_t pos = 0; pos < encoded.size(); ) {
+        const size_t length = std::min(encoded.size() - pos, (size_t)(1 + rand() % maxChunk));
+        if (!firmwareUpdateStreamFeed(&stream, &encoded[pos], length)) {
+            return false;
+        }
+        pos += length;
+    }
+    return firmwareUpdateStreamIsComplete(&stream);
+}
+
+class FirmwareUpdateStreamTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        srand(42);
+        const syntheticFirmware_t current = randomFirmware(600);
+        const syntheticFirmware_t next = nextRelease(&current, 20, 8);
+        base = linkFirmware(&current);
+        image = linkFirmware(&next);
+    }
+
+    bytes_t base;
+    bytes_t image;
+};
+
+TEST_F(FirmwareUpdateStreamTest, DecodesCompressedImage)
+{
+    const bytes_t encoded = encodeStream(image, NULL);
+    ASSERT_LT(encoded.size(), image.size());
+
+    for (int maxChunk : { 1, 7, 64, 250, 4096 }) {
+        ASSERT_TRUE(feedStream(encoded, NULL, image.size(), 256, maxChunk)) << "chunks up to " << maxChunk;
+        ASSERT_TRUE(storage == image);
+        EXPECT_LE(storageShortWrites, 1u);
+    }
+}
+
+TEST_F(FirmwareUpdateStreamTest, DecodesDeltaImage)
+{
+    const bytes_t encoded = encodeStream(image, &base);
+
+    for (uint16_t blockSize : { 256, 512, 1024 }) {
+        ASSERT_TRUE(feedStream(encoded, &base, image.size(), blockSize, 300)) << "block size " << blockSize;
+        ASSERT_TRUE(storage == image);
+        EXPECT_EQ(storageWrites, (image.size() + blockSize - 1) / blockSize);
+    }
+}
+
+TEST_F(FirmwareUpdateStreamTest, RejectsOtherBase)
+{
+    const bytes_t encoded = encodeStream(image, &base);
+
+    bytes_t otherBase = base;
+    otherBase[otherBase.size() / 2] ^= 1;
+    EXPECT_FALSE(feedStream(encoded, &otherBase, image.size(), 256, 64));
+    EXPECT_EQ(storage.size(), 0u);
+
+    // Running firmware smaller than the base
+    bytes_t shortBase(base.begin(), base.end() - 1);
+    EXPECT_FALSE(feedStream(encoded, &shortBase, image.size(), 256, 64));
+}
+
+TEST_F(FirmwareUpdateStreamTest, RejectsDamagedStreams)
+{
+    const bytes_t encoded = encodeStream(image, &base);
+
+    EXPECT_FALSE(feedStream(encoded, &base, image.size() + 1, 256, 64));
+
+    bytes_t truncated(encoded.begin(), encoded.end() - 1);
+    EXPECT_FALSE(feedStream(truncated, &base, image.size(), 256, 64));
+
+    bytes_t trailing = encoded;
+    trailing.push_back(0);
+    EXPECT_FALSE(feedStream(trailing, &base, image.size(), 256, 64));
+
+    for (int i = 0; i < 50; i++) {
+        bytes_t damaged = encoded;
+        damaged[FIRMWARE_UPDATE_STREAM_HEADER_SIZE + rand() % (damaged.size() - FIRMWARE_UPDATE_STREAM_HEADER_SIZE)] ^= 1 << (rand() % 8);
+        // A damaged copy may still produce the same bytes, a wrong image never completes
+        if (feedStream(damaged, &base, image.size(), 256, 64)) {
+            ASSERT_TRUE(storage == image) << "damage " << i;
+        }
+    }
+
+    storageReset(256);
+    storageFail = true;
+    ASSERT_TRUE(firmwareUpdateStreamInit(&stream, image.size(), base.data(), base.size(), 256, storageWrite));
+    EXPECT_FALSE(firmwareUpdateStreamFeed(&stream, encoded.data(), encoded.size()));
+    EXPECT_FALSE(firmwareUpdateStreamIsComplete(&stream));
+}
+
+TEST_F(FirmwareUpdateStreamTest, RejectsBadBlockSize)
+{
+    EXPECT_FALSE(firmwareUpdateStreamInit(&stream, image.size(), NULL, 0, 0, storageWrite));
+    EXPECT_FALSE(firmwareUpdateStreamInit(&stream, image.size(), NULL, 0, 384, storageWrite));
+    EXPECT_FALSE(firmwareUpdateStreamInit(&stream, image.size(), NULL, 0, 2048, storageWrite));
+}
+
+/*
+ * Bytes on the wire and update time for the synthetic release pair, sent as
+ * MSP2_INAV_FWUPDT_STORE messages over links of a given rate and round trip
+ * time, one message in flight. Times come from the link and storage models
+ * above, not from hardware.
+ */
+
+#define MSP_V2_OVERHEAD         9       // $X< flag cmd(2) size(2) crc
+#define MSP_STORE_PAYLOAD       128
+
+typedef struct {
+    const char *name;
+    uint32_t bytesPerSecond;
+    uint32_t roundTripUs;
+} linkModel_t;
+
+static uint32_t wireBytes(size_t payload)
+{
+    const uint32_t messages = (payload + MSP_STORE_PAYLOAD - 1) / MSP_STORE_PAYLOAD;
+    // Every request is acknowledged with an empty reply
+    return payload + messages * (MSP_V2_OVERHEAD + MSP_V2_OVERHEAD);
+}
+
+static double updateSeconds(size_t payload, const linkModel_t *link, uint64_t storageUs)
+{
+    const uint32_t messages = (payload + MSP_STORE_PAYLOAD - 1) / MSP_STORE_PAYLOAD;
+    const double wireUs = wireBytes(payload) * 1e6 / link->bytesPerSecond + (double)messages * link->roundTripUs;
+    return (wireUs + storageUs) / 1e6;
+}
+
+TEST_F(FirmwareUpdateStreamTest, ReleaseToReleaseWireReport)
+{
+    const bytes_t compressed = encodeStream(image, NULL);
+    const bytes_t delta = encodeStream(image, &base);
+
+    ASSERT_TRUE(feedStream(compressed, NULL, image.size(), FLASH_PAGE_SIZE, MSP_STORE_PAYLOAD));
+    const uint64_t storageUs = storageTimeUs;
+    ASSERT_TRUE(feedStream(delta, &base, image.size(), FLASH_PAGE_SIZE, MSP_STORE_PAYLOAD));
+    ASSERT_EQ(storageUs, storageTimeUs);
+
+    EXPECT_LT(compressed.size(), image.size());
+    EXPECT_LT(delta.size(), compressed.size());
+
+    const linkModel_t links[] = {
+        { "serial 115200", 11520, 2000 },
+        { "telemetry 1kB/s", 1000, 40000 },
+    };
+    const struct {
+        const char *name;
+        size_t size;
+    } encodings[] = {
+        { "raw", image.size() },
+        { "compressed", compressed.size() },
+        { "delta", delta.size() },
+    };
+
+    printf("synthetic image %u bytes, storage model %.1f s\n", (unsigned)image.size(), storageUs / 1e6);
+    for (const linkModel_t &link : links) {
+        for (const auto &encoding : encodings) {
+            printf("%-16s %-11s %8u bytes on the wire %8.1f s\n", link.name, encoding.name,
+                (unsigned)wireBytes(encoding.size), updateSeconds(encoding.size, &link, storageUs));
+        }
+    }
+}
+
+TEST(FirmwareUpdateStreamRamTest, BoundedState)
+{
+    // The window, which doubles as the storage block buffer, and a few words
+    EXPECT_LE(sizeof(firmwareUpdateStream_t), FIRMWARE_UPDATE_STREAM_WINDOW_SIZE + 128u);
+}
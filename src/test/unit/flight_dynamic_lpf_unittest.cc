@@ -0,0 +1,216 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cstring>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+
+    #include "fc/rc_controls.h"
+
+    #include "flight/dynamic_lpf.h"
+    #include "flight/mixer.h"
+
+    #include "sensors/gyro.h"
+
+    int32_t *debugModeValues[DEBUG_COUNT];
+    int16_t rcCommand[4];
+    gyroConfig_t gyroConfig_System;
+    motorConfig_t motorConfig_System;
+
+    int getThrottleIdleValue(void)
+    {
+        return 1150;
+    }
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// What dynamicLpfGyroTask() computed for a throttle position
+static float directCutoffFreq(float throttle, uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo)
+{
+    const float expof = expo / 10.0f;
+    const float curve = throttle * (1 - throttle) * expof + throttle;
+    return (dynLpfMax - dynLpfMin) * curve + dynLpfMin;
+}
+
+// Cutoff moved by half a table step at most, from the slope of the curve
+static float halfStepCutoff(uint16_t dynLpfMin, uint16_t dynLpfMax, uint8_t expo)
+{
+    return 0.5f * (dynLpfMax - dynLpfMin) * (1 + expo / 10.0f) / DYN_LPF_TABLE_STEPS;
+}
+
+TEST(DynamicLpfTest, BiquadCoefficientsMatchDirectComputation)
+{
+    const uint32_t looptimes[] = { 1000, 500, 250, 125 };
+    dynLpfTable_t table;
+
+    for (uint32_t looptime : looptimes) {
+        dynLpfTableInit(&table, FILTER_BIQUAD, 200, 400, 5, looptime);
+
+        for (int i = 0; i <= 1000; i++) {
+            const float throttle = i / 1000.0f;
+            const uint8_t index = dynLpfTableIndex(throttle);
+
+            filter_t state[XYZ_AXIS_COUNT];
+            memset(state, 0, sizeof(state));
+            table.index = UINT8_MAX;
+            dynLpfTableApply(&table, index, state);
+
+            // The table picked the nearest step, at most half a step away
+            const float cutoffFreq = directCutoffFreq(throttle, 200, 400, 5);
+            ASSERT_NEAR(cutoffFreq, table.cutoffHz[index], halfStepCutoff(200, 400, 5) + 0.5f) << "throttle " << throttle;
+
+            biquadFilter_t lower, upper;
+            biquadFilterInit(&lower, cutoffFreq - halfStepCutoff(200, 400, 5) - 1, looptime, BIQUAD_Q, FILTER_LPF);
+            biquadFilterInit(&upper, cutoffFreq + halfStepCutoff(200, 400, 5) + 1, looptime, BIQUAD_Q, FILTER_LPF);
+
+            for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+                // Between the filters half a table step either side of
+                // the throttle, plus a Hz as biquadFilterInit() truncates
+                ASSERT_GE(state[axis].biquad.b0, lower.b0) << "throttle " << throttle;
+                ASSERT_LE(state[axis].biquad.b0, upper.b0) << "throttle " << throttle;
+                ASSERT_NEAR((lower.a1 + upper.a1) / 2, state[axis].biquad.a1, fabsf(upper.a1 - lower.a1) / 2 + 1e-4f) << "throttle " << throttle;
+                ASSERT_NEAR((lower.a2 + upper.a2) / 2, state[axis].biquad.a2, fabsf(upper.a2 - lower.a2) / 2 + 1e-4f) << "throttle " << throttle;
+            }
+        }
+    }
+}
+
+TEST(DynamicLpfTest, TableStepsAreExact)
+{
+    dynLpfTable_t table;
+    filter_t state[XYZ_AXIS_COUNT];
+
+    dynLpfTableInit(&table, FILTER_BIQUAD, 150, 450, 7, 250);
+
+    for (int index = 0; index <= DYN_LPF_TABLE_STEPS; index++) {
+        const float cutoffFreq = directCutoffFreq((float)index / DYN_LPF_TABLE_STEPS, 150, 450, 7);
+
+        // As gyroUpdateDynamicLpf() did it, on a running filter
+        biquadFilter_t direct;
+        biquadFilterInitLPF(&direct, 100, 250);
+        biquadFilterUpdate(&direct, cutoffFreq, 250, BIQUAD_Q, FILTER_LPF);
+
+        memset(state, 0, sizeof(state));
+        table.index = UINT8_MAX;
+        dynLpfTableApply(&table, index, state);
+
+        EXPECT_EQ(direct.b0, state[Z].biquad.b0);
+        EXPECT_EQ(direct.b1, state[Z].biquad.b1);
+        EXPECT_EQ(direct.b2, state[Z].biquad.b2);
+        EXPECT_EQ(direct.a1, state[Z].biquad.a1);
+        EXPECT_EQ(direct.a2, state[Z].biquad.a2);
+    }
+}
+
+TEST(DynamicLpfTest, Pt1CoefficientsMatchDirectComputation)
+{
+    dynLpfTable_t table;
+    filter_t state[XYZ_AXIS_COUNT];
+
+    dynLpfTableInit(&table, FILTER_PT1, 100, 500, 3, 500);
+
+    for (int i = 0; i <= 1000; i++) {
+        const float throttle = i / 1000.0f;
+
+        memset(state, 0, sizeof(state));
+        table.index = UINT8_MAX;
+        dynLpfTableApply(&table, dynLpfTableIndex(throttle), state);
+
+        // As gyroUpdateDynamicLpf() did it, half a table step either side
+        const float cutoffFreq = directCutoffFreq(throttle, 100, 500, 3);
+        pt1Filter_t lower, upper;
+        pt1FilterInit(&lower, 100, US2S(500));
+        pt1FilterUpdateCutoff(&lower, cutoffFreq - halfStepCutoff(100, 500, 3));
+        pt1FilterInit(&upper, 100, US2S(500));
+        pt1FilterUpdateCutoff(&upper, cutoffFreq + halfStepCutoff(100, 500, 3));
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            ASSERT_GE(state[axis].pt1.alpha, lower.alpha) << "throttle " << throttle;
+            ASSERT_LE(state[axis].pt1.alpha, upper.alpha) << "throttle " << throttle;
+        }
+    }
+}
+
+TEST(DynamicLpfTest, KeepsFilterState)
+{
+    dynLpfTable_t table;
+    filter_t state[XYZ_AXIS_COUNT];
+
+    dynLpfTableInit(&table, FILTER_BIQUAD, 200, 500, 5, 1000);
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        biquadFilterInitLPF(&state[axis].biquad, 200, 1000);
+        for (int i = 0; i < 10; i++) {
+            biquadFilterApply(&state[axis].biquad, 100.0f * (axis + 1));
+        }
+    }
+    const biquadFilter_t before = state[Y].biquad;
+
+    dynLpfTableApply(&table, DYN_LPF_TABLE_STEPS / 2, state);
+
+    EXPECT_EQ(before.x1, state[Y].biquad.x1);
+    EXPECT_EQ(before.x2, state[Y].biquad.x2);
+    EXPECT_EQ(before.y1, state[Y].biquad.y1);
+    EXPECT_EQ(before.y2, state[Y].biquad.y2);
+    EXPECT_NE(before.b0, state[Y].biquad.b0);
+}
+
+TEST(DynamicLpfTest, ThrottleOutOfRangeIsClamped)
+{
+    EXPECT_EQ(0, dynLpfTableIndex(-0.3f));
+    EXPECT_EQ(0, dynLpfTableIndex(0.0f));
+    EXPECT_EQ(DYN_LPF_TABLE_STEPS / 2, dynLpfTableIndex(0.5f));
+    EXPECT_EQ(DYN_LPF_TABLE_STEPS, dynLpfTableIndex(1.0f));
+    EXPECT_EQ(DYN_LPF_TABLE_STEPS, dynLpfTableIndex(1.7f));
+}
+
+TEST(DynamicLpfTest, GyroUpdateFollowsThrottle)
+{
+    filter_t state[XYZ_AXIS_COUNT];
+
+    gyroConfig_System.gyro_main_lpf_type = FILTER_PT1;
+    gyroConfig_System.gyroDynamicLpfMinHz = 200;
+    gyroConfig_System.gyroDynamicLpfMaxHz = 500;
+    gyroConfig_System.gyroDynamicLpfCurveExpo = 5;
+    motorConfig_System.maxthrottle = 1850;
+
+    memset(state, 0, sizeof(state));
+    dynamicLpfGyroInit(1000);
+
+    rcCommand[THROTTLE] = 1150;
+    dynamicLpfGyroUpdate(state);
+    const float idleAlpha = state[X].pt1.alpha;
+
+    rcCommand[THROTTLE] = 1850;
+    dynamicLpfGyroUpdate(state);
+    EXPECT_GT(state[X].pt1.alpha, idleAlpha);
+
+    pt1Filter_t direct;
+    pt1FilterInit(&direct, 500, US2S(1000));
+    EXPECT_FLOAT_EQ(direct.alpha, state[Y].pt1.alpha);
+}
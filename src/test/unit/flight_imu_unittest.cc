@@ -113,6 +113,8 @@ uint32_t millis(void) { return 0; }
 timeDelta_t getLooptime(void) { return gyro.targetLooptime; }
 timeDelta_t getGyroLooptime(void) { return gyro.targetLooptime; }
 void schedulerResetTaskStatistics(cfTaskId_e) {}
+void dynamicLpfGyroInit(uint32_t) {}
+void dynamicLpfGyroUpdate(filter_t *) {}
 void sensorsSet(uint32_t) {}
 bool compassIsHealthy(void) { return true; }
 void accGetVibrationLevels(fpVector3_t *accVibeLevels)
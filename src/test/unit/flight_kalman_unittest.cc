@@ -0,0 +1,222 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+
+    #include "flight/kalman.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * The filter before all three axes were processed in one pass, kept as the
+ * reference: one axis at a time, a divide for e, a divide for k, and a
+ * window of MAX_KALMAN_WINDOW_SIZE + 1 slots.
+ */
+typedef struct {
+    float q, r, p, k, x, lastX, e;
+    float setpoint;
+    float axisVar;
+    uint16_t windex;
+    float axisWindow[MAX_KALMAN_WINDOW_SIZE + 1];
+    float varianceWindow[MAX_KALMAN_WINDOW_SIZE + 1];
+    float axisSumMean, axisMean, axisSumVar, inverseN;
+    uint16_t w;
+} referenceKalman_t;
+
+static void referenceInit(referenceKalman_t *filter, uint16_t q)
+{
+    memset(filter, 0, sizeof(*filter));
+    filter->q = q * 0.03f;
+    filter->r = 88.0f;
+    filter->p = 30.0f;
+    filter->e = 1.0f;
+    filter->w = MAX_KALMAN_WINDOW_SIZE;
+    filter->inverseN = 1.0f / (float)(filter->w);
+}
+
+static float referenceUpdate(referenceKalman_t *s, float input)
+{
+    s->axisWindow[s->windex] = input;
+    s->axisSumMean += s->axisWindow[s->windex];
+    float varianceElement = s->axisWindow[s->windex] - s->axisMean;
+    varianceElement = varianceElement * varianceElement;
+    s->axisSumVar += varianceElement;
+    s->varianceWindow[s->windex] = varianceElement;
+    s->windex++;
+    if (s->windex > s->w) {
+        s->windex = 0;
+    }
+    s->axisSumMean -= s->axisWindow[s->windex];
+    s->axisSumVar -= s->varianceWindow[s->windex];
+    s->axisMean = s->axisSumMean * s->inverseN;
+    s->axisVar = s->axisSumVar * s->inverseN;
+    // arm_sqrt_f32() as on the flight controller, 0 for negative input
+    s->r = (s->axisVar > 0.0f ? sqrtf(s->axisVar) : 0.0f) * VARIANCE_SCALE;
+
+    s->x += (s->x - s->lastX);
+    s->lastX = s->x;
+    if (s->lastX != 0.0f) {
+        s->e = fabsf(1.0f - (s->setpoint / s->lastX));
+    }
+    s->p = s->p + (s->q * s->e);
+    s->k = s->p / (s->p + s->r);
+    s->x += s->k * (input - s->x);
+    s->p = (1.0f - s->k) * s->p;
+    return s->x;
+}
+
+/*
+ * Synthetic gyro traces at a 1kHz PID loop, generated rather than taken
+ * from blackbox logs so they can live in the test: stick inputs through
+ * rate smoothing, a frame that follows the setpoint with some lag, motor
+ * noise harmonics and sensor noise quantised to the 16.4 LSB/dps scale.
+ */
+typedef struct {
+    std::vector<float> gyro[XYZ_AXIS_COUNT];
+    std::vector<float> setpoint[XYZ_AXIS_COUNT];
+} gyroTrace_t;
+
+static uint32_t traceRandomState;
+
+static float traceRandom(float min, float max)
+{
+    traceRandomState = traceRandomState * 1664525 + 1013904223;
+    return min + (max - min) * (traceRandomState >> 8) * (1.0f / (1 << 24));
+}
+
+static gyroTrace_t makeTrace(uint32_t seed, int samples, float maxRate, float stickHoldMs, float motorHz, float noise)
+{
+    gyroTrace_t trace;
+    float stick[XYZ_AXIS_COUNT] = { 0 };
+    float setpoint[XYZ_AXIS_COUNT] = { 0 };
+    float rate[XYZ_AXIS_COUNT] = { 0 };
+    float phase = 0;
+
+    traceRandomState = seed;
+    for (int i = 0; i < samples; i++) {
+        phase += 2 * (float)M_PI * (motorHz + 20 * sinf(i * 0.001f)) * 0.001f;
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            if (traceRandom(0, stickHoldMs) < 1.0f) {
+                // Centre sticks half of the time
+                stick[axis] = traceRandom(0, 1) < 0.5f ? 0 : traceRandom(-maxRate, maxRate);
+            }
+            setpoint[axis] += (stick[axis] - setpoint[axis]) * 0.05f;
+            rate[axis] += (setpoint[axis] - rate[axis]) * 0.04f;
+            const float vibration = noise * (sinf(phase + axis) + 0.4f * sinf(2 * phase + 2 * axis));
+            const float raw = rate[axis] + vibration + traceRandom(-noise, noise) * 0.3f;
+            trace.gyro[axis].push_back(roundf(raw * 16.4f) / 16.4f);
+            trace.setpoint[axis].push_back(setpoint[axis]);
+        }
+    }
+    return trace;
+}
+
+extern "C" {
+    extern kalman_t kalmanFilterStateRate;
+}
+
+static void expectMatchesReference(const gyroTrace_t &trace, uint16_t q)
+{
+    referenceKalman_t reference[XYZ_AXIS_COUNT];
+
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        referenceInit(&reference[axis], q);
+    }
+    gyroKalmanInitialize(q);
+
+    for (size_t i = 0; i < trace.gyro[X].size(); i++) {
+        float gyroADCf[XYZ_AXIS_COUNT];
+        float expected[XYZ_AXIS_COUNT];
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            reference[axis].setpoint = trace.setpoint[axis][i];
+            gyroKalmanUpdateSetpoint(axis, trace.setpoint[axis][i]);
+            expected[axis] = referenceUpdate(&reference[axis], trace.gyro[axis][i]);
+            gyroADCf[axis] = trace.gyro[axis][i];
+        }
+
+        gyroKalmanUpdate(gyroADCf);
+
+        for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+            const float error = fabsf(gyroADCf[axis] - expected[axis]);
+            ASSERT_LE(error, 0.02f + 1e-5f * fabsf(expected[axis])) << "sample " << i << " axis " << axis;
+        }
+    }
+}
+
+TEST(FlightKalmanTest, MatchesReferenceHover)
+{
+    expectMatchesReference(makeTrace(1, 20000, 60, 800, 180, 8), 100);
+}
+
+TEST(FlightKalmanTest, MatchesReferenceFreestyle)
+{
+    expectMatchesReference(makeTrace(2, 20000, 800, 150, 230, 20), 100);
+}
+
+TEST(FlightKalmanTest, MatchesReferenceTuningRange)
+{
+    // Lowest, default and highest setpoint_kalman_q
+    expectMatchesReference(makeTrace(3, 5000, 400, 300, 200, 12), 1);
+    expectMatchesReference(makeTrace(4, 5000, 400, 300, 200, 12), 100);
+    expectMatchesReference(makeTrace(5, 5000, 400, 300, 200, 12), 1000);
+}
+
+TEST(FlightKalmanTest, MatchesReferenceQuietGyro)
+{
+    // Disarmed on the bench: the gyro reads exactly zero for long stretches,
+    // which keeps the state at zero and the error ratio at its last value
+    gyroTrace_t trace = makeTrace(6, 4000, 200, 300, 200, 2);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        for (int i = 1000; i < 3000; i++) {
+            trace.gyro[axis][i] = 0;
+            trace.setpoint[axis][i] = 0;
+        }
+    }
+    expectMatchesReference(trace, 100);
+}
+
+TEST(FlightKalmanTest, WindowHoldsLastSamples)
+{
+    float gyroADCf[XYZ_AXIS_COUNT];
+
+    gyroKalmanInitialize(100);
+    for (int i = 0; i < 3 * MAX_KALMAN_WINDOW_SIZE + 5; i++) {
+        gyroADCf[X] = i;
+        gyroADCf[Y] = -i;
+        gyroADCf[Z] = 1;
+        gyroKalmanUpdate(gyroADCf);
+    }
+
+    // Mean of the last MAX_KALMAN_WINDOW_SIZE samples
+    const float expectedMean = 3 * MAX_KALMAN_WINDOW_SIZE + 4 - (MAX_KALMAN_WINDOW_SIZE - 1) / 2.0f;
+    EXPECT_FLOAT_EQ(expectedMean, kalmanFilterStateRate.axisMean[X]);
+    EXPECT_FLOAT_EQ(-expectedMean, kalmanFilterStateRate.axisMean[Y]);
+    EXPECT_FLOAT_EQ(1, kalmanFilterStateRate.axisMean[Z]);
+}
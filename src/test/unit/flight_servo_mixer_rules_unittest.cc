@@ -0,0 +1,228 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cstring>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/filter.h"
+
+    #include "flight/servo_mixer_rules.h"
+    #include "flight/servos.h"
+
+    #include "programming/logic_condition.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define MIXER_DT            0.001f
+#define MIXER_MINCOMMAND    1000
+
+static bool conditionValue[MAX_LOGIC_CONDITIONS];
+
+extern "C" {
+    int logicConditionGetValue(int8_t conditionId)
+    {
+        return conditionId >= 0 ? conditionValue[conditionId] : true;
+    }
+}
+
+static uint32_t mixerRandomState;
+
+static int32_t mixerRandom(int32_t min, int32_t max)
+{
+    mixerRandomState = mixerRandomState * 1664525 + 1013904223;
+    return min + (int32_t)((mixerRandomState >> 8) % (uint32_t)(max - min + 1));
+}
+
+// The rule loop of servoMixer() before the rules were compiled: every
+// input computed, every rule checked for its condition and speed limit
+static void referenceMix(const servoMixer_t *rules, const int16_t *input, rateLimitFilter_t *filters, bool armed, int16_t *output)
+{
+    int ruleCount = 0;
+    while (ruleCount < MAX_SERVO_RULES && rules[ruleCount].rate != 0) {
+        ruleCount++;
+    }
+
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        output[i] = 0;
+    }
+
+    for (int i = 0; i < ruleCount; i++) {
+        if (!logicConditionGetValue(rules[i].conditionId)) {
+            continue;
+        }
+        const uint8_t target = rules[i].targetChannel;
+        const uint8_t from = rules[i].inputSource;
+        int16_t inputLimited = (int16_t) rateLimitFilterApply4(&filters[i], input[from], rules[i].speed * 10, MIXER_DT);
+        output[target] += ((int32_t)inputLimited * rules[i].rate) / 100;
+    }
+
+    if (!armed) {
+        for (int i = 0; i < ruleCount; i++) {
+            const uint8_t from = rules[i].inputSource;
+            if (from == INPUT_STABILIZED_THROTTLE || from == INPUT_RC_THROTTLE) {
+                output[rules[i].targetChannel] = MIXER_MINCOMMAND;
+            }
+        }
+    }
+}
+
+static void compiledMix(const servoMixerRuleList_t *list, const int16_t *input, rateLimitFilter_t *filters, bool armed, int16_t *output)
+{
+    for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+        output[i] = 0;
+    }
+
+    servoMixerRulesApply(list, input, filters, MIXER_DT, output);
+
+    if (!armed) {
+        for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+            if (list->throttleTargets & (1 << i)) {
+                output[i] = MIXER_MINCOMMAND;
+            }
+        }
+    }
+}
+
+static void randomMix(servoMixer_t *rules)
+{
+    memset(rules, 0, sizeof(servoMixer_t) * MAX_SERVO_RULES);
+
+    const int ruleCount = mixerRandom(1, MAX_SERVO_RULES);
+    for (int i = 0; i < ruleCount; i++) {
+        rules[i].targetChannel = mixerRandom(0, MAX_SUPPORTED_SERVOS - 1);
+        rules[i].inputSource = mixerRandom(0, INPUT_SOURCE_COUNT - 1);
+        rules[i].rate = mixerRandom(1, 1000) * (mixerRandom(0, 1) ? 1 : -1);
+        rules[i].speed = mixerRandom(0, 2) ? 0 : mixerRandom(1, MAX_SERVO_SPEED);
+        rules[i].conditionId = mixerRandom(0, 2) ? -1 : mixerRandom(0, MAX_LOGIC_CONDITIONS - 1);
+    }
+}
+
+TEST(ServoMixerRulesTest, MatchesReferenceOnRandomMixes)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    servoMixerRuleList_t list;
+
+    mixerRandomState = 1;
+
+    for (int mix = 0; mix < 500; mix++) {
+        rateLimitFilter_t referenceFilters[MAX_SERVO_RULES];
+        rateLimitFilter_t compiledFilters[MAX_SERVO_RULES];
+
+        randomMix(rules);
+        servoMixerRulesCompile(&list, rules);
+        memset(referenceFilters, 0, sizeof(referenceFilters));
+        memset(compiledFilters, 0, sizeof(compiledFilters));
+
+        for (int loop = 0; loop < 200; loop++) {
+            int16_t input[INPUT_SOURCE_COUNT];
+            int16_t compiledInput[INPUT_SOURCE_COUNT];
+            int16_t expected[MAX_SUPPORTED_SERVOS];
+            int16_t output[MAX_SUPPORTED_SERVOS];
+
+            for (int source = 0; source < INPUT_SOURCE_COUNT; source++) {
+                input[source] = mixerRandom(-500, 500);
+                // Inputs outside of the mask aren't computed by servoMixer()
+                compiledInput[source] = (list.inputs & SERVO_MIXER_INPUT_BIT(source)) ? input[source] : INT16_MIN;
+            }
+            for (int i = 0; i < MAX_LOGIC_CONDITIONS; i++) {
+                conditionValue[i] = mixerRandom(0, 3) != 0;
+            }
+            const bool armed = mixerRandom(0, 9) != 0;
+
+            referenceMix(rules, input, referenceFilters, armed, expected);
+            compiledMix(&list, compiledInput, compiledFilters, armed, output);
+
+            for (int i = 0; i < MAX_SUPPORTED_SERVOS; i++) {
+                ASSERT_EQ(expected[i], output[i]) << "mix " << mix << " loop " << loop << " servo " << i;
+            }
+        }
+    }
+}
+
+TEST(ServoMixerRulesTest, CompilesPlaneMix)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    servoMixerRuleList_t list;
+
+    memset(rules, 0, sizeof(rules));
+    rules[0] = (servoMixer_t){ 1, INPUT_STABILIZED_ROLL, 100, 0, -1 };
+    rules[1] = (servoMixer_t){ 2, INPUT_STABILIZED_ROLL, 100, 0, -1 };
+    rules[2] = (servoMixer_t){ 3, INPUT_STABILIZED_PITCH, 100, 0, -1 };
+    rules[3] = (servoMixer_t){ 4, INPUT_STABILIZED_YAW, 100, 20, 3 };
+    rules[4] = (servoMixer_t){ 5, INPUT_RC_THROTTLE, 100, 0, -1 };
+
+    servoMixerRulesCompile(&list, rules);
+
+    EXPECT_EQ(5, list.ruleCount);
+    EXPECT_EQ(5, list.configuredCount);
+    EXPECT_EQ(1, list.minTarget);
+    EXPECT_EQ(5, list.maxTarget);
+    EXPECT_EQ(SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_ROLL) | SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH) |
+              SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_YAW) | SERVO_MIXER_INPUT_BIT(INPUT_RC_THROTTLE), list.inputs);
+    EXPECT_EQ(1 << 5, list.throttleTargets);
+    EXPECT_EQ(0, list.rules[0].flags);
+    EXPECT_EQ(SERVO_MIXER_RULE_SPEED_LIMIT | SERVO_MIXER_RULE_CONDITION, list.rules[3].flags);
+    EXPECT_EQ(200, list.rules[3].speedLimit);
+}
+
+TEST(ServoMixerRulesTest, StopsAtFirstEmptyRule)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    servoMixerRuleList_t list;
+
+    memset(rules, 0, sizeof(rules));
+    rules[0] = (servoMixer_t){ 2, INPUT_STABILIZED_PITCH, 100, 0, -1 };
+    rules[2] = (servoMixer_t){ 7, INPUT_GVAR_0, 100, 0, -1 };
+
+    servoMixerRulesCompile(&list, rules);
+
+    EXPECT_EQ(1, list.ruleCount);
+    EXPECT_EQ(SERVO_MIXER_INPUT_BIT(INPUT_STABILIZED_PITCH), list.inputs);
+}
+
+TEST(ServoMixerRulesTest, SkipsRulesOutOfRange)
+{
+    servoMixer_t rules[MAX_SERVO_RULES];
+    servoMixerRuleList_t list;
+    rateLimitFilter_t filters[MAX_SERVO_RULES];
+    int16_t input[INPUT_SOURCE_COUNT] = { 0 };
+    int16_t output[MAX_SUPPORTED_SERVOS] = { 0 };
+
+    memset(rules, 0, sizeof(rules));
+    rules[0] = (servoMixer_t){ 2, INPUT_SOURCE_COUNT, 100, 0, -1 };
+    rules[1] = (servoMixer_t){ MAX_SUPPORTED_SERVOS, INPUT_STABILIZED_ROLL, 100, 0, -1 };
+    rules[2] = (servoMixer_t){ 3, INPUT_STABILIZED_ROLL, 50, 0, -1 };
+
+    servoMixerRulesCompile(&list, rules);
+
+    // Still counted as configured servos, as before
+    EXPECT_EQ(3, list.configuredCount);
+    EXPECT_EQ(MAX_SUPPORTED_SERVOS, list.maxTarget);
+    EXPECT_EQ(1, list.ruleCount);
+
+    input[INPUT_STABILIZED_ROLL] = 200;
+    memset(filters, 0, sizeof(filters));
+    servoMixerRulesApply(&list, input, filters, MIXER_DT, output);
+    EXPECT_EQ(100, output[3]);
+}
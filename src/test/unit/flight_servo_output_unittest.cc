@@ -0,0 +1,205 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cmath>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/filter.h"
+
+    #include "flight/servo_output.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define LOOPTIME_US     1000
+#define SERVO_MIN       1000
+#define SERVO_MAX       2000
+
+static int16_t servoInput(int loop)
+{
+    return 1500 + (int16_t)(400 * sin(loop * 0.013) + 150 * sin(loop * 0.31));
+}
+
+static int16_t constrainServo(int16_t value)
+{
+    return value < SERVO_MIN ? SERVO_MIN : (value > SERVO_MAX ? SERVO_MAX : value);
+}
+
+// filterServos() before the output stages: a biquad at the loop rate and
+// the travel limits, on every loop
+TEST(ServoOutputTest, EveryLoopMatchesLoopRateFilter)
+{
+    servoOutputStage_t stage;
+    biquadFilter_t reference;
+
+    servoOutputStageInit(&stage, 3, LOOPTIME_US, 0, 20, 0, 1500);
+    biquadFilterInitLPF(&reference, 20, LOOPTIME_US);
+    biquadFilterReset(&reference, 1500);
+
+    EXPECT_EQ(1, stage.divider);
+
+    for (int loop = 0; loop < 2000; loop++) {
+        const int16_t input = servoInput(loop);
+        const int16_t expected = constrainServo((int16_t)lrintf(biquadFilterApply(&reference, input)));
+
+        ASSERT_TRUE(servoOutputStageUpdate(&stage, input, SERVO_MIN, SERVO_MAX)) << "loop " << loop;
+        ASSERT_EQ(expected, stage.output) << "loop " << loop;
+    }
+}
+
+TEST(ServoOutputTest, DecimatedOutputsMatchFilterAtServoRate)
+{
+    servoOutputStage_t stage;
+    biquadFilter_t reference;
+
+    // 50Hz servo on a 1kHz loop is updated on one loop out of 20, and
+    // filtered as if sampled at 50Hz
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 50, 10, 0, 1500);
+    biquadFilterInitLPF(&reference, 10, 20 * LOOPTIME_US);
+    biquadFilterReset(&reference, 1500);
+
+    EXPECT_EQ(20, stage.divider);
+
+    int16_t written = 1500;
+    int updates = 0;
+    for (int loop = 0; loop < 2000; loop++) {
+        const int16_t input = servoInput(loop);
+        const bool due = servoOutputStageUpdate(&stage, input, SERVO_MIN, SERVO_MAX);
+
+        ASSERT_EQ(loop % 20 == 0, due) << "loop " << loop;
+        if (due) {
+            written = constrainServo((int16_t)lrintf(biquadFilterApply(&reference, input)));
+            updates++;
+        }
+        // Held between updates
+        ASSERT_EQ(written, stage.output) << "loop " << loop;
+    }
+    EXPECT_EQ(100, updates);
+}
+
+TEST(ServoOutputTest, DividerNeverSlowerThanRequested)
+{
+    servoOutputStage_t stage;
+
+    // 333Hz from 1kHz: every 3rd loop, 333.3Hz
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 333, 0, 0, 1500);
+    EXPECT_EQ(3, stage.divider);
+
+    // 400Hz from 1kHz: every 2nd loop, 500Hz
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 400, 0, 0, 1500);
+    EXPECT_EQ(2, stage.divider);
+
+    // Faster than the loop
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 1000, 0, 0, 1500);
+    EXPECT_EQ(1, stage.divider);
+
+    // Slower than the divider can go
+    servoOutputStageInit(&stage, 0, 125, 1, 0, 0, 1500);
+    EXPECT_EQ(SERVO_OUTPUT_MAX_DIVIDER, stage.divider);
+}
+
+TEST(ServoOutputTest, PhaseSpreadsServosOverLoops)
+{
+    servoOutputStage_t stage[8];
+
+    for (int i = 0; i < 8; i++) {
+        servoOutputStageInit(&stage[i], i, LOOPTIME_US, 250, 20, 0, 1500);
+    }
+
+    // 250Hz is every 4th loop, so two servos are due on every loop
+    for (int loop = 0; loop < 400; loop++) {
+        int due = 0;
+        for (int i = 0; i < 8; i++) {
+            if (servoOutputStageUpdate(&stage[i], servoInput(loop), SERVO_MIN, SERVO_MAX)) {
+                EXPECT_EQ(i % 4, loop % 4) << "servo " << i << " loop " << loop;
+                due++;
+            }
+        }
+        ASSERT_EQ(2, due) << "loop " << loop;
+    }
+}
+
+TEST(ServoOutputTest, SlewLimit)
+{
+    servoOutputStage_t stage;
+
+    // 2000us/s at 100Hz is 20us per update
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 100, 0, 2000, 1000);
+    EXPECT_EQ(20, stage.slewPerUpdate);
+
+    int16_t last = 1000;
+    for (int loop = 0; loop < 1000; loop++) {
+        if (servoOutputStageUpdate(&stage, 2000, SERVO_MIN, SERVO_MAX)) {
+            ASSERT_EQ(last + 20 < 2000 ? last + 20 : 2000, stage.output) << "loop " << loop;
+            last = stage.output;
+        }
+    }
+    // Half a second for the full sweep
+    EXPECT_EQ(2000, stage.output);
+
+    // Small steps aren't limited
+    servoOutputStageUpdate(&stage, 1990, SERVO_MIN, SERVO_MAX);
+    EXPECT_EQ(1990, stage.output);
+}
+
+TEST(ServoOutputTest, SlewLimitIsAtLeastOneStep)
+{
+    servoOutputStage_t stage;
+
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 0, 0, 1, 1500);
+    EXPECT_EQ(1, stage.slewPerUpdate);
+}
+
+TEST(ServoOutputTest, CutoffKeptBelowNyquist)
+{
+    servoOutputStage_t stage;
+    biquadFilter_t reference;
+
+    // 100Hz cutoff asked for a 50Hz servo: filtered at 24Hz
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 50, 100, 0, 1500);
+    biquadFilterInitLPF(&reference, 24, 20 * LOOPTIME_US);
+    biquadFilterReset(&reference, 1500);
+
+    for (int loop = 0; loop < 200; loop++) {
+        const int16_t input = servoInput(loop * 20);
+        ASSERT_TRUE(servoOutputStageUpdate(&stage, input, SERVO_MIN, SERVO_MAX));
+        ASSERT_EQ(constrainServo((int16_t)lrintf(biquadFilterApply(&reference, input))), stage.output);
+        for (int skip = 1; skip < 20; skip++) {
+            ASSERT_FALSE(servoOutputStageUpdate(&stage, input, SERVO_MIN, SERVO_MAX));
+        }
+    }
+}
+
+TEST(ServoOutputTest, UnfilteredIsConstrained)
+{
+    servoOutputStage_t stage;
+
+    servoOutputStageInit(&stage, 0, LOOPTIME_US, 0, 0, 0, 1500);
+
+    servoOutputStageUpdate(&stage, 2300, SERVO_MIN, SERVO_MAX);
+    EXPECT_EQ(SERVO_MAX, stage.output);
+    servoOutputStageUpdate(&stage, 700, SERVO_MIN, SERVO_MAX);
+    EXPECT_EQ(SERVO_MIN, stage.output);
+    servoOutputStageUpdate(&stage, 1234, SERVO_MIN, SERVO_MAX);
+    EXPECT_EQ(1234, stage.output);
+}
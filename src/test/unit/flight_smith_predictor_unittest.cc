@@ -0,0 +1,252 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/filter.h"
+
+    #include "flight/smith_predictor.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define PLANT_DELAY_MS      2.7f
+#define PREDICTOR_STRENGTH  0.5f
+#define PREDICTOR_LPF_HZ    50
+#define TEST_FREQUENCY_HZ   15.0
+
+// applySmithPredictor() before the axes shared one delay line: a delay of
+// a whole number of loops, rounded down
+typedef struct {
+    bool enabled;
+    uint8_t samples;
+    uint8_t idx;
+    float data[MAX_SMITH_SAMPLES + 1];
+    pt1Filter_t filter;
+    float strength;
+} referencePredictor_t;
+
+static void referenceInit(referencePredictor_t *predictor, float delay, float strength, uint16_t filterLpfHz, uint32_t looptime)
+{
+    memset(predictor, 0, sizeof(*predictor));
+    predictor->enabled = delay > 0.1f;
+    predictor->samples = (delay * 1000) / looptime;
+    predictor->strength = strength;
+    pt1FilterInit(&predictor->filter, filterLpfHz, looptime * 1e-6f);
+}
+
+static float referenceApply(referencePredictor_t *predictor, float sample)
+{
+    if (predictor->enabled) {
+        predictor->data[predictor->idx] = sample;
+
+        predictor->idx++;
+        if (predictor->idx > predictor->samples) {
+            predictor->idx = 0;
+        }
+
+        float delayed = pt1FilterApply(&predictor->filter, predictor->data[predictor->idx]);
+        sample += predictor->strength * (sample - delayed);
+    }
+    return sample;
+}
+
+// Synthetic plant: the craft turns at sin(wt) and the gyro sees it
+// PLANT_DELAY_MS later, motor response and filtering lumped together. The
+// phase lag of the predicted rate behind the real one is measured by
+// correlating it with sin and cos over whole periods.
+typedef struct {
+    double sinSum;
+    double cosSum;
+} phaseMeter_t;
+
+static double plantRate(double t)
+{
+    return 200.0 * sin(2 * M_PI * TEST_FREQUENCY_HZ * t);
+}
+
+static double plantGyro(double t)
+{
+    return plantRate(t - PLANT_DELAY_MS * 1e-3);
+}
+
+static void phaseMeterAdd(phaseMeter_t *meter, double t, double value)
+{
+    meter->sinSum += value * sin(2 * M_PI * TEST_FREQUENCY_HZ * t);
+    meter->cosSum += value * cos(2 * M_PI * TEST_FREQUENCY_HZ * t);
+}
+
+// Degrees, positive when behind
+static double phaseMeterLag(const phaseMeter_t *meter)
+{
+    return -atan2(meter->cosSum, meter->sinSum) * 180.0 / M_PI;
+}
+
+typedef struct {
+    double gyroLag;
+    double referenceLag;
+    double fractionalLag;
+} lagResult_t;
+
+static lagResult_t measureLag(uint32_t looptime, float delay)
+{
+    smithPredictor_t predictor;
+    referencePredictor_t reference[XYZ_AXIS_COUNT];
+    phaseMeter_t gyroMeter = { 0, 0 };
+    phaseMeter_t referenceMeter = { 0, 0 };
+    phaseMeter_t fractionalMeter = { 0, 0 };
+
+    smithPredictorInit(&predictor, delay, PREDICTOR_STRENGTH, PREDICTOR_LPF_HZ, looptime);
+    for (int axis = 0; axis < XYZ_AXIS_COUNT; axis++) {
+        referenceInit(&reference[axis], delay, PREDICTOR_STRENGTH, PREDICTOR_LPF_HZ, looptime);
+    }
+
+    // Settle for half a second, then measure over 15 whole periods
+    const int settleLoops = 500000 / looptime;
+    const int measureLoops = 1000000 / looptime;
+
+    for (int loop = 0; loop < settleLoops + measureLoops; loop++) {
+        const double t = loop * looptime * 1e-6;
+        const float gyro = plantGyro(t);
+
+        // Same signal on every axis, with the sign of pitch flipped
+        float samples[XYZ_AXIS_COUNT] = { gyro, -gyro, gyro };
+        applySmithPredictor(&predictor, samples);
+
+        float referenceSamples[XYZ_AXIS_COUNT];
+        referenceSamples[X] = referenceApply(&reference[X], gyro);
+        referenceSamples[Y] = referenceApply(&reference[Y], -gyro);
+        referenceSamples[Z] = referenceApply(&reference[Z], gyro);
+
+        EXPECT_FLOAT_EQ(samples[X], -samples[Y]);
+        EXPECT_FLOAT_EQ(samples[X], samples[Z]);
+        EXPECT_FLOAT_EQ(referenceSamples[X], -referenceSamples[Y]);
+
+        if (loop >= settleLoops) {
+            phaseMeterAdd(&gyroMeter, t, gyro);
+            phaseMeterAdd(&referenceMeter, t, referenceSamples[X]);
+            phaseMeterAdd(&fractionalMeter, t, samples[X]);
+        }
+    }
+
+    return (lagResult_t){ phaseMeterLag(&gyroMeter), phaseMeterLag(&referenceMeter), phaseMeterLag(&fractionalMeter) };
+}
+
+class SmithPredictorLagTest : public ::testing::TestWithParam<uint32_t> {};
+
+TEST_P(SmithPredictorLagTest, LessLagThanWholeLoopDelay)
+{
+    const uint32_t looptime = GetParam();
+    const lagResult_t lag = measureLag(looptime, PLANT_DELAY_MS);
+
+    // 2.7ms at 15Hz
+    EXPECT_NEAR(14.58, lag.gyroLag, 0.05);
+
+    EXPECT_LT(lag.referenceLag, lag.gyroLag);
+    EXPECT_LT(lag.fractionalLag, lag.referenceLag - 0.05) << "looptime " << looptime;
+}
+
+INSTANTIATE_TEST_CASE_P(LoopRates, SmithPredictorLagTest, ::testing::Values(1000, 500, 250, 125));
+
+TEST(SmithPredictorTest, WholeLoopDelayMatchesReference)
+{
+    // 2ms at 1kHz and 8ms at 8kHz are whole numbers of loops
+    const uint32_t looptimes[] = { 1000, 125 };
+    const float delays[] = { 2.0f, 8.0f };
+
+    for (int i = 0; i < 2; i++) {
+        smithPredictor_t predictor;
+        referencePredictor_t reference;
+
+        smithPredictorInit(&predictor, delays[i], PREDICTOR_STRENGTH, PREDICTOR_LPF_HZ, looptimes[i]);
+        referenceInit(&reference, delays[i], PREDICTOR_STRENGTH, PREDICTOR_LPF_HZ, looptimes[i]);
+
+        for (int loop = 0; loop < 2000; loop++) {
+            const float gyro = plantGyro(loop * looptimes[i] * 1e-6) + (loop % 7) * 3.0f;
+            float samples[XYZ_AXIS_COUNT] = { gyro, gyro, gyro };
+
+            applySmithPredictor(&predictor, samples);
+            ASSERT_FLOAT_EQ(referenceApply(&reference, gyro), samples[X]) << "looptime " << looptimes[i] << " loop " << loop;
+        }
+    }
+}
+
+TEST(SmithPredictorTest, InterpolatesBetweenLoops)
+{
+    smithPredictor_t predictor;
+
+    // With a ramp, the delayed sample is the ramp 2.25 loops ago, and the
+    // output is sample + strength * (sample - pt1(delayed))
+    smithPredictorInit(&predictor, 2.25f, 1.0f, 100, 1000);
+    EXPECT_EQ(2, predictor.delayTaps);
+    EXPECT_FLOAT_EQ(0.25f, predictor.delayFraction);
+
+    pt1Filter_t filter;
+    pt1FilterInit(&filter, 100, 1e-3f);
+
+    for (int loop = 0; loop < 100; loop++) {
+        float samples[XYZ_AXIS_COUNT] = { (float)loop, 2.0f * loop, -3.0f * loop };
+        applySmithPredictor(&predictor, samples);
+
+        const float delayed = loop >= 3 ? loop - 2.25f : 0.0f;
+        const float expected = loop + (loop - pt1FilterApply(&filter, delayed));
+        if (loop >= 3) {
+            ASSERT_NEAR(expected, samples[X], 1e-3f) << "loop " << loop;
+            ASSERT_NEAR(2 * expected, samples[Y], 2e-3f) << "loop " << loop;
+            ASSERT_NEAR(-3 * expected, samples[Z], 3e-3f) << "loop " << loop;
+        }
+    }
+}
+
+TEST(SmithPredictorTest, DelayChangedOnTheFly)
+{
+    smithPredictor_t predictor;
+
+    smithPredictorInit(&predictor, 0, PREDICTOR_STRENGTH, PREDICTOR_LPF_HZ, 250);
+    EXPECT_FALSE(predictor.enabled);
+
+    float samples[XYZ_AXIS_COUNT] = { 10.0f, 20.0f, 30.0f };
+    applySmithPredictor(&predictor, samples);
+    EXPECT_EQ(10.0f, samples[X]);
+
+    smithPredictorSetDelay(&predictor, 3.3f);
+    EXPECT_TRUE(predictor.enabled);
+    EXPECT_EQ(13, predictor.delayTaps);
+    EXPECT_NEAR(0.2f, predictor.delayFraction, 1e-4f);
+
+    // Longer than the buffer: both samples stay inside it
+    smithPredictorSetDelay(&predictor, 50.0f);
+    EXPECT_EQ(MAX_SMITH_SAMPLES - 1, predictor.delayTaps);
+    EXPECT_FLOAT_EQ(1.0f, predictor.delayFraction);
+    for (int loop = 0; loop < 3 * MAX_SMITH_SAMPLES; loop++) {
+        float ramp[XYZ_AXIS_COUNT] = { (float)loop, (float)loop, (float)loop };
+        applySmithPredictor(&predictor, ramp);
+        ASSERT_TRUE(std::isfinite(ramp[X]));
+    }
+
+    smithPredictorSetDelay(&predictor, 0.05f);
+    EXPECT_FALSE(predictor.enabled);
+}
@@ -0,0 +1,651 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/crc.h"
+    #include "common/time.h"
+
+    #include "drivers/io.h"
+    #include "drivers/serial.h"
+    #include "drivers/time.h"
+
+    #include "io/serial_4way.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * Simulated ESC pin: the FC bit-bangs it against a simulated clock and a
+ * BLHeli bootloader on the other end decodes the bits at its own clock and
+ * answers on the same pin. Every clock read and pin read moves the clock by
+ * a quarter of a microsecond. The host has queued all of its requests, so
+ * the time measured is the FC and the ESC link only, not USB round trips.
+ */
+
+#define SIM_US_TICKS            168
+#define SIM_POLL_CYCLES         (SIM_US_TICKS / 4)
+#define ESC_BIT_RATE            19200
+#define ESC_TURNAROUND_US       50
+// EFM8 flash timing, typical
+#define ESC_PAGE_ERASE_US       5200
+#define ESC_BYTE_WRITE_US       20
+#define ESC_PAGE_SIZE           512
+#define ESC_FLASH_SIZE          0x4000
+
+#define HOST_ESCAPE             0x2F
+#define FC_ESCAPE               0x2E
+#define CMD_INTERFACE_EXIT      0x34
+#define CMD_DEVICE_INIT_FLASH   0x37
+#define CMD_DEVICE_PAGE_ERASE   0x39
+#define CMD_DEVICE_READ         0x3A
+#define CMD_DEVICE_WRITE        0x3B
+#define ACK_OK                  0x00
+#define ACK_I_INVALID_CRC       0x03
+
+#define BL_SUCCESS              0x30
+#define BL_ERROR_COMMAND        0xC1
+#define BL_ERROR_CRC            0xC2
+
+static uint64_t simCycles;
+static bool fcOutput;
+static bool fcLevel;
+
+// Bootloader end of the pin
+class SimEsc {
+public:
+    void reset(double clockError)
+    {
+        bitCycles = (double)SIM_US_TICKS * 1000000 / (ESC_BIT_RATE * (1 + clockError));
+        connected = false;
+        rxBusy = false;
+        lineHistory.clear();
+        received.clear();
+        txBytes.clear();
+        memset(flash, 0xFF, sizeof(flash));
+        commandBytes = 0;
+    }
+
+    // Pin level as the bootloader sees it changed
+    void lineChanged(bool level)
+    {
+        advance();
+        lineHistory.push_back({ simCycles, level });
+        if (!level && !rxBusy) {
+            rxBusy = true;
+            rxStart = simCycles;
+        }
+    }
+
+    // Finish a byte once its stop bit has been sampled
+    void advance(void)
+    {
+        if (!rxBusy || simCycles < rxStart + 9.5 * bitCycles) {
+            return;
+        }
+        uint16_t bits = 0;
+        for (int bit = 0; bit < 10; bit++) {
+            if (levelAt(rxStart + (bit + 0.5) * bitCycles)) {
+                bits |= 1 << bit;
+            }
+        }
+        rxBusy = false;
+        const bool level = lineHistory.back().level;
+        lineHistory.clear();
+        lineHistory.push_back({ simCycles, level });
+        if (!(bits & 1) && (bits & (1 << 9))) {
+            receive(bits >> 1);
+        }
+    }
+
+    bool txLevel(void) const
+    {
+        if (txBytes.empty() || simCycles < txStart) {
+            return true;
+        }
+        const uint64_t bitIndex = (simCycles - txStart) / bitCycles;
+        if (bitIndex >= txBytes.size() * 10) {
+            return true;
+        }
+        const int bit = bitIndex % 10;
+        if (bit == 0) {
+            return false;
+        }
+        if (bit == 9) {
+            return true;
+        }
+        return (txBytes[bitIndex / 10] >> (bit - 1)) & 1;
+    }
+
+    uint8_t flash[ESC_FLASH_SIZE];
+    uint32_t commandBytes;
+
+private:
+    struct lineLevel_t {
+        uint64_t at;
+        bool level;
+    };
+
+    bool levelAt(double at) const
+    {
+        bool level = true;
+        for (const lineLevel_t &entry : lineHistory) {
+            if (entry.at > at) {
+                break;
+            }
+            level = entry.level;
+        }
+        return level;
+    }
+
+    static uint16_t crc(const uint8_t *data, int len)
+    {
+        uint16_t crc = 0;
+        for (int i = 0; i < len; i++) {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; bit++) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+            }
+        }
+        return crc;
+    }
+
+    void respond(std::vector<uint8_t> bytes, uint32_t processingUs)
+    {
+        txBytes = bytes;
+        txStart = simCycles + (uint64_t)(ESC_TURNAROUND_US + processingUs) * SIM_US_TICKS;
+    }
+
+    void receive(uint8_t c)
+    {
+        received.push_back(c);
+
+        if (!connected) {
+            static const uint8_t bootInit[] = { 0x0D, 'B', 'L', 'H', 'e', 'l', 'i', 0xF4, 0x7D };
+            if (received.size() >= sizeof(bootInit) &&
+                    memcmp(&received[received.size() - sizeof(bootInit)], bootInit, sizeof(bootInit)) == 0) {
+                // "471", signature 0xF310, version and pages, no CRC yet
+                respond({ '4', '7', '1', 'c', 0xF3, 0x10, 0x06, 0x20, BL_SUCCESS }, 0);
+                connected = true;
+                received.clear();
+                bufferLen = 0;
+            }
+            return;
+        }
+
+        commandBytes++;
+        const int commandLen = (received[0] == 0xFF || received[0] == 0xFE) ? 4 : 2;
+        const int expected = bufferLen ? bufferLen + 2 : commandLen + 2;
+        if ((int)received.size() < expected) {
+            return;
+        }
+        std::vector<uint8_t> frame = received;
+        received.clear();
+
+        if (crc(frame.data(), expected - 2) != (frame[expected - 2] | (frame[expected - 1] << 8))) {
+            bufferLen = 0;
+            respond({ BL_ERROR_CRC }, 0);
+            return;
+        }
+
+        if (bufferLen) {
+            buffer.assign(frame.begin(), frame.begin() + bufferLen);
+            bufferLen = 0;
+            respond({ BL_SUCCESS }, 0);
+            return;
+        }
+
+        switch (frame[0]) {
+        case 0xFF:
+            address = (frame[2] << 8) | frame[3];
+            respond({ BL_SUCCESS }, 0);
+            break;
+        case 0xFE:
+            // Silent until the data has been received
+            bufferLen = (frame[2] << 8) | frame[3];
+            break;
+        case 0x01:
+            for (size_t i = 0; i < buffer.size(); i++) {
+                flash[(address + i) % ESC_FLASH_SIZE] &= buffer[i];
+            }
+            respond({ BL_SUCCESS }, buffer.size() * ESC_BYTE_WRITE_US);
+            break;
+        case 0x02:
+            memset(&flash[address & ~(ESC_PAGE_SIZE - 1) & (ESC_FLASH_SIZE - 1)], 0xFF, ESC_PAGE_SIZE);
+            respond({ BL_SUCCESS }, ESC_PAGE_ERASE_US);
+            break;
+        case 0x03:
+        {
+            const int len = frame[1] ? frame[1] : 256;
+            std::vector<uint8_t> out(&flash[address % ESC_FLASH_SIZE], &flash[address % ESC_FLASH_SIZE] + len);
+            const uint16_t outCrc = crc(out.data(), len);
+            out.push_back(outCrc & 0xFF);
+            out.push_back(outCrc >> 8);
+            out.push_back(BL_SUCCESS);
+            respond(out, 0);
+            break;
+        }
+        case 0x00:
+            connected = false;
+            break;
+        default:
+            respond({ BL_ERROR_COMMAND }, 0);
+            break;
+        }
+    }
+
+    double bitCycles;
+    bool connected;
+    bool rxBusy;
+    uint64_t rxStart;
+    std::vector<lineLevel_t> lineHistory;
+    std::vector<uint8_t> received;
+    int bufferLen;
+    std::vector<uint8_t> buffer;
+    uint16_t address;
+    std::vector<uint8_t> txBytes;
+    uint64_t txStart;
+};
+
+static SimEsc esc;
+
+static void simAdvance(uint32_t cycles)
+{
+    simCycles += cycles;
+    esc.advance();
+}
+
+static void fcLineUpdate(void)
+{
+    const bool level = fcOutput ? fcLevel : true;
+    static bool lastLevel = true;
+    if (level != lastLevel) {
+        lastLevel = level;
+        esc.lineChanged(level);
+    }
+}
+
+// Host side of the passthrough
+typedef struct {
+    uint8_t command;
+    uint8_t ack;
+    std::vector<uint8_t> params;
+    uint64_t atCycles;
+} response_t;
+
+static std::deque<uint8_t> fromHost;
+static size_t hostChunk;
+static std::vector<uint8_t> toHost;
+static std::vector<uint64_t> toHostAt;
+static serialPort_t hostPort;
+
+static uint16_t xmodemCrc(const uint8_t *data, int len)
+{
+    uint16_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static void hostSend(uint8_t command, uint16_t address, const std::vector<uint8_t> &params)
+{
+    std::vector<uint8_t> frame = { HOST_ESCAPE, command, (uint8_t)(address >> 8), (uint8_t)address, (uint8_t)params.size() };
+    frame.insert(frame.end(), params.begin(), params.end());
+    const uint16_t crc = xmodemCrc(frame.data(), frame.size());
+    frame.push_back(crc >> 8);
+    frame.push_back(crc & 0xFF);
+    fromHost.insert(fromHost.end(), frame.begin(), frame.end());
+}
+
+static std::vector<response_t> hostResponses(void)
+{
+    std::vector<response_t> responses;
+    size_t i = 0;
+    while (i + 8 <= toHost.size()) {
+        EXPECT_EQ(FC_ESCAPE, toHost[i]);
+        const size_t len = toHost[i + 4] ? toHost[i + 4] : 256;
+        const size_t frameLen = 5 + len + 1;
+        const uint16_t crc = (toHost[i + frameLen] << 8) | toHost[i + frameLen + 1];
+        EXPECT_EQ(xmodemCrc(&toHost[i], frameLen), crc);
+
+        response_t response;
+        response.command = toHost[i + 1];
+        response.params.assign(&toHost[i + 5], &toHost[i + 5 + len]);
+        response.ack = toHost[i + 5 + len];
+        response.atCycles = toHostAt[i + frameLen + 1];
+        responses.push_back(response);
+        i += frameLen + 2;
+    }
+    EXPECT_EQ(toHost.size(), i);
+    return responses;
+}
+
+extern "C" {
+    uint32_t usTicks = SIM_US_TICKS;
+
+    uint32_t ticks(void)
+    {
+        simAdvance(SIM_POLL_CYCLES);
+        return (uint32_t)simCycles;
+    }
+
+    timeUs_t micros(void)
+    {
+        simAdvance(SIM_POLL_CYCLES);
+        return simCycles / SIM_US_TICKS;
+    }
+
+    timeMs_t millis(void)
+    {
+        simAdvance(SIM_POLL_CYCLES);
+        return simCycles / (SIM_US_TICKS * 1000);
+    }
+
+    void delayMicroseconds(timeUs_t us)
+    {
+        simCycles += (uint64_t)us * SIM_US_TICKS;
+        esc.advance();
+    }
+
+    bool IORead(IO_t io)
+    {
+        UNUSED(io);
+        simAdvance(SIM_POLL_CYCLES);
+        return fcOutput ? fcLevel : esc.txLevel();
+    }
+
+    void IOHi(IO_t io)
+    {
+        UNUSED(io);
+        fcLevel = true;
+        fcLineUpdate();
+    }
+
+    void IOLo(IO_t io)
+    {
+        UNUSED(io);
+        fcLevel = false;
+        fcLineUpdate();
+    }
+
+    void IOConfigGPIO(IO_t io, ioConfig_t cfg)
+    {
+        UNUSED(io);
+        fcOutput = (cfg == IOCFG_OUT_PP);
+        fcLineUpdate();
+    }
+
+    IO_t IOGetByTag(ioTag_t tag)
+    {
+        return (IO_t)(uintptr_t)tag;
+    }
+
+    ioTag_t pwmGetMotorPinTag(int motorIndex)
+    {
+        return motorIndex + 1;
+    }
+
+    uint8_t getMotorCount(void)
+    {
+        return 1;
+    }
+
+    void pwmDisableMotors(void) {}
+    void pwmEnableMotors(void) {}
+    void beeperSilence(void) {}
+
+    uint32_t serialRxBytesWaiting(const serialPort_t *instance)
+    {
+        UNUSED(instance);
+        if (fromHost.empty()) {
+            // Nothing more is coming, don't spin forever
+            ADD_FAILURE() << "passthrough waiting for the host";
+            hostSend(CMD_INTERFACE_EXIT, 0, { 0 });
+        }
+        return std::min(fromHost.size(), hostChunk);
+    }
+
+    uint8_t serialRead(serialPort_t *instance)
+    {
+        UNUSED(instance);
+        const uint8_t c = fromHost.front();
+        fromHost.pop_front();
+        return c;
+    }
+
+    void serialWrite(serialPort_t *instance, uint8_t ch)
+    {
+        UNUSED(instance);
+        toHost.push_back(ch);
+        toHostAt.push_back(simCycles);
+    }
+
+    void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+    {
+        while (count--) {
+            serialWrite(instance, *data++);
+        }
+    }
+
+    uint32_t serialTxBytesFree(const serialPort_t *instance)
+    {
+        UNUSED(instance);
+        return 256;
+    }
+
+    void serialBeginWrite(serialPort_t *instance) { UNUSED(instance); }
+    void serialEndWrite(serialPort_t *instance) { UNUSED(instance); }
+}
+
+class Serial4wayTest : public ::testing::Test {
+protected:
+    virtual void SetUp()
+    {
+        // Close to the cycle counter wrapping, the transfers run across it
+        simCycles = UINT32_MAX - (uint64_t)SIM_US_TICKS * 1000000;
+        fcOutput = false;
+        fcLevel = true;
+        esc.reset(0);
+        fromHost.clear();
+        hostChunk = SIZE_MAX;
+        toHost.clear();
+        toHostAt.clear();
+
+        image.resize(ESC_FLASH_SIZE);
+        for (size_t i = 0; i < image.size(); i++) {
+            image[i] = (i * 7 + (i >> 8) * 13) & 0xFF;
+        }
+    }
+
+    void run(void)
+    {
+        hostSend(CMD_INTERFACE_EXIT, 0, { 0 });
+        ASSERT_EQ(1, esc4wayInit());
+        esc4wayProcess(&hostPort);
+        EXPECT_TRUE(fromHost.empty());
+    }
+
+    void connect(void)
+    {
+        hostSend(CMD_DEVICE_INIT_FLASH, 0, { 0 });
+    }
+
+    void writeImage(void)
+    {
+        for (uint32_t page = 0; page < ESC_FLASH_SIZE / ESC_PAGE_SIZE; page++) {
+            hostSend(CMD_DEVICE_PAGE_ERASE, 0, { (uint8_t)page });
+            for (uint32_t address = page * ESC_PAGE_SIZE; address < (page + 1) * ESC_PAGE_SIZE; address += 256) {
+                hostSend(CMD_DEVICE_WRITE, address, std::vector<uint8_t>(&image[address], &image[address] + 256));
+            }
+        }
+    }
+
+    void readImage(void)
+    {
+        for (uint32_t address = 0; address < ESC_FLASH_SIZE; address += 256) {
+            hostSend(CMD_DEVICE_READ, address, { 0 });
+        }
+    }
+
+    // Bytes per second from the connect response to the last transfer
+    static double throughput(const std::vector<response_t> &responses)
+    {
+        const double seconds = (double)(responses[responses.size() - 2].atCycles - responses[0].atCycles) / (SIM_US_TICKS * 1e6);
+        return ESC_FLASH_SIZE / seconds;
+    }
+
+    // The bytes that have to go over the 19200 baud link for 256 bytes,
+    // 10 bits each: set address and command with CRC out, ACKs back
+    static double lineLimit(int bytesPer256)
+    {
+        return 256.0 * ESC_BIT_RATE / (bytesPer256 * 10);
+    }
+
+    std::vector<uint8_t> image;
+};
+
+TEST_F(Serial4wayTest, Crc16CcittMatchesBitwise)
+{
+    for (int len = 0; len < 300; len += 7) {
+        std::vector<uint8_t> data(len);
+        for (int i = 0; i < len; i++) {
+            data[i] = (i * 31 + len) & 0xFF;
+        }
+        EXPECT_EQ(xmodemCrc(data.data(), len), crc16_ccitt_update(0, data.data(), len));
+    }
+    EXPECT_EQ(0x31C3, crc16_ccitt_update(0, "123456789", 9));
+}
+
+TEST_F(Serial4wayTest, Connects)
+{
+    connect();
+    run();
+
+    const std::vector<response_t> responses = hostResponses();
+    ASSERT_EQ(2, responses.size());
+    EXPECT_EQ(CMD_DEVICE_INIT_FLASH, responses[0].command);
+    EXPECT_EQ(ACK_OK, responses[0].ack);
+    const std::vector<uint8_t> deviceInfo = { 0x10, 0xF3, 'c', 1 };
+    EXPECT_EQ(deviceInfo, responses[0].params);
+    EXPECT_EQ(CMD_INTERFACE_EXIT, responses[1].command);
+}
+
+TEST_F(Serial4wayTest, WriteFullImage)
+{
+    connect();
+    writeImage();
+    run();
+
+    const std::vector<response_t> responses = hostResponses();
+    ASSERT_EQ(2 + ESC_FLASH_SIZE / ESC_PAGE_SIZE + ESC_FLASH_SIZE / 256, responses.size());
+    for (const response_t &response : responses) {
+        ASSERT_EQ(ACK_OK, response.ack) << "command " << (int)response.command;
+    }
+    EXPECT_EQ(0, memcmp(image.data(), esc.flash, ESC_FLASH_SIZE));
+
+    // Set address 6, set buffer 6, data 258, program 4, three ACKs
+    const double rate = throughput(responses);
+    printf("write %u bytes: %.0f bytes/s simulated, line limit %.0f bytes/s\n", ESC_FLASH_SIZE, rate, lineLimit(277));
+    EXPECT_GT(rate, 0.85 * lineLimit(277));
+}
+
+TEST_F(Serial4wayTest, ReadFullImage)
+{
+    memcpy(esc.flash, image.data(), ESC_FLASH_SIZE);
+    connect();
+    readImage();
+    run();
+
+    const std::vector<response_t> responses = hostResponses();
+    ASSERT_EQ(2 + ESC_FLASH_SIZE / 256, responses.size());
+    std::vector<uint8_t> read;
+    for (size_t i = 1; i < responses.size() - 1; i++) {
+        ASSERT_EQ(ACK_OK, responses[i].ack);
+        ASSERT_EQ(256, responses[i].params.size());
+        read.insert(read.end(), responses[i].params.begin(), responses[i].params.end());
+    }
+    EXPECT_EQ(image, read);
+
+    // Set address 6, ACK, read command 4, data 256 with CRC and ACK
+    const double rate = throughput(responses);
+    printf("read %u bytes: %.0f bytes/s simulated, line limit %.0f bytes/s\n", ESC_FLASH_SIZE, rate, lineLimit(270));
+    EXPECT_GT(rate, 0.9 * lineLimit(270));
+}
+
+TEST_F(Serial4wayTest, EscClockOffset)
+{
+    // The bootloader runs off an RC oscillator
+    const double clockErrors[] = { -0.02, 0.02 };
+    for (double clockError : clockErrors) {
+        SetUp();
+        esc.reset(clockError);
+        connect();
+        hostSend(CMD_DEVICE_PAGE_ERASE, 0, { 0 });
+        hostSend(CMD_DEVICE_WRITE, 0, std::vector<uint8_t>(&image[0], &image[256]));
+        hostSend(CMD_DEVICE_READ, 0, { 0 });
+        run();
+
+        const std::vector<response_t> responses = hostResponses();
+        ASSERT_EQ(5, responses.size());
+        for (const response_t &response : responses) {
+            EXPECT_EQ(ACK_OK, response.ack) << "clock error " << clockError;
+        }
+        EXPECT_EQ(std::vector<uint8_t>(&image[0], &image[256]), responses[3].params);
+    }
+}
+
+TEST_F(Serial4wayTest, FrameArrivingBytewise)
+{
+    hostChunk = 1;
+    memcpy(esc.flash, image.data(), ESC_FLASH_SIZE);
+    connect();
+    hostSend(CMD_DEVICE_READ, 0x1200, { 16 });
+    run();
+
+    const std::vector<response_t> responses = hostResponses();
+    ASSERT_EQ(3, responses.size());
+    EXPECT_EQ(ACK_OK, responses[1].ack);
+    EXPECT_EQ(std::vector<uint8_t>(&image[0x1200], &image[0x1210]), responses[1].params);
+}
+
+TEST_F(Serial4wayTest, BadCrcFromHost)
+{
+    connect();
+    hostSend(CMD_DEVICE_READ, 0, { 0 });
+    fromHost[fromHost.size() - 1] ^= 0x01;
+    run();
+
+    const std::vector<response_t> responses = hostResponses();
+    ASSERT_EQ(3, responses.size());
+    EXPECT_EQ(ACK_I_INVALID_CRC, responses[1].ack);
+    // Nothing went to the ESC after connecting
+    EXPECT_EQ(0U, esc.commandBytes);
+}
@@ -0,0 +1,836 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "build/debug.h"
+
+    #include "common/crc.h"
+    #include "common/utils.h"
+
+    #include "drivers/serial.h"
+    #include "drivers/time.h"
+    #include "drivers/vtx_common.h"
+
+    #include "io/serial.h"
+    #include "io/vtx.h"
+    #include "io/vtx_control.h"
+    #include "io/vtx_smartaudio.h"
+    #include "io/vtx_string.h"
+    #include "io/vtx_tramp.h"
+
+    int32_t *debugModeValues[DEBUG_COUNT];
+    vtxConfig_t vtxConfig_System;
+    vtxSettingsConfig_t vtxSettingsConfig_System;
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+/*
+ * Simulated serial line: bytes written by the driver reach the fake VTX at
+ * the line rate, and come back to the driver as a half-duplex echo. The
+ * fake VTX answers after its processing time, at the line rate too. Time
+ * moves in 1ms steps and the driver is processed whenever it says it has
+ * something to do, or every 200ms as the VTX task did before.
+ */
+
+#define SCHEDULER_PERIOD_MS     200
+
+typedef struct {
+    double atMs;
+    uint8_t c;
+} lineByte_t;
+
+class FakeVtx {
+public:
+    virtual ~FakeVtx() {}
+    virtual void receive(uint8_t c, double atMs) = 0;
+};
+
+static uint32_t simTimeMs = 10000;
+static uint32_t lastProcessMs;
+static serialPort_t fakePort;
+static std::deque<lineByte_t> toVtx;
+static std::deque<lineByte_t> toFc;
+static double toVtxFreeAtMs;
+static double toFcFreeAtMs;
+static FakeVtx *fakeVtx;
+
+static double byteTimeMs(void)
+{
+    return 10000.0 / fakePort.baudRate;
+}
+
+// Queue bytes on a line, after what is already on it
+static void lineSend(std::deque<lineByte_t> *line, double *freeAtMs, const uint8_t *data, int len, double atMs)
+{
+    double t = atMs > *freeAtMs ? atMs : *freeAtMs;
+    for (int i = 0; i < len; i++) {
+        t += byteTimeMs();
+        line->push_back({ t, data[i] });
+    }
+    *freeAtMs = t;
+}
+
+static void fakeVtxRespond(const uint8_t *data, int len, double atMs)
+{
+    lineSend(&toFc, &toFcFreeAtMs, data, len, atMs);
+}
+
+static void simReset(FakeVtx *vtx)
+{
+    toVtx.clear();
+    toFc.clear();
+    toVtxFreeAtMs = simTimeMs;
+    toFcFreeAtMs = simTimeMs;
+    fakeVtx = vtx;
+}
+
+static void simTick(void)
+{
+    simTimeMs++;
+
+    while (!toVtx.empty() && toVtx.front().atMs <= simTimeMs) {
+        fakeVtx->receive(toVtx.front().c, toVtx.front().atMs);
+        toVtx.pop_front();
+    }
+
+    vtxDevice_t *device = vtxCommonDevice();
+    if (vtxCommonIsProcessPending(device, simTimeMs * 1000) || simTimeMs - lastProcessMs >= SCHEDULER_PERIOD_MS) {
+        lastProcessMs = simTimeMs;
+        vtxCommonProcess(device, simTimeMs * 1000);
+    }
+}
+
+// Milliseconds until done() holds, or UINT32_MAX
+static uint32_t simRunUntil(std::function<bool()> done, uint32_t limitMs)
+{
+    const uint32_t startMs = simTimeMs;
+
+    while (simTimeMs - startMs < limitMs) {
+        if (done()) {
+            return simTimeMs - startMs;
+        }
+        simTick();
+    }
+    return done() ? limitMs : UINT32_MAX;
+}
+
+static void simRun(uint32_t durationMs)
+{
+    simRunUntil([]() { return false; }, durationMs);
+}
+
+extern "C" {
+    timeMs_t millis(void)
+    {
+        return simTimeMs;
+    }
+
+    timeUs_t micros(void)
+    {
+        return simTimeMs * 1000;
+    }
+
+    serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+    {
+        static serialPortConfig_t portConfig;
+
+        portConfig.identifier = SERIAL_PORT_USART1;
+        portConfig.functionMask = function;
+        return &portConfig;
+    }
+
+    serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e functionMask, serialReceiveCallbackPtr callback, void *callbackData, uint32_t baudRate, portMode_t mode, portOptions_t options)
+    {
+        UNUSED(functionMask);
+        UNUSED(callback);
+        UNUSED(callbackData);
+
+        memset(&fakePort, 0, sizeof(fakePort));
+        fakePort.identifier = identifier;
+        fakePort.baudRate = baudRate;
+        fakePort.mode = mode;
+        fakePort.options = options;
+        return &fakePort;
+    }
+
+    void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+    {
+        UNUSED(instance);
+
+        lineSend(&toVtx, &toVtxFreeAtMs, data, count, simTimeMs);
+        // Half-duplex echo
+        for (int i = count; i > 0; i--) {
+            toFc.push_back(toVtx[toVtx.size() - i]);
+        }
+    }
+
+    void serialWrite(serialPort_t *instance, uint8_t ch)
+    {
+        serialWriteBuf(instance, &ch, 1);
+    }
+
+    uint32_t serialRxBytesWaiting(const serialPort_t *instance)
+    {
+        UNUSED(instance);
+
+        uint32_t count = 0;
+        for (const lineByte_t &b : toFc) {
+            if (b.atMs > simTimeMs) {
+                break;
+            }
+            count++;
+        }
+        return count;
+    }
+
+    uint8_t serialRead(serialPort_t *instance)
+    {
+        UNUSED(instance);
+
+        const uint8_t c = toFc.front().c;
+        toFc.pop_front();
+        return c;
+    }
+
+    bool isSerialTransmitBufferEmpty(const serialPort_t *instance)
+    {
+        UNUSED(instance);
+        return toVtxFreeAtMs <= simTimeMs;
+    }
+
+    void serialSetBaudRate(serialPort_t *instance, uint32_t baudRate)
+    {
+        instance->baudRate = baudRate;
+    }
+}
+
+/*
+ * SmartAudio V2.0 device: commands are 0xAA 0x55, command << 1 | 1, length,
+ * payload and a CRC from the preamble on. It answers after 65ms, only at
+ * baud rates it can decode.
+ */
+
+#define SA_RESPONSE_DELAY_MS    65
+
+// CRC8 the driver had before it used crc8_dvb_s2_update()
+static uint8_t legacySaCrc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+
+    for (int i = 0 ; i < len ; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0xd5) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+class FakeSmartAudio : public FakeVtx {
+public:
+    uint8_t channel = 0;
+    uint8_t power = 1;
+    uint8_t mode = 0;
+    uint16_t freq = 5865;
+    uint16_t pitFreq = 5584;
+
+    uint32_t minBaud = 0;
+    uint32_t maxBaud = UINT32_MAX;
+    int dropCommands = 0;
+    int dropResponses = 0;
+    int commandsHeard = 0;
+
+    void receive(uint8_t c, double atMs) override
+    {
+        rx.push_back(c);
+
+        // Resynchronise on the preamble, skipping the 0x00 line breaks
+        while (!rx.empty() && rx[0] != 0xAA) {
+            rx.erase(rx.begin());
+        }
+        if (rx.size() < 4) {
+            return;
+        }
+        const size_t frameLen = 5 + rx[3];
+        if (rx.size() < frameLen) {
+            return;
+        }
+
+        const bool valid = rx[1] == 0x55 && legacySaCrc8(rx.data(), frameLen - 1) == rx[frameLen - 1];
+        if (valid && fakePort.baudRate >= minBaud && fakePort.baudRate <= maxBaud) {
+            if (dropCommands > 0) {
+                dropCommands--;
+            } else {
+                commandsHeard++;
+                execute(rx[2] >> 1, &rx[4], atMs);
+            }
+        }
+        rx.erase(rx.begin(), rx.begin() + (valid ? frameLen : 1));
+    }
+
+private:
+    std::vector<uint8_t> rx;
+
+    void respond(uint8_t code, std::vector<uint8_t> data, double atMs)
+    {
+        if (dropResponses > 0) {
+            dropResponses--;
+            return;
+        }
+
+        std::vector<uint8_t> frame = { 0xAA, 0x55, code, (uint8_t)data.size() };
+        frame.insert(frame.end(), data.begin(), data.end());
+        frame.push_back(legacySaCrc8(&frame[2], frame.size() - 2));
+        fakeVtxRespond(frame.data(), frame.size(), atMs + SA_RESPONSE_DELAY_MS);
+    }
+
+    void execute(uint8_t cmd, const uint8_t *payload, double atMs)
+    {
+        switch (cmd) {
+        case 0x01:
+            respond(0x09, { channel, power, mode, (uint8_t)(freq >> 8), (uint8_t)freq }, atMs);
+            break;
+        case 0x02:
+            power = payload[0];
+            respond(cmd, { power, 0x01 }, atMs);
+            break;
+        case 0x03:
+            channel = payload[0];
+            mode &= ~SA_MODE_GET_FREQ_BY_FREQ;
+            respond(cmd, { channel, 0x01 }, atMs);
+            break;
+        case 0x04: {
+            const uint16_t value = (payload[0] << 8) | payload[1];
+            uint16_t reply = value;
+            if (value & SA_FREQ_GETPIT) {
+                reply = pitFreq | SA_FREQ_GETPIT;
+            } else if (value & SA_FREQ_SETPIT) {
+                pitFreq = value & SA_FREQ_MASK;
+            } else {
+                freq = value;
+                mode |= SA_MODE_GET_FREQ_BY_FREQ;
+            }
+            respond(cmd, { (uint8_t)(reply >> 8), (uint8_t)reply, 0x01 }, atMs);
+            break;
+        }
+        case 0x05:
+            respond(cmd, { payload[0], 0x01 }, atMs);
+            break;
+        }
+    }
+};
+
+/*
+ * Tramp device: 16 byte frames of 0x0F, command, 12 bytes of payload, a sum
+ * and 0x00. Only queries are answered, after 20ms.
+ */
+
+#define TRAMP_RESPONSE_DELAY_MS     20
+
+class FakeTramp : public FakeVtx {
+public:
+    uint16_t freq = 5740;
+    uint16_t power = 25;
+    uint8_t pitMode = 0;
+
+    int dropCommands = 0;
+    int dropResponses = 0;
+    bool mute = false;
+
+    void receive(uint8_t c, double atMs) override
+    {
+        rx.push_back(c);
+
+        while (!rx.empty() && rx[0] != 0x0F) {
+            rx.erase(rx.begin());
+        }
+        if (rx.size() < 16) {
+            return;
+        }
+
+        const bool valid = rx[14] == crc8_sum_update(0, &rx[1], 13) && rx[15] == 0;
+        if (valid) {
+            if (dropCommands > 0) {
+                dropCommands--;
+            } else {
+                execute(rx[1], rx[2] | (rx[3] << 8), atMs);
+            }
+        }
+        rx.erase(rx.begin(), rx.begin() + (valid ? 16 : 1));
+    }
+
+private:
+    std::vector<uint8_t> rx;
+
+    void respond(uint8_t code, uint16_t a, uint16_t b, uint16_t c, uint8_t d, double atMs)
+    {
+        if (mute) {
+            return;
+        }
+        if (dropResponses > 0) {
+            dropResponses--;
+            return;
+        }
+
+        uint8_t frame[16] = { 0x0F, code, (uint8_t)a, (uint8_t)(a >> 8), (uint8_t)b, (uint8_t)(b >> 8), (uint8_t)c, (uint8_t)(c >> 8) };
+        frame[7] = (code == 'v') ? d : frame[7];
+        frame[14] = crc8_sum_update(0, &frame[1], 13);
+        fakeVtxRespond(frame, sizeof(frame), atMs + TRAMP_RESPONSE_DELAY_MS);
+    }
+
+    void execute(uint8_t cmd, uint16_t param, double atMs)
+    {
+        switch (cmd) {
+        case 'r':
+            respond('r', 5600, 5950, 600, 0, atMs);
+            break;
+        case 'v':
+            respond('v', freq, power, 0, pitMode, atMs);
+            break;
+        case 'F':
+            freq = param;
+            break;
+        case 'P':
+            power = param;
+            break;
+        case 's':
+            pitMode = param;
+            break;
+        }
+    }
+};
+
+//
+// Transport
+//
+
+static std::vector<uint8_t> toyFramesProcessed;
+static int toyRequestsFailed;
+
+// Toy protocol: 0x7E, command, value
+static int toyDecodeFrame(const uint8_t *buf, int len)
+{
+    if (buf[0] != 0x7E) {
+        return -1;
+    }
+    return len < 3 ? 0 : 3;
+}
+
+static bool toyIsResponse(uint8_t command, const uint8_t *frame, int len)
+{
+    UNUSED(len);
+    return frame[1] == command;
+}
+
+static void toyProcessFrame(const uint8_t *frame, int len)
+{
+    UNUSED(len);
+    toyFramesProcessed.push_back(frame[2]);
+}
+
+static void toyRequestFailed(uint8_t command)
+{
+    UNUSED(command);
+    toyRequestsFailed++;
+}
+
+static const vtxProtocol_t toyProtocol = {
+    .decodeFrame = toyDecodeFrame,
+    .isResponse = toyIsResponse,
+    .processFrame = toyProcessFrame,
+    .requestFailed = toyRequestFailed,
+    .responseTimeoutMs = 100,
+    .settleTimeMs = 30,
+    .maxRetries = 2,
+    .baudMin = 0,
+    .baudMax = 0,
+    .baudStep = 0,
+};
+
+class VtxTransportTest : public ::testing::Test {
+protected:
+    vtxTransport_t transport;
+
+    void SetUp() override
+    {
+        openSerialPort(SERIAL_PORT_USART1, FUNCTION_NONE, NULL, NULL, 115200, MODE_RXTX, SERIAL_NOT_INVERTED);
+        vtxTransportInit(&transport, &toyProtocol, &fakePort, 115200);
+        toVtx.clear();
+        toFc.clear();
+        toVtxFreeAtMs = simTimeMs;
+        toyFramesProcessed.clear();
+        toyRequestsFailed = 0;
+    }
+
+    void queue(uint8_t command, uint8_t value, uint8_t flags)
+    {
+        const uint8_t frame[3] = { 0x7E, command, value };
+        EXPECT_TRUE(vtxTransportQueue(&transport, command, frame, 3, flags));
+    }
+
+    void reply(uint8_t command, uint8_t value)
+    {
+        const uint8_t frame[3] = { 0x7E, command, value };
+        toVtx.clear();
+        toFc.clear();
+        lineSend(&toFc, &toFcFreeAtMs, frame, 3, simTimeMs);
+    }
+
+    void advance(uint32_t ms)
+    {
+        for (uint32_t i = 0; i < ms; i++) {
+            simTimeMs++;
+            vtxTransportProcess(&transport, simTimeMs);
+        }
+    }
+};
+
+TEST_F(VtxTransportTest, MatchesResponseToRequest)
+{
+    queue(1, 10, VTX_TRANSACTION_RESPONSE);
+    queue(2, 20, VTX_TRANSACTION_RESPONSE);
+
+    advance(1);
+    EXPECT_EQ(VTX_TRANSPORT_WAIT_RESPONSE, transport.state);
+    EXPECT_EQ(1, transport.stats.sent);
+
+    // Something else than the answer is processed, but doesn't complete it
+    reply(5, 55);
+    advance(5);
+    EXPECT_EQ(1, transport.stats.unexpected);
+    EXPECT_EQ(1, transport.stats.sent);
+
+    // The answer sends the next request right away
+    reply(1, 11);
+    advance(1);
+    EXPECT_EQ(2, transport.stats.sent);
+    EXPECT_EQ(std::vector<uint8_t>({ 55, 11 }), toyFramesProcessed);
+}
+
+TEST_F(VtxTransportTest, IgnoresEcho)
+{
+    queue(3, 30, VTX_TRANSACTION_RESPONSE);
+    advance(5);
+
+    // The request read back on a half-duplex line isn't its response
+    EXPECT_EQ(0, transport.stats.received);
+    EXPECT_EQ(VTX_TRANSPORT_WAIT_RESPONSE, transport.state);
+}
+
+TEST_F(VtxTransportTest, RetriesThenGivesUp)
+{
+    queue(1, 10, VTX_TRANSACTION_RESPONSE);
+
+    advance(1);
+    for (int retry = 1; retry <= 2; retry++) {
+        advance(99);
+        EXPECT_EQ(retry, transport.stats.sent);
+        advance(1);
+        EXPECT_EQ(retry + 1, transport.stats.sent);
+    }
+
+    advance(100);
+    EXPECT_EQ(3, transport.stats.sent);
+    EXPECT_EQ(2, transport.stats.retries);
+    EXPECT_EQ(1, transport.stats.lost);
+    EXPECT_EQ(1, toyRequestsFailed);
+    EXPECT_TRUE(vtxTransportIsIdle(&transport));
+}
+
+TEST_F(VtxTransportTest, PersistentRequestIsResentUntilAnswered)
+{
+    queue(1, 10, VTX_TRANSACTION_RESPONSE | VTX_TRANSACTION_PERSIST);
+    queue(2, 20, VTX_TRANSACTION_RESPONSE);
+
+    advance(1);
+    advance(10 * 100);
+    EXPECT_EQ(11, transport.stats.sent);
+    EXPECT_EQ(0, transport.stats.lost);
+    EXPECT_EQ(0, toyRequestsFailed);
+
+    reply(1, 11);
+    advance(1);
+    EXPECT_EQ(20, toVtx.back().c);
+}
+
+TEST_F(VtxTransportTest, RequestWithoutResponseHoldsLine)
+{
+    queue(1, 10, 0);
+    queue(2, 20, 0);
+
+    advance(1);
+    EXPECT_EQ(VTX_TRANSPORT_WAIT_SETTLE, transport.state);
+    advance(29);
+    EXPECT_EQ(1, transport.stats.sent);
+    advance(1);
+    EXPECT_EQ(2, transport.stats.sent);
+    advance(30);
+    EXPECT_TRUE(vtxTransportIsIdle(&transport));
+    EXPECT_FALSE(vtxTransportIsProcessPending(&transport, simTimeMs));
+}
+
+TEST_F(VtxTransportTest, ReplaceKeepsLatestUnsentRequest)
+{
+    queue(1, 10, VTX_TRANSACTION_RESPONSE);
+    advance(1);
+
+    // In flight, not replaced
+    queue(1, 11, VTX_TRANSACTION_RESPONSE | VTX_TRANSACTION_REPLACE);
+    queue(2, 20, VTX_TRANSACTION_RESPONSE | VTX_TRANSACTION_REPLACE);
+    // Replaces the queued one and goes last
+    queue(1, 12, VTX_TRANSACTION_RESPONSE | VTX_TRANSACTION_REPLACE);
+    queue(1, 12, VTX_TRANSACTION_RESPONSE | VTX_TRANSACTION_REPLACE);
+    EXPECT_EQ(3, transport.count);
+
+    reply(1, 0);
+    advance(1);
+    EXPECT_EQ(20, toVtx.back().c);
+    reply(2, 0);
+    advance(1);
+    EXPECT_EQ(12, toVtx.back().c);
+}
+
+TEST_F(VtxTransportTest, QueueFull)
+{
+    for (int i = 0; i < VTX_TRANSPORT_QUEUE_SIZE; i++) {
+        queue(i, i, VTX_TRANSACTION_RESPONSE);
+    }
+
+    const uint8_t frame[3] = { 0x7E, 0x40, 0 };
+    EXPECT_FALSE(vtxTransportQueue(&transport, 0x40, frame, 3, VTX_TRANSACTION_RESPONSE));
+}
+
+//
+// SmartAudio
+//
+
+class SmartAudioTest : public ::testing::Test {
+protected:
+    FakeSmartAudio vtx;
+
+    void SetUp() override
+    {
+        memset(&vtxConfig_System, 0, sizeof(vtxConfig_System));
+        vtx.power = 0;
+
+        ASSERT_TRUE(vtxSmartAudioInit());
+        simReset(&vtx);
+        lastProcessMs = simTimeMs;
+
+        ASSERT_NE(UINT32_MAX, simRunUntil([]() { return vtxCommonDeviceIsReady(vtxCommonDevice()); }, 5000));
+        simRun(1500);
+    }
+
+    bool reportsBandAndChannel(uint8_t band, uint8_t channel)
+    {
+        uint8_t reportedBand, reportedChannel;
+        return vtxCommonGetBandAndChannel(vtxCommonDevice(), &reportedBand, &reportedChannel) &&
+            reportedBand == band && reportedChannel == channel;
+    }
+
+    bool reportsPowerIndex(uint8_t index)
+    {
+        uint8_t reportedIndex;
+        return vtxCommonGetPowerIndex(vtxCommonDevice(), &reportedIndex) && reportedIndex == index;
+    }
+};
+
+TEST_F(SmartAudioTest, CrcMatchesLegacy)
+{
+    uint8_t data[24];
+
+    for (int i = 0; i < 1000; i++) {
+        const int len = 1 + i % sizeof(data);
+        for (int j = 0; j < len; j++) {
+            data[j] = (i * 131 + j * 17) & 0xff;
+        }
+        ASSERT_EQ(legacySaCrc8(data, len), crc8_dvb_s2_update(0, data, len));
+    }
+
+    // The GetSettings frame the driver used to send
+    const uint8_t getSettings[] = { 0xAA, 0x55, 0x03, 0x00 };
+    EXPECT_EQ(0x9F, crc8_dvb_s2_update(0, getSettings, sizeof(getSettings)));
+}
+
+TEST_F(SmartAudioTest, Detected)
+{
+    EXPECT_EQ(SA_2_0, saDevice.version);
+    EXPECT_EQ(5584, saDevice.orfreq);
+    EXPECT_TRUE(reportsPowerIndex(1));
+}
+
+TEST_F(SmartAudioTest, TimeToApplyBandChannelAndPower)
+{
+    // Band 2 channel 3 is device channel 10
+    vtxCommonSetBandAndChannel(vtxCommonDevice(), 2, 3);
+    const uint32_t appliedMs = simRunUntil([this]() { return vtx.channel == 10; }, 2000);
+    const uint32_t reportedMs = appliedMs + simRunUntil([this]() { return reportsBandAndChannel(2, 3); }, 2000);
+
+    // A 7 byte command at 4800 baud is 15ms, then its response and a
+    // GetSettings round trip of up to 10 bytes each way
+    EXPECT_LE(appliedMs, 20U);
+    EXPECT_LE(reportedMs, 2 * (SA_RESPONSE_DELAY_MS + 35));
+
+    simRun(1500);
+    vtxCommonSetPowerByIndex(vtxCommonDevice(), 3);
+    EXPECT_LE(simRunUntil([this]() { return vtx.power == 2; }, 2000), 20U);
+    EXPECT_LE(simRunUntil([this]() { return reportsPowerIndex(3); }, 2000), 2U * (SA_RESPONSE_DELAY_MS + 35));
+}
+
+TEST_F(SmartAudioTest, CommandsQueuedTogetherGoBackToBack)
+{
+    vtxCommonSetBandAndChannel(vtxCommonDevice(), 4, 8);
+    vtxCommonSetPowerByIndex(vtxCommonDevice(), 2);
+
+    // Each one as soon as the previous is answered
+    EXPECT_LE(simRunUntil([this]() { return vtx.channel == 31 && vtx.power == 1; }, 2000), SA_RESPONSE_DELAY_MS + 50U);
+}
+
+TEST_F(SmartAudioTest, LostResponseIsResent)
+{
+    vtx.dropResponses = 2;
+    vtxCommonSetBandAndChannel(vtxCommonDevice(), 1, 5);
+
+    // Applied by the first command, confirmed after two resends
+    EXPECT_LE(simRunUntil([this]() { return vtx.channel == 4; }, 2000), 20U);
+    const uint32_t reportedMs = simRunUntil([this]() { return reportsBandAndChannel(1, 5); }, 3000);
+    EXPECT_NE(UINT32_MAX, reportedMs);
+    EXPECT_LE(reportedMs, 3 * (120 + 20) + 2 * (SA_RESPONSE_DELAY_MS + 35));
+}
+
+TEST_F(SmartAudioTest, LostCommandIsResent)
+{
+    vtx.dropCommands = 1;
+    vtxCommonSetPowerByIndex(vtxCommonDevice(), 4);
+
+    // Timeout after the command went out, then the resend
+    const uint32_t appliedMs = simRunUntil([this]() { return vtx.power == 3; }, 2000);
+    EXPECT_GE(appliedMs, 120U);
+    EXPECT_LE(appliedMs, 120U + 40);
+}
+
+TEST_F(SmartAudioTest, FindsBaudRate)
+{
+    // A device that can't decode the rates tried first
+    FakeSmartAudio slowVtx;
+    slowVtx.minBaud = 4900;
+    slowVtx.maxBaud = 4900;
+    slowVtx.power = 0;
+
+    ASSERT_TRUE(vtxSmartAudioInit());
+    simReset(&slowVtx);
+    saDevice.version = SA_UNKNOWN;
+
+    // Ask again and again, as vtxUpdate() does
+    EXPECT_NE(UINT32_MAX, simRunUntil([&slowVtx]() {
+        if (simTimeMs % 500 == 0) {
+            vtxCommonSetBandAndChannel(vtxCommonDevice(), 3, 3);
+        }
+        return slowVtx.commandsHeard > 0;
+    }, 30000));
+    EXPECT_EQ(4900, sa_smartbaud);
+    EXPECT_EQ(4900U, fakePort.baudRate);
+}
+
+//
+// Tramp
+//
+
+class TrampTest : public ::testing::Test {
+protected:
+    FakeTramp vtx;
+
+    void SetUp() override
+    {
+        memset(&vtxConfig_System, 0, sizeof(vtxConfig_System));
+        memset(&vtxSettingsConfig_System, 0, sizeof(vtxSettingsConfig_System));
+
+        ASSERT_TRUE(vtxTrampInit());
+        simReset(&vtx);
+        lastProcessMs = simTimeMs;
+
+        ASSERT_NE(UINT32_MAX, simRunUntil([]() { return vtxCommonDeviceIsReady(vtxCommonDevice()); }, 5000));
+    }
+};
+
+TEST_F(TrampTest, DetectedQuickly)
+{
+    FakeTramp other;
+
+    ASSERT_TRUE(vtxTrampInit());
+    simReset(&other);
+
+    // Capabilities and status round trips, 16 bytes at 9600 baud each way
+    EXPECT_LE(simRunUntil([]() { return vtxCommonDeviceIsReady(vtxCommonDevice()); }, 5000), 2U * (2 * 17 + TRAMP_RESPONSE_DELAY_MS + 2));
+}
+
+TEST_F(TrampTest, TimeToApplyBandChannelAndPower)
+{
+    // Band 1 (A) channel 1 is 5865MHz
+    vtxCommonSetBandAndChannel(vtxCommonDevice(), 1, 1);
+    EXPECT_LE(simRunUntil([this]() { return vtx.freq == 5865; }, 3000), 20U);
+
+    vtxCommonSetPowerByIndex(vtxCommonDevice(), 3);
+    EXPECT_LE(simRunUntil([this]() { return vtx.power == 200; }, 3000), 200U + 20 + 60);
+}
+
+TEST_F(TrampTest, LostCommandIsResentAfterStatus)
+{
+    vtx.dropCommands = 1;
+    vtxCommonSetBandAndChannel(vtxCommonDevice(), 2, 4);
+
+    // Band B channel 4 is 5790MHz: the status after the settle time shows
+    // the old frequency, and the command goes again
+    const uint32_t appliedMs = simRunUntil([this]() { return vtx.freq == 5790; }, 3000);
+    EXPECT_GE(appliedMs, 200U);
+    EXPECT_LE(appliedMs, 200U + 2 * 17 + TRAMP_RESPONSE_DELAY_MS + 40);
+}
+
+TEST_F(TrampTest, LostStatusIsResent)
+{
+    vtx.dropResponses = 2;
+    vtxCommonSetPowerByIndex(vtxCommonDevice(), 2);
+    EXPECT_LE(simRunUntil([this]() { return vtx.power == 100; }, 3000), 20U);
+
+    // Still ready after two lost status responses
+    simRun(3 * 200 + 300);
+    EXPECT_TRUE(vtxCommonDeviceIsReady(vtxCommonDevice()));
+    EXPECT_EQ(0, vtx.dropResponses);
+}
+
+TEST_F(TrampTest, SilentVtxIsDetectedAgain)
+{
+    vtx.mute = true;
+
+    // Status polled every 2s, four tries each 200ms apart
+    EXPECT_NE(UINT32_MAX, simRunUntil([]() { return !vtxCommonDeviceIsReady(vtxCommonDevice()); }, 4000));
+
+    vtx.mute = false;
+    EXPECT_NE(UINT32_MAX, simRunUntil([]() { return vtxCommonDeviceIsReady(vtxCommonDevice()); }, 2000));
+}
@@ -0,0 +1,105 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+extern "C" {
+#include "common/memory.h"
+#include "fc/runtime_config.h"
+
+uint32_t armingFlags;
+}
+
+#include "gtest/gtest.h"
+
+// The allocator has no free, tests only look at what their own
+// allocations change
+
+TEST(MemoryTest, PoolSizes)
+{
+    EXPECT_EQ(memGetPoolSize(MEM_POOL_FAST), (size_t)MEM_POOL_FAST_SIZE);
+    EXPECT_EQ(memGetPoolSize(MEM_POOL_RAM), (size_t)MEM_POOL_RAM_SIZE);
+    EXPECT_EQ(memGetPoolSize(MEM_POOL_DMA), 0U);
+}
+
+TEST(MemoryTest, AllocateFromPool)
+{
+    const size_t fastAvailable = memGetPoolAvailableBytes(MEM_POOL_FAST);
+    const size_t ramAvailable = memGetAvailableBytes();
+    const size_t gyroUsed = memGetPoolUsedBytesByOwner(MEM_POOL_FAST, OWNER_GYRO_ANALYSE);
+    const size_t blackboxUsed = memGetPoolUsedBytesByOwner(MEM_POOL_FAST, OWNER_BLACKBOX);
+
+    uint8_t *p1 = (uint8_t *)memAllocateFromPool(MEM_POOL_FAST, 5, OWNER_GYRO_ANALYSE);
+    uint8_t *p2 = (uint8_t *)memAllocateFromPool(MEM_POOL_FAST, 12, OWNER_BLACKBOX);
+
+    ASSERT_NE(p1, nullptr);
+    ASSERT_NE(p2, nullptr);
+
+    // Sizes are rounded up to a word
+    EXPECT_EQ(p2 - p1, 8);
+    EXPECT_EQ(memGetPoolUsedBytesByOwner(MEM_POOL_FAST, OWNER_GYRO_ANALYSE), gyroUsed + 8);
+    EXPECT_EQ(memGetPoolUsedBytesByOwner(MEM_POOL_FAST, OWNER_BLACKBOX), blackboxUsed + 12);
+    EXPECT_EQ(memGetPoolAvailableBytes(MEM_POOL_FAST), fastAvailable - 20);
+
+    // Other pools are not touched
+    EXPECT_EQ(memGetAvailableBytes(), ramAvailable);
+
+    for (int i = 0; i < 12; i++) {
+        EXPECT_EQ(p2[i], 0);
+    }
+}
+
+TEST(MemoryTest, EmptyPoolFallsBackToRam)
+{
+    const size_t ramAvailable = memGetAvailableBytes();
+    const size_t spiUsed = memGetPoolUsedBytesByOwner(MEM_POOL_RAM, OWNER_SPI);
+    void *p = memAllocateFromPool(MEM_POOL_DMA, 64, OWNER_SPI);
+
+    ASSERT_NE(p, nullptr);
+    EXPECT_EQ((uintptr_t)p % 4, 0U);
+    EXPECT_EQ(memGetPoolUsedBytesByOwner(MEM_POOL_RAM, OWNER_SPI), spiUsed + 64);
+    EXPECT_EQ(memGetPoolUsedBytesByOwner(MEM_POOL_DMA, OWNER_SPI), 0U);
+    EXPECT_EQ(memGetAvailableBytes(), ramAvailable - 64);
+}
+
+TEST(MemoryTest, LegacyAllocateUsesRamPool)
+{
+    const size_t timerUsed = memGetUsedBytesByOwner(OWNER_TIMER);
+    const size_t ramAvailable = memGetAvailableBytes();
+
+    EXPECT_NE(memAllocate(16, OWNER_TIMER), nullptr);
+    EXPECT_EQ(memGetAvailableBytes(), ramAvailable - 16);
+    EXPECT_NE(memAllocateFromPool(MEM_POOL_FAST, 8, OWNER_TIMER), nullptr);
+
+    // Usage by owner is summed over all pools
+    EXPECT_EQ(memGetUsedBytesByOwner(OWNER_TIMER), timerUsed + 24);
+}
+
+TEST(MemoryTest, OutOfMemory)
+{
+    const size_t available = memGetPoolAvailableBytes(MEM_POOL_FAST);
+
+    armingFlags = 0;
+    EXPECT_EQ(memAllocateFromPool(MEM_POOL_FAST, available + 1, OWNER_OSD), nullptr);
+    EXPECT_TRUE(ARMING_FLAG(ARMING_DISABLED_OOM));
+
+    // A failed allocation doesn't use up the pool
+    EXPECT_EQ(memGetPoolAvailableBytes(MEM_POOL_FAST), available);
+    EXPECT_EQ(memGetPoolUsedBytesByOwner(MEM_POOL_FAST, OWNER_OSD), 0U);
+    EXPECT_NE(memAllocateFromPool(MEM_POOL_FAST, available, OWNER_OSD), nullptr);
+    EXPECT_EQ(memGetPoolAvailableBytes(MEM_POOL_FAST), 0U);
+}
@@ -84,3 +84,11 @@ extern SysTick_Type *SysTick;
 #define FAST_CODE 
 #define NOINLINE
 #define EXTENDED_FASTRAM
+#define SLOW_RAM
+
+// Config storage, as target/common_post.h sets it up
+#if defined(CONFIG_IN_RAM)
+extern uint8_t eepromData[EEPROM_SIZE];
+#define __config_start (*eepromData)
+#define __config_end (eepromData[EEPROM_SIZE])
+#endif
@@ -811,16 +811,6 @@ extern "C" {
             sbufWriteData(dst, string, strlen(string));
         }
     }
-    void sbufWriteU8(sbuf_t *dst, uint8_t val)
-    {
-        UNUSED(dst);
-        UNUSED(val);
-
-        if (testData.isAllowBufferReadWrite) {
-            *dst->ptr++ = val;
-        }
-    }
-
     void sbufWriteData(sbuf_t *dst, const void *data, int len)
     {
         UNUSED(dst);
@@ -890,18 +880,6 @@ extern "C" {
         return ret;
     }
 
-    void sbufWriteU16(sbuf_t *dst, uint16_t val)
-    {
-        sbufWriteU8(dst, val >> 0);
-        sbufWriteU8(dst, val >> 8);
-    }
-
-    void sbufWriteU16BigEndian(sbuf_t *dst, uint16_t val)
-    {
-        sbufWriteU8(dst, val >> 8);
-        sbufWriteU8(dst, (uint8_t)val);
-    }
-
     bool feature(uint32_t) { return false; }
 
     void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
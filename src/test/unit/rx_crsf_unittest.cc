@@ -0,0 +1,345 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+extern "C" {
+#include "platform.h"
+
+#include "common/crc.h"
+#include "common/time.h"
+#include "common/utils.h"
+
+#include "drivers/serial.h"
+
+#include "io/serial.h"
+
+#include "rx/rx.h"
+#include "rx/crsf.h"
+
+extern uint32_t crsfChannelData[CRSF_MAX_CHANNEL];
+
+void crsfParseBytes(const uint8_t *data, int len, timeUs_t lastByteAt);
+uint8_t crsfFrameStatus(rxRuntimeConfig_t *rxRuntimeConfig);
+timeUs_t crsfFrameTimeUs(void);
+}
+
+#include "gtest/gtest.h"
+
+#define BYTE_TIME_US        24      // 420000 baud
+#define FRAME_GAP_US        2000
+
+static uint8_t referenceCrc8(const uint8_t *data, int len)
+{
+    uint8_t crc = 0;
+    for (int i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (crc << 1) ^ 0xD5 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+typedef struct {
+    uint8_t type;
+    bool valid;                     // CRC intact
+    uint16_t channels[16];
+    uint8_t linkStats[CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE];
+    timeUs_t lastByteAt;
+} recordedFrame_t;
+
+typedef struct {
+    std::vector<uint8_t> bytes;
+    std::vector<timeUs_t> times;    // capture time of every byte
+    std::vector<size_t> bursts;     // start of every run of bytes without an idle line
+    std::vector<recordedFrame_t> frames;
+    std::vector<size_t> frameEnds;  // index of the last byte of every frame
+} recording_t;
+
+static void appendFrame(recording_t *rec, timeUs_t *now, uint8_t type, const uint8_t *payload, int payloadLength, recordedFrame_t *frame)
+{
+    uint8_t bytes[CRSF_FRAME_SIZE_MAX];
+    bytes[0] = CRSF_ADDRESS_FLIGHT_CONTROLLER;
+    bytes[1] = payloadLength + CRSF_FRAME_LENGTH_TYPE_CRC;
+    bytes[2] = type;
+    memcpy(&bytes[3], payload, payloadLength);
+    bytes[3 + payloadLength] = referenceCrc8(&bytes[2], payloadLength + 1);
+    if (!frame->valid) {
+        bytes[3 + rand() % payloadLength] ^= 1 << (rand() % 8);
+    }
+
+    for (int i = 0; i < payloadLength + 4; i++) {
+        rec->bytes.push_back(bytes[i]);
+        rec->times.push_back(*now);
+        *now += BYTE_TIME_US;
+    }
+    frame->type = type;
+    frame->lastByteAt = rec->times.back();
+    rec->frames.push_back(*frame);
+    rec->frameEnds.push_back(rec->bytes.size() - 1);
+}
+
+static void appendChannels(recording_t *rec, timeUs_t *now, bool valid)
+{
+    recordedFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.valid = valid;
+
+    uint8_t payload[CRSF_FRAME_RC_CHANNELS_PAYLOAD_SIZE];
+    memset(payload, 0, sizeof(payload));
+    for (int chan = 0; chan < 16; chan++) {
+        frame.channels[chan] = rand() % 2048;
+        for (int bit = 0; bit < 11; bit++) {
+            const int pos = chan * 11 + bit;
+            if (frame.channels[chan] & (1 << bit)) {
+                payload[pos / 8] |= 1 << (pos % 8);
+            }
+        }
+    }
+    appendFrame(rec, now, CRSF_FRAMETYPE_RC_CHANNELS_PACKED, payload, sizeof(payload), &frame);
+}
+
+static void appendLinkStatistics(recording_t *rec, timeUs_t *now, bool valid)
+{
+    recordedFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.valid = valid;
+
+    for (int i = 0; i < CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE; i++) {
+        frame.linkStats[i] = rand();
+    }
+    frame.linkStats[4] &= 1;        // active antenna
+    frame.linkStats[6] %= 10;       // tx power index
+    appendFrame(rec, now, CRSF_FRAMETYPE_LINK_STATISTICS, frame.linkStats, CRSF_FRAME_LINK_STATISTICS_PAYLOAD_SIZE, &frame);
+}
+
+static void appendOther(recording_t *rec, timeUs_t *now)
+{
+    recordedFrame_t frame;
+    memset(&frame, 0, sizeof(frame));
+    frame.valid = true;
+
+    uint8_t payload[CRSF_PAYLOAD_SIZE_MAX];
+    const int payloadLength = 1 + rand() % CRSF_PAYLOAD_SIZE_MAX;
+    for (int i = 0; i < payloadLength; i++) {
+        payload[i] = rand();
+    }
+    appendFrame(rec, now, CRSF_FRAMETYPE_DEVICE_PING, payload, payloadLength, &frame);
+}
+
+// Link traffic at 500Hz: channels every burst, sometimes followed without an
+// idle line by link statistics or another frame, with damaged frames and
+// line noise in between
+static void record(recording_t *rec, int bursts)
+{
+    timeUs_t now = 0xFFFF0000;      // wraps during the recording
+
+    for (int i = 0; i < bursts; i++) {
+        rec->bursts.push_back(rec->bytes.size());
+        if (rand() % 20 == 0) {
+            // Noise, followed by an idle line long enough to resync
+            const int count = 1 + rand() % 8;
+            for (int j = 0; j < count; j++) {
+                rec->bytes.push_back(rand());
+                rec->times.push_back(now);
+                now += BYTE_TIME_US;
+            }
+            now += FRAME_GAP_US;
+            rec->bursts.push_back(rec->bytes.size());
+        }
+        appendChannels(rec, &now, rand() % 10 != 0);
+        switch (rand() % 4) {
+            case 0:
+                appendLinkStatistics(rec, &now, rand() % 10 != 0);
+                break;
+            case 1:
+                appendOther(rec, &now);
+                break;
+            default:
+                break;
+        }
+        now += FRAME_GAP_US;
+    }
+}
+
+static rxRuntimeConfig_t runtime;
+
+static void checkLinkStatistics(const recordedFrame_t *frame)
+{
+    const uint16_t txPower[] = {0, 10, 25, 100, 500, 1000, 2000, 250, 50};
+    const uint8_t *s = frame->linkStats;
+
+    EXPECT_EQ(-(s[4] ? s[1] : s[0]), rxLinkStatistics.uplinkRSSI);
+    EXPECT_EQ(s[2], rxLinkStatistics.uplinkLQ);
+    EXPECT_EQ((int8_t)s[3], rxLinkStatistics.uplinkSNR);
+    EXPECT_EQ(s[5], rxLinkStatistics.rfMode);
+    EXPECT_EQ(txPower[s[6] < 9 ? s[6] : 0], rxLinkStatistics.uplinkTXPower);
+    EXPECT_EQ(s[4], rxLinkStatistics.activeAntenna);
+}
+
+/*
+ * Feeds the recording in chunks that end at random points but never span an
+ * idle line, as delivered by idle line delimited reception, and polls the
+ * driver after every chunk. maxChunk of 1 replays the per byte interrupt.
+ */
+static void replay(const recording_t *rec, int maxChunk)
+{
+    size_t nextFrame = 0;
+    const recordedFrame_t *expectedChannels = NULL;
+    const recordedFrame_t *expectedLinkStats = NULL;
+    int completed = 0;
+
+    for (size_t burst = 0; burst < rec->bursts.size(); burst++) {
+        const size_t burstEnd = burst + 1 < rec->bursts.size() ? rec->bursts[burst + 1] : rec->bytes.size();
+
+        for (size_t pos = rec->bursts[burst]; pos < burstEnd; ) {
+            const size_t len = std::min(burstEnd - pos, (size_t)(1 + rand() % maxChunk));
+            crsfParseBytes(&rec->bytes[pos], len, rec->times[pos + len - 1]);
+            pos += len;
+
+            bool newChannels = false;
+            while (nextFrame < rec->frames.size() && rec->frameEnds[nextFrame] < pos) {
+                const recordedFrame_t *frame = &rec->frames[nextFrame++];
+                if (!frame->valid) {
+                    continue;
+                }
+                if (frame->type == CRSF_FRAMETYPE_RC_CHANNELS_PACKED) {
+                    expectedChannels = frame;
+                    newChannels = true;
+                } else if (frame->type == CRSF_FRAMETYPE_LINK_STATISTICS) {
+                    expectedLinkStats = frame;
+                }
+            }
+
+            const uint8_t status = crsfFrameStatus(&runtime);
+            ASSERT_EQ(newChannels ? RX_FRAME_COMPLETE : RX_FRAME_PENDING, status) << "byte " << pos;
+
+            if (newChannels) {
+                completed++;
+                ASSERT_EQ(expectedChannels->lastByteAt, crsfFrameTimeUs()) << "byte " << pos;
+                for (int chan = 0; chan < 16; chan++) {
+                    ASSERT_EQ(expectedChannels->channels[chan], crsfChannelData[chan]) << "byte " << pos << " channel " << chan;
+                }
+            }
+            if (expectedLinkStats) {
+                checkLinkStatistics(expectedLinkStats);
+            }
+        }
+    }
+
+    EXPECT_GT(completed, 0);
+}
+
+TEST(CrsfTest, Crc8MatchesBitwise)
+{
+    for (int crc = 0; crc < 256; crc++) {
+        for (int byte = 0; byte < 256; byte++) {
+            uint8_t expected = crc ^ byte;
+            for (int bit = 0; bit < 8; bit++) {
+                expected = (expected & 0x80) ? (expected << 1) ^ 0xD5 : expected << 1;
+            }
+            ASSERT_EQ(expected, crc8_dvb_s2(crc, byte));
+        }
+    }
+
+    const uint8_t data[] = { 0x16, 0xE0, 0x03, 0x1F, 0x58, 0xC0, 0x07 };
+    EXPECT_EQ(referenceCrc8(data, sizeof(data)), crc8_dvb_s2_update(0, data, sizeof(data)));
+}
+
+TEST(CrsfTest, ReplayPerByte)
+{
+    srand(1);
+    recording_t rec;
+    record(&rec, 500);
+    replay(&rec, 1);
+}
+
+TEST(CrsfTest, ReplayRandomChunks)
+{
+    srand(2);
+    recording_t rec;
+    record(&rec, 500);
+
+    for (int maxChunk = 2; maxChunk <= 80; maxChunk += 13) {
+        replay(&rec, maxChunk);
+    }
+}
+
+TEST(CrsfTest, ReplayWholeBursts)
+{
+    srand(3);
+    recording_t rec;
+    record(&rec, 500);
+    replay(&rec, 1000);
+}
+
+TEST(CrsfTest, OversizedLengthIsDropped)
+{
+    srand(4);
+    recording_t rec;
+    timeUs_t now = 1000;
+
+    // A length past the frame buffer used to be accepted
+    const uint8_t bogus[] = { CRSF_ADDRESS_FLIGHT_CONTROLLER, 0xF0, CRSF_FRAMETYPE_RC_CHANNELS_PACKED };
+    crsfParseBytes(bogus, sizeof(bogus), now);
+    now += FRAME_GAP_US;
+
+    appendChannels(&rec, &now, true);
+    crsfParseBytes(rec.bytes.data(), rec.bytes.size(), rec.times.back());
+    ASSERT_EQ(RX_FRAME_COMPLETE, crsfFrameStatus(&runtime));
+    EXPECT_EQ(rec.frames[0].lastByteAt, crsfFrameTimeUs());
+    EXPECT_EQ(rec.frames[0].channels[7], crsfChannelData[7]);
+}
+
+// STUBS
+
+extern "C" {
+rxLinkStatistics_t rxLinkStatistics;
+
+uint32_t micros(void) { return 0; }
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function)
+{
+    UNUSED(function);
+    return NULL;
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFunction_e function, serialReceiveCallbackPtr rxCallback,
+                             void *rxCallbackData, uint32_t baudrate, portMode_t mode, portOptions_t options)
+{
+    UNUSED(identifier);
+    UNUSED(function);
+    UNUSED(rxCallback);
+    UNUSED(rxCallbackData);
+    UNUSED(baudrate);
+    UNUSED(mode);
+    UNUSED(options);
+    return NULL;
+}
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count)
+{
+    UNUSED(instance);
+    UNUSED(data);
+    UNUSED(count);
+}
+}
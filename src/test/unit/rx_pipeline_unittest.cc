@@ -0,0 +1,234 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+extern "C" {
+#include "common/maths.h"
+#include "common/utils.h"
+
+#include "rx/rx.h"
+#include "rx/rx_pipeline.h"
+}
+
+#include "gtest/gtest.h"
+
+static uint16_t testRawData[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+
+static uint16_t testReadRawRC(const rxRuntimeConfig_t *rxRuntimeConfig, uint8_t chan)
+{
+    return chan < rxRuntimeConfig->channelCount ? testRawData[chan] : 0;
+}
+
+static void testReadRawChannels(const rxRuntimeConfig_t *rxRuntimeConfig, uint16_t *raw, uint8_t count)
+{
+    UNUSED(rxRuntimeConfig);
+    memcpy(raw, testRawData, count * sizeof(raw[0]));
+}
+
+// Channel processing as done by calculateRxChannelsAndUpdateFailsafe()
+// before the table was introduced
+static bool referenceProcess(const rxConfig_t *config, const rxChannelRangeConfig_t *ranges, const rxRuntimeConfig_t *runtime,
+                             uint8_t channelCount, rcChannel_t *channels, int16_t *staging, timeMs_t currentTimeMs)
+{
+    bool valid = true;
+
+    for (int channel = 0; channel < channelCount; channel++) {
+        const uint8_t rawChannel = channel < (int)REMAPPABLE_CHANNEL_COUNT ? config->rcmap[channel] : channel;
+        uint16_t sample = runtime->rcReadRawFn(runtime, rawChannel);
+
+        if (channel < NON_AUX_CHANNEL_COUNT && sample != 0) {
+            sample = scaleRange(sample, ranges[channel].min, ranges[channel].max, PWM_RANGE_MIN, PWM_RANGE_MAX);
+            sample = MIN(MAX(PWM_PULSE_MIN, sample), PWM_PULSE_MAX);
+        }
+
+        channels[channel].raw = sample;
+
+        if (!(sample >= config->rx_min_usec && sample <= config->rx_max_usec)) {
+            sample = channels[channel].data;
+            if ((currentTimeMs > channels[channel].expiresAt) && (channel < NON_AUX_CHANNEL_COUNT)) {
+                valid = false;
+            }
+        } else {
+            channels[channel].expiresAt = currentTimeMs + MAX_INVALID_RX_PULSE_TIME;
+        }
+
+        staging[channel] = sample;
+    }
+
+    return valid;
+}
+
+static uint16_t randomSample(void)
+{
+    switch (rand() % 8) {
+        case 0:
+            return 0;                               // driver has no value
+        case 1:
+            return rand() % 700;                    // far below any rxrange, wraps when scaled
+        case 2:
+            return 2300 + rand() % 2000;            // far above
+        default:
+            return 880 + rand() % 1280;             // SBUS full range
+    }
+}
+
+static void randomConfig(rxConfig_t *config, rxChannelRangeConfig_t *ranges)
+{
+    memset(config, 0, sizeof(*config));
+    for (unsigned i = 0; i < REMAPPABLE_CHANNEL_COUNT; i++) {
+        config->rcmap[i] = (rand() % 16 == 0) ? 20 + rand() % 200 : rand() % 8;
+    }
+    config->rx_min_usec = 850 + rand() % 150;
+    config->rx_max_usec = 2000 + rand() % 200;
+    for (int i = 0; i < NON_AUX_CHANNEL_COUNT; i++) {
+        ranges[i].min = 750 + rand() % 500;
+        ranges[i].max = 1750 + rand() % 500;
+    }
+}
+
+TEST(RxPipelineTest, MatchesPerChannelProcessing)
+{
+    srand(42);
+
+    for (int run = 0; run < 200; run++) {
+        rxConfig_t config;
+        rxChannelRangeConfig_t ranges[NON_AUX_CHANNEL_COUNT];
+        randomConfig(&config, ranges);
+
+        const uint8_t channelCount = 4 + rand() % (MAX_SUPPORTED_RC_CHANNEL_COUNT - 3);
+
+        rxRuntimeConfig_t runtime;
+        memset(&runtime, 0, sizeof(runtime));
+        runtime.channelCount = channelCount;
+        runtime.rcReadRawFn = testReadRawRC;
+        runtime.rcReadRawChannelsFn = (run & 1) ? testReadRawChannels : NULL;
+
+        rxChannelPipeline_t pipeline;
+        rxChannelPipelineCompile(&pipeline, channelCount, &config, ranges);
+        ASSERT_TRUE(rxChannelPipelineIsCurrent(&pipeline, channelCount, &config, ranges));
+
+        rcChannel_t expected[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+        rcChannel_t actual[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+        for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+            expected[i].raw = expected[i].data = PWM_RANGE_MIDDLE;
+            expected[i].expiresAt = MAX_INVALID_RX_PULSE_TIME;
+        }
+        memcpy(actual, expected, sizeof(actual));
+
+        timeMs_t now = 0;
+        for (int frame = 0; frame < 100; frame++) {
+            now += rand() % 150;
+            for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+                testRawData[i] = randomSample();
+            }
+
+            int16_t expectedStaging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+            int16_t actualStaging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+            uint16_t raw[RX_RAW_CHANNEL_COUNT];
+
+            const bool expectedValid = referenceProcess(&config, ranges, &runtime, channelCount, expected, expectedStaging, now);
+            rxChannelPipelineReadRaw(&pipeline, &runtime, raw);
+            const bool actualValid = rxChannelPipelineRun(&pipeline, raw, actual, actualStaging, now);
+
+            ASSERT_EQ(expectedValid, actualValid) << "run " << run << " frame " << frame;
+            for (int channel = 0; channel < channelCount; channel++) {
+                ASSERT_EQ(expected[channel].raw, actual[channel].raw) << "run " << run << " frame " << frame << " channel " << channel;
+                ASSERT_EQ(expected[channel].expiresAt, actual[channel].expiresAt) << "run " << run << " frame " << frame << " channel " << channel;
+                ASSERT_EQ(expectedStaging[channel], actualStaging[channel]) << "run " << run << " frame " << frame << " channel " << channel;
+            }
+
+            // As done when the receiver isn't in failsafe
+            if (expectedValid) {
+                for (int channel = 0; channel < channelCount; channel++) {
+                    expected[channel].data = expectedStaging[channel];
+                    actual[channel].data = actualStaging[channel];
+                }
+            }
+        }
+    }
+}
+
+TEST(RxPipelineTest, RecompilesOnConfigChange)
+{
+    rxConfig_t config;
+    rxChannelRangeConfig_t ranges[NON_AUX_CHANNEL_COUNT];
+    srand(1);
+    randomConfig(&config, ranges);
+
+    rxChannelPipeline_t pipeline;
+    rxChannelPipelineCompile(&pipeline, 16, &config, ranges);
+    EXPECT_TRUE(rxChannelPipelineIsCurrent(&pipeline, 16, &config, ranges));
+    EXPECT_FALSE(rxChannelPipelineIsCurrent(&pipeline, 12, &config, ranges));
+
+    config.rcmap[2]++;
+    EXPECT_FALSE(rxChannelPipelineIsCurrent(&pipeline, 16, &config, ranges));
+    config.rcmap[2]--;
+
+    ranges[3].max--;
+    EXPECT_FALSE(rxChannelPipelineIsCurrent(&pipeline, 16, &config, ranges));
+    ranges[3].max++;
+
+    config.rx_max_usec++;
+    EXPECT_FALSE(rxChannelPipelineIsCurrent(&pipeline, 16, &config, ranges));
+    config.rx_max_usec--;
+
+    EXPECT_TRUE(rxChannelPipelineIsCurrent(&pipeline, 16, &config, ranges));
+}
+
+TEST(RxPipelineTest, MissingChannelsHoldLastValue)
+{
+    rxConfig_t config;
+    rxChannelRangeConfig_t ranges[NON_AUX_CHANNEL_COUNT];
+    memset(&config, 0, sizeof(config));
+    config.rcmap[0] = 0;
+    config.rcmap[1] = 1;
+    config.rcmap[2] = 3;
+    config.rcmap[3] = 9;    // past the 8 channels of the receiver
+    config.rx_min_usec = 885;
+    config.rx_max_usec = 2115;
+    for (int i = 0; i < NON_AUX_CHANNEL_COUNT; i++) {
+        ranges[i].min = PWM_RANGE_MIN;
+        ranges[i].max = PWM_RANGE_MAX;
+    }
+
+    rxChannelPipeline_t pipeline;
+    rxChannelPipelineCompile(&pipeline, 8, &config, ranges);
+    EXPECT_EQ(pipeline.stages[3].source, RX_RAW_CHANNEL_NONE);
+
+    uint16_t raw[RX_RAW_CHANNEL_COUNT];
+    for (int i = 0; i < RX_RAW_CHANNEL_COUNT; i++) {
+        raw[i] = 1600;
+    }
+    raw[RX_RAW_CHANNEL_NONE] = 0;
+
+    rcChannel_t channels[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    int16_t staging[MAX_SUPPORTED_RC_CHANNEL_COUNT];
+    for (int i = 0; i < MAX_SUPPORTED_RC_CHANNEL_COUNT; i++) {
+        channels[i].raw = channels[i].data = 1234;
+        channels[i].expiresAt = 100 + MAX_INVALID_RX_PULSE_TIME;
+    }
+
+    // Held within MAX_INVALID_RX_PULSE_TIME, failsafe after
+    EXPECT_TRUE(rxChannelPipelineRun(&pipeline, raw, channels, staging, 100));
+    EXPECT_EQ(channels[3].raw, 0);
+    EXPECT_EQ(staging[3], 1234);
+    EXPECT_EQ(staging[2], 1600);
+    EXPECT_FALSE(rxChannelPipelineRun(&pipeline, raw, channels, staging, 101 + MAX_INVALID_RX_PULSE_TIME));
+}
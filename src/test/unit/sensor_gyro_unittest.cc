@@ -145,4 +145,6 @@ timeDelta_t getLooptime(void) {return gyro.targetLooptime;}
 timeDelta_t getGyroLooptime(void) {return gyro.targetLooptime;}
 void sensorsSet(uint32_t) {}
 void schedulerResetTaskStatistics(cfTaskId_e) {}
+void dynamicLpfGyroInit(uint32_t) {}
+void dynamicLpfGyroUpdate(filter_t *) {}
 }
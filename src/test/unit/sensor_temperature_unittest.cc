@@ -0,0 +1,526 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/maths.h"
+
+    #include "drivers/1-wire.h"
+    #include "drivers/1-wire/ds_crc.h"
+    #include "drivers/bus.h"
+    #include "drivers/temperature/ds18b20.h"
+    #include "drivers/time.h"
+
+    #include "scheduler/scheduler.h"
+
+    #include "sensors/temperature.h"
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// Simulated DS2482-100 on a 400kHz I2C bus with DS18B20s on its 1-Wire
+// side, all timed against a simulated clock
+
+#define I2C_BIT_NS          2500
+#define OW_SLOT_US          70
+#define OW_RESET_US         1148
+#define CONVERSION_US       94000
+
+#define SENSOR_COUNT        8
+
+typedef enum {
+    OW_IDLE,
+    OW_ROM_COMMAND,
+    OW_MATCH_ROM,
+    OW_SEARCH_ROM,
+    OW_FUNCTION,
+    OW_READ_SCRATCHPAD,
+    OW_WRITE_SCRATCHPAD,
+    OW_DESELECTED,
+} owSlaveState_e;
+
+typedef struct {
+    uint8_t rom[8];
+    bool present;
+    int16_t temperature;        // Sixteenths of a degree
+    uint8_t scratchpad[9];
+    uint64_t conversionDoneUs;
+    int16_t converting;
+    owSlaveState_e state;
+    uint8_t index;
+} ds18b20Sim_t;
+
+static ds18b20Sim_t sensor[SENSOR_COUNT];
+
+static uint64_t simTimeNs;
+static uint64_t owBusyUntilNs;
+static uint8_t readPointer;
+static uint8_t dataRegister;
+static uint8_t statusRegister;
+static uint8_t owBytesSinceReset;
+static uint8_t owFirstByte;
+
+// Per cycle counters
+static uint64_t i2cTimeNs;
+static uint32_t i2cTransactions;
+static uint32_t conversions;
+static uint32_t commandsWhileBusy;
+static uint32_t readsDuringConversion;
+
+static timeDelta_t taskPeriodUs;
+
+static uint64_t simTimeUs(void)
+{
+    return simTimeNs / 1000;
+}
+
+static void i2cTransaction(unsigned bytes)
+{
+    // Start, the bytes with their acks and stop
+    const uint64_t ns = (bytes * 9 + 2) * I2C_BIT_NS;
+    simTimeNs += ns;
+    i2cTimeNs += ns;
+    i2cTransactions++;
+}
+
+static bool owBusy(void)
+{
+    return simTimeNs < owBusyUntilNs;
+}
+
+static void updateScratchpad(ds18b20Sim_t *s)
+{
+    s->scratchpad[0] = s->converting & 0xFF;
+    s->scratchpad[1] = s->converting >> 8;
+    s->scratchpad[8] = ds_crc8(s->scratchpad, 8);
+}
+
+static void addSensor(int index, uint32_t serial, int16_t temperature)
+{
+    ds18b20Sim_t *s = &sensor[index];
+    memset(s, 0, sizeof(*s));
+
+    s->rom[0] = 0x28;
+    memcpy(&s->rom[1], &serial, sizeof(serial));
+    s->rom[7] = ds_crc8(s->rom, 7);
+    s->present = true;
+    s->temperature = temperature;
+
+    // Power on: 85C, 12 bits
+    const uint8_t powerOn[8] = { 0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10 };
+    memcpy(s->scratchpad, powerOn, 8);
+    s->converting = 0x0550;
+    updateScratchpad(s);
+    s->conversionDoneUs = 0;
+}
+
+static uint64_t sensorRom(int index)
+{
+    uint64_t rom;
+    memcpy(&rom, sensor[index].rom, sizeof(rom));
+    return rom;
+}
+
+static void owReset(void)
+{
+    bool presence = false;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        if (sensor[i].present) {
+            sensor[i].state = OW_ROM_COMMAND;
+            presence = true;
+        }
+    }
+    statusRegister = presence ? 0x02 : 0;
+    owBytesSinceReset = 0;
+    owBusyUntilNs = simTimeNs + OW_RESET_US * 1000ULL;
+}
+
+static void owWriteByte(uint8_t byte)
+{
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        ds18b20Sim_t *s = &sensor[i];
+        if (!s->present) {
+            continue;
+        }
+
+        switch (s->state) {
+        case OW_ROM_COMMAND:
+            s->index = 0;
+            s->state = byte == 0xCC ? OW_FUNCTION : byte == 0x55 ? OW_MATCH_ROM : byte == 0xF0 ? OW_SEARCH_ROM : OW_DESELECTED;
+            break;
+        case OW_MATCH_ROM:
+            if (byte != s->rom[s->index]) {
+                s->state = OW_DESELECTED;
+            } else if (++s->index == 8) {
+                s->state = OW_FUNCTION;
+            }
+            break;
+        case OW_FUNCTION:
+            s->index = 0;
+            if (byte == 0x44) {
+                s->conversionDoneUs = simTimeUs() + CONVERSION_US;
+                // 9 bits resolution, the lower 3 bits undefined
+                s->converting = s->temperature & ~7;
+                s->state = OW_DESELECTED;
+            } else if (byte == 0xBE) {
+                if (simTimeUs() < s->conversionDoneUs) {
+                    readsDuringConversion++;
+                }
+                s->state = OW_READ_SCRATCHPAD;
+            } else if (byte == 0x4E) {
+                s->state = OW_WRITE_SCRATCHPAD;
+            } else {
+                s->state = OW_DESELECTED;
+            }
+            break;
+        case OW_WRITE_SCRATCHPAD:
+            s->scratchpad[2 + s->index] = byte;
+            if (++s->index == 3) {
+                s->state = OW_DESELECTED;
+            }
+            break;
+        default:
+            break;
+        }
+    }
+
+    // Skip ROM then Convert T
+    if (owBytesSinceReset == 1 && owFirstByte == 0xCC && byte == 0x44) {
+        conversions++;
+    }
+    if (owBytesSinceReset++ == 0) {
+        owFirstByte = byte;
+    }
+    owBusyUntilNs = simTimeNs + 8 * OW_SLOT_US * 1000ULL;
+}
+
+static uint8_t owReadByte(void)
+{
+    uint8_t byte = 0xFF;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        ds18b20Sim_t *s = &sensor[i];
+        if (s->present && s->state == OW_READ_SCRATCHPAD) {
+            if (simTimeUs() >= s->conversionDoneUs) {
+                updateScratchpad(s);
+            }
+            byte &= s->index < 9 ? s->scratchpad[s->index++] : 0xFF;
+        }
+    }
+    owBusyUntilNs = simTimeNs + 8 * OW_SLOT_US * 1000ULL;
+    return byte;
+}
+
+static void owTriplet(uint8_t direction)
+{
+    bool firstBit = true, secondBit = true;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        ds18b20Sim_t *s = &sensor[i];
+        if (s->present && s->state == OW_SEARCH_ROM) {
+            const bool bit = (s->rom[s->index / 8] >> (s->index % 8)) & 1;
+            firstBit &= bit;
+            secondBit &= !bit;
+        }
+    }
+
+    const bool taken = firstBit != secondBit ? firstBit : direction;
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        ds18b20Sim_t *s = &sensor[i];
+        if (s->present && s->state == OW_SEARCH_ROM) {
+            const bool bit = (s->rom[s->index / 8] >> (s->index % 8)) & 1;
+            s->state = bit == taken ? OW_SEARCH_ROM : OW_DESELECTED;
+            s->index++;
+        }
+    }
+
+    statusRegister = (firstBit << 5) | (secondBit << 6) | (taken << 7);
+    owBusyUntilNs = simTimeNs + 3 * OW_SLOT_US * 1000ULL;
+}
+
+// Raises the clock until the next run of the task is due and runs it.
+// Returns the I2C time it took.
+static uint64_t runTask(void)
+{
+    simTimeNs += taskPeriodUs * 1000ULL;
+
+    const uint64_t before = i2cTimeNs;
+    temperatureUpdate();
+    return i2cTimeNs - before;
+}
+
+static void resetCounters(void)
+{
+    i2cTimeNs = 0;
+    i2cTransactions = 0;
+    conversions = 0;
+    commandsWhileBusy = 0;
+    readsDuringConversion = 0;
+}
+
+typedef struct {
+    uint64_t i2cTimeUs;
+    uint32_t i2cTransactions;
+    uint32_t taskRuns;
+    uint64_t longestRunUs;
+    uint64_t cycleUs;
+} cycleStats_t;
+
+// Runs the task through the wait for the conversion and the batch of
+// reads after it, up to the values being updated
+static cycleStats_t runCycle(void)
+{
+    cycleStats_t stats = {};
+    const uint64_t start = simTimeNs;
+    bool batch = false;
+
+    resetCounters();
+    while (stats.taskRuns < 100000) {
+        const uint64_t runNs = runTask();
+        stats.longestRunUs = MAX(stats.longestRunUs, runNs / 1000);
+        stats.taskRuns++;
+
+        // The task runs fast while the batch is on the bus
+        if (taskPeriodUs < TASK_PERIOD_HZ(100)) {
+            batch = true;
+        } else if (batch) {
+            break;
+        }
+    }
+
+    stats.i2cTimeUs = i2cTimeNs / 1000;
+    stats.i2cTransactions = i2cTransactions;
+    stats.cycleUs = (simTimeNs - start) / 1000;
+    return stats;
+}
+
+static int findSlot(uint64_t rom)
+{
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+        if (tempSensorConfig(i)->type == TEMP_SENSOR_DS18B20 && tempSensorConfig(i)->address == rom) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+class TemperatureTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        simTimeNs = 1000000000ULL;
+        owBusyUntilNs = 0;
+        readPointer = 0xF0;
+        statusRegister = 0;
+        taskPeriodUs = TASK_PERIOD_HZ(100);
+
+        // -55.0C to +125.0C on 9 bits
+        const int16_t temperatures[SENSOR_COUNT] = { 25 * 16, -10 * 16 - 8, 0, 125 * 16, -55 * 16, 40 * 16 + 8, 85 * 16, 3 * 16 };
+        for (int i = 0; i < SENSOR_COUNT; i++) {
+            addSensor(i, 0x1000 + i * 0x2345, temperatures[i]);
+        }
+
+        resetTempSensorConfig();
+        owInit();
+        temperatureInit();
+        resetCounters();
+    }
+};
+
+TEST_F(TemperatureTest, FindsAndConfiguresEverySensor)
+{
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        EXPECT_NE(-1, findSlot(sensorRom(i))) << "sensor " << i;
+        EXPECT_EQ(0x1F, sensor[i].scratchpad[4]) << "sensor " << i;
+    }
+}
+
+TEST_F(TemperatureTest, ReadsEverySensorAfterOneBroadcastConversion)
+{
+    // The first reads find the power on value, which isn't trusted
+    runCycle();
+    runCycle();
+    const cycleStats_t stats = runCycle();
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        const int slot = findSlot(sensorRom(i));
+        ASSERT_NE(-1, slot);
+
+        int16_t temperature;
+        EXPECT_TRUE(getSensorTemperature(slot, &temperature)) << "sensor " << i;
+        EXPECT_EQ(sensor[i].temperature * 10 / 16, temperature) << "sensor " << i;
+    }
+
+    EXPECT_EQ(1u, conversions);
+    EXPECT_EQ(0u, commandsWhileBusy);
+    EXPECT_EQ(0u, readsDuringConversion);
+
+    // A reset, 10 bytes out and 9 in per sensor, then the conversion
+    const uint32_t owTimeUs = SENSOR_COUNT * (OW_RESET_US + 19 * 8 * OW_SLOT_US) + OW_RESET_US + 2 * 8 * OW_SLOT_US;
+
+    printf("simulated %d sensors: %u us of 1-Wire, %u us of I2C in %u transactions, %u runs, longest %u us, %u us per cycle\n",
+        SENSOR_COUNT, owTimeUs, (unsigned)stats.i2cTimeUs, stats.i2cTransactions, stats.taskRuns,
+        (unsigned)stats.longestRunUs, (unsigned)stats.cycleUs);
+
+    // No run waits on the 1-Wire bus: a status read, fetching a byte read
+    // and the next command at most
+    EXPECT_LE(stats.longestRunUs, 250u);
+
+    // The bridge is only polled once a step should be over, so about one
+    // status read per 1-Wire step on top of the commands
+    const uint32_t owSteps = SENSOR_COUNT * 20 + 3;
+    EXPECT_LE(stats.i2cTransactions, owSteps * 2 + SENSOR_COUNT * 9 * 2 + 2);
+
+    // The reads run back to back at the pace of the 1-Wire bus, not of the
+    // task, then the conversion time
+    EXPECT_LT(stats.cycleUs, owTimeUs * 5 / 4 + 120000);
+}
+
+TEST_F(TemperatureTest, MissingSensorIsInvalid)
+{
+    runCycle();
+    runCycle();
+
+    sensor[3].present = false;
+    runCycle();
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        int16_t temperature;
+        EXPECT_EQ(i != 3, getSensorTemperature(findSlot(sensorRom(i)), &temperature)) << "sensor " << i;
+    }
+    EXPECT_EQ(0u, readsDuringConversion);
+}
+
+TEST_F(TemperatureTest, NoSensorAnswers)
+{
+    runCycle();
+    runCycle();
+
+    for (int i = 0; i < SENSOR_COUNT; i++) {
+        sensor[i].present = false;
+    }
+
+    // Every reset goes without a presence pulse and ends its transaction
+    const cycleStats_t stats = runCycle();
+    EXPECT_EQ(0u, commandsWhileBusy);
+    EXPECT_LE(stats.longestRunUs, 250u);
+
+    for (int i = 0; i < MAX_TEMP_SENSORS; i++) {
+        int16_t temperature;
+        EXPECT_FALSE(getSensorTemperature(i, &temperature));
+    }
+}
+
+// STUBS
+
+extern "C" {
+
+static busDevice_t ds2482BusDev;
+
+busDevice_t * busDeviceInit(busType_e, devHardwareType_e, uint8_t, resourceOwner_e)
+{
+    return &ds2482BusDev;
+}
+
+void busDeviceDeInit(busDevice_t *) {}
+
+bool busWrite(const busDevice_t *, uint8_t reg, uint8_t data)
+{
+    // Raw commands have no parameter byte
+    const bool raw = reg == 0xFF;
+    const uint8_t command = raw ? data : reg;
+    i2cTransaction(raw ? 2 : 3);
+
+    if (owBusy() && command != 0xE1) {
+        commandsWhileBusy++;
+        return true;
+    }
+
+    switch (command) {
+    case 0xF0:      // Device reset
+        owBusyUntilNs = 0;
+        readPointer = 0xF0;
+        break;
+    case 0xE1:      // Set read pointer
+        readPointer = data;
+        return true;
+    case 0xD2:      // Write configuration
+        readPointer = 0xC3;
+        return true;
+    case 0xB4:
+        owReset();
+        break;
+    case 0xA5:
+        owWriteByte(data);
+        break;
+    case 0x96:
+        dataRegister = owReadByte();
+        break;
+    case 0x78:
+        owTriplet(data >> 7);
+        break;
+    case 0x87:
+        statusRegister = 1 << 5;
+        owBusyUntilNs = simTimeNs + OW_SLOT_US * 1000ULL;
+        break;
+    default:
+        return false;
+    }
+
+    // 1-Wire commands leave the status to be polled
+    readPointer = 0xF0;
+    return true;
+}
+
+bool busRead(const busDevice_t *, uint8_t, uint8_t *data)
+{
+    i2cTransaction(2);
+
+    switch (readPointer) {
+    case 0xF0:
+        *data = (statusRegister & ~1) | (owBusy() ? 1 : 0);
+        break;
+    case 0xE1:
+        *data = dataRegister;
+        break;
+    default:
+        *data = 0x01;
+        break;
+    }
+    return true;
+}
+
+void delay(timeMs_t ms) { simTimeNs += ms * 1000000ULL; }
+timeUs_t micros(void) { return simTimeNs / 1000; }
+timeMs_t millis(void) { return simTimeNs / 1000000; }
+
+void rescheduleTask(cfTaskId_e, timeDelta_t newPeriodUs) { taskPeriodUs = newPeriodUs; }
+
+bool gyroReadTemperature(void) { return false; }
+int16_t gyroGetTemperature(void) { return 0; }
+int16_t baroGetTemperature(void) { return 0; }
+bool sensors(uint32_t) { return false; }
+void sensorsSet(uint32_t) {}
+
+int tfp_sprintf(char *, const char *, ...) { return 0; }
+
+}
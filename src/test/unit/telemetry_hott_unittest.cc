@@ -21,6 +21,9 @@
 
 #include <limits.h>
 
+#include <deque>
+#include <vector>
+
 extern "C" {
     #include "platform.h"
 
@@ -63,6 +66,7 @@ extern "C" {
 
 extern "C" {
     void addGPSCoordinates(HOTT_GPS_MSG_t *hottGPSMessage, int32_t latitude, int32_t longitude);
+    void hottPrepareEAMResponse(HOTT_EAM_MSG_t *hottEAMMessage);
 }
 // See http://en.wikipedia.org/wiki/Geographic_coordinate_conversion
 
@@ -141,6 +145,187 @@ TEST(TelemetryHottTest, UpdateGPSCoordinates3)
     EXPECT_EQ((int16_t)(hottGPSMessage->pos_EW_sec_H << 8 | hottGPSMessage->pos_EW_sec_L), 9999);
 }
 
+// A receiver polling a 19200 baud line, with the telemetry task at 500Hz
+
+#define TASK_PERIOD_US      2000
+#define TX_WINDOW_US        5000    // From the request to the first byte allowed out
+#define TX_DELAY_US         2000    // Line kept after the CRC byte
+
+typedef struct {
+    timeUs_t time;
+    uint8_t byte;
+} txByte_t;
+
+static timeUs_t simTimeUs = 1000000;
+static std::deque<uint8_t> rxQueue;
+static std::vector<txByte_t> txLog;
+static std::vector<timeUs_t> rxReadTimes;
+static int txWriteCalls;
+static uint32_t testTxByteSpacingUs;
+
+static void runTask(timeUs_t durationUs)
+{
+    const timeUs_t end = simTimeUs + durationUs;
+    while (simTimeUs < end) {
+        simTimeUs += TASK_PERIOD_US;
+        handleHoTTTelemetry(simTimeUs);
+    }
+}
+
+static void startHoTT(uint32_t txByteSpacingUs)
+{
+    testTxByteSpacingUs = txByteSpacingUs;
+    initHoTTTelemetry();
+    configureHoTTTelemetryPort();
+
+    // Settle into waiting for a request, messages are prepared every 200ms
+    // from the first run on
+    runTask(402000);
+    rxQueue.clear();
+    txLog.clear();
+    rxReadTimes.clear();
+    txWriteCalls = 0;
+}
+
+// Returns the task run that takes the request
+static timeUs_t sendEAMRequest(void)
+{
+    rxQueue.push_back(HOTT_BINARY_MODE_REQUEST_ID);
+    rxQueue.push_back(HOTT_TELEMETRY_EAM_SENSOR_ID);
+    return simTimeUs + TASK_PERIOD_US;
+}
+
+static std::vector<uint8_t> expectedEAMMessage(void)
+{
+    HOTT_EAM_MSG_t msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.start_byte = 0x7C;
+    msg.eam_sensor_id = HOTT_TELEMETRY_EAM_SENSOR_ID;
+    msg.sensor_id = HOTT_EAM_SENSOR_TEXT_ID;
+    msg.stop_byte = 0x7D;
+    hottPrepareEAMResponse(&msg);
+
+    const uint8_t *bytes = (const uint8_t *)&msg;
+    return std::vector<uint8_t>(bytes, bytes + sizeof(msg));
+}
+
+// What the byte by byte transmitter did before messages were prepared ahead:
+// from the run after the TX window opens, one byte per run with the running
+// sum last, then the line held for TX_DELAY_US
+static std::vector<txByte_t> baselineTransmission(const std::vector<uint8_t> &msg, timeUs_t requestUs, timeUs_t *flushUs)
+{
+    std::vector<txByte_t> sent;
+    timeUs_t time = requestUs;
+    uint8_t crc = 0;
+
+    while (time - requestUs < TX_WINDOW_US) {
+        time += TASK_PERIOD_US;
+    }
+
+    for (uint8_t byte : msg) {
+        time += TASK_PERIOD_US;
+        sent.push_back({ time, byte });
+        crc += byte;
+    }
+    time += TASK_PERIOD_US;
+    sent.push_back({ time, crc });
+
+    const timeUs_t crcUs = time;
+    while (time - crcUs < TX_DELAY_US) {
+        time += TASK_PERIOD_US;
+    }
+    *flushUs = time;
+
+    return sent;
+}
+
+TEST(TelemetryHottTest, PacedPortGetsWholeMessage)
+{
+    // given
+    startHoTT(TX_DELAY_US);
+    testBatteryVoltage = 1110;
+    testAmperage = 420;
+    testMAhDrawn = 1337;
+    runTask(200000);
+    const std::vector<uint8_t> msg = expectedEAMMessage();
+
+    // when
+    const timeUs_t requestUs = sendEAMRequest();
+    runTask(TX_WINDOW_US + 20 * TASK_PERIOD_US);
+    rxQueue.push_back(0x55);
+    runTask(100000);
+
+    // then the port gets the baseline bytes when the first of them went out,
+    // and the line is held as long
+    timeUs_t flushUs;
+    const std::vector<txByte_t> expected = baselineTransmission(msg, requestUs, &flushUs);
+    ASSERT_EQ(expected.size(), txLog.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        EXPECT_EQ(expected[0].time, txLog[i].time) << "byte " << i;
+        EXPECT_EQ(expected[i].byte, txLog[i].byte) << "byte " << i;
+    }
+    EXPECT_EQ(2, txWriteCalls);     // Message and CRC
+    ASSERT_EQ(3u, rxReadTimes.size());
+    EXPECT_EQ(flushUs, rxReadTimes[2]);
+}
+
+TEST(TelemetryHottTest, ResponsePreparedAhead)
+{
+    // given
+    startHoTT(TX_DELAY_US);
+    testBatteryVoltage = 1000;
+    runTask(200000);
+    const std::vector<uint8_t> before = expectedEAMMessage();
+
+    // when the battery changes right before the request, 50ms before the
+    // next preparation
+    runTask(150000);
+    testBatteryVoltage = 1500;
+    const std::vector<uint8_t> after = expectedEAMMessage();
+    sendEAMRequest();
+    runTask(TX_WINDOW_US + 60 * TASK_PERIOD_US);
+
+    // then the message prepared before goes out whole, even with the next
+    // one prepared meanwhile
+    ASSERT_EQ(before.size() + 1, txLog.size());
+    uint8_t crc = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        EXPECT_EQ(before[i], txLog[i].byte) << "byte " << i;
+        crc += txLog[i].byte;
+    }
+    EXPECT_EQ(crc, txLog.back().byte);
+
+    // and the next request gets the new one
+    runTask(200000);
+    txLog.clear();
+    sendEAMRequest();
+    runTask(TX_WINDOW_US + 60 * TASK_PERIOD_US);
+    ASSERT_EQ(after.size() + 1, txLog.size());
+    for (size_t i = 0; i < after.size(); i++) {
+        EXPECT_EQ(after[i], txLog[i].byte) << "byte " << i;
+    }
+}
+
+TEST(TelemetryHottTest, UnpacedPortPreparesOnRequest)
+{
+    // given
+    startHoTT(0);
+    testBatteryVoltage = 1000;
+    runTask(150000);
+
+    // when the battery changes right before the request
+    testBatteryVoltage = 1500;
+    const std::vector<uint8_t> msg = expectedEAMMessage();
+    sendEAMRequest();
+    runTask(TX_WINDOW_US + 60 * TASK_PERIOD_US);
+
+    // then the response is prepared when the request comes in
+    ASSERT_EQ(msg.size() + 1, txLog.size());
+    for (size_t i = 0; i < msg.size(); i++) {
+        EXPECT_EQ(msg[i], txLog[i].byte) << "byte " << i;
+    }
+}
+
 /*
 TEST(TelemetryHottTest, PrepareGPSMessage_Altitude1m)
 {
@@ -190,24 +375,55 @@ uint32_t millis(void) {
 
 uint32_t micros(void) { return 0; }
 
+static serialPort_t testPort;
+static serialPortConfig_t testPortConfig;
+
 uint32_t serialRxBytesWaiting(const serialPort_t *instance) {
     UNUSED(instance);
-    return 0;
+    return rxQueue.size();
 }
 
 uint32_t serialTxBytesFree(const serialPort_t *instance) {
     UNUSED(instance);
-    return 0;
+    return 256;
 }
 
 uint8_t serialRead(serialPort_t *instance) {
     UNUSED(instance);
-    return 0;
+    if (rxQueue.empty()) {
+        return 0;
+    }
+    const uint8_t ch = rxQueue.front();
+    rxQueue.pop_front();
+    rxReadTimes.push_back(simTimeUs);
+    return ch;
 }
 
 void serialWrite(serialPort_t *instance, uint8_t ch) {
     UNUSED(instance);
-    UNUSED(ch);
+    txLog.push_back({ simTimeUs, ch });
+    txWriteCalls++;
+}
+
+void serialWriteBuf(serialPort_t *instance, const uint8_t *data, int count) {
+    UNUSED(instance);
+    for (int i = 0; i < count; i++) {
+        txLog.push_back({ simTimeUs, data[i] });
+    }
+    txWriteCalls++;
+}
+
+void serialBeginWrite(serialPort_t *instance) {
+    UNUSED(instance);
+}
+
+void serialEndWrite(serialPort_t *instance) {
+    UNUSED(instance);
+}
+
+uint32_t serialSetTxByteSpacing(serialPort_t *instance, uint32_t spacingUs) {
+    UNUSED(instance);
+    return testTxByteSpacingUs ? spacingUs : 0;
 }
 
 void serialSetMode(serialPort_t *instance, portMode_t mode) {
@@ -228,7 +444,7 @@ serialPort_t *openSerialPort(serialPortIdentifier_e identifier, serialPortFuncti
     UNUSED(mode);
     UNUSED(options);
 
-    return NULL;
+    return &testPort;
 }
 
 void closeSerialPort(serialPort_t *serialPort) {
@@ -238,7 +454,7 @@ void closeSerialPort(serialPort_t *serialPort) {
 serialPortConfig_t *findSerialPortConfig(serialPortFunction_e function) {
     UNUSED(function);
 
-    return NULL;
+    return &testPortConfig;
 }
 
 bool sensors(uint32_t mask) {
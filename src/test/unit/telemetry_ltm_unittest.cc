@@ -0,0 +1,361 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <map>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+    #include "common/maths.h"
+
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "fc/fc_core.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "navigation/navigation.h"
+
+    #include "sensors/battery.h"
+    #include "sensors/sensors.h"
+
+    #include "telemetry/ltm.h"
+    #include "telemetry/telemetry.h"
+
+    PG_REGISTER(telemetryConfig_t, telemetryConfig, PG_TELEMETRY_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+#define TASK_PERIOD_MS      2       // Telemetry task at 500Hz
+#define TX_BUFFER_SIZE      256     // UART TX buffer
+
+static serialPort_t testPort;
+static serialPortConfig_t testPortConfig;
+static uint32_t testBaudRate;
+static uint32_t testMillis;
+static uint32_t stateMillis;
+
+// The UART: bytes leave the TX buffer at the baud rate
+static uint32_t txQueued;
+static uint32_t txDrainedBits;
+static uint32_t txMaxQueued;
+static bool txOverflow;
+
+typedef struct {
+    uint32_t time;
+    std::vector<uint8_t> bytes;
+} txWrite_t;
+
+static std::vector<txWrite_t> txWrites;
+
+// Flight state as a function of time, so any frame can be checked against
+// the state when it was written
+static void setState(uint32_t timeMs)
+{
+    stateMillis = timeMs;
+    attitude.values.roll = (int16_t)((timeMs / 3) % 3600) - 1800;
+    attitude.values.pitch = (int16_t)((timeMs / 7) % 1800) - 900;
+    attitude.values.yaw = (timeMs / 11) % 3600;
+
+    // GPS updates at 5Hz, home stays put
+    const uint32_t gpsUpdate = timeMs / 200;
+    gpsSol.llh.lat = 473977420 + gpsUpdate * 13;
+    gpsSol.llh.lon = 85455940 - gpsUpdate * 7;
+    gpsSol.groundSpeed = 1200 + (gpsUpdate % 10) * 100;
+    gpsSol.numSat = 14;
+    gpsSol.fixType = GPS_FIX_3D;
+    gpsSol.hdop = 120 + gpsUpdate % 5;
+
+    GPS_home.lat = 473977000;
+    GPS_home.lon = 85455000;
+    GPS_home.alt = 48800;
+}
+
+static std::vector<uint8_t> expectedFrame(ltm_frame_e frameType, uint32_t timeMs)
+{
+    setState(timeMs);
+    uint8_t frame[LTM_MAX_PAYLOAD_SIZE + 1];
+    const int size = getLtmFrame(frame, frameType);
+    return std::vector<uint8_t>(frame, frame + size);
+}
+
+static int payloadSize(uint8_t function)
+{
+    switch (function) {
+    case 'A': return LTM_AFRAME_PAYLOAD_SIZE;
+    case 'S': return LTM_SFRAME_PAYLOAD_SIZE;
+    case 'G': return LTM_GFRAME_PAYLOAD_SIZE;
+    case 'O': return LTM_OFRAME_PAYLOAD_SIZE;
+    case 'N': return LTM_NFRAME_PAYLOAD_SIZE;
+    case 'X': return LTM_XFRAME_PAYLOAD_SIZE;
+    default: return -1;
+    }
+}
+
+static ltm_frame_e frameType(uint8_t function)
+{
+    switch (function) {
+    case 'S': return LTM_SFRAME;
+    case 'G': return LTM_GFRAME;
+    case 'O': return LTM_OFRAME;
+    case 'N': return LTM_NFRAME;
+    case 'X': return LTM_XFRAME;
+    default: return LTM_AFRAME;
+    }
+}
+
+typedef struct {
+    uint32_t time;                  // Written at
+    std::vector<uint8_t> frame;     // Function byte and payload
+} decodedFrame_t;
+
+// Splits the stream into frames and checks their checksums
+static std::vector<decodedFrame_t> decodeStream(void)
+{
+    std::vector<decodedFrame_t> frames;
+
+    for (const txWrite_t &write : txWrites) {
+        const std::vector<uint8_t> &bytes = write.bytes;
+        size_t i = 0;
+        while (i < bytes.size()) {
+            // Each write carries whole frames
+            EXPECT_EQ('$', bytes[i]);
+            EXPECT_EQ('T', bytes[i + 1]);
+            const int size = payloadSize(bytes[i + 2]);
+            if (size < 0 || i + size + 4 > bytes.size()) {
+                ADD_FAILURE() << "bad frame at " << write.time << "ms";
+                return frames;
+            }
+
+            uint8_t crc = 0;
+            for (int j = 0; j < size; j++) {
+                crc ^= bytes[i + 3 + j];
+            }
+            EXPECT_EQ(crc, bytes[i + 3 + size]);
+
+            frames.push_back({ write.time, std::vector<uint8_t>(bytes.begin() + i + 2, bytes.begin() + i + 3 + size) });
+            i += size + 4;
+        }
+    }
+
+    return frames;
+}
+
+static void runLtm(uint32_t baudRate, ltmUpdateRate_e rate, uint32_t durationMs)
+{
+    telemetryConfigMutable()->ltmUpdateRate = rate;
+    testBaudRate = baudRate;
+    testMillis = 100000;
+    txQueued = 0;
+    txDrainedBits = 0;
+    txMaxQueued = 0;
+    txOverflow = false;
+    txWrites.clear();
+
+    setState(testMillis);
+    initLtmTelemetry();
+    configureLtmTelemetryPort();
+
+    for (uint32_t t = 0; t < durationMs; t += TASK_PERIOD_MS) {
+        testMillis += TASK_PERIOD_MS;
+
+        // In bit-milliseconds, 10 bits a byte
+        txDrainedBits += TASK_PERIOD_MS * baudRate;
+        const uint32_t drained = MIN(txDrainedBits / 10000, txQueued);
+        txQueued -= drained;
+        txDrainedBits = txQueued ? txDrainedBits - drained * 10000 : 0;
+
+        setState(testMillis);
+        handleLtmTelemetry();
+    }
+
+    freeLtmTelemetryPort();
+}
+
+TEST(TelemetryLtmTest, FramesMatchState)
+{
+    runLtm(9600, LTM_RATE_NORMAL, 5000);
+
+    const std::vector<decodedFrame_t> frames = decodeStream();
+    ASSERT_FALSE(frames.empty());
+    EXPECT_FALSE(txOverflow);
+
+    uint8_t xCounter = 0;
+    for (const decodedFrame_t &decoded : frames) {
+        std::vector<uint8_t> expected = expectedFrame(frameType(decoded.frame[0]), decoded.time);
+        if (decoded.frame[0] == 'X') {
+            // Counts the X frames sent
+            expected[4] = xCounter++;
+        }
+        EXPECT_EQ(expected, decoded.frame) << decoded.frame[0] << " frame at " << decoded.time << "ms";
+    }
+}
+
+TEST(TelemetryLtmTest, OneWritePerPass)
+{
+    runLtm(57600, LTM_RATE_NORMAL, 2000);
+
+    // At most one write per task run, each one whole frames
+    for (size_t i = 1; i < txWrites.size(); i++) {
+        EXPECT_LT(txWrites[i - 1].time, txWrites[i].time);
+    }
+    decodeStream();
+
+    // All due together on the first pass, in the order they were always sent
+    ASSERT_FALSE(txWrites.empty());
+    std::vector<uint8_t> functions;
+    for (size_t i = 0; i < txWrites[0].bytes.size(); i += payloadSize(txWrites[0].bytes[i + 2]) + 4) {
+        functions.push_back(txWrites[0].bytes[i + 2]);
+    }
+    EXPECT_EQ(std::vector<uint8_t>({ 'A', 'G', 'O', 'X', 'S', 'N' }), functions);
+}
+
+typedef struct {
+    ltmUpdateRate_e rate;
+    const char *name;
+    uint32_t baudRate;
+} rateCase_t;
+
+class TelemetryLtmRateTest : public ::testing::TestWithParam<rateCase_t> {};
+
+TEST_P(TelemetryLtmRateTest, RatesFitBaud)
+{
+    const rateCase_t &param = GetParam();
+    const uint32_t durationMs = 20000;
+    runLtm(param.baudRate, param.rate, durationMs);
+
+    const std::vector<decodedFrame_t> frames = decodeStream();
+    std::map<uint8_t, int> counts;
+    uint32_t bytes = 0;
+    for (const decodedFrame_t &decoded : frames) {
+        counts[decoded.frame[0]]++;
+        bytes += decoded.frame.size() + 3;
+    }
+
+    // The rate table, all scaled alike to 90% of the line if it doesn't fit
+    static const std::map<ltmUpdateRate_e, std::map<uint8_t, int>> tables = {
+        { LTM_RATE_NORMAL, { { 'A', 10 }, { 'G', 5 }, { 'O', 1 }, { 'X', 1 }, { 'S', 5 }, { 'N', 3 } } },
+        { LTM_RATE_MEDIUM, { { 'A', 5 }, { 'G', 2 }, { 'O', 2 }, { 'X', 1 }, { 'S', 2 }, { 'N', 1 } } },
+        { LTM_RATE_SLOW, { { 'A', 2 }, { 'G', 2 }, { 'O', 1 }, { 'X', 1 }, { 'S', 1 }, { 'N', 1 } } },
+        { LTM_RATE_FAST, { { 'A', 25 }, { 'G', 5 }, { 'O', 1 }, { 'X', 1 }, { 'S', 5 }, { 'N', 5 } } },
+    };
+    const std::map<uint8_t, int> &table = tables.at(param.rate);
+    double demand = 0;
+    for (const auto &entry : table) {
+        demand += entry.second * (payloadSize(entry.first) + 4);
+    }
+    const double budget = param.baudRate / 10 * 0.9;
+    const double scale = demand > budget ? budget / demand : 1.0;
+
+    printf("LTM %-6s at %5u baud:", param.name, param.baudRate);
+    for (uint8_t function : { 'A', 'G', 'O', 'X', 'S', 'N' }) {
+        const double achieved = counts[function] * 1000.0 / durationMs;
+        printf(" %c %5.2f Hz", function, achieved);
+        EXPECT_NEAR(table.at(function) * scale, achieved, 0.1 + table.at(function) * scale * 0.05) << function << " frames";
+    }
+    printf(", %u bytes/s, TX buffer peak %u bytes\n", bytes * 1000 / durationMs, txMaxQueued);
+
+    // Within the budget, after the first pass sending everything at once
+    EXPECT_LE(bytes, budget * durationMs / 1000 + LTM_FRAME_COUNT * LTM_MAX_MESSAGE_SIZE);
+    EXPECT_FALSE(txOverflow);
+    // Frames don't queue up behind each other on the line
+    EXPECT_LE(txMaxQueued, (uint32_t)LTM_FRAME_COUNT * LTM_MAX_MESSAGE_SIZE);
+}
+
+INSTANTIATE_TEST_CASE_P(Bauds, TelemetryLtmRateTest, ::testing::Values(
+    rateCase_t { LTM_RATE_NORMAL, "NORMAL", 2400 },
+    rateCase_t { LTM_RATE_NORMAL, "NORMAL", 9600 },
+    rateCase_t { LTM_RATE_NORMAL, "NORMAL", 57600 },
+    rateCase_t { LTM_RATE_MEDIUM, "MEDIUM", 2400 },
+    rateCase_t { LTM_RATE_SLOW, "SLOW", 2400 },
+    rateCase_t { LTM_RATE_FAST, "FAST", 2400 },
+    rateCase_t { LTM_RATE_FAST, "FAST", 9600 },
+    rateCase_t { LTM_RATE_FAST, "FAST", 57600 }
+));
+
+// STUBS
+
+extern "C" {
+
+uint32_t stateFlags;
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+
+attitudeEulerAngles_t attitude;
+gpsSolutionData_t gpsSol;
+gpsLocation_t GPS_home;
+navSystemStatus_t NAV_Status;
+
+const uint32_t baudRates[] = { 0, 1200, 2400, 4800, 9600, 19200, 38400, 57600, 115200, 230400, 250000, 460800, 921600, 1000000, 1500000, 2000000, 2470000 };
+
+serialPort_t *telemetrySharedPort = NULL;
+
+uint32_t millis(void) { return testMillis; }
+
+uint32_t serialTxBytesFree(const serialPort_t *) { return TX_BUFFER_SIZE - txQueued; }
+
+uint32_t serialGetBaudRate(serialPort_t *) { return testBaudRate; }
+
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+{
+    if (txQueued + count > TX_BUFFER_SIZE) {
+        txOverflow = true;
+    }
+    txQueued += count;
+    txMaxQueued = MAX(txMaxQueued, txQueued);
+    txWrites.push_back({ testMillis, std::vector<uint8_t>(data, data + count) });
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_t, portOptions_t)
+{
+    return &testPort;
+}
+
+void closeSerialPort(serialPort_t *) {}
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return &testPortConfig; }
+portSharing_e determinePortSharing(const serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+bool telemetryDetermineEnabledState(portSharing_e) { return true; }
+bool telemetryCheckRxPortShared(const serialPortConfig_t *) { return false; }
+
+bool sensors(uint32_t mask) { return mask & SENSOR_GPS; }
+
+bool failsafeIsActive(void) { return false; }
+bool isHardwareHealthy(void) { return true; }
+disarmReason_t getDisarmReason(void) { return DISARM_NONE; }
+
+uint16_t getBatteryVoltage(void) { return 1680 + (stateMillis / 1000) % 20; }
+int32_t getMAhDrawn(void) { return stateMillis / 500; }
+uint16_t getRSSI(void) { return 900; }
+
+float getEstimatedActualPosition(int) { return 1234.0f + (stateMillis / 100) % 50; }
+
+}
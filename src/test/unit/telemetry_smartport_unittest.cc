@@ -0,0 +1,409 @@
+/*
+ * This file is part of INAV.
+ *
+ * INAV is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * INAV is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with INAV.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <deque>
+#include <map>
+#include <vector>
+
+extern "C" {
+    #include "platform.h"
+
+    #include "common/axis.h"
+
+    #include "config/feature.h"
+    #include "config/parameter_group.h"
+    #include "config/parameter_group_ids.h"
+
+    #include "fc/config.h"
+    #include "fc/rc_modes.h"
+    #include "fc/runtime_config.h"
+
+    #include "flight/imu.h"
+
+    #include "io/gps.h"
+    #include "io/serial.h"
+
+    #include "navigation/navigation.h"
+
+    #include "sensors/acceleration.h"
+    #include "sensors/battery.h"
+    #include "sensors/sensors.h"
+
+    #include "telemetry/smartport.h"
+    #include "telemetry/telemetry.h"
+
+    PG_REGISTER(telemetryConfig_t, telemetryConfig, PG_TELEMETRY_CONFIG, 0);
+}
+
+#include "unittest_macros.h"
+#include "gtest/gtest.h"
+
+// The ID values from the OpenTX frsky.h
+#define DATAID_SPEED        0x0830
+#define DATAID_VFAS         0x0210
+#define DATAID_CURRENT      0x0200
+#define DATAID_ALTITUDE     0x0100
+#define DATAID_FUEL         0x0600
+#define DATAID_LATLONG      0x0800
+#define DATAID_VARIO        0x0110
+#define DATAID_HEADING      0x0840
+#define DATAID_FPV          0x0450
+#define DATAID_ACCX         0x0700
+#define DATAID_ACCY         0x0710
+#define DATAID_ACCZ         0x0720
+#define DATAID_T1           0x0400
+#define DATAID_T2           0x0410
+#define DATAID_HOME_DIST    0x0420
+#define DATAID_GPS_ALT      0x0820
+#define DATAID_A4           0x0910
+#define DATAID_AZIMUTH      0x0460
+
+// Longitude goes out with the latitude ID and the MSB set
+#define SENSOR_LONGITUDE    0x10000
+
+static std::deque<uint8_t> rxQueue;
+static std::vector<uint8_t> txBytes;
+static serialPort_t testPort;
+static serialPortConfig_t testPortConfig;
+
+static uint32_t testSensors;
+static uint16_t testBatteryVoltage;
+static bool testGpsFeature;
+
+static bool telemetryStarted = false;
+
+typedef struct {
+    bool answered;
+    smartPortPayload_t payload;
+} pollReply_t;
+
+static void startTelemetry(void)
+{
+    if (!telemetryStarted) {
+        initSmartPortTelemetry();
+        checkSmartPortTelemetryState();
+        telemetryStarted = true;
+    }
+}
+
+// Undoes the byte stuffing and checks the checksum of one reply
+static pollReply_t decodeReply(const std::vector<uint8_t> &bytes)
+{
+    pollReply_t reply = { false, {} };
+    uint8_t frame[sizeof(smartPortPayload_t) + 1];
+    unsigned length = 0;
+
+    if (bytes.empty()) {
+        return reply;
+    }
+
+    for (size_t i = 0; i < bytes.size(); i++) {
+        EXPECT_NE(FSSP_START_STOP, bytes[i]);
+        uint8_t c = bytes[i];
+        if (c == FSSP_DLE) {
+            EXPECT_LT(i + 1, bytes.size());
+            c = bytes[++i] ^ FSSP_DLE_XOR;
+        }
+        EXPECT_LT(length, sizeof(frame));
+        if (length < sizeof(frame)) {
+            frame[length++] = c;
+        }
+    }
+    EXPECT_EQ(sizeof(frame), length);
+
+    uint16_t sum = 0;
+    for (unsigned i = 0; i < length; i++) {
+        sum += frame[i];
+        sum = (sum & 0xFF) + (sum >> 8);
+    }
+    EXPECT_EQ(0xFF, sum);
+
+    reply.answered = true;
+    memcpy(&reply.payload, frame, sizeof(reply.payload));
+    return reply;
+}
+
+// The receiver polling our physical ID
+static pollReply_t poll(void)
+{
+    startTelemetry();
+
+    rxQueue.push_back(FSSP_START_STOP);
+    rxQueue.push_back(FSSP_SENSOR_ID1);
+    txBytes.clear();
+    handleSmartPortTelemetry();
+
+    pollReply_t reply = decodeReply(txBytes);
+    if (reply.answered) {
+        EXPECT_EQ(FSSP_DATA_FRAME, reply.payload.frameId);
+    }
+    return reply;
+}
+
+static uint32_t sensorOf(const smartPortPayload_t &payload)
+{
+    if (payload.valueId == DATAID_LATLONG && (payload.data & 0x80000000)) {
+        return SENSOR_LONGITUDE;
+    }
+    return payload.valueId;
+}
+
+// The polls each sensor should get relative to the others
+static const std::map<uint32_t, unsigned> sensorWeights = {
+    { DATAID_VARIO, 4 },
+    { DATAID_ALTITUDE, 3 },
+    { DATAID_VFAS, 2 },
+    { DATAID_CURRENT, 2 },
+    { DATAID_T1, 2 },
+    { DATAID_HEADING, 2 },
+    { DATAID_ACCX, 1 },
+    { DATAID_ACCY, 1 },
+    { DATAID_ACCZ, 1 },
+    { DATAID_LATLONG, 2 },
+    { SENSOR_LONGITUDE, 2 },
+    { DATAID_SPEED, 2 },
+    { DATAID_T2, 1 },
+    { DATAID_GPS_ALT, 1 },
+    { DATAID_HOME_DIST, 1 },
+    { DATAID_FPV, 1 },
+    { DATAID_AZIMUTH, 1 },
+    { DATAID_FUEL, 1 },
+    { DATAID_A4, 1 },
+};
+
+static bool isGpsSensor(uint32_t sensor)
+{
+    switch (sensor) {
+        case DATAID_LATLONG:
+        case SENSOR_LONGITUDE:
+        case DATAID_SPEED:
+        case DATAID_T2:
+        case DATAID_GPS_ALT:
+        case DATAID_HOME_DIST:
+        case DATAID_FPV:
+        case DATAID_AZIMUTH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+class SmartPortTelemetryTest : public ::testing::Test {
+protected:
+    void SetUp() override
+    {
+        testSensors = SENSOR_ACC | SENSOR_BARO;
+        testGpsFeature = true;
+        testBatteryVoltage = 1680;
+        stateFlags = GPS_FIX;
+        armingFlags = 0;
+        flightModeFlags = 0;
+    }
+
+    // Polls the sensors in weights for cycles full rounds and checks each
+    // got exactly its share, never waiting much longer than its period
+    void expectShares(const std::map<uint32_t, unsigned> &weights, unsigned cycles)
+    {
+        unsigned totalWeight = 0;
+        for (const auto &sensor : weights) {
+            totalWeight += sensor.second;
+        }
+
+        // Settle the credit left from earlier tests
+        for (unsigned i = 0; i < totalWeight; i++) {
+            poll();
+        }
+
+        std::map<uint32_t, unsigned> counts;
+        std::map<uint32_t, unsigned> lastPoll;
+        std::map<uint32_t, unsigned> longestGap;
+        for (unsigned i = 0; i < cycles * totalWeight; i++) {
+            const pollReply_t reply = poll();
+            ASSERT_TRUE(reply.answered);
+            const uint32_t sensor = sensorOf(reply.payload);
+            ASSERT_EQ(1u, weights.count(sensor)) << "sensor " << std::hex << sensor;
+            counts[sensor]++;
+            if (lastPoll.count(sensor)) {
+                longestGap[sensor] = std::max(longestGap[sensor], i - lastPoll[sensor]);
+            }
+            lastPoll[sensor] = i;
+        }
+
+        for (const auto &sensor : weights) {
+            EXPECT_EQ(cycles * sensor.second, counts[sensor.first]) << "sensor " << std::hex << sensor.first;
+            EXPECT_LE(longestGap[sensor.first], 2 * totalWeight / sensor.second) << "sensor " << std::hex << sensor.first;
+        }
+    }
+};
+
+TEST_F(SmartPortTelemetryTest, DeliversEachSensorItsShareOfPolls)
+{
+    expectShares(sensorWeights, 20);
+}
+
+TEST_F(SmartPortTelemetryTest, SensorsWithoutDataGiveUpTheirShare)
+{
+    // No fix after arming: the GPS sensors stop updating
+    stateFlags = 0;
+    armingFlags = WAS_EVER_ARMED;
+
+    std::map<uint32_t, unsigned> weights;
+    for (const auto &sensor : sensorWeights) {
+        if (!isGpsSensor(sensor.first)) {
+            weights.insert(sensor);
+        }
+    }
+    expectShares(weights, 20);
+
+    // Nor the altitude ones without a barometer
+    testSensors = SENSOR_ACC;
+    weights.erase(DATAID_VARIO);
+    weights.erase(DATAID_ALTITUDE);
+    expectShares(weights, 20);
+}
+
+TEST_F(SmartPortTelemetryTest, FramesAreStuffedAndChecksummed)
+{
+    // Both bytes with a meaning on the wire in the value
+    testBatteryVoltage = (FSSP_START_STOP << 8) | FSSP_DLE;
+
+    for (int i = 0; i < 100; i++) {
+        const pollReply_t reply = poll();
+        ASSERT_TRUE(reply.answered);
+        if (reply.payload.valueId == DATAID_VFAS) {
+            EXPECT_EQ(testBatteryVoltage, reply.payload.data);
+            EXPECT_EQ(sizeof(smartPortPayload_t) + 1 + 2, txBytes.size());
+            return;
+        }
+    }
+    FAIL() << "VFAS never sent";
+}
+
+TEST_F(SmartPortTelemetryTest, FlightModeFollowsTheFlags)
+{
+    auto flightMode = []() {
+        for (int i = 0; i < 100; i++) {
+            const pollReply_t reply = poll();
+            if (reply.answered && reply.payload.valueId == DATAID_T1) {
+                return reply.payload.data;
+            }
+        }
+        ADD_FAILURE() << "T1 never sent";
+        return 0u;
+    };
+
+    flightModeFlags = ANGLE_MODE;
+    EXPECT_EQ(11u, flightMode());
+
+    flightModeFlags = HORIZON_MODE;
+    EXPECT_EQ(21u, flightMode());
+
+    armingFlags = ARMED;
+    EXPECT_EQ(25u, flightMode());
+}
+
+TEST(SmartPortEncodeTest, FrameStartsFromTheGivenChecksum)
+{
+    const smartPortPayload_t payload = { FSSP_DATA_FRAME, 0x7E7D, 0x12345678 };
+    uint8_t prefixed[2 + SMARTPORT_FRAME_ENCODED_MAX];
+    uint8_t plain[SMARTPORT_FRAME_ENCODED_MAX];
+
+    // A prefix covered by the checksum, as FPort sends
+    uint16_t checksum = 0;
+    uint8_t *ptr = smartPortEncodeByte(prefixed, 0x08, &checksum);
+    ptr = smartPortEncodeFrame(ptr, &payload, checksum);
+    const int prefixedLength = ptr - prefixed;
+
+    const int plainLength = smartPortEncodeFrame(plain, &payload, 0) - plain;
+
+    // Same escaped payload, different checksum
+    EXPECT_EQ(plainLength + 1, prefixedLength);
+    EXPECT_EQ(0, memcmp(prefixed + 1, plain, plainLength - 1));
+    EXPECT_EQ(0, memcmp(plain + 1, "\x7D\x5D\x7D\x5E", 4));
+
+    uint16_t sum = 0;
+    for (int i = 0; i < prefixedLength; i++) {
+        uint8_t c = prefixed[i];
+        if (c == FSSP_DLE) {
+            c = prefixed[++i] ^ FSSP_DLE_XOR;
+        }
+        sum += c;
+        sum = (sum & 0xFF) + (sum >> 8);
+    }
+    EXPECT_EQ(0xFF, sum);
+}
+
+// STUBS
+
+extern "C" {
+
+uint32_t stateFlags;
+uint32_t armingFlags;
+uint32_t flightModeFlags;
+
+attitudeEulerAngles_t attitude;
+acc_t acc;
+gpsSolutionData_t gpsSol;
+uint32_t GPS_distanceToHome;
+int16_t GPS_directionToHome;
+
+uint32_t serialRxBytesWaiting(const serialPort_t *) { return rxQueue.size(); }
+
+uint8_t serialRead(serialPort_t *)
+{
+    const uint8_t c = rxQueue.front();
+    rxQueue.pop_front();
+    return c;
+}
+
+void serialWriteBuf(serialPort_t *, const uint8_t *data, int count)
+{
+    txBytes.insert(txBytes.end(), data, data + count);
+}
+
+serialPort_t *openSerialPort(serialPortIdentifier_e, serialPortFunction_e, serialReceiveCallbackPtr, void *, uint32_t, portMode_t, portOptions_t)
+{
+    return &testPort;
+}
+
+void closeSerialPort(serialPort_t *) {}
+
+serialPortConfig_t *findSerialPortConfig(serialPortFunction_e) { return &testPortConfig; }
+portSharing_e determinePortSharing(const serialPortConfig_t *, serialPortFunction_e) { return PORTSHARING_NOT_SHARED; }
+bool telemetryDetermineEnabledState(portSharing_e) { return true; }
+
+bool feature(uint32_t mask) { return (mask & FEATURE_GPS) && testGpsFeature; }
+bool sensors(uint32_t mask) { return testSensors & mask; }
+bool IS_RC_MODE_ACTIVE(boxId_e) { return false; }
+
+bool isBatteryVoltageConfigured(void) { return true; }
+bool isAmperageConfigured(void) { return true; }
+uint16_t getBatteryVoltage(void) { return testBatteryVoltage; }
+uint16_t getBatteryAverageCellVoltage(void) { return 420; }
+int16_t getAmperage(void) { return 1234; }
+int32_t getMAhDrawn(void) { return 321; }
+int32_t getMWhDrawn(void) { return 4321; }
+uint8_t calculateBatteryPercentage(void) { return 77; }
+
+float getEstimatedActualPosition(int) { return 1000.0f; }
+float getEstimatedActualVelocity(int) { return -50.0f; }
+
+}
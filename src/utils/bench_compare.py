@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+#
+# Compares two hot kernel benchmark runs (see docs/development/Benchmarks.md)
+# and fails if any kernel got slower than the allowed threshold.
+#
+# Usage: bench_compare.py [--threshold PERCENT] baseline.txt current.txt
+
+import argparse
+import sys
+
+
+def parse(filename):
+    results = {}
+    unit = None
+    with open(filename) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) != 4 or fields[0] != 'BENCH':
+                continue
+            results[fields[1]] = float(fields[2])
+            unit = fields[3]
+    return results, unit
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare hot kernel benchmark results')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='allowed slowdown per kernel, in percent')
+    parser.add_argument('baseline')
+    parser.add_argument('current')
+    args = parser.parse_args()
+
+    baseline, baseline_unit = parse(args.baseline)
+    current, current_unit = parse(args.current)
+
+    if baseline_unit != current_unit:
+        print('error: baseline is in %s, current run is in %s' % (baseline_unit, current_unit))
+        return 2
+
+    regressions = 0
+    print('%-48s %12s %12s %8s' % ('kernel', 'baseline', 'current', 'delta'))
+    for name in sorted(set(baseline) | set(current)):
+        if name not in baseline or name not in current:
+            print('%-48s %12s %12s %8s' % (name,
+                  baseline.get(name, '-'), current.get(name, '-'), 'n/a'))
+            continue
+        old = baseline[name]
+        new = current[name]
+        delta = (new - old) * 100.0 / old if old else 0.0
+        marker = ''
+        if delta > args.threshold:
+            marker = ' REGRESSION'
+            regressions += 1
+        print('%-48s %12.1f %12.1f %+7.1f%%%s' % (name, old, new, delta, marker))
+
+    if regressions:
+        print('%d kernel(s) slower than %.1f%% threshold (%s/call)' % (regressions, args.threshold, current_unit))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,94 @@
+#!/usr/bin/env python3
+#
+# Compares two firmware build directories, typically one built with the
+# default optimization and one with -DOPTIMIZATION_PROFILE=speed (see
+# docs/development/Build_Profiles.md). Prints the flash and RAM used by every
+# target built in both, and the hot kernel benchmark deltas for every
+# bench_<name>.txt found in both.
+#
+# Usage: build_profile_report.py [--size arm-none-eabi-size] baseline_dir current_dir [target ...]
+
+import argparse
+import glob
+import math
+import os
+import subprocess
+import sys
+
+from bench_compare import parse as parse_bench
+
+
+def image_size(size_tool, elf):
+    # Berkeley format: text data bss dec hex filename
+    output = subprocess.check_output([size_tool, '-B', elf], universal_newlines=True)
+    fields = output.splitlines()[1].split()
+    text, data, bss = int(fields[0]), int(fields[1]), int(fields[2])
+    return text + data, data + bss
+
+
+def find(directory, pattern, suffix):
+    found = {}
+    for path in glob.glob(os.path.join(directory, pattern)):
+        name = os.path.basename(path)[:-len(suffix)]
+        found[name] = path
+    return found
+
+
+def delta(old, new):
+    return (new - old) * 100.0 / old if old else 0.0
+
+
+def report_sizes(args):
+    baseline = find(os.path.join(args.baseline, 'bin'), '*.elf', '.elf')
+    current = find(os.path.join(args.current, 'bin'), '*.elf', '.elf')
+    names = sorted(set(baseline) & set(current))
+    if args.targets:
+        names = [n for n in names if n in args.targets]
+    if not names:
+        print('no firmware built in both %s and %s' % (args.baseline, args.current))
+        return
+
+    print('%-32s %10s %10s %8s %10s %10s %8s' % ('target', 'flash', 'flash', 'delta', 'ram', 'ram', 'delta'))
+    for name in names:
+        old_flash, old_ram = image_size(args.size, baseline[name])
+        new_flash, new_ram = image_size(args.size, current[name])
+        print('%-32s %10d %10d %+7.1f%% %10d %10d %+7.1f%%' % (name,
+              old_flash, new_flash, delta(old_flash, new_flash),
+              old_ram, new_ram, delta(old_ram, new_ram)))
+
+
+def report_bench(args):
+    baseline = find(os.path.join(args.baseline, 'bench'), 'bench_*.txt', '.txt')
+    current = find(os.path.join(args.current, 'bench'), 'bench_*.txt', '.txt')
+    for name in sorted(set(baseline) & set(current)):
+        old, old_unit = parse_bench(baseline[name])
+        new, new_unit = parse_bench(current[name])
+        if old_unit != new_unit:
+            print('%s: baseline is in %s, current run is in %s' % (name, old_unit, new_unit))
+            continue
+        kernels = sorted(k for k in set(old) & set(new) if old[k] and new[k])
+        print('')
+        print('%-48s %12s %12s %8s' % (name, 'baseline', 'current', 'delta'))
+        for kernel in kernels:
+            print('%-48s %12.1f %12.1f %+7.1f%%' % (kernel, old[kernel], new[kernel], delta(old[kernel], new[kernel])))
+        if kernels:
+            # Geometric mean, so one slow kernel doesn't dominate the summary
+            ratio = math.exp(sum(math.log(new[k] / old[k]) for k in kernels) / len(kernels))
+            print('%-48s %12s %12s %+7.1f%%' % ('geometric mean (%s/call)' % new_unit, '', '', (ratio - 1.0) * 100.0))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare flash, RAM and benchmarks of two builds')
+    parser.add_argument('--size', default='arm-none-eabi-size')
+    parser.add_argument('baseline', help='build directory of the reference build')
+    parser.add_argument('current', help='build directory of the build to compare')
+    parser.add_argument('targets', nargs='*', help='only report these targets')
+    args = parser.parse_args()
+
+    report_sizes(args)
+    report_bench(args)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
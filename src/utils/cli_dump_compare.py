@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+#
+# Runs the same configuration through SITL over TCP and checks that dump
+# and diff print exactly the same thing as a reference, timing each command.
+# The reference is either a second SITL build or the files in
+# src/test/cli, captured from the printer that built the whole dump in
+# one go. ctest runs the second form against every SITL build.
+# Only the diff commands are stored: they go through every section and
+# profile the streaming touches, but print just the SETUP changes, so a
+# new setting or default doesn't change them. dump is compared between
+# two builds only.
+# The version lines carry the build date, commit and compiler, so they're
+# skipped.
+#
+# Usage: cli_dump_compare.py [--port PORT] reference/SITL.elf current/SITL.elf
+#        cli_dump_compare.py [--port PORT] --expected src/test/cli current/SITL.elf
+#        cli_dump_compare.py [--port PORT] --write src/test/cli reference/SITL.elf
+
+import argparse
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+import time
+
+PROMPT = b'\r\n# '
+
+# Lines that change with the build rather than with the configuration
+VERSION_LINES = (b'# INAV/', b'# GCC-')
+
+# Changes from the defaults in every section that dump and diff print
+SETUP = [
+    'set name =  spaced',
+    'set looptime = 500',
+    'set gyro_main_lpf_hz = 90',
+    'set serialrx_provider = CRSF',
+    'aux 0 0 0 1700 2100',
+    'aux 3 1 2 1300 1700',
+    'feature GPS',
+    'feature -AIRMODE',
+    'beeper -RUNTIME_CALIBRATION',
+    'blackbox -MOTORS',
+    'map TAER',
+    'serial 1 2 115200 115200 0 115200',
+    'mmix 0 1.0 -1.0 1.0 -1.0',
+    'mmix 1 1.0 -1.0 -1.0 1.0',
+    'smix 0 0 0 100 0 -1',
+    'servo 0 1000 2000 1500 -100',
+    'rxrange 0 1050 1950',
+    'adjrange 0 0 0 900 2100 0 0 0 0',
+    'led 0 1,1::C:0',
+    'color 2 120,0,255',
+    'safehome 0 1 500000000 100000000',
+    'osd_layout 0 0 10 10 V',
+    'logic 0 1 -1 1 0 1000 0 0 0',
+    'gvar 0 10 -100 100',
+    'pid 0 1 -1 0 0 0 0 0 100 0 0',
+    'set mc_p_pitch = 50',
+    'profile 2',
+    'set mc_p_roll = 55',
+    'set rc_expo = 50',
+    'battery_profile 2',
+    'set bat_cells = 4',
+    'profile 1',
+]
+
+COMMANDS = [
+    'dump',
+    'diff',
+    'dump all',
+    'diff all',
+    'diff all showdefaults',
+    'dump master',
+    'diff profile',
+    'diff battery_profile',
+    'dump profile showdefaults',
+]
+
+# Commands whose output is kept in src/test/cli
+STORED_COMMANDS = [line for line in COMMANDS if line.startswith('diff')]
+
+
+class Sitl:
+    def __init__(self, elf, port):
+        self.dir = tempfile.TemporaryDirectory()
+        self.proc = subprocess.Popen([os.path.abspath(elf), '--path=' + os.path.join(self.dir.name, 'eeprom.bin')],
+                                     cwd=self.dir.name, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        deadline = time.time() + 10
+        while True:
+            try:
+                self.sock = socket.create_connection(('127.0.0.1', port))
+                break
+            except OSError:
+                if time.time() > deadline:
+                    raise
+                time.sleep(0.1)
+        self.sock.settimeout(0.05)
+        self.sock.sendall(b'#')
+        self.read_until_prompt()
+
+    def read_until_prompt(self, timeout=30):
+        # A hash line can end a chunk with the prompt, so wait for a quiet
+        # line before taking it as one
+        data = b''
+        last = time.time()
+        deadline = last + timeout
+        while time.time() < deadline:
+            try:
+                chunk = self.sock.recv(65536)
+                if not chunk:
+                    break
+                data += chunk
+                last = time.time()
+            except socket.timeout:
+                if data.endswith(PROMPT) and time.time() - last > 0.2:
+                    break
+        return data, last
+
+    def command(self, line):
+        start = time.time()
+        self.sock.sendall(line.encode() + b'\n')
+        data, last = self.read_until_prompt()
+        return data, last - start
+
+    def close(self):
+        self.sock.close()
+        self.proc.kill()
+        self.proc.wait()
+        self.dir.cleanup()
+
+
+def capture(elf, port, commands):
+    sitl = Sitl(elf, port)
+    try:
+        for line in SETUP:
+            sitl.command(line)
+        results = {}
+        for line in commands:
+            data, elapsed = sitl.command(line)
+            lines = data.split(b'\r\n')
+            lines = [l for l in lines if not l.startswith(VERSION_LINES)]
+            results[line] = (b'\r\n'.join(lines), elapsed)
+        return results
+    finally:
+        sitl.close()
+
+
+def output_path(directory, line):
+    return os.path.join(directory, line.replace(' ', '_') + '.out')
+
+
+def write(directory, results):
+    os.makedirs(directory, exist_ok=True)
+    for line in STORED_COMMANDS:
+        with open(output_path(directory, line), 'wb') as f:
+            f.write(results[line][0])
+
+
+def load(directory):
+    results = {}
+    for line in STORED_COMMANDS:
+        with open(output_path(directory, line), 'rb') as f:
+            results[line] = (f.read(), None)
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare CLI dump and diff output of SITL against a reference')
+    parser.add_argument('--port', type=int, default=5760, help='TCP port of the SITL CLI')
+    group = parser.add_mutually_exclusive_group()
+    group.add_argument('--expected', metavar='DIR', help='compare against the output stored in DIR')
+    group.add_argument('--write', metavar='DIR', help='store the output of the given build in DIR')
+    parser.add_argument('elf', nargs='+', help='reference and current build, or a single build with --expected/--write')
+    args = parser.parse_args()
+
+    if len(args.elf) != (1 if args.expected or args.write else 2):
+        parser.error('wrong number of SITL builds')
+
+    if args.write:
+        write(args.write, capture(args.elf[0], args.port, STORED_COMMANDS))
+        return 0
+
+    if args.expected:
+        commands = STORED_COMMANDS
+        reference = load(args.expected)
+    else:
+        commands = COMMANDS
+        reference = capture(args.elf[0], args.port, commands)
+    current = capture(args.elf[-1], args.port, commands)
+
+    mismatches = 0
+    print('%-28s %8s %12s %12s' % ('command', 'bytes', 'reference', 'current'))
+    for line in commands:
+        ref_data, ref_time = reference[line]
+        cur_data, cur_time = current[line]
+        marker = ''
+        if ref_data != cur_data:
+            marker = ' MISMATCH'
+            mismatches += 1
+        ref_ms = '%10.1fms' % (ref_time * 1000) if ref_time is not None else '%12s' % '-'
+        print('%-28s %8d %s %10.1fms%s' % (line, len(cur_data), ref_ms, cur_time * 1000, marker))
+
+    if mismatches:
+        print('%d command(s) printed something different' % mismatches)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
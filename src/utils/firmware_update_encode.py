@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+#
+# Encodes a firmware image (.bin) for MSP2_INAV_FWUPDT_STORE with the
+# FIRMWARE_UPDATE_ENCODING_STREAM encoding (see
+# docs/development/Firmware_Update_Streams.md). Without --base the image is
+# only compressed, with --base it is also encoded as a delta against the
+# image running on the flight controller, which must be exactly that file.
+#
+# Usage: firmware_update_encode.py [--base running.bin] [--report] image.bin output.ifus
+
+import argparse
+import struct
+import sys
+
+MAGIC = 0x53554649
+VERSION = 1
+WINDOW_SIZE = 1024
+
+OP_LITERAL = 0
+OP_WINDOW = 1
+OP_BASE = 2
+
+MAX_CHAIN = 64
+MAX_LENGTH = 65536
+
+# MSP2_INAV_FWUPDT_STORE framing used by --report
+MSP_V2_OVERHEAD = 9
+MSP_STORE_PAYLOAD = 128
+
+
+def crc16_ccitt(data):
+    crc = 0
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def varint(value):
+    out = bytearray()
+    while value >= 0x80:
+        out.append((value & 0x7F) | 0x80)
+        value >>= 7
+    out.append(value)
+    return out
+
+
+def zigzag(value):
+    return ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+
+
+def match_length(a, a_pos, b, b_pos):
+    limit = min(len(a) - a_pos, len(b) - b_pos, MAX_LENGTH)
+    length = 0
+    # Compare in slices first, byte by byte for the tail
+    step = 64
+    while length + step <= limit and a[a_pos + length:a_pos + length + step] == b[b_pos + length:b_pos + length + step]:
+        length += step
+    while length < limit and a[a_pos + length] == b[b_pos + length]:
+        length += 1
+    return length
+
+
+def index(data):
+    chains = {}
+    for pos in range(len(data) - 3):
+        chains.setdefault(bytes(data[pos:pos + 4]), []).append(pos)
+    return chains
+
+
+def encode(image, base):
+    out = bytearray()
+    out += struct.pack('<IBBHIIH', MAGIC, VERSION, 0, crc16_ccitt(image), len(image),
+                       len(base) if base else 0, crc16_ccitt(base) if base else 0)
+
+    base_chains = index(base) if base else {}
+    window_chains = {}
+    base_cursor = 0
+    literals = bytearray()
+
+    def flush_literals():
+        for pos in range(0, len(literals), MAX_LENGTH):
+            chunk = literals[pos:pos + MAX_LENGTH]
+            out.extend(varint(((len(chunk) - 1) << 2) | OP_LITERAL))
+            out.extend(chunk)
+        del literals[:]
+
+    def insert(pos):
+        if pos + 4 <= len(image):
+            window_chains.setdefault(bytes(image[pos:pos + 4]), []).append(pos)
+
+    pos = 0
+    while pos < len(image):
+        best = (0, 0, 0, 0)     # gain, length, op, argument
+
+        def consider(op, length, argument):
+            nonlocal best
+            if length < 3:
+                return
+            gain = length - len(varint(((length - 1) << 2) | op)) - len(varint(argument))
+            if gain > best[0]:
+                best = (gain, length, op, argument)
+
+        key = bytes(image[pos:pos + 4])
+        if base:
+            # Where the image continues in the base after the copy or after
+            # an edit of the same size, then anywhere else
+            for candidate in (base_cursor, base_cursor + len(literals)):
+                if candidate < len(base):
+                    consider(OP_BASE, match_length(image, pos, base, candidate), zigzag(candidate - base_cursor))
+            if len(key) == 4:
+                for candidate in reversed(base_chains.get(key, [])[-MAX_CHAIN:]):
+                    consider(OP_BASE, match_length(image, pos, base, candidate), zigzag(candidate - base_cursor))
+
+        if len(key) == 4:
+            for candidate in reversed(window_chains.get(key, [])[-MAX_CHAIN:]):
+                distance = pos - candidate
+                if distance > WINDOW_SIZE:
+                    break
+                consider(OP_WINDOW, match_length(image, pos, image, candidate), distance - 1)
+
+        gain, length, op, argument = best
+        if not length:
+            literals.append(image[pos])
+            insert(pos)
+            pos += 1
+            continue
+
+        flush_literals()
+        out.extend(varint(((length - 1) << 2) | op))
+        out.extend(varint(argument))
+        if op == OP_BASE:
+            move = (argument >> 1) ^ -(argument & 1)
+            base_cursor += move + length
+        for i in range(length):
+            insert(pos + i)
+        pos += length
+
+    flush_literals()
+    return out
+
+
+def wire_bytes(payload):
+    messages = (payload + MSP_STORE_PAYLOAD - 1) // MSP_STORE_PAYLOAD
+    # Every request is acknowledged with an empty reply
+    return payload + messages * 2 * MSP_V2_OVERHEAD
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode a firmware image for a streamed MSP firmware update')
+    parser.add_argument('--base', help='image running on the flight controller, to encode a delta against')
+    parser.add_argument('--report', action='store_true', help='print the bytes on the wire for raw and encoded updates')
+    parser.add_argument('image')
+    parser.add_argument('output')
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    base = None
+    if args.base:
+        with open(args.base, 'rb') as f:
+            base = f.read()
+
+    encoded = encode(image, base)
+    with open(args.output, 'wb') as f:
+        f.write(encoded)
+
+    if args.report:
+        print('image   %8d bytes, %8d on the wire' % (len(image), wire_bytes(len(image))))
+        print('encoded %8d bytes, %8d on the wire (%.1f%%)' % (len(encoded), wire_bytes(len(encoded)),
+              100.0 * wire_bytes(len(encoded)) / wire_bytes(len(image))))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,330 @@
+#!/usr/bin/env python3
+#
+# Profile guided placement of hot code and data into tightly coupled memory
+# (ITCM/DTCM on F7/H7, CCM on F4, RAM1 on AT32). See
+# docs/development/TCM_Placement.md.
+#
+# Usage:
+#   tcm_placement.py convert --format gprof|perf|pc [--elf firmware.elf] input > profile.txt
+#   tcm_placement.py place --profile profile.txt --objects-dir DIR --output-dir DIR
+#                          [--code-budget BYTES] [--data-budget BYTES]
+#
+# A profile is a text file with one "<weight> <symbol>" pair per line. Weights
+# are relative (samples, percent or seconds), lines starting with '#' are
+# comments and "!<symbol>" never gets placed.
+#
+# place looks at the objects built with -ffunction-sections -fdata-sections,
+# so every function lives in .text.<name> and every zero initialised
+# variable in .bss.<name>. Variables inherit the weight of the hot functions
+# referencing them. Sections are then picked by weight per byte until the
+# budget is used up and written as the .tcm_code_profile and
+# .tcm_data_profile output sections the linker scripts INCLUDE
+# (tcm_code_profile.ld, tcm_data_profile.ld).
+
+import argparse
+import bisect
+import os
+import re
+import subprocess
+import sys
+
+CODE_FRAGMENT = 'tcm_code_profile.ld'
+DATA_FRAGMENT = 'tcm_data_profile.ld'
+REPORT = 'tcm_placement.txt'
+
+# Code that runs before .tcm_code is copied into place
+NEVER_PLACE = {
+    'Reset_Handler',
+    'SystemInit',
+    'initialiseMemorySections',
+    'main',
+}
+
+# DMA can't reach F4 CCM or H7 DTCM, and DMA_RAM is empty on F4/F7, so DMA
+# buffers can't be told apart by their section. An object which calls into a
+# DMA driver (dmaInit, DMA_Init, HAL_ADC_Start_DMA, timerPWMConfigChannelDMA,
+# ...) keeps all its variables out of TCM, as do the variables named by the
+# functions making those calls.
+DMA_SYMBOL = re.compile(r'dma', re.IGNORECASE)
+
+# Buffers handed to DMA through a driver API, which the above can't see
+DMA_VARIABLES = {
+    'afatfs',           # the SDIO driver reads and writes the sector cache in place
+    'afatfs_cache',
+}
+
+
+def read_profile(filename):
+    weights = {}
+    excluded = set()
+    with open(filename) as f:
+        for line in f:
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            if line.startswith('!'):
+                excluded.add(line[1:].strip())
+                continue
+            fields = line.split()
+            if len(fields) != 2:
+                raise ValueError('%s: bad profile line "%s"' % (filename, line))
+            weights[fields[1]] = weights.get(fields[1], 0.0) + float(fields[0])
+    return weights, excluded
+
+
+def convert_gprof(f):
+    # Flat profile from "gprof -b -p", self seconds are the weight
+    weights = {}
+    for line in f:
+        fields = line.split()
+        if len(fields) < 4 or not re.match(r'^[\d.]+$', fields[0]):
+            continue
+        weights[fields[-1]] = weights.get(fields[-1], 0.0) + float(fields[2])
+    return weights
+
+
+def convert_perf(f):
+    # "perf report --stdio --sort symbol" output: "  12.34%  [.] name"
+    weights = {}
+    for line in f:
+        m = re.match(r'^\s*([\d.]+)%\s+\[.\]\s+(\S+)', line)
+        if m:
+            weights[m.group(2)] = weights.get(m.group(2), 0.0) + float(m.group(1))
+    return weights
+
+
+def convert_pc(f, elf, nm):
+    # One sampled program counter per line, as collected by DWT PC sampling
+    # over SWO. Addresses are resolved with the ELF the samples were taken on.
+    output = subprocess.check_output([nm, '-S', '--defined-only', elf], universal_newlines=True)
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[2] in 'tTwW':
+            symbols.append((int(fields[0], 16) & ~1, int(fields[1], 16), fields[3]))
+    symbols.sort()
+    starts = [s[0] for s in symbols]
+
+    weights = {}
+    for line in f:
+        line = line.strip()
+        if not line:
+            continue
+        pc = int(line, 16)
+        i = bisect.bisect_right(starts, pc) - 1
+        if i >= 0 and pc < symbols[i][0] + symbols[i][1]:
+            name = symbols[i][2]
+            weights[name] = weights.get(name, 0) + 1
+    return weights
+
+
+def read_object(objdump, path):
+    # Returns ({section: size}, {section: set(referenced sections/symbols)})
+    output = subprocess.check_output([objdump, '-h', '-r', path], universal_newlines=True)
+    sections = {}
+    relocations = {}
+    current = None
+    for line in output.splitlines():
+        m = re.match(r'^\s*\d+\s+(\S+)\s+([0-9a-fA-F]+)\s', line)
+        if m:
+            sections[m.group(1)] = int(m.group(2), 16)
+            continue
+        m = re.match(r'^RELOCATION RECORDS FOR \[(\S+)\]:', line)
+        if m:
+            current = relocations.setdefault(m.group(1), set())
+            continue
+        fields = line.split()
+        if current is not None and len(fields) == 3 and re.match(r'^[0-9a-fA-F]+$', fields[0]):
+            current.add(re.split(r'[+-]0x', fields[2])[0])
+    return sections, relocations
+
+
+def symbol_name(target):
+    # Relocations name a global symbol, or the section of a static one
+    for prefix in ('.text.', '.bss.', '.data.', '.rodata.'):
+        if target.startswith(prefix):
+            return target[len(prefix):]
+    return target
+
+
+def dma_variables(sections, relocations):
+    # Variables in an object talking to a DMA driver, see DMA_SYMBOL
+    names = set()
+    for section, targets in relocations.items():
+        if any(DMA_SYMBOL.search(symbol_name(t)) for t in targets):
+            names.update(symbol_name(t) for t in targets)
+    if names:
+        names.update(s[len('.bss.'):] for s in sections if s.startswith('.bss.'))
+    return names
+
+
+def pick(candidates, budget):
+    # Greedy by weight per byte, good enough for a few hundred sections
+    chosen = []
+    used = 0
+    for weight, size, pattern, name in sorted(candidates, key=lambda c: (-c[0] / max(c[1], 1), c[3])):
+        if used + size <= budget:
+            chosen.append((weight, size, pattern, name))
+            used += size
+    return chosen, used
+
+
+# Output sections of the generated fragments, see drivers/system.c
+CODE_SECTION = """\
+tcm_code_profile = LOADADDR(.tcm_code_profile);
+.tcm_code_profile :
+{
+    . = ALIGN(4);
+    tcm_code_profile_start = .;
+%s    . = ALIGN(4);
+    tcm_code_profile_end = .;
+} >ITCM_RAM AT >FLASH1
+"""
+
+DATA_SECTION = """\
+.tcm_data_profile (NOLOAD) :
+{
+    . = ALIGN(4);
+    tcm_data_profile_start = .;
+%s    . = ALIGN(4);
+    tcm_data_profile_end = .;
+} >FASTRAM
+"""
+
+
+def write_fragment(path, kind, section, chosen):
+    with open(path, 'w') as f:
+        f.write('/* Generated by tcm_placement.py, do not edit. Hot %s by weight per byte. */\n' % kind)
+        if chosen:
+            f.write(section % ''.join('    %s /* %s, %d bytes, weight %g */\n' % (pattern, name, size, weight)
+                                      for weight, size, pattern, name in chosen))
+
+
+def place(args):
+    weights, excluded = read_profile(args.profile)
+    excluded |= NEVER_PLACE
+    dma = set(DMA_VARIABLES)
+
+    objects = []
+    for root, _, files in os.walk(args.objects_dir):
+        for filename in files:
+            if filename.endswith('.o'):
+                objects.append(os.path.join(root, filename))
+    objects.sort()
+
+    code = []
+    data = {}
+    fixed_code = 0
+    fixed_data = 0
+    for path in objects:
+        sections, relocations = read_object(args.objdump, path)
+        dma |= dma_variables(sections, relocations)
+        # ld matches input files as they were passed to it, relative to the
+        # build directory. A leading '*' keeps the pattern independent of that.
+        filename = '*/' + os.path.relpath(path, args.objects_dir).replace(os.sep, '/')
+
+        for section, size in sections.items():
+            if section.startswith('.tcm_code'):
+                fixed_code += size
+            elif section.startswith('.fastram_bss'):
+                fixed_data += size
+
+        for section, size in sections.items():
+            if not section.startswith('.text.'):
+                continue
+            name = section[len('.text.'):]
+            weight = weights.get(name, 0.0)
+            if weight <= 0 or name in excluded:
+                continue
+            code.append((weight, size, '%s(%s)' % (filename, section), name))
+
+            # Zero initialised data used by a hot function gets its weight
+            for target in relocations.get(section, ()):
+                variable = target[len('.bss.'):] if target.startswith('.bss.') else target
+                bss = '.bss.' + variable
+                if bss in sections:
+                    key = (filename, bss)
+                    w, s, p, n = data.get(key, (0.0, sections[bss], '%s(%s)' % (filename, bss), variable))
+                    data[key] = (w + weight, s, p, n)
+
+        for section, size in sections.items():
+            if section.startswith('.bss.') and section[len('.bss.'):] in weights:
+                variable = section[len('.bss.'):]
+                key = (filename, section)
+                w, s, p, n = data.get(key, (0.0, size, '%s(%s)' % (filename, section), variable))
+                data[key] = (w + weights[variable], s, p, n)
+
+    data = [d for d in data.values() if d[3] not in excluded and d[3] not in dma]
+
+    code_chosen, code_used = pick(code, max(args.code_budget - fixed_code, 0))
+    data_chosen, data_used = pick(data, max(args.data_budget - fixed_data, 0))
+
+    os.makedirs(args.output_dir, exist_ok=True)
+    write_fragment(os.path.join(args.output_dir, CODE_FRAGMENT), 'functions', CODE_SECTION, code_chosen)
+    write_fragment(os.path.join(args.output_dir, DATA_FRAGMENT), 'variables', DATA_SECTION, data_chosen)
+
+    total = sum(weights.values()) or 1.0
+    lines = []
+    lines.append('TCM placement from %s' % args.profile)
+    for kind, fixed, used, budget, chosen, candidates in (
+            ('code', fixed_code, code_used, args.code_budget, code_chosen, code),
+            ('data', fixed_data, data_used, args.data_budget, data_chosen, data)):
+        lines.append('%s: %d bytes FAST_CODE/FASTRAM + %d bytes from profile of %d byte budget, %d of %d candidates placed' %
+                     (kind, fixed, used, budget, len(chosen), len(candidates)))
+    covered = sum(c[0] for c in code_chosen)
+    lines.append('profiled code weight in TCM: %.1f%%' % (covered * 100.0 / total))
+    for weight, size, _, name in code_chosen + data_chosen:
+        lines.append('  %-40s %6d bytes  weight %g' % (name, size, weight))
+
+    with open(os.path.join(args.output_dir, REPORT), 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+    print('\n'.join(lines[:4]))
+    return 0
+
+
+def convert(args):
+    with open(args.input) as f:
+        if args.format == 'gprof':
+            weights = convert_gprof(f)
+        elif args.format == 'perf':
+            weights = convert_perf(f)
+        else:
+            if not args.elf:
+                print('error: --elf is required to resolve PC samples', file=sys.stderr)
+                return 2
+            weights = convert_pc(f, args.elf, args.nm)
+
+    for name, weight in sorted(weights.items(), key=lambda w: (-w[1], w[0])):
+        print('%g %s' % (weight, name))
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Profile guided TCM placement')
+    subparsers = parser.add_subparsers(dest='command')
+    subparsers.required = True
+
+    p = subparsers.add_parser('convert', help='turn profiler output into a profile')
+    p.add_argument('--format', choices=('gprof', 'perf', 'pc'), required=True)
+    p.add_argument('--elf', help='firmware the PC samples were taken on')
+    p.add_argument('--nm', default='arm-none-eabi-nm')
+    p.add_argument('input')
+    p.set_defaults(func=convert)
+
+    p = subparsers.add_parser('place', help='generate the linker script fragments')
+    p.add_argument('--profile', required=True)
+    p.add_argument('--objects-dir', required=True)
+    p.add_argument('--output-dir', required=True)
+    p.add_argument('--code-budget', type=int, default=0,
+                   help='bytes of ITCM for FAST_CODE and profiled functions')
+    p.add_argument('--data-budget', type=int, default=0,
+                   help='bytes of DTCM/CCM for FASTRAM and profiled variables')
+    p.add_argument('--objdump', default='arm-none-eabi-objdump')
+    p.set_defaults(func=place)
+
+    args = parser.parse_args()
+    return args.func(args)
+
+
+if __name__ == '__main__':
+    sys.exit(main())